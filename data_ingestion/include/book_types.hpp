@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "common_constants.hpp"
+
+using microregime::DEPTH_LEVELS;
+
+// Types shared by every order book implementation
+enum class BookSide { Bid, Ask };
+
+struct PriceLevel {
+    double price;
+    int size;
+};
+
+// A single resting order as reported by a book
+struct RestingOrder {
+    BookSide side;
+    int64_t price;  // DBN fixed-point
+    int size;
+};
+
+struct L3Snapshot {
+    std::array<PriceLevel, DEPTH_LEVELS> bid{};
+    std::array<PriceLevel, DEPTH_LEVELS> ask{};
+};
+
+struct L3Delta {
+    std::array<int8_t, DEPTH_LEVELS> bid_dir{}; // +1 = added, -1 = removed
+    std::array<int8_t, DEPTH_LEVELS> ask_dir{};
+};
+
+// Per-level direction of liquidity change between two top-N views of one side
+inline void compute_depth_delta(const std::array<PriceLevel, DEPTH_LEVELS>& old_levels,
+                                const std::array<PriceLevel, DEPTH_LEVELS>& new_levels,
+                                std::array<int8_t, DEPTH_LEVELS>& delta) {
+    for (size_t i = 0; i < DEPTH_LEVELS; ++i) {
+        double old_price = old_levels[i].price;
+        double new_price = new_levels[i].price;
+        int old_size = old_levels[i].size;
+        int new_size = new_levels[i].size;
+
+        if (std::abs(new_price - old_price) < 1e-10) {
+            // Same price level: compare sizes
+            if (new_size > old_size) {
+                delta[i] = 1;   // Added liquidity
+            } else if (new_size < old_size) {
+                delta[i] = -1;  // Removed liquidity
+            } else {
+                delta[i] = 0;    // No change
+            }
+        } else {
+            // Price level changed
+            if (new_size == old_size) {
+                delta[i] = 0;   // Assume shift without net liquidity change
+            } else if (new_size > old_size) {
+                delta[i] = 1;   // Net add at new level
+            } else {
+                delta[i] = -1;  // Net remove
+            }
+        }
+    }
+}
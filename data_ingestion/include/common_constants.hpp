@@ -1,13 +1,21 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 namespace microregime {
 
 // Common constants used across the codebase
 constexpr size_t DEPTH_LEVELS = 10;     // Top N price levels
 constexpr size_t ROLLING_WINDOW = 1500;   // For Feature Input windows *We avg 470 events per second, so 500 is about 1 second
+constexpr size_t MIDPRICE_WINDOW = 1800;  // 50ms midprice/spread samples kept for volatility features
 constexpr size_t WINDOW_SIZE = 30000; // For Feature Normalizer windows
 constexpr size_t SNAPSHOT_INTERVAL_NS = 500'000'000; // 100ms (for Timestamp Pipeline)
+constexpr uint64_t LOG_RETURN_LOOKBACK_NS = 10'000'000'000; // log_return is taken against the midprice this long ago
+
+// Prices (DBN fixed-point, 1 unit = 1e-9)
+constexpr int64_t PRICE_SCALE = 1'000'000'000;
+constexpr int64_t DEFAULT_TICK_SIZE = 10'000'000;  // $0.01, US equities
+constexpr int64_t ES_TICK_SIZE = 250'000'000;      // 0.25 index points, CME E-mini S&P 500
 
 } // namespace microregime
@@ -1,36 +1,79 @@
 #pragma once
 
 #include <cstdint>
+#include <exception>
 #include <memory>
+#include <span>
 #include <string>
 #include "databento/dbn_decoder.hpp"
+#include "event_source.hpp"
 #include "market_event.hpp"
+#include "symbol_table.hpp"
 
-class DbnMboReader {
+// How DbnMboReader gets records off disk
+enum class DbnReadMode {
+    Streaming,  // Decode one record at a time on the calling thread
+    Prefetch,   // Decompress and decode on a background thread into a ring of large blocks
+    Mapped,     // mmap a pre-decompressed .dbn file and hand out records in place (zero-copy)
+};
+
+class DbnMboReader : public EventSource {
 public:
-    explicit DbnMboReader(const std::string& filepath, const std::string& instrument);
-    ~DbnMboReader();
+    explicit DbnMboReader(const std::string& filepath, const std::string& instrument,
+                          DbnReadMode mode = DbnReadMode::Streaming);
+    ~DbnMboReader() override;
 
     // Whether there are more MBO records to read
-    bool has_next() const;
+    bool has_next() const override;
 
     // Return the next parsed MBO record as a MarketEvent
-    MarketEvent next_event();
+    MarketEvent next_event() override;
+
+    // Fill `out` with as many upcoming events as are available, converting a
+    // whole block at a time. Returns the number written; 0 at end of file. A
+    // read error after some events were written ends the batch early and is
+    // thrown by the next read instead.
+    size_t next_batch(std::span<MarketEvent> out) override;
+
+    // Next run of MBO records for batch consumption, starting after whatever
+    // next_event() has already returned. Views stay valid until the next call
+    // to next_block(), next_event() or has_next(). Empty at end of file.
+    std::span<const databento::MboMsg> next_block();
+
+    // Convert one DBN MBO record to this reader's MarketEvent
+    MarketEvent to_event(const databento::MboMsg& mbo) const;
 
     // Return the instrument name (e.g., "ES" or "SPY")
     const std::string& instrument_id() const { return instrument_; }
 
+    // Interned id stamped on every event from this reader
+    microregime::SymbolId symbol() const { return symbol_; }
+
     // Total number of events parsed
     size_t event_count() const { return event_count_; }
 
 private:
-    // PIMPL pattern to hide implementation details
+    // PIMPL pattern to hide implementation details; one Impl per read mode
     struct Impl;
+    struct StreamingImpl;
+    struct PrefetchImpl;
+    struct MappedImpl;
     std::unique_ptr<Impl> pimpl_;
-    
+
     // Instrument name
     std::string instrument_;
-    
+    microregime::SymbolId symbol_;
+
+    // Current block and the next record in it, refilled lazily
+    mutable std::span<const databento::MboMsg> block_;
+    mutable size_t block_pos_{0};
+
     // Event counter
     size_t event_count_{0};
-};
\ No newline at end of file
+
+    // Read error held back by next_batch, rethrown by the next refill
+    mutable std::exception_ptr pending_error_;
+
+    // Make block_ non-empty unless the file is exhausted
+    void refill() const;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "event_source.hpp"
+#include "mapped_file.hpp"
+#include "market_event.hpp"
+#include "symbol_table.hpp"
+
+// Pre-decoded, columnar cache of one instrument-day of MarketEvents.
+//
+// Written once from a DBN file (see tools/build_event_cache.cpp) with the
+// OrderEngine instrument filter already applied, then memory-mapped on every
+// later run so replays skip zstd and DBN decoding entirely.
+//
+// Layout: a fixed header followed by one contiguous array per MarketEvent
+// field, each starting on a 64-byte boundary. All integers little-endian.
+namespace event_cache {
+
+constexpr char kMagic[8] = {'M', 'R', 'E', 'V', 'C', 'A', 'C', 'H'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kColumnAlignment = 64;
+constexpr const char* kExtension = ".events";
+
+enum Column : size_t {
+    Timestamp,     // uint64_t
+    Price,         // int64_t
+    OrderId,       // uint64_t
+    InstrumentId,  // uint32_t
+    Sequence,      // uint32_t
+    Size,          // int32_t
+    Action,        // char
+    Side,          // char
+    Flags,         // uint8_t
+    ChannelId,     // uint8_t
+    ColumnCount
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t column_count;
+    uint64_t event_count;
+    char instrument[16];                   // NUL-padded
+    uint64_t column_offset[ColumnCount];   // Byte offset of each column from file start
+};
+
+// Cache file that sits next to a DBN file: foo.mbo.dbn.zst -> foo.mbo.events
+std::string path_for(const std::string& dbn_path);
+
+} // namespace event_cache
+
+class EventCacheWriter {
+public:
+    EventCacheWriter(const std::string& filepath, const std::string& instrument);
+    ~EventCacheWriter();
+
+    EventCacheWriter(const EventCacheWriter&) = delete;
+    EventCacheWriter& operator=(const EventCacheWriter&) = delete;
+
+    void append(const MarketEvent& event);
+
+    // Assemble the final file. Called by the destructor if not called explicitly.
+    void finish();
+
+    size_t event_count() const { return event_count_; }
+
+private:
+    std::string filepath_;
+    std::string instrument_;
+    size_t event_count_ = 0;
+    bool finished_ = false;
+
+    // Columns are spilled to side files while writing so memory stays flat
+    std::vector<std::string> spill_paths_;
+    std::vector<std::ofstream> spill_;
+};
+
+class EventCacheReader : public EventSource {
+public:
+    explicit EventCacheReader(const std::string& filepath);
+
+    bool has_next() const override { return pos_ < event_count_; }
+    MarketEvent next_event() override;
+    size_t next_batch(std::span<MarketEvent> out) override;
+
+    // Instrument the cache was built for
+    const std::string& instrument() const { return instrument_; }
+    microregime::SymbolId symbol() const { return symbol_; }
+    size_t event_count() const { return event_count_; }
+
+private:
+    MappedFile file_;
+    std::string instrument_;
+    microregime::SymbolId symbol_;
+    size_t event_count_ = 0;
+    size_t pos_ = 0;
+
+    const uint64_t* timestamp_;
+    const int64_t* price_;
+    const uint64_t* order_id_;
+    const uint32_t* instrument_id_;
+    const uint32_t* sequence_;
+    const int32_t* size_;
+    const char* action_;
+    const char* side_;
+    const uint8_t* flags_;
+    const uint8_t* channel_id_;
+
+    template <typename T>
+    const T* column(const event_cache::Header& header, event_cache::Column column) const;
+};
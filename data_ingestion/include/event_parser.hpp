@@ -1,16 +1,25 @@
 #pragma once
 
 #include "dbn_reader.hpp"
+#include "event_source.hpp"
 #include "order_engine.hpp"
 #include "feature_engine.hpp"
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <vector>
 #include <cstdint>
 
 class EventParser {
 public:
-    // Constructor with DBN file path and instrument
-    EventParser(const std::string& dbn_filepath, const std::string& instrument);
+    // Constructor with DBN file path and instrument. A path ending in
+    // event_cache::kExtension replays a pre-decoded event cache instead.
+    EventParser(const std::string& dbn_filepath, const std::string& instrument,
+                DbnReadMode mode = DbnReadMode::Streaming);
+
+    // Constructor with any event source
+    explicit EventParser(std::unique_ptr<EventSource> source);
     ~EventParser() = default;
     
     // Disable copy and move
@@ -30,6 +39,17 @@ public:
     // Returns true if an event was processed, false if no more events
     bool process_next(OrderEngine& engine, FeatureEngine* feature_engine = nullptr);
     
+    // Process the next batch of up to kBatchSize events through engine.process_events
+    // Returns true if any events were processed, false if no more events
+    bool process_batch(OrderEngine& engine, FeatureEngine* feature_engine = nullptr);
+
+    // Fill `out` with upcoming events, starting with the buffered lookahead event
+    // Returns the number of events written, 0 when exhausted
+    size_t next_batch(std::span<MarketEvent> out);
+
+    // Events per process_batch call
+    static constexpr size_t kBatchSize = 4096;
+
     // Get the current timestamp (from last processed event)
     uint64_t current_timestamp() const { return current_timestamp_; }
     
@@ -39,14 +59,19 @@ public:
     // Get the next event from the reader (with buffering)
     std::optional<MarketEvent> get_next_event();
 private:
-    // The DBN reader
-    std::unique_ptr<DbnMboReader> reader_;
+    // The event source (DBN reader or event cache)
+    std::unique_ptr<EventSource> reader_;
+
+    // Prime the lookahead event
+    void prime();
     
     // Current timestamp (from last processed event)
     uint64_t current_timestamp_ = 0;
     
     // Buffer for the next event (used for lookahead)
     std::optional<MarketEvent> next_event_;
-    
+
+    // Reused storage for process_batch
+    std::vector<MarketEvent> batch_;
 
 };
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include "market_event.hpp"
+
+// A forward-only stream of MarketEvents for EventParser to replay.
+// Implemented by DbnMboReader (DBN files) and EventCacheReader (pre-decoded cache).
+class EventSource {
+public:
+    virtual ~EventSource() = default;
+
+    // Whether there are more events to read
+    virtual bool has_next() const = 0;
+
+    // Return the next event. Throws std::runtime_error when exhausted.
+    virtual MarketEvent next_event() = 0;
+
+    // Fill `out` with as many upcoming events as are available.
+    // Returns the number written; 0 when exhausted. Throws only if it wrote
+    // nothing: an error after some events ends the batch short and is thrown
+    // by the next call.
+    virtual size_t next_batch(std::span<MarketEvent> out) = 0;
+};
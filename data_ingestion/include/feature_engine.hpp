@@ -1,8 +1,9 @@
 #pragma once
 
-#include "order_book.hpp"
+#include "price_ladder_book.hpp"
 #include "feature_snapshot.hpp"
-#include <deque>
+#include "rolling_stats.hpp"
+#include "ring_buffer.hpp"
 #include <array>
 #include <cstdint>
 #include <memory>
@@ -10,10 +11,17 @@
 // Forward declaration
 struct L3Snapshot;
 
+// Window lengths of a FeatureEngine's rolling state
+struct FeatureWindows {
+    size_t rolling_events = ROLLING_WINDOW;      // Trades, tick directions and event types
+    size_t midprice_samples = MIDPRICE_WINDOW;   // 50ms midprice / spread samples
+};
+
 class FeatureEngine {
 public:
-    // Constructor that takes a reference to an OrderBookManager
-    FeatureEngine(OrderBookManager& order_book, std::string instrument);
+    // Constructor that takes a reference to the instrument's order book. Several
+    // engines may share one book; each tracks its own depth changes between snapshots.
+    FeatureEngine(PriceLadderBook& order_book, std::string instrument, FeatureWindows windows = {});
     
     // Disable copy and move constructors/assignment (rule of 5 :))
     ~FeatureEngine() = default;
@@ -38,21 +46,47 @@ public:
     
     void UpdateMidpriceAndSpread(double midprice, double spread);
     uint64_t most_recent_timestamp_ns = 0;
+
+    const FeatureWindows& windows() const { return windows_; }
     
 private:
     // Reference to the order book
-    OrderBookManager& order_book_;
-    std::string instrument_;
+    PriceLadderBook& order_book_;
+    microregime::SymbolId instrument_;
+    FeatureWindows windows_;
+
+    // Top levels at this engine's previous snapshot, for the depth change directions
+    L3Snapshot last_depth_{};
+    uint64_t last_depth_version_ = 0;
+
     // Internal state for rolling calculations
     struct RollingState {
-        std::deque<double> midprices; // Take the last 5 minutes of midprices 0.05 seconds between each update.
-        std::deque<double> spreads; // Take the last 5 minutes of spreads 0.05 seconds between each update.
+        explicit RollingState(const FeatureWindows& windows)
+            : midprices{windows.midprice_samples + 1},
+              spreads{windows.midprice_samples + 1},
+              midprice_returns{windows.midprice_samples + 1, 2.0 / (windows.rolling_events + 1)},
+              rolling_trade_directions{windows.rolling_events},
+              tick_directions{windows.rolling_events},
+              recent_event_types{windows.rolling_events},
+              trade_volumes{windows.rolling_events + 1} {}
+
+        // Windows hold one extra sample between the push and the eviction in UpdateMidpriceAndSpread
+        microregime::RingBuffer<double> midprices; // Take the last 5 minutes of midprices 0.05 seconds between each update.
+        microregime::RingBuffer<double> spreads; // Take the last 5 minutes of spreads 0.05 seconds between each update.
+
+        // Volatility inputs over the same windows, updated per sample
+        RollingLogReturns midprice_returns;
+        RollingMoments spread_moments;
         
-        std::deque<int8_t> rolling_trade_directions;
-        std::deque<int8_t> tick_directions;
-        std::deque<char> recent_event_types;
+        RollingDirections rolling_trade_directions;
+        RollingDirections tick_directions;
+        microregime::RingBuffer<char> recent_event_types;
 
-        std::deque<std::pair<int8_t, double>> trade_volumes;
+        struct TradeVolume {
+            int8_t direction;
+            double size;
+        };
+        microregime::RingBuffer<TradeVolume> trade_volumes;
         double buy_volume = 0.0;
         double sell_volume = 0.0;
 
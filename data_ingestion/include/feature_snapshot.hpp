@@ -1,18 +1,21 @@
 #pragma once
 
-#include <deque>
 #include <array>
+#include <span>
 #include <string>
 #include <cstdint>
 #include "common_constants.hpp"
+#include "rolling_stats.hpp"
+#include "symbol_table.hpp"
 
 using microregime::DEPTH_LEVELS;
 using microregime::ROLLING_WINDOW;
+using microregime::MIDPRICE_WINDOW;
 
 struct FeatureInputSnapshot {
     // --- Timestamp and Event Type ---
     uint64_t timestamp_ns;               // Nanosecond timestamp
-    std::string instrument;
+    microregime::SymbolId instrument;
 
     // --- Top of Book State ---
     double best_bid_price;
@@ -29,11 +32,13 @@ struct FeatureInputSnapshot {
     double rolling_sell_volume;
     int adds_since_last_snapshot;
 
-    // Rolling windows.
-    const std::deque<double>* rolling_midprices; // Take the last 5 minutes of midprices 0.05 seconds between each update.
-    const std::deque<double>* rolling_spreads;   // Take the last 5 minutes of spreads 0.05 seconds between each update.
-    const std::deque<int8_t>* rolling_tick_directions; // +1, 0, -1
-    const std::deque<int8_t>* rolling_trade_directions;
+    // Rolling windows, oldest first. Views into the engine's state, valid until its next update.
+    std::span<const double> rolling_midprices; // Take the last 5 minutes of midprices 0.05 seconds between each update.
+    std::span<const double> rolling_spreads;   // Take the last 5 minutes of spreads 0.05 seconds between each update.
+    const RollingDirections* rolling_tick_directions; // +1, 0, -1
+    const RollingDirections* rolling_trade_directions;
+    const RollingLogReturns* midprice_returns;      // Log returns of rolling_midprices
+    const RollingMoments* spread_moments;           // Moments of rolling_spreads
 
     // --- Depth Change Direction (LOB Dynamics) ---
     std::array<int8_t, DEPTH_LEVELS> bid_depth_change_direction; // +1 = added, -1 = removed
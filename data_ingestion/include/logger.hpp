@@ -0,0 +1,37 @@
+#pragma once
+
+#include <ios>
+#include <sstream>
+#include <string>
+
+namespace microregime {
+
+// One line of progress output, written to std::cout as a whole when it goes
+// out of scope, so lines from days running in parallel never interleave:
+//
+//     LogLine() << date << ": " << count << " snapshots";
+class LogLine {
+public:
+    LogLine() = default;
+    ~LogLine();
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    template <typename T>
+    LogLine& operator<<(const T& value) {
+        buffer_ << value;
+        return *this;
+    }
+
+    // Manipulators such as std::fixed
+    LogLine& operator<<(std::ios_base& (*manipulator)(std::ios_base&)) {
+        buffer_ << manipulator;
+        return *this;
+    }
+
+private:
+    std::ostringstream buffer_;
+};
+
+} // namespace microregime
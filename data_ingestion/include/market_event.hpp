@@ -1,19 +1,30 @@
 #pragma once
 
 #include <cstdint>
-#include <string>
+#include <type_traits>
+#include "common_constants.hpp"
+#include "symbol_table.hpp"
 
-// Common market event structure used across the application
+// Common market event structure used across the application.
+// Fixed-size and trivially copyable: no per-event allocation anywhere on the ingest path.
 struct MarketEvent {
     uint64_t timestamp_ns;   // Nanoseconds since epoch
-    std::string instrument;  // Instrument identifier (e.g., "ES")
+    int64_t price;           // Price level, DBN fixed-point (1 unit = 1e-9)
+    uint64_t order_id;      // Unique order identifier
+    uint32_t instrument_id; // Numeric instrument identifier
+    uint32_t sequence;      // Sequence number for gap detection
+    int size;               // Order size
+    microregime::SymbolId symbol; // Interned instrument name (e.g., "ES"), see symbol_table.hpp
     char action;            // 'A'dd, 'M'odify, 'C'ancel, 'T'rade, 'F'ill, 'R'eplace
     char side;              // 'B'id, 'A'sk, or 'N'one
-    double price;           // Price level
-    int size;               // Order size
-    uint64_t order_id;      // Unique order identifier
     uint8_t flags;          // Bitfield: end-of-event, implied, self-trade, etc.
-    uint32_t instrument_id; // Numeric instrument identifier
     uint8_t channel_id;     // Channel identifier for sharded feeds
-    uint32_t sequence;      // Sequence number for gap detection
+
+    // Price in instrument units (e.g., dollars)
+    double price_value() const {
+        return static_cast<double>(price) / microregime::PRICE_SCALE;
+    }
 };
+
+static_assert(std::is_trivially_copyable_v<MarketEvent>, "MarketEvent must stay trivially copyable");
+static_assert(sizeof(MarketEvent) == 48, "MarketEvent layout changed");
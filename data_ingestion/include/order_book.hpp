@@ -7,27 +7,11 @@
 #include <cstdint>
 #include <stdexcept>
 #include <limits>
+#include "book_types.hpp"
 #include "common_constants.hpp"
 
 using microregime::DEPTH_LEVELS;
 
-enum class BookSide { Bid, Ask };
-
-struct PriceLevel {
-    double price;
-    int size;
-};
-
-struct L3Snapshot {
-    std::array<PriceLevel, DEPTH_LEVELS> bid{};
-    std::array<PriceLevel, DEPTH_LEVELS> ask{};
-};
-
-struct L3Delta {
-    std::array<int8_t, DEPTH_LEVELS> bid_dir{}; // +1 = added, -1 = removed
-    std::array<int8_t, DEPTH_LEVELS> ask_dir{};
-};
-
 struct Order {
     uint64_t order_id;
     int size;
@@ -75,7 +59,4 @@ private:
 
     int sum_level_size(const OrderQueue& queue) const;
     void build_snapshot(BookSide side, const auto& book, std::array<PriceLevel, DEPTH_LEVELS>& levels) const;
-    void compute_delta(const std::array<PriceLevel, DEPTH_LEVELS>& old_levels,
-                       const std::array<PriceLevel, DEPTH_LEVELS>& new_levels,
-                       std::array<int8_t, DEPTH_LEVELS>& delta) const;
 };
@@ -1,18 +1,20 @@
 #pragma once
 
-#include "order_book.hpp"
+#include "price_ladder_book.hpp"
 #include "market_event.hpp"
 #include "feature_engine.hpp"
+#include "symbol_table.hpp"
 #include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <optional>
+#include <span>
 
 // Structure to track order metadata
 struct OrderInfo {
     BookSide side;
-    double price;
-    std::string instrument;
+    int64_t price;  // DBN fixed-point
+    microregime::SymbolId symbol;
 };
 
 class OrderEngine {
@@ -28,9 +30,23 @@ public:
 
     // Process a single market event
     void process_event(const MarketEvent& event, FeatureEngine* feature_engine = nullptr);
+
+    // Same, notifying each of several feature engines kept over the same book
+    void process_event(const MarketEvent& event, std::span<FeatureEngine* const> feature_engines);
+
+    // Process a batch of events in order; same result as process_event on each.
+    // The book lookup is hoisted out of runs of events for the same instrument.
+    void process_events(std::span<const MarketEvent> events, FeatureEngine* feature_engine = nullptr);
+    void process_events(std::span<const MarketEvent> events, std::span<FeatureEngine* const> feature_engines);
     
+    // Whether process_event would apply this event (instrument filter: ES front month only)
+    bool accepts(const MarketEvent& event) const {
+        return !(event.symbol == es_symbol_ && event.instrument_id != 4916);
+    }
+
     // Get the order book for a specific instrument
-    const OrderBookManager& get_order_book(const std::string& instrument) const;
+    const PriceLadderBook& get_order_book(microregime::SymbolId symbol) const;
+    const PriceLadderBook& get_order_book(const std::string& instrument) const;
     
     // Get all order books (for iteration)
     const auto& get_order_books() const { return order_books_; }
@@ -38,34 +54,26 @@ public:
     // Get the current timestamp (latest event processed)
     uint64_t current_timestamp() const { return current_timestamp_; }
     
-    // Reset the engine (clear all order books and order info)
+    // Reset the engine (clear all order books)
     void reset();
 
-    // Lookup order information by ID
-    std::optional<OrderInfo> get_order_info(uint64_t order_id) const {
-        auto it = order_info_.find(order_id);
-        if (it != order_info_.end()) {
-            return it->second;
-        }
-        return std::nullopt;
-    }
+    // Lookup order information by ID, answered by the order books' own indexes
+    std::optional<OrderInfo> get_order_info(uint64_t order_id) const;
     
     // Get or create an order book for an instrument
-    OrderBookManager& get_or_create_order_book(const std::string& instrument);
+    PriceLadderBook& get_or_create_order_book(microregime::SymbolId symbol);
+    PriceLadderBook& get_or_create_order_book(const std::string& instrument);
 
 private:
-    // Order books by instrument
-    std::unordered_map<std::string, OrderBookManager> order_books_;
-    
-    // Order metadata by order ID
-    std::unordered_map<uint64_t, OrderInfo> order_info_;
+    // Order books by interned instrument
+    std::unordered_map<microregime::SymbolId, PriceLadderBook> order_books_;
+
+    // Instruments that need special handling, interned once
+    const microregime::SymbolId es_symbol_ = microregime::intern_symbol("ES");
     
     // Current timestamp (from last processed event)
     uint64_t current_timestamp_ = 0;
-    
-    // Update order info when an order is added
-    void track_order(uint64_t order_id, const std::string& instrument, BookSide side, double price);
-    
-    // Remove order info when an order is fully canceled
-    void untrack_order(uint64_t order_id);
+
+    // Apply an accepted, in-order event to its book and feature engines
+    void apply_event(PriceLadderBook& order_book, const MarketEvent& event, std::span<FeatureEngine* const> feature_engines);
 };
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "book_types.hpp"
+
+// Open-addressing hash index from order id to a resting order's location.
+//
+// One flat array of slots, linear probing, and backward-shift deletion so
+// there are no tombstones to accumulate over a session of adds and cancels.
+// The table doubles when it passes half full; between resizes nothing
+// allocates. Slot pointers are invalidated by insert().
+class OrderIndex {
+public:
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    struct Slot {
+        uint64_t order_id;
+        int64_t key;              // Book key of the order's price level
+        uint32_t handle = kEmpty; // Order's queue node, kEmpty if the slot is free
+        BookSide side;
+    };
+
+    explicit OrderIndex(size_t initial_capacity = 1024) {
+        size_t capacity = 16;
+        while (capacity < initial_capacity * 2) capacity <<= 1;
+        slots_.assign(capacity, Slot{});
+        mask_ = capacity - 1;
+    }
+
+    Slot* find(uint64_t order_id) {
+        for (size_t i = bucket(order_id);; i = (i + 1) & mask_) {
+            Slot& slot = slots_[i];
+            if (slot.handle == kEmpty) return nullptr;
+            if (slot.order_id == order_id) return &slot;
+        }
+    }
+
+    const Slot* find(uint64_t order_id) const {
+        return const_cast<OrderIndex*>(this)->find(order_id);
+    }
+
+    // Returns the slot for order_id, claiming a free one if absent.
+    // `inserted` is false if the id was already present.
+    Slot* insert(uint64_t order_id, bool& inserted) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            grow();
+        }
+        for (size_t i = bucket(order_id);; i = (i + 1) & mask_) {
+            Slot& slot = slots_[i];
+            if (slot.handle == kEmpty) {
+                slot.order_id = order_id;
+                ++size_;
+                inserted = true;
+                return &slot;
+            }
+            if (slot.order_id == order_id) {
+                inserted = false;
+                return &slot;
+            }
+        }
+    }
+
+    void erase(Slot* slot) {
+        // Shift later members of the probe run back so lookups never stop early
+        size_t hole = static_cast<size_t>(slot - slots_.data());
+        for (size_t i = (hole + 1) & mask_;; i = (i + 1) & mask_) {
+            Slot& next = slots_[i];
+            if (next.handle == kEmpty) break;
+            size_t home = bucket(next.order_id);
+            // Movable unless its home lies cyclically in (hole, i]
+            if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+                slots_[hole] = next;
+                hole = i;
+            }
+        }
+        slots_[hole].handle = kEmpty;
+        --size_;
+    }
+
+    void clear() {
+        for (Slot& slot : slots_) slot.handle = kEmpty;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+
+    size_t bucket(uint64_t order_id) const {
+        // Fibonacci hashing; exchange ids are often sequential
+        return static_cast<size_t>((order_id * 0x9E3779B97F4A7C15ull) >> 32) & mask_;
+    }
+
+    void grow() {
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(old.size() * 2, Slot{});
+        mask_ = slots_.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.handle == kEmpty) continue;
+            size_t i = bucket(slot.order_id);
+            while (slots_[i].handle != kEmpty) i = (i + 1) & mask_;
+            slots_[i] = slot;
+        }
+    }
+};
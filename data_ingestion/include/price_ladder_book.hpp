@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+#include "book_types.hpp"
+#include "common_constants.hpp"
+#include "order_index.hpp"
+
+using microregime::DEPTH_LEVELS;
+
+// Limit order book keyed on integer price ticks.
+//
+// Each side is a contiguous array of price levels anchored around the first
+// touch it sees, holding the aggregated size of every level. Orders sit in a
+// pooled intrusive FIFO per level, so once the pool has grown to the day's
+// peak, add/modify/cancel never allocate. Prices outside the array (stub
+// quotes, far-away resting orders) spill into a small ordered overflow map.
+// When the best level of a side leaves the array (a stub first quote, or the
+// price drifting through the session) the array is recentered on it, moving
+// levels between it and the overflow map.
+//
+// Orders are found through a single open-addressing OrderIndex holding each
+// order's side, level key and queue node, so it is the only per-order index
+// in the ingest path. Callers ask the book (FindOrder) instead of keeping
+// their own copy.
+//
+// The top DEPTH_LEVELS of each side are kept up to date as orders are
+// applied, so snapshots are a fixed-size copy regardless of how often they
+// are taken.
+//
+// Exposes the same interface as OrderBookManager so the two are interchangeable.
+class PriceLadderBook {
+public:
+    // tick_size is in DBN fixed-point units (see common_constants.hpp)
+    explicit PriceLadderBook(int64_t tick_size = microregime::DEFAULT_TICK_SIZE);
+
+    // Core event application, prices in DBN fixed-point as carried by MarketEvent.
+    // A modify at the same price that does not increase size keeps the order's
+    // queue position; any other modify moves it to the back of its new level.
+    void ApplyAdd(uint64_t order_id, int64_t price, int size, BookSide side);
+    void ApplyModify(uint64_t order_id, int64_t new_price, int new_size);
+
+    // Same, with prices in instrument units as OrderBookManager takes them
+    void ApplyAdd(uint64_t order_id, double price, int size, BookSide side);
+    void ApplyModify(uint64_t order_id, double new_price, int new_size);
+
+    void ApplyCancel(uint64_t order_id, int canceled_size);
+    void ApplyClear();
+
+    // ApplyModify / ApplyCancel that return false for an unknown order instead
+    // of throwing, so a feed handler skipping pre-session orders looks each
+    // order up once
+    bool TryModify(uint64_t order_id, int64_t new_price, int new_size);
+    bool TryCancel(uint64_t order_id);
+
+    // Query top-of-book and top N levels
+    void GetL3Snapshot(L3Snapshot& snapshot) const;
+    void GetDepthChange(L3Delta& delta) const;
+
+    // Resets internal state
+    void Reset();
+
+    // Market microstructure metrics
+    double GetMidPrice() const;
+    double GetSpread() const;
+
+    // Side, price and remaining size of a resting order, if it is in the book
+    std::optional<RestingOrder> FindOrder(uint64_t order_id) const;
+
+    // Number of orders ahead of this one at its price level
+    size_t QueuePosition(uint64_t order_id) const;
+
+    int64_t tick_size() const { return tick_size_; }
+    size_t order_count() const { return order_index_.size(); }
+
+    // Incremented whenever any of the top DEPTH_LEVELS on either side changes
+    uint64_t top_version() const { return top_version_; }
+
+    // Number of non-empty levels of a side held in the overflow map
+    size_t overflow_levels(BookSide side) const { return ladder(side).overflow.size(); }
+
+    // Number of price levels held in the contiguous array, per side
+    static constexpr size_t kLadderLevels = size_t{1} << 15;
+
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    // Pooled FIFO node. Side and level key live in the order's index slot.
+    // Free nodes are chained through `next`.
+    struct OrderNode {
+        int size;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    struct Level {
+        int64_t total_size = 0;
+        uint32_t head = kNil;
+        uint32_t tail = kNil;
+        uint32_t order_count = 0;
+    };
+
+    // One side of the book. Keys are ticks on the ask side and negated ticks
+    // on the bid side, so the best level is always the lowest key.
+    struct Ladder {
+        std::vector<Level> levels;          // keys [base, base + kLadderLevels)
+        std::vector<uint64_t> occupied;     // Bit per array level holding orders
+        std::map<int64_t, Level> overflow;  // keys outside the array
+        int64_t base = 0;
+        bool anchored = false;
+
+        // Best min(DEPTH_LEVELS, level count) levels, best first
+        std::array<int64_t, DEPTH_LEVELS> top_keys{};
+        std::array<PriceLevel, DEPTH_LEVELS> top{};
+        size_t top_count = 0;
+    };
+
+    int64_t tick_size_;
+    Ladder bids_;
+    Ladder asks_;
+
+    std::vector<OrderNode> nodes_;
+    uint32_t free_head_ = kNil;
+    OrderIndex order_index_;
+
+    uint64_t top_version_ = 0;
+    mutable uint64_t last_delta_version_ = 0;
+    mutable L3Snapshot last_snapshot_;
+    mutable L3Delta last_delta_;
+
+    Ladder& ladder(BookSide side) { return side == BookSide::Bid ? bids_ : asks_; }
+    const Ladder& ladder(BookSide side) const { return side == BookSide::Bid ? bids_ : asks_; }
+
+    int64_t to_key(int64_t price, BookSide side) const;
+    double to_price(int64_t key, BookSide side) const;
+    int64_t to_fixed_price(int64_t key, BookSide side) const;
+
+    uint32_t allocate_node();
+    void release_node(uint32_t index);
+
+    void modify(OrderIndex::Slot& slot, int64_t new_price, int new_size);
+    void cancel(OrderIndex::Slot& slot);
+
+    void insert_order(uint32_t index, BookSide side, int64_t key);
+    void remove_order(uint32_t index, BookSide side, int64_t key);
+
+    // Level holding an existing key
+    static Level& level_at(Ladder& ladder, int64_t key);
+
+    static void set_occupied(Ladder& ladder, int64_t offset, bool occupied);
+    static void clear_ladder(Ladder& ladder);
+    // Recenters the array on the best level once that has left it
+    static void follow_touch(Ladder& ladder);
+    static bool best_key(const Ladder& ladder, int64_t& key);
+    static const Level* next_level_after(const Ladder& ladder, int64_t key, int64_t& next_key);
+
+    // Top-N maintenance, called as levels change
+    void top_level_resized(Ladder& ladder, int64_t key, int64_t total_size);
+    void top_level_added(Ladder& ladder, BookSide side, int64_t key, int64_t total_size);
+    void top_level_removed(Ladder& ladder, BookSide side, int64_t key);
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace microregime {
+
+// Fixed-capacity FIFO window over trivially copyable values, for the rolling
+// windows that push at the back and drop from the front on every update.
+//
+// Slots are rounded up to a power of two and the storage is cache-line aligned.
+// Every value is written twice, at slot i and slot i + slots, so the live window
+// is always one contiguous run and view() can hand out a plain span.
+template <typename T>
+class RingBuffer {
+    static_assert(std::is_trivially_copyable_v<T>, "RingBuffer copies values with memcpy");
+
+public:
+    static constexpr size_t kAlignment = 64;
+
+    explicit RingBuffer(size_t capacity)
+        : capacity_{capacity},
+          slots_{std::bit_ceil(capacity < 1 ? size_t{1} : capacity)},
+          mask_{slots_ - 1},
+          data_{allocate(2 * slots_)} {}
+
+    RingBuffer(const RingBuffer& other)
+        : capacity_{other.capacity_}, slots_{other.slots_}, mask_{other.mask_},
+          data_{allocate(2 * slots_)}, head_{other.head_}, size_{other.size_} {
+        std::memcpy(data_.get(), other.data_.get(), 2 * slots_ * sizeof(T));
+    }
+
+    RingBuffer& operator=(const RingBuffer& other) {
+        if (this != &other) *this = RingBuffer(other);
+        return *this;
+    }
+
+    // Leaves `other` empty; it must be assigned to before it is pushed to again
+    RingBuffer(RingBuffer&& other) noexcept
+        : capacity_{other.capacity_}, slots_{other.slots_}, mask_{other.mask_},
+          data_{std::move(other.data_)},
+          head_{std::exchange(other.head_, 0)}, size_{std::exchange(other.size_, 0)} {}
+
+    RingBuffer& operator=(RingBuffer&& other) noexcept {
+        capacity_ = other.capacity_;
+        slots_ = other.slots_;
+        mask_ = other.mask_;
+        data_ = std::move(other.data_);
+        head_ = std::exchange(other.head_, 0);
+        size_ = std::exchange(other.size_, 0);
+        return *this;
+    }
+
+    // Append at the back, dropping the oldest value if already at capacity
+    void push_back(const T& value) {
+        if (size_ == capacity_) pop_front();
+        size_t slot = (head_ + size_) & mask_;
+        data_[slot] = value;
+        data_[slot + slots_] = value;
+        ++size_;
+    }
+
+    void pop_front() {
+        assert(size_ > 0);
+        head_ = (head_ + 1) & mask_;
+        --size_;
+    }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    const T& front() const { return data_[head_]; }
+    const T& back() const { return data_[head_ + size_ - 1]; }
+    const T& operator[](size_t i) const { return data_[head_ + i]; }
+
+    // Oldest to newest; valid until the next push_back / pop_front
+    std::span<const T> view() const { return {data_.get() + head_, size_}; }
+    const T* begin() const { return data_.get() + head_; }
+    const T* end() const { return data_.get() + head_ + size_; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == capacity_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Free {
+        void operator()(T* p) const { ::operator delete[](p, std::align_val_t{kAlignment}); }
+    };
+
+    static std::unique_ptr<T[], Free> allocate(size_t count) {
+        T* data = static_cast<T*>(::operator new[](count * sizeof(T), std::align_val_t{kAlignment}));
+        std::uninitialized_value_construct_n(data, count);
+        return std::unique_ptr<T[], Free>(data);
+    }
+
+    size_t capacity_;
+    size_t slots_;
+    size_t mask_;
+    std::unique_ptr<T[], Free> data_;
+    size_t head_ = 0;  // Slot of the oldest value, always < slots_
+    size_t size_ = 0;
+};
+
+} // namespace microregime
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "ring_buffer.hpp"
+
+// Incremental statistics over sliding windows, updated as values enter and
+// leave so snapshot-time features read them in O(1).
+//
+// Tolerance: every query agrees with a full recomputation over the window to
+// within 1e-9 relative (typically ~1e-14). Sums are rebuilt from the window
+// every window's worth of updates, so round-off cannot accumulate over a day.
+
+// Count, sum and sum of squares of the values in a window kept by the owner,
+// which reports each value as it enters (add) and leaves (remove).
+// Sums are taken relative to a shift near the data so variances don't cancel.
+// NaN and infinite values are left out, so one bad sample can't poison the
+// sums for the rest of the day.
+class RollingMoments {
+public:
+    void add(double x) {
+        if (!std::isfinite(x)) return;
+        if (count_ == 0) reset(x);
+        double d = x - shift_;
+        sum_ += d;
+        sum_sq_ += d * d;
+        ++count_;
+        ++updates_;
+    }
+
+    void remove(double x) {
+        if (!std::isfinite(x)) return;
+        double d = x - shift_;
+        sum_ -= d;
+        sum_sq_ -= d * d;
+        --count_;
+        ++updates_;
+    }
+
+    // Recompute exactly from the owner's window
+    template <typename Window>
+    void rebase(const Window& window) {
+        count_ = 0;
+        sum_ = sum_sq_ = 0.0;
+        for (double x : window) add(x);
+        updates_ = 0;
+    }
+
+    // Adds and removes since the last rebase
+    size_t updates() const { return updates_; }
+
+    size_t count() const { return count_; }
+    double sum() const { return sum_ + count_ * shift_; }
+
+    // Sum over the window of (x - center)^2
+    double sum_sq_dev(double center) const {
+        double c = center - shift_;
+        return std::max(0.0, sum_sq_ - 2.0 * c * sum_ + count_ * c * c);
+    }
+
+private:
+    size_t count_ = 0;
+    size_t updates_ = 0;
+    double shift_ = 0.0;
+    double sum_ = 0.0;     // Sum of (x - shift_)
+    double sum_sq_ = 0.0;  // Sum of (x - shift_)^2
+
+    void reset(double shift) {
+        shift_ = shift;
+        sum_ = sum_sq_ = 0.0;
+    }
+};
+
+// The last `capacity` directions (+1 / 0 / -1) with their counts, signed sum
+// and number of adjacent sign reversals, all maintained on push and evict.
+// Integer counts, so results are exact.
+class RollingDirections {
+public:
+    explicit RollingDirections(size_t capacity) : values_{capacity} {}
+
+    // Append a direction, evicting the oldest once at capacity
+    void push(int8_t direction) {
+        if (values_.full()) {
+            int8_t oldest = values_.front();
+            values_.pop_front();
+            if (!values_.empty() && is_reversal(oldest, values_.front())) --reversals_;
+            count(oldest, -1);
+        }
+        if (!values_.empty() && is_reversal(values_.back(), direction)) ++reversals_;
+        values_.push_back(direction);
+        count(direction, +1);
+    }
+
+    size_t size() const { return values_.size(); }
+    bool empty() const { return values_.empty(); }
+    int8_t operator[](size_t i) const { return values_[i]; }
+    std::span<const int8_t> view() const { return values_.view(); }
+    auto begin() const { return values_.begin(); }
+    auto end() const { return values_.end(); }
+
+    size_t up() const { return up_; }
+    size_t down() const { return down_; }
+    size_t zero() const { return values_.size() - up_ - down_; }
+    int64_t sum() const { return static_cast<int64_t>(up_) - static_cast<int64_t>(down_); }
+
+    // Adjacent pairs (a, b) with b != 0 and b == -a
+    size_t reversals() const { return reversals_; }
+
+private:
+    microregime::RingBuffer<int8_t> values_;
+    size_t up_ = 0;
+    size_t down_ = 0;
+    size_t reversals_ = 0;
+
+    static bool is_reversal(int8_t previous, int8_t next) { return next != 0 && next == -previous; }
+
+    void count(int8_t direction, int delta) {
+        if (direction > 0) up_ += delta;
+        else if (direction < 0) down_ += delta;
+    }
+};
+
+// Log returns between consecutive samples of a price window, kept alongside
+// the owner's price window: push(prev, cur) when a price is appended and
+// pop(oldest, next) when the oldest price is dropped. Pairs involving a zero
+// price (empty book) are skipped, as the per-snapshot loops did, and so are
+// pairs involving a NaN, infinite or negative one.
+class RollingLogReturns {
+public:
+    // `window` is the owner's price window length; it holds at most window - 1 returns
+    RollingLogReturns(size_t window, double ewm_alpha)
+        : alpha_{ewm_alpha}, decay_{1.0 - ewm_alpha}, returns_{window} {}
+
+    void push(double previous, double current) {
+        if (!usable(previous) || !usable(current)) return;
+        double ret = std::log(current) - std::log(previous);
+        returns_.push_back(ret);
+        add(ret);
+        ewm_sum_ = decay_ * ewm_sum_ + ret * ret;
+        if (++updates_ >= kRebaseEvery) rebase();
+    }
+
+    void pop(double oldest, double next) {
+        if (!usable(oldest) || !usable(next)) return;
+        double ret = returns_.front();
+        ewm_sum_ -= std::pow(decay_, static_cast<double>(returns_.size() - 1)) * ret * ret;
+        remove(ret);
+        returns_.pop_front();
+        if (++updates_ >= kRebaseEvery) rebase();
+    }
+
+    // Number of valid returns in the window
+    size_t count() const { return returns_.size(); }
+
+    // Mean squared return (realized variance)
+    double mean_square() const { return count() ? std::max(0.0, sum_sq_) / count() : 0.0; }
+
+    // Mean squared return over positive / non-positive returns
+    double up_mean_square() const { return up_count_ ? std::max(0.0, up_sum_sq_) / up_count_ : 0.0; }
+    double down_mean_square() const { return down_count_ ? std::max(0.0, down_sum_sq_) / down_count_ : 0.0; }
+
+    // EWM of squared returns over the window, seeded with its oldest return:
+    // v = x1^2, then v = (1 - a) v + a x^2 for each later return
+    double ewm_square() const {
+        if (returns_.empty()) return 0.0;
+        double first = returns_.front();
+        double value = alpha_ * ewm_sum_ + std::pow(decay_, static_cast<double>(returns_.size())) * first * first;
+        return std::max(0.0, value);
+    }
+
+private:
+    // Longest window used in practice; rebasing this often keeps the cost O(1) amortized
+    static constexpr size_t kRebaseEvery = 2048;
+
+    double alpha_;
+    double decay_;
+    microregime::RingBuffer<double> returns_;
+
+    double sum_sq_ = 0.0;
+    double up_sum_sq_ = 0.0;
+    double down_sum_sq_ = 0.0;
+    size_t up_count_ = 0;
+    size_t down_count_ = 0;
+    // Sum over the window of decay^(newest - k) * x_k^2
+    double ewm_sum_ = 0.0;
+    size_t updates_ = 0;
+
+    static bool usable(double price) { return std::isfinite(price) && price > 0.0; }
+
+    void add(double ret) {
+        sum_sq_ += ret * ret;
+        if (ret > 0) {
+            up_sum_sq_ += ret * ret;
+            ++up_count_;
+        } else {
+            down_sum_sq_ += ret * ret;
+            ++down_count_;
+        }
+    }
+
+    void remove(double ret) {
+        sum_sq_ -= ret * ret;
+        if (ret > 0) {
+            up_sum_sq_ -= ret * ret;
+            --up_count_;
+        } else {
+            down_sum_sq_ -= ret * ret;
+            --down_count_;
+        }
+    }
+
+    void rebase() {
+        sum_sq_ = up_sum_sq_ = down_sum_sq_ = ewm_sum_ = 0.0;
+        up_count_ = down_count_ = 0;
+        for (double ret : returns_) {
+            add(ret);
+            ewm_sum_ = decay_ * ewm_sum_ + ret * ret;
+        }
+        updates_ = 0;
+    }
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace microregime {
+
+// Small dense id standing in for an instrument name on the hot path
+using SymbolId = uint16_t;
+
+// Process-wide instrument name <-> SymbolId mapping.
+//
+// Names are interned once (reader/engine construction), after which events,
+// order books and tracked orders carry only the 16-bit id. Ids are assigned in
+// order of first use and are stable for the life of the process. Thread-safe.
+SymbolId intern_symbol(const std::string& name);
+
+// Name for an id returned by intern_symbol. Throws std::out_of_range otherwise.
+const std::string& symbol_name(SymbolId id);
+
+} // namespace microregime
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace microregime {
+
+// Probabilities must sum to one within this
+constexpr double kProbabilityTolerance = 1e-6;
+
+// Throws std::invalid_argument unless p is non-negative and sums to one;
+// `what` names it in the message
+void check_distribution(std::span<const double> p, const std::string& what);
+
+// Reader for the whitespace-separated "keyword value ..." text files models
+// are saved in (GaussianHmm, StreamingPca, RegimeParameterMap). `what` names
+// the kind of file in errors: "Failed to open <what>: <path>" and
+// "Bad <what> <path>: <why>".
+class TextParser {
+public:
+    TextParser(const std::string& filepath, std::string what);
+
+    // The error to throw for a malformed file
+    std::runtime_error fail(const std::string& why) const;
+
+    // Read the next word, failing unless it's `keyword`
+    void expect(const char* keyword);
+
+    // `keyword` followed by `count` numbers
+    std::vector<double> read_values(const char* keyword, size_t count);
+
+    template <typename T>
+    bool read(T& value) {
+        return static_cast<bool>(in_ >> value);
+    }
+
+private:
+    std::ifstream in_;
+    std::string filepath_;
+    std::string what_;
+};
+
+} // namespace microregime
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace microregime {
+
+// Fixed-size work-stealing thread pool.
+//
+// Tasks submitted from outside the pool go on one shared FIFO queue, so they
+// start in submission order (callers can put the longest jobs first). Tasks
+// submitted from inside a task go to the submitting worker's own deque, which
+// it pops newest first (LIFO, cache-warm). A worker runs its own tasks, then
+// the shared queue, and steals the oldest task from a sibling when both are
+// empty.
+class ThreadPool {
+public:
+    // Defaults to one worker per hardware thread
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+
+    // Finishes every queued task, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue `task`; exceptions it throws are delivered through the future
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        auto future = packaged->get_future();
+        push([packaged] { (*packaged)(); });
+        return future;
+    }
+
+    // Block until every submitted task has finished
+    void wait_idle();
+
+    size_t size() const { return workers_.size(); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    // Submissions from outside the pool, oldest first
+    std::mutex injected_mutex_;
+    std::deque<std::function<void()>> injected_;
+
+    // Sleeping workers wait on wake_ until queued_ > 0 or stop_
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    size_t queued_ = 0;     // Tasks sitting in some deque (guarded by sleep_mutex_)
+    size_t unfinished_ = 0; // Tasks submitted but not yet finished (guarded by sleep_mutex_)
+    bool stop_ = false;
+
+    void push(std::function<void()> task);
+    bool try_pop(size_t index, std::function<void()>& task);
+    bool try_pop_injected(std::function<void()>& task);
+    bool try_steal(size_t index, std::function<void()>& task);
+    void run(size_t index);
+};
+
+} // namespace microregime
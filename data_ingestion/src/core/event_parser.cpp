@@ -1,8 +1,38 @@
 #include "event_parser.hpp"
+#include "event_cache.hpp"
+#include <iostream>
 #include <stdexcept>
 
-EventParser::EventParser(const std::string& dbn_filepath, const std::string& instrument)
-    : reader_(std::make_unique<DbnMboReader>(dbn_filepath, instrument)) {
+namespace {
+
+std::unique_ptr<EventSource> open_source(const std::string& filepath, const std::string& instrument,
+                                         DbnReadMode mode) {
+    const std::string extension = event_cache::kExtension;
+    if (filepath.size() >= extension.size() &&
+        filepath.compare(filepath.size() - extension.size(), extension.size(), extension) == 0) {
+        auto cache = std::make_unique<EventCacheReader>(filepath);
+        if (cache->instrument() != instrument) {
+            throw std::runtime_error("Event cache " + filepath + " holds " + cache->instrument() +
+                                     ", expected " + instrument);
+        }
+        return cache;
+    }
+    return std::make_unique<DbnMboReader>(filepath, instrument, mode);
+}
+
+} // namespace
+
+EventParser::EventParser(const std::string& dbn_filepath, const std::string& instrument, DbnReadMode mode)
+    : reader_(open_source(dbn_filepath, instrument, mode)) {
+    prime();
+}
+
+EventParser::EventParser(std::unique_ptr<EventSource> source)
+    : reader_(std::move(source)) {
+    prime();
+}
+
+void EventParser::prime() {
     // Pre-fetch the first event
     next_event_ = get_next_event();
     if (next_event_) {
@@ -11,8 +41,7 @@ EventParser::EventParser(const std::string& dbn_filepath, const std::string& ins
 }
 
 void EventParser::process_all(OrderEngine& engine) {
-    while (has_more_events()) {
-        process_next(engine);
+    while (process_batch(engine)) {
     }
 }
 
@@ -53,21 +82,56 @@ bool EventParser::process_next(OrderEngine& engine, FeatureEngine* feature_engin
     return true;
 }
 
-bool EventParser::has_more_events() const {
-    return next_event_.has_value();
+bool EventParser::process_batch(OrderEngine& engine, FeatureEngine* feature_engine) {
+    batch_.resize(kBatchSize);
+    size_t count = next_batch(batch_);
+    if (count == 0) {
+        return false;
+    }
+
+    std::span<const MarketEvent> events(batch_.data(), count);
+    engine.process_events(events, feature_engine);
+    current_timestamp_ = events.back().timestamp_ns;
+    return true;
 }
 
-std::optional<MarketEvent> EventParser::get_next_event() {
-    if (!reader_ || !reader_->has_next()) {
-        return std::nullopt;
+size_t EventParser::next_batch(std::span<MarketEvent> out) {
+    if (out.empty() || !next_event_) {
+        return 0;
     }
-    
+
+    // The lookahead event comes first, then a straight run from the reader
+    out[0] = *next_event_;
+    size_t count = 1;
     try {
-        return reader_->next_event();
+        count += reader_->next_batch(out.subspan(1));
     } catch (const std::exception& e) {
-        // Log the error and continue with the next event if possible
-        // In a production system, you might want to handle this differently
-        std::cerr << "Error reading event: " << e.what() << std::endl;
-        return get_next_event(); // Try to get the next event
+        // Sources only throw from a batch they wrote nothing into, so no event
+        // is lost; the lookahead below retries past the bad record
+        std::cerr << "Error reading event batch: " << e.what() << std::endl;
+    }
+
+    next_event_ = get_next_event();
+    return count;
+}
+
+bool EventParser::has_more_events() const {
+    return next_event_.has_value();
+}
+
+std::optional<MarketEvent> EventParser::get_next_event() {
+    // Log errors and continue with the next event if possible, giving up on a
+    // reader that keeps failing. In a production system, you might want to handle this differently
+    constexpr int kMaxConsecutiveErrors = 16;
+    for (int errors = 0; reader_ && errors < kMaxConsecutiveErrors; ++errors) {
+        try {
+            if (!reader_->has_next()) {
+                break;
+            }
+            return reader_->next_event();
+        } catch (const std::exception& e) {
+            std::cerr << "Error reading event: " << e.what() << std::endl;
+        }
     }
+    return std::nullopt;
 }
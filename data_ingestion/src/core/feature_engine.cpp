@@ -5,9 +5,9 @@
 #include <cmath>
 #include <limits>
 
-FeatureEngine::FeatureEngine(OrderBookManager& order_book, std::string instrument)
-    : order_book_(order_book) {
-    instrument_ = instrument;
+FeatureEngine::FeatureEngine(PriceLadderBook& order_book, std::string instrument, FeatureWindows windows)
+    : order_book_(order_book), instrument_(microregime::intern_symbol(instrument)), windows_(windows),
+      rolling_state_(windows_) {
     reset();
 }
 
@@ -43,10 +43,12 @@ FeatureInputSnapshot FeatureEngine::generate_snapshot_from_l3(
     double mid_price = (snapshot.best_bid_price + snapshot.best_ask_price) / 2.0;
     double spread = snapshot.best_ask_price - snapshot.best_bid_price;
     
-    snapshot.rolling_midprices = &rolling_state_.midprices;
-    snapshot.rolling_spreads = &rolling_state_.spreads;
+    snapshot.rolling_midprices = rolling_state_.midprices.view();
+    snapshot.rolling_spreads = rolling_state_.spreads.view();
     snapshot.rolling_tick_directions = &rolling_state_.tick_directions;
     snapshot.rolling_trade_directions = &rolling_state_.rolling_trade_directions;
+    snapshot.midprice_returns = &rolling_state_.midprice_returns;
+    snapshot.spread_moments = &rolling_state_.spread_moments;
     
     // Set basic metrics
     snapshot.rolling_buy_volume = !l3_snapshot.bid.empty() ? l3_snapshot.bid[0].size : 0;
@@ -74,9 +76,15 @@ FeatureInputSnapshot FeatureEngine::generate_snapshot() {
     snapshot.adds_since_last_snapshot = rolling_state_.adds_since_last_snapshot;
     rolling_state_.adds_since_last_snapshot = 0;
     
-    // Update depth changes and trade info
+    // Depth changes since this engine's last snapshot; kept here rather than in
+    // the book so engines on different snapshot schedules can share one book
     L3Delta delta;
-    order_book_.GetDepthChange(delta);
+    if (order_book_.top_version() != last_depth_version_) {
+        compute_depth_delta(last_depth_.bid, book_snapshot.bid, delta.bid_dir);
+        compute_depth_delta(last_depth_.ask, book_snapshot.ask, delta.ask_dir);
+        last_depth_ = book_snapshot;
+        last_depth_version_ = order_book_.top_version();
+    }
     snapshot.bid_depth_change_direction = delta.bid_dir;
     snapshot.ask_depth_change_direction = delta.ask_dir;
     
@@ -86,10 +94,7 @@ FeatureInputSnapshot FeatureEngine::generate_snapshot() {
 
 void FeatureEngine::update_trade(double price, double size, int8_t direction) {
     if (direction != 0) {
-        rolling_state_.rolling_trade_directions.push_back(direction);
-        if (rolling_state_.rolling_trade_directions.size() > ROLLING_WINDOW) {
-            rolling_state_.rolling_trade_directions.pop_front();
-        }
+        rolling_state_.rolling_trade_directions.push(direction);
     }
 
     // Update rolling statistics
@@ -99,12 +104,12 @@ void FeatureEngine::update_trade(double price, double size, int8_t direction) {
         rolling_state_.sell_volume += size;
     }
 
-    rolling_state_.trade_volumes.push_back(std::make_pair(direction, size));
-    if (rolling_state_.trade_volumes.size() > ROLLING_WINDOW) {
-        if (rolling_state_.trade_volumes.front().first > 0) {
-            rolling_state_.buy_volume -= rolling_state_.trade_volumes.front().second;
+    rolling_state_.trade_volumes.push_back({direction, size});
+    if (rolling_state_.trade_volumes.size() > windows_.rolling_events) {
+        if (rolling_state_.trade_volumes.front().direction > 0) {
+            rolling_state_.buy_volume -= rolling_state_.trade_volumes.front().size;
         } else {
-            rolling_state_.sell_volume -= rolling_state_.trade_volumes.front().second;
+            rolling_state_.sell_volume -= rolling_state_.trade_volumes.front().size;
         }
         rolling_state_.trade_volumes.pop_front();
     }
@@ -112,7 +117,7 @@ void FeatureEngine::update_trade(double price, double size, int8_t direction) {
 
 void FeatureEngine::reset() {
     // Reset rolling state
-    rolling_state_ = RollingState{};
+    rolling_state_ = RollingState{windows_};
 }
 
 
@@ -120,31 +125,33 @@ void FeatureEngine::update_events(char event_type) {
     if (event_type == 'A') {
         rolling_state_.adds_since_last_snapshot++;
     }
+    // Evicts the oldest type once the rolling window is full
     rolling_state_.recent_event_types.push_back(event_type);
-    if (rolling_state_.recent_event_types.size() > ROLLING_WINDOW) {
-        rolling_state_.recent_event_types.pop_front();
-    }
 }
 
 
 void FeatureEngine::UpdateMidpriceAndSpread(double midprice, double spread) {
     rolling_state_.midprices.push_back(midprice);
     rolling_state_.spreads.push_back(spread);
+    rolling_state_.spread_moments.add(spread);
     // 3 minutes worth of 10 HZ = 10 * 60 * 3 = 1800
     if (rolling_state_.midprices.size() > 1) {
-        auto it = rolling_state_.midprices.rbegin();
-        double current = *it;
-        double previous = *(++it);
-        rolling_state_.tick_directions.push_back((current > previous) ? 1 : ((current < previous) ? -1 : 0));
+        double current = rolling_state_.midprices.back();
+        double previous = rolling_state_.midprices[rolling_state_.midprices.size() - 2];
+        rolling_state_.tick_directions.push((current > previous) ? 1 : ((current < previous) ? -1 : 0));
+        rolling_state_.midprice_returns.push(previous, current);
     } else {
-        rolling_state_.tick_directions.push_back(0);
+        rolling_state_.tick_directions.push(0);
     }
 
-    if (rolling_state_.tick_directions.size() > ROLLING_WINDOW) {
-        rolling_state_.tick_directions.pop_front();
-    }
-    if (rolling_state_.midprices.size() > 1800) {
+    if (rolling_state_.midprices.size() > windows_.midprice_samples) {
+        rolling_state_.midprice_returns.pop(rolling_state_.midprices[0], rolling_state_.midprices[1]);
+        rolling_state_.spread_moments.remove(rolling_state_.spreads.front());
         rolling_state_.midprices.pop_front();
         rolling_state_.spreads.pop_front();
     }
+    // Rebuild the spread sums once per window so round-off can't build up
+    if (rolling_state_.spread_moments.updates() >= 2 * windows_.midprice_samples) {
+        rolling_state_.spread_moments.rebase(rolling_state_.spreads.view());
+    }
 }
@@ -34,29 +34,28 @@ void OrderBookManager::ApplyModify(uint64_t order_id, double new_price, int new_
     
     auto& order_ref = it->second;
     
-    // Remove from old price level
-    if (order_ref.side == BookSide::Bid) {
-        auto& old_queue = bid_book_[order_ref.price];
-        old_queue.erase(order_ref.it);
-        if (old_queue.empty()) {
-            bid_book_.erase(order_ref.price);
+    // Same price, size not increased: update in place and keep queue priority
+    if (new_price == order_ref.price && new_size <= order_ref.it->size) {
+        order_ref.it->size = new_size;
+        return;
+    }
+    
+    // Otherwise the order loses priority and moves to the back of its new level
+    auto requeue = [&](auto& book) {
+        auto price_it = book.find(order_ref.price);
+        price_it->second.erase(order_ref.it);
+        if (price_it->second.empty()) {
+            book.erase(price_it);
         }
         
-        // Add to new price level
-        auto& new_queue = bid_book_[new_price];
+        auto& new_queue = book[new_price];
         new_queue.push_back({order_id, new_size});
         order_ref.it = --new_queue.end();
+    };
+    if (order_ref.side == BookSide::Bid) {
+        requeue(bid_book_);
     } else {
-        auto& old_queue = ask_book_[order_ref.price];
-        old_queue.erase(order_ref.it);
-        if (old_queue.empty()) {
-            ask_book_.erase(order_ref.price);
-        }
-        
-        // Add to new price level
-        auto& new_queue = ask_book_[new_price];
-        new_queue.push_back({order_id, new_size});
-        order_ref.it = --new_queue.end();
+        requeue(ask_book_);
     }
     
     // Update order reference
@@ -150,8 +149,8 @@ void OrderBookManager::GetDepthChange(L3Delta& delta) const {
     L3Snapshot new_snapshot;
     GetL3Snapshot(new_snapshot);
     
-    compute_delta(last_snapshot_.bid, new_snapshot.bid, delta.bid_dir);
-    compute_delta(last_snapshot_.ask, new_snapshot.ask, delta.ask_dir);
+    compute_depth_delta(last_snapshot_.bid, new_snapshot.bid, delta.bid_dir);
+    compute_depth_delta(last_snapshot_.ask, new_snapshot.ask, delta.ask_dir);
     
     last_snapshot_ = new_snapshot;
     last_delta_ = delta;
@@ -205,39 +204,6 @@ void OrderBookManager::build_snapshot(BookSide side, const auto& book,
     }
 }
 
-void OrderBookManager::compute_delta(
-    const std::array<PriceLevel, DEPTH_LEVELS>& old_levels,
-    const std::array<PriceLevel, DEPTH_LEVELS>& new_levels,
-    std::array<int8_t, DEPTH_LEVELS>& delta
-) const {
-    for (size_t i = 0; i < DEPTH_LEVELS; ++i) {
-        double old_price = old_levels[i].price;
-        double new_price = new_levels[i].price;
-        int old_size = old_levels[i].size;
-        int new_size = new_levels[i].size;
-
-        if (std::abs(new_price - old_price) < 1e-10) {
-            // Same price level: compare sizes
-            if (new_size > old_size) {
-                delta[i] = 1;   // Added liquidity
-            } else if (new_size < old_size) {
-                delta[i] = -1;  // Removed liquidity
-            } else {
-                delta[i] = 0;    // No change
-            }
-        } else {
-            // Price level changed
-            if (new_size == old_size) {
-                delta[i] = 0;   // Assume shift without net liquidity change
-            } else if (new_size > old_size) {
-                delta[i] = 1;   // Net add at new level
-            } else {
-                delta[i] = -1;  // Net remove
-            }
-        }
-    }
-}
-
 double OrderBookManager::GetMidPrice() const {
     if (bid_book_.empty() || ask_book_.empty()) {
         return std::numeric_limits<double>::quiet_NaN();
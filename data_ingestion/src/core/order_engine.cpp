@@ -1,110 +1,147 @@
 #include "order_engine.hpp"
 #include "market_event.hpp"
+#include "logger.hpp"
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
 
-OrderBookManager& OrderEngine::get_or_create_order_book(const std::string& instrument) {
-    auto [it, inserted] = order_books_.try_emplace(instrument);
+PriceLadderBook& OrderEngine::get_or_create_order_book(microregime::SymbolId symbol) {
+    int64_t tick_size = (symbol == es_symbol_) ? microregime::ES_TICK_SIZE : microregime::DEFAULT_TICK_SIZE;
+    auto [it, inserted] = order_books_.try_emplace(symbol, tick_size);
     return it->second;
 }
 
-void OrderEngine::track_order(uint64_t order_id, const std::string& instrument, BookSide side, double price) {
-    order_info_[order_id] = {side, price, instrument};
+PriceLadderBook& OrderEngine::get_or_create_order_book(const std::string& instrument) {
+    return get_or_create_order_book(microregime::intern_symbol(instrument));
 }
 
-void OrderEngine::untrack_order(uint64_t order_id) {
-    order_info_.erase(order_id);
+std::optional<OrderInfo> OrderEngine::get_order_info(uint64_t order_id) const {
+    for (const auto& [symbol, book] : order_books_) {
+        if (auto order = book.FindOrder(order_id)) {
+            return OrderInfo{order->side, order->price, symbol};
+        }
+    }
+    return std::nullopt;
 }
 
 void OrderEngine::reset() {
     order_books_.clear();
-    order_info_.clear();
     current_timestamp_ = 0;
 }
 
-const OrderBookManager& OrderEngine::get_order_book(const std::string& instrument) const {
-    auto it = order_books_.find(instrument);
+const PriceLadderBook& OrderEngine::get_order_book(microregime::SymbolId symbol) const {
+    auto it = order_books_.find(symbol);
     if (it == order_books_.end()) {
-        throw std::runtime_error("No order book found for instrument: " + instrument);
+        throw std::runtime_error("No order book found for instrument: " + microregime::symbol_name(symbol));
     }
     return it->second;
 }
 
+const PriceLadderBook& OrderEngine::get_order_book(const std::string& instrument) const {
+    return get_order_book(microregime::intern_symbol(instrument));
+}
+
+namespace {
+
+// No engines for a null pointer, else just that one
+std::span<FeatureEngine* const> engines_of(FeatureEngine* const& feature_engine) {
+    return feature_engine ? std::span<FeatureEngine* const>(&feature_engine, 1) : std::span<FeatureEngine* const>{};
+}
+
+} // namespace
+
 void OrderEngine::process_event(const MarketEvent& event, FeatureEngine* feature_engine) {
+    process_event(event, engines_of(feature_engine));
+}
+
+void OrderEngine::process_events(std::span<const MarketEvent> events, FeatureEngine* feature_engine) {
+    process_events(events, engines_of(feature_engine));
+}
+
+void OrderEngine::process_event(const MarketEvent& event, std::span<FeatureEngine* const> feature_engines) {
     // Update current timestamp
     if (event.timestamp_ns < current_timestamp_) {
         throw std::runtime_error("Out-of-order event detected");
     }
     
-    if (event.instrument == "ES" && event.instrument_id != 4916) {
+    if (!accepts(event)) {
         return;
     }
 
     current_timestamp_ = event.timestamp_ns;
-    
-    auto& order_book = get_or_create_order_book(event.instrument);
-    feature_engine->most_recent_timestamp_ns = event.timestamp_ns;
+    apply_event(get_or_create_order_book(event.symbol), event, feature_engines);
+}
+
+void OrderEngine::process_events(std::span<const MarketEvent> events, std::span<FeatureEngine* const> feature_engines) {
+    PriceLadderBook* order_book = nullptr;
+    microregime::SymbolId book_symbol = 0;
+
+    for (const MarketEvent& event : events) {
+        if (event.timestamp_ns < current_timestamp_) {
+            throw std::runtime_error("Out-of-order event detected");
+        }
+        if (!accepts(event)) {
+            continue;
+        }
+        current_timestamp_ = event.timestamp_ns;
+
+        // A batch normally comes from one reader, so this lookup happens once
+        if (!order_book || event.symbol != book_symbol) {
+            order_book = &get_or_create_order_book(event.symbol);
+            book_symbol = event.symbol;
+        }
+        apply_event(*order_book, event, feature_engines);
+    }
+}
+
+void OrderEngine::apply_event(PriceLadderBook& order_book, const MarketEvent& event, std::span<FeatureEngine* const> feature_engines) {
+    for (FeatureEngine* feature_engine : feature_engines) {
+        feature_engine->most_recent_timestamp_ns = event.timestamp_ns;
+    }
     try {
         switch (event.action) {
             case 'A': {  // Add
                 BookSide side = (event.side == 'B') ? BookSide::Bid : BookSide::Ask;
                 order_book.ApplyAdd(event.order_id, event.price, event.size, side);
-                track_order(event.order_id, event.instrument, side, event.price);
-                feature_engine->update_events('A');
+                for (FeatureEngine* feature_engine : feature_engines) feature_engine->update_events('A');
                 break;
             }
             case 'M': {  // Modify
-                // Look up the order to get its original side and price
-                auto order_info = get_order_info(event.order_id);
-                if (!order_info) {
+                // Size reductions at the same price keep queue priority; anything else requeues
+                if (!order_book.TryModify(event.order_id, event.price, event.size)) {
                     std::cerr << "Warning: Modify for unknown order ID: " << event.order_id << std::endl;
                     break;
                 }
-                
-                // Cancel the old order (0 means cancel all remaining size)
-                order_book.ApplyCancel(event.order_id, 0);
-                
-                // Add the modified order with new price/size
-                order_book.ApplyAdd(event.order_id, event.price, event.size, order_info->side);
-                
-                // Update the order info with new price
-                track_order(event.order_id, event.instrument, order_info->side, event.price);
-                feature_engine->update_events('M');
+                for (FeatureEngine* feature_engine : feature_engines) feature_engine->update_events('M');
                 break;
             }
             case 'C': {  // Cancel
-                // Look up the order to get its side and price
-                auto order_info = get_order_info(event.order_id);
-                if (!order_info) {
-                    // std::cerr << "Warning: Cancel for unknown order ID: " << event.order_id << std::endl;
+                // Orders resting before the session started are skipped; any
+                // other cancel removes all remaining size
+                if (!order_book.TryCancel(event.order_id)) {
                     break;
                 }
-                
-                // Apply the cancel (0 means cancel all remaining size)
-                order_book.ApplyCancel(event.order_id, 0);
-                
-                // Remove the order from tracking
-                untrack_order(event.order_id);
-                feature_engine->update_events('C');
+                for (FeatureEngine* feature_engine : feature_engines) feature_engine->update_events('C');
                 break;
             }
             case 'R': { // Clear
-                std::cout << "Flags: " << event.flags << std::endl;
+                microregime::LogLine() << "Flags: " << event.flags;
                 // order_book.Reset();
                 // feature_engine->reset();
                 // reset();
-                std::cout << "Clear event received at " << event.timestamp_ns << std::endl;
+                microregime::LogLine() << "Clear event received at " << event.timestamp_ns;
                 break;
             }
             case 'T': {  // Trade
                 // Trades typically don't modify the order book directly
                 // They're recorded but don't change the visible order book
-                if (feature_engine) {
-                    double price = event.price;
+                if (!feature_engines.empty()) {
+                    double price = event.price_value();
                     int size = event.size;
                     int8_t direction = event.side == 'B' ? 1 : -1;
-                    feature_engine->update_trade(price, size, direction);
+                    for (FeatureEngine* feature_engine : feature_engines) {
+                        feature_engine->update_trade(price, size, direction);
+                    }
                 }
                 break;
             }
@@ -0,0 +1,451 @@
+#include "price_ladder_book.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using microregime::PRICE_SCALE;
+
+PriceLadderBook::PriceLadderBook(int64_t tick_size)
+    : tick_size_{tick_size} {
+    if (tick_size_ <= 0) {
+        throw std::invalid_argument("Tick size must be positive");
+    }
+    Reset();
+}
+
+void PriceLadderBook::ApplyAdd(uint64_t order_id, int64_t price, int size, BookSide side) {
+    int64_t key = to_key(price, side);
+    uint32_t index = allocate_node();
+
+    // One probe both checks for a duplicate and claims the slot
+    bool inserted;
+    OrderIndex::Slot* slot = order_index_.insert(order_id, inserted);
+    if (!inserted) {
+        release_node(index);
+        throw std::runtime_error("Order ID already exists");
+    }
+    slot->key = key;
+    slot->side = side;
+    slot->handle = index;
+
+    nodes_[index].size = size;
+    insert_order(index, side, key);
+}
+
+void PriceLadderBook::ApplyModify(uint64_t order_id, int64_t new_price, int new_size) {
+    if (!TryModify(order_id, new_price, new_size)) {
+        throw std::runtime_error("Order ID not found for modify");
+    }
+}
+
+bool PriceLadderBook::TryModify(uint64_t order_id, int64_t new_price, int new_size) {
+    OrderIndex::Slot* slot = order_index_.find(order_id);
+    if (!slot) {
+        return false;
+    }
+    modify(*slot, new_price, new_size);
+    return true;
+}
+
+void PriceLadderBook::modify(OrderIndex::Slot& slot, int64_t new_price, int new_size) {
+    int64_t new_key = to_key(new_price, slot.side);
+    OrderNode& node = nodes_[slot.handle];
+
+    // Same price, size not increased: update in place and keep queue priority
+    if (new_key == slot.key && new_size <= node.size) {
+        if (new_size == node.size) return;
+        Ladder& side = ladder(slot.side);
+        Level& level = level_at(side, new_key);
+        level.total_size += new_size - node.size;
+        node.size = new_size;
+        top_level_resized(side, new_key, level.total_size);
+        return;
+    }
+
+    // Price change or size increase: requeue at the back of the new price level
+    remove_order(slot.handle, slot.side, slot.key);
+    slot.key = new_key;
+    node.size = new_size;
+    insert_order(slot.handle, slot.side, new_key);
+}
+
+void PriceLadderBook::ApplyAdd(uint64_t order_id, double price, int size, BookSide side) {
+    ApplyAdd(order_id, static_cast<int64_t>(std::llround(price * PRICE_SCALE)), size, side);
+}
+
+void PriceLadderBook::ApplyModify(uint64_t order_id, double new_price, int new_size) {
+    ApplyModify(order_id, static_cast<int64_t>(std::llround(new_price * PRICE_SCALE)), new_size);
+}
+
+void PriceLadderBook::ApplyCancel(uint64_t order_id, int /*canceled_size*/) {
+    if (!TryCancel(order_id)) {
+        throw std::runtime_error("Order ID not found for cancel");
+    }
+}
+
+bool PriceLadderBook::TryCancel(uint64_t order_id) {
+    OrderIndex::Slot* slot = order_index_.find(order_id);
+    if (!slot) {
+        return false;
+    }
+    cancel(*slot);
+    return true;
+}
+
+void PriceLadderBook::cancel(OrderIndex::Slot& slot) {
+    // As with OrderBookManager, a cancel always removes the whole order
+    remove_order(slot.handle, slot.side, slot.key);
+    release_node(slot.handle);
+    order_index_.erase(&slot);
+}
+
+void PriceLadderBook::ApplyClear() {
+    clear_ladder(bids_);
+    clear_ladder(asks_);
+    nodes_.clear();
+    free_head_ = kNil;
+    order_index_.clear();
+    ++top_version_;
+    last_snapshot_ = L3Snapshot{};
+    last_delta_ = L3Delta{};
+}
+
+std::optional<RestingOrder> PriceLadderBook::FindOrder(uint64_t order_id) const {
+    const OrderIndex::Slot* slot = order_index_.find(order_id);
+    if (!slot) {
+        return std::nullopt;
+    }
+    return RestingOrder{slot->side, to_fixed_price(slot->key, slot->side), nodes_[slot->handle].size};
+}
+
+size_t PriceLadderBook::QueuePosition(uint64_t order_id) const {
+    const OrderIndex::Slot* slot = order_index_.find(order_id);
+    if (!slot) {
+        throw std::runtime_error("Order ID not found");
+    }
+    size_t ahead = 0;
+    for (uint32_t i = nodes_[slot->handle].prev; i != kNil; i = nodes_[i].prev) {
+        ++ahead;
+    }
+    return ahead;
+}
+
+void PriceLadderBook::GetL3Snapshot(L3Snapshot& snapshot) const {
+    snapshot.bid = bids_.top;
+    snapshot.ask = asks_.top;
+}
+
+void PriceLadderBook::GetDepthChange(L3Delta& delta) const {
+    if (top_version_ == last_delta_version_) {
+        // Nothing in the top levels moved since the last call
+        delta = L3Delta{};
+        last_delta_ = delta;
+        return;
+    }
+
+    compute_depth_delta(last_snapshot_.bid, bids_.top, delta.bid_dir);
+    compute_depth_delta(last_snapshot_.ask, asks_.top, delta.ask_dir);
+
+    GetL3Snapshot(last_snapshot_);
+    last_delta_ = delta;
+    last_delta_version_ = top_version_;
+}
+
+void PriceLadderBook::Reset() {
+    ApplyClear();
+}
+
+double PriceLadderBook::GetMidPrice() const {
+    int64_t bid_key, ask_key;
+    if (!best_key(bids_, bid_key) || !best_key(asks_, ask_key)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return (to_price(bid_key, BookSide::Bid) + to_price(ask_key, BookSide::Ask)) / 2.0;
+}
+
+double PriceLadderBook::GetSpread() const {
+    int64_t bid_key, ask_key;
+    if (!best_key(bids_, bid_key) || !best_key(asks_, ask_key)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return to_price(ask_key, BookSide::Ask) - to_price(bid_key, BookSide::Bid);
+}
+
+int64_t PriceLadderBook::to_key(int64_t price, BookSide side) const {
+    // Nearest tick; feed prices are normally exact multiples of the tick size
+    int64_t tick = price / tick_size_;
+    int64_t remainder = price % tick_size_;
+    if (2 * remainder >= tick_size_) {
+        ++tick;
+    } else if (2 * remainder <= -tick_size_) {
+        --tick;
+    }
+    return side == BookSide::Bid ? -tick : tick;
+}
+
+double PriceLadderBook::to_price(int64_t key, BookSide side) const {
+    int64_t tick = side == BookSide::Bid ? -key : key;
+    // Same conversion DbnMboReader applies to raw prices, so levels compare exactly
+    return static_cast<double>(tick * tick_size_) / PRICE_SCALE;
+}
+
+int64_t PriceLadderBook::to_fixed_price(int64_t key, BookSide side) const {
+    return (side == BookSide::Bid ? -key : key) * tick_size_;
+}
+
+uint32_t PriceLadderBook::allocate_node() {
+    if (free_head_ != kNil) {
+        uint32_t index = free_head_;
+        free_head_ = nodes_[index].next;
+        return index;
+    }
+    nodes_.emplace_back();
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+void PriceLadderBook::release_node(uint32_t index) {
+    nodes_[index].next = free_head_;
+    free_head_ = index;
+}
+
+void PriceLadderBook::insert_order(uint32_t index, BookSide book_side, int64_t key) {
+    OrderNode& node = nodes_[index];
+    Ladder& side = ladder(book_side);
+
+    if (!side.anchored) {
+        side.base = key - static_cast<int64_t>(kLadderLevels / 2);
+        side.anchored = true;
+    }
+
+    int64_t offset = key - side.base;
+    bool in_array = offset >= 0 && offset < static_cast<int64_t>(kLadderLevels);
+    Level& level = in_array ? side.levels[offset] : side.overflow[key];
+
+    // Append to the level's FIFO
+    node.prev = level.tail;
+    node.next = kNil;
+    if (level.tail != kNil) {
+        nodes_[level.tail].next = index;
+    } else {
+        level.head = index;
+    }
+    level.tail = index;
+    level.total_size += node.size;
+    ++level.order_count;
+
+    if (level.order_count == 1) {
+        if (in_array) set_occupied(side, offset, true);
+        top_level_added(side, book_side, key, level.total_size);
+        follow_touch(side);
+    } else {
+        top_level_resized(side, key, level.total_size);
+    }
+}
+
+void PriceLadderBook::remove_order(uint32_t index, BookSide book_side, int64_t key) {
+    OrderNode& node = nodes_[index];
+    Ladder& side = ladder(book_side);
+
+    int64_t offset = key - side.base;
+    bool in_array = offset >= 0 && offset < static_cast<int64_t>(kLadderLevels);
+    auto overflow_it = side.overflow.end();
+    Level* level;
+    if (in_array) {
+        level = &side.levels[offset];
+    } else {
+        overflow_it = side.overflow.find(key);
+        level = &overflow_it->second;
+    }
+
+    // Unlink from the level's FIFO
+    if (node.prev != kNil) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        level->head = node.next;
+    }
+    if (node.next != kNil) {
+        nodes_[node.next].prev = node.prev;
+    } else {
+        level->tail = node.prev;
+    }
+    level->total_size -= node.size;
+    --level->order_count;
+
+    if (level->order_count > 0) {
+        top_level_resized(side, key, level->total_size);
+        return;
+    }
+
+    if (in_array) {
+        set_occupied(side, offset, false);
+    } else {
+        side.overflow.erase(overflow_it);
+    }
+    top_level_removed(side, book_side, key);
+    follow_touch(side);
+}
+
+PriceLadderBook::Level& PriceLadderBook::level_at(Ladder& ladder, int64_t key) {
+    int64_t offset = key - ladder.base;
+    if (offset >= 0 && offset < static_cast<int64_t>(kLadderLevels)) {
+        return ladder.levels[offset];
+    }
+    return ladder.overflow.find(key)->second;
+}
+
+void PriceLadderBook::set_occupied(Ladder& ladder, int64_t offset, bool occupied) {
+    uint64_t bit = uint64_t{1} << (offset % 64);
+    if (occupied) {
+        ladder.occupied[offset / 64] |= bit;
+    } else {
+        ladder.occupied[offset / 64] &= ~bit;
+    }
+}
+
+void PriceLadderBook::clear_ladder(Ladder& ladder) {
+    ladder.levels.assign(kLadderLevels, Level{});
+    ladder.occupied.assign(kLadderLevels / 64, 0);
+    ladder.overflow.clear();
+    ladder.base = 0;
+    ladder.anchored = false;
+    ladder.top.fill(PriceLevel{0.0, 0});
+    ladder.top_count = 0;
+}
+
+void PriceLadderBook::follow_touch(Ladder& ladder) {
+    constexpr int64_t size = static_cast<int64_t>(kLadderLevels);
+    if (ladder.top_count == 0) return;
+    const int64_t best = ladder.top_keys[0];
+    if (best >= ladder.base && best < ladder.base + size) return;
+
+    const int64_t base = best - size / 2;
+    const int64_t shift = base - ladder.base;
+
+    // Levels leaving the array go to the overflow map, the rest slide over
+    for (int64_t offset = 0; offset < size; ++offset) {
+        const int64_t moved = offset - shift;
+        Level& level = ladder.levels[offset];
+        if ((moved < 0 || moved >= size) && level.order_count > 0) {
+            ladder.overflow.emplace(ladder.base + offset, level);
+            level = Level{};
+        }
+    }
+    if (shift > 0 && shift < size) {
+        std::move(ladder.levels.begin() + shift, ladder.levels.end(), ladder.levels.begin());
+        std::fill(ladder.levels.end() - shift, ladder.levels.end(), Level{});
+    } else if (shift < 0 && -shift < size) {
+        std::move_backward(ladder.levels.begin(), ladder.levels.end() + shift, ladder.levels.end());
+        std::fill(ladder.levels.begin(), ladder.levels.begin() - shift, Level{});
+    }
+    ladder.base = base;
+
+    // Overflow levels inside the new window come back
+    auto first = ladder.overflow.lower_bound(base);
+    auto last = ladder.overflow.lower_bound(base + size);
+    for (auto it = first; it != last; ++it) {
+        ladder.levels[it->first - base] = it->second;
+    }
+    ladder.overflow.erase(first, last);
+
+    std::fill(ladder.occupied.begin(), ladder.occupied.end(), 0);
+    for (int64_t offset = 0; offset < size; ++offset) {
+        if (ladder.levels[offset].order_count > 0) set_occupied(ladder, offset, true);
+    }
+}
+
+bool PriceLadderBook::best_key(const Ladder& ladder, int64_t& key) {
+    if (ladder.top_count == 0) {
+        return false;
+    }
+    key = ladder.top_keys[0];
+    return true;
+}
+
+const PriceLadderBook::Level* PriceLadderBook::next_level_after(const Ladder& ladder, int64_t key,
+                                                                int64_t& next_key) {
+    const int64_t array_end = ladder.base + static_cast<int64_t>(kLadderLevels);
+
+    // Overflow below the array, the array itself, then overflow above it
+    if (key < ladder.base) {
+        auto it = ladder.overflow.upper_bound(key);
+        if (it != ladder.overflow.end() && it->first < ladder.base) {
+            next_key = it->first;
+            return &it->second;
+        }
+    }
+    // First occupied array level, a word of the bitmap at a time
+    const int64_t start = std::max(key + 1, ladder.base) - ladder.base;
+    const size_t words = ladder.occupied.size();
+    for (size_t w = static_cast<size_t>(start / 64); w < words; ++w) {
+        uint64_t bits = ladder.occupied[w];
+        if (w == static_cast<size_t>(start / 64)) bits &= ~uint64_t{0} << (start % 64);
+        if (bits != 0) {
+            next_key = ladder.base + static_cast<int64_t>(w * 64) + std::countr_zero(bits);
+            return &ladder.levels[next_key - ladder.base];
+        }
+    }
+    auto it = ladder.overflow.lower_bound(std::max(key + 1, array_end));
+    if (it != ladder.overflow.end()) {
+        next_key = it->first;
+        return &it->second;
+    }
+    return nullptr;
+}
+
+void PriceLadderBook::top_level_resized(Ladder& ladder, int64_t key, int64_t total_size) {
+    for (size_t i = 0; i < ladder.top_count && ladder.top_keys[i] <= key; ++i) {
+        if (ladder.top_keys[i] == key) {
+            ladder.top[i].size = static_cast<int>(total_size);
+            ++top_version_;
+            return;
+        }
+    }
+}
+
+void PriceLadderBook::top_level_added(Ladder& ladder, BookSide side, int64_t key, int64_t total_size) {
+    size_t pos = 0;
+    while (pos < ladder.top_count && ladder.top_keys[pos] < key) {
+        ++pos;
+    }
+    if (pos == DEPTH_LEVELS) return;
+
+    // Shift worse levels down, dropping the last one if the view is full
+    size_t last = std::min(ladder.top_count, DEPTH_LEVELS - 1);
+    for (size_t i = last; i > pos; --i) {
+        ladder.top_keys[i] = ladder.top_keys[i - 1];
+        ladder.top[i] = ladder.top[i - 1];
+    }
+    ladder.top_keys[pos] = key;
+    ladder.top[pos] = {to_price(key, side), static_cast<int>(total_size)};
+    ladder.top_count = std::min(ladder.top_count + 1, DEPTH_LEVELS);
+    ++top_version_;
+}
+
+void PriceLadderBook::top_level_removed(Ladder& ladder, BookSide side, int64_t key) {
+    size_t pos = 0;
+    while (pos < ladder.top_count && ladder.top_keys[pos] != key) {
+        ++pos;
+    }
+    if (pos == ladder.top_count) return;
+
+    bool was_full = ladder.top_count == DEPTH_LEVELS;
+    int64_t last_key = ladder.top_keys[ladder.top_count - 1];
+    for (size_t i = pos + 1; i < ladder.top_count; ++i) {
+        ladder.top_keys[i - 1] = ladder.top_keys[i];
+        ladder.top[i - 1] = ladder.top[i];
+    }
+    --ladder.top_count;
+    ladder.top[ladder.top_count] = PriceLevel{0.0, 0};
+
+    // A full view may have had more levels behind it; pull the next one in
+    int64_t next_key;
+    const Level* next = was_full ? next_level_after(ladder, last_key, next_key) : nullptr;
+    if (next) {
+        ladder.top_keys[ladder.top_count] = next_key;
+        ladder.top[ladder.top_count] = {to_price(next_key, side), static_cast<int>(next->total_size)};
+        ++ladder.top_count;
+    }
+    ++top_version_;
+}
@@ -0,0 +1,50 @@
+#include "symbol_table.hpp"
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace microregime {
+
+namespace {
+
+struct SymbolTable {
+    std::mutex mutex;
+    std::deque<std::string> names;  // deque keeps references stable as it grows
+    std::unordered_map<std::string, SymbolId> ids;
+};
+
+SymbolTable& table() {
+    static SymbolTable instance;
+    return instance;
+}
+
+} // namespace
+
+SymbolId intern_symbol(const std::string& name) {
+    SymbolTable& t = table();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    auto it = t.ids.find(name);
+    if (it != t.ids.end()) {
+        return it->second;
+    }
+    if (t.names.size() > std::numeric_limits<SymbolId>::max()) {
+        throw std::runtime_error("Symbol table full");
+    }
+    SymbolId id = static_cast<SymbolId>(t.names.size());
+    t.names.push_back(name);
+    t.ids.emplace(name, id);
+    return id;
+}
+
+const std::string& symbol_name(SymbolId id) {
+    SymbolTable& t = table();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    if (id >= t.names.size()) {
+        throw std::out_of_range("Unknown symbol id");
+    }
+    return t.names[id];
+}
+
+} // namespace microregime
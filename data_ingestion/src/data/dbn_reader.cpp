@@ -1,42 +1,258 @@
 #include "dbn_reader.hpp"
+#include "mapped_file.hpp"
 #include <databento/dbn_decoder.hpp>
 #include <databento/log.hpp>
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using namespace databento;
 
-// PIMPL implementation
+namespace {
+
+// Records per block handed out by the prefetch and mapped readers (~3.5 MB of MboMsg)
+constexpr size_t kBlockRecords = size_t{1} << 16;
+
+// Blocks in flight between the prefetch thread and the consumer
+constexpr size_t kPrefetchBlocks = 4;
+
+// Logger that does nothing, databento::DbnDecoder() requires a pointer to an ILogReceiver
+struct NullLogReceiver : public ILogReceiver {
+    void Receive(LogLevel, const std::string&) noexcept override {}
+};
+
+} // namespace
+
+// PIMPL implementation: a source of blocks of MBO records
 struct DbnMboReader::Impl {
+    virtual ~Impl() = default;
+
+    // Next run of MBO records, empty at end of file
+    virtual std::span<const MboMsg> next_block() = 0;
+};
+
+// Decodes on the calling thread and hands out each record in place
+struct DbnMboReader::StreamingImpl : DbnMboReader::Impl {
     // prevents implicit conversions of string literals to Impl type
-    explicit Impl(const std::string& filepath) 
-        : file_stream_{filepath}, decoder_{&log_receiver_, std::move(file_stream_)} {
+    explicit StreamingImpl(const std::string& filepath)
+        : decoder_{&log_receiver_, InFileStream{filepath}} {
         // Decode metadata first
         metadata_ = decoder_.DecodeMetadata();
     }
 
-    // Logger that does nothing, databento::DbnDecoder() requires a pointer to an ILogReceiver
-    struct NullLogReceiver : public ILogReceiver {
-        void Receive(LogLevel, const std::string&) noexcept override {}
-    } log_receiver_;
-    
-    InFileStream file_stream_;
-    DbnDecoder decoder_{&log_receiver_, std::move(file_stream_)};
+    std::span<const MboMsg> next_block() override {
+        // Skip non-MBO records
+        while (const Record* record = decoder_.DecodeRecord()) {
+            if (record->RType() == RType::Mbo) {
+                return {&record->Get<MboMsg>(), 1};
+            }
+        }
+        return {};
+    }
+
+    NullLogReceiver log_receiver_;
+    DbnDecoder decoder_;
+    Metadata metadata_;
+};
+
+// Decompresses and decodes on a background thread, copying records into a ring
+// of large blocks so the pipeline thread only ever waits on a full block
+struct DbnMboReader::PrefetchImpl : DbnMboReader::Impl {
+    explicit PrefetchImpl(const std::string& filepath)
+        : decoder_{&log_receiver_, InFileStream{filepath}} {
+        // Metadata errors surface here, on the constructing thread
+        metadata_ = decoder_.DecodeMetadata();
+        for (auto& block : ring_) {
+            block.reserve(kBlockRecords);
+        }
+        worker_ = std::thread([this] { produce(); });
+    }
+
+    ~PrefetchImpl() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        space_ready_.notify_one();
+        worker_.join();
+    }
+
+    std::span<const MboMsg> next_block() override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (holding_) {
+            // Hand the previous block back to the producer
+            ++consumed_;
+            holding_ = false;
+            space_ready_.notify_one();
+        }
+        data_ready_.wait(lock, [this] { return produced_ > consumed_ || done_; });
+        if (produced_ > consumed_) {
+            holding_ = true;
+            return ring_[consumed_ % kPrefetchBlocks];
+        }
+        if (error_) {
+            // Report the failure once; afterwards the reader is simply exhausted
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+        return {};
+    }
+
+    void produce() {
+        try {
+            bool eof = false;
+            while (!eof) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    space_ready_.wait(lock, [this] { return produced_ - consumed_ < kPrefetchBlocks || stop_; });
+                    if (stop_) return;
+                }
+
+                // Only this thread touches the slot until it is published
+                auto& block = ring_[produced_ % kPrefetchBlocks];
+                block.clear();
+                while (block.size() < kBlockRecords) {
+                    const Record* record = decoder_.DecodeRecord();
+                    if (!record) {
+                        eof = true;
+                        break;
+                    }
+                    if (record->RType() == RType::Mbo) {
+                        block.push_back(record->Get<MboMsg>());
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!block.empty()) ++produced_;
+                    done_ = eof;
+                }
+                data_ready_.notify_one();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = std::current_exception();
+            done_ = true;
+            data_ready_.notify_one();
+        }
+    }
+
+    NullLogReceiver log_receiver_;
+    DbnDecoder decoder_;
     Metadata metadata_;
-    const Record* next_record_{nullptr};
+
+    std::array<std::vector<MboMsg>, kPrefetchBlocks> ring_;
+    std::mutex mutex_;
+    std::condition_variable data_ready_;
+    std::condition_variable space_ready_;
+    size_t produced_ = 0;  // Blocks published by the producer
+    size_t consumed_ = 0;  // Blocks released by the consumer
+    bool holding_ = false; // Consumer holds ring_[consumed_ % kPrefetchBlocks]
+    bool done_ = false;
+    bool stop_ = false;
+    std::exception_ptr error_;
+    std::thread worker_;
 };
 
-// Constructor creates pimpl and decodes the first record
-DbnMboReader::DbnMboReader(const std::string& filepath, const std::string& instrument)
+// Walks a memory-mapped, already decompressed DBN file and hands out runs of
+// MBO records directly from the mapping
+struct DbnMboReader::MappedImpl : DbnMboReader::Impl {
+    explicit MappedImpl(const std::string& filepath) : file_{filepath} {
+        auto bytes = file_.bytes();
+        // DBN prelude: "DBN", version byte, little-endian uint32 metadata length
+        if (bytes.size() < 8 || std::memcmp(bytes.data(), "DBN", 3) != 0) {
+            throw std::runtime_error("Mapped mode needs a decompressed .dbn file: " + filepath);
+        }
+        uint32_t metadata_length;
+        std::memcpy(&metadata_length, bytes.data() + 4, sizeof(metadata_length));
+        pos_ = 8 + static_cast<size_t>(metadata_length);
+        if (pos_ > bytes.size()) {
+            throw std::runtime_error("Truncated DBN metadata: " + filepath);
+        }
+    }
+
+    std::span<const MboMsg> next_block() override {
+        auto bytes = file_.bytes();
+
+        // Skip non-MBO records
+        while (pos_ + sizeof(RecordHeader) <= bytes.size() && !is_mbo(bytes.data() + pos_)) {
+            pos_ += record_size(bytes.data() + pos_);
+        }
+        if (pos_ + sizeof(MboMsg) > bytes.size()) {
+            return {};
+        }
+        if (reinterpret_cast<uintptr_t>(bytes.data() + pos_) % alignof(MboMsg) != 0) {
+            throw std::runtime_error("Misaligned DBN record in mapped file");
+        }
+
+        // Extend the run over consecutive MBO records
+        const auto* first = reinterpret_cast<const MboMsg*>(bytes.data() + pos_);
+        size_t count = 0;
+        while (count < kBlockRecords && pos_ + sizeof(MboMsg) <= bytes.size() && is_mbo(bytes.data() + pos_)) {
+            pos_ += sizeof(MboMsg);
+            ++count;
+        }
+        return {first, count};
+    }
+
+    static const RecordHeader& header(const std::byte* at) {
+        return *reinterpret_cast<const RecordHeader*>(at);
+    }
+
+    static size_t record_size(const std::byte* at) {
+        size_t size = static_cast<size_t>(header(at).length) * RecordHeader::kLengthMultiplier;
+        if (size == 0) {
+            throw std::runtime_error("Corrupt DBN record length in mapped file");
+        }
+        return size;
+    }
+
+    static bool is_mbo(const std::byte* at) {
+        return header(at).rtype == RType::Mbo && record_size(at) == sizeof(MboMsg);
+    }
+
+    MappedFile file_;
+    size_t pos_ = 0;
+};
+
+// Constructor picks the record source and primes the first block
+DbnMboReader::DbnMboReader(const std::string& filepath, const std::string& instrument, DbnReadMode mode)
     : instrument_{instrument},
-      pimpl_{std::make_unique<Impl>(filepath)} {
-    // Prime the first record
-    pimpl_->next_record_ = pimpl_->decoder_.DecodeRecord();
+      symbol_{microregime::intern_symbol(instrument)} {
+    switch (mode) {
+        case DbnReadMode::Streaming:
+            pimpl_ = std::make_unique<StreamingImpl>(filepath);
+            break;
+        case DbnReadMode::Prefetch:
+            pimpl_ = std::make_unique<PrefetchImpl>(filepath);
+            break;
+        case DbnReadMode::Mapped:
+            pimpl_ = std::make_unique<MappedImpl>(filepath);
+            break;
+    }
+    refill();
 }
 
 DbnMboReader::~DbnMboReader() = default;
 
+void DbnMboReader::refill() const {
+    if (pending_error_) {
+        std::rethrow_exception(std::exchange(pending_error_, nullptr));
+    }
+    if (block_pos_ < block_.size()) return;
+    block_ = pimpl_->next_block();
+    block_pos_ = 0;
+}
+
 bool DbnMboReader::has_next() const {
-    return pimpl_->next_record_ != nullptr;
+    refill();
+    return block_pos_ < block_.size();
 }
 
 // Returns the next parsed MBO record as a MarketEvent
@@ -44,35 +260,56 @@ MarketEvent DbnMboReader::next_event() {
     if (!has_next()) {
         throw std::runtime_error("No more events to read");
     }
-
-    // Store current record and move to next record.
-    const auto* record = pimpl_->next_record_;
-    pimpl_->next_record_ = pimpl_->decoder_.DecodeRecord();
     ++event_count_;
+    return to_event(block_[block_pos_++]);
+}
 
-    MarketEvent event{};
-    
-    // Map the DBN record to our MarketEvent
-    if (record->RType() == RType::Mbo) {
-        const auto& mbo = record->Get<MboMsg>();
-        // Convert UnixNanos (time_point) to uint64_t by getting time since epoch
-        event.timestamp_ns = mbo.ts_recv.time_since_epoch().count();
-        event.instrument = instrument_;
-        event.action = static_cast<char>(mbo.action);
-        event.side = mbo.side == Side::Bid ? 'B' : 
-                     mbo.side == Side::Ask ? 'A' : 'N';
-        event.price = static_cast<double>(mbo.price) / 1e9;
-        event.size = static_cast<int>(mbo.size);
-        event.order_id = mbo.order_id;
-        event.flags = static_cast<uint8_t>(mbo.flags);
-        // Get the instrument_id from the record's header
-        event.instrument_id = record->Header().instrument_id;
-        event.channel_id = mbo.channel_id;
-        event.sequence = mbo.sequence;
-    } else {
-        // Skip non-MBO records
-        return next_event();
+size_t DbnMboReader::next_batch(std::span<MarketEvent> out) {
+    size_t filled = 0;
+    try {
+        while (filled < out.size() && has_next()) {
+            size_t n = std::min(block_.size() - block_pos_, out.size() - filled);
+            const MboMsg* in = block_.data() + block_pos_;
+            MarketEvent* dst = out.data() + filled;
+            // Straight-line field copies over the block, no per-event calls or checks
+            for (size_t i = 0; i < n; ++i) {
+                dst[i] = to_event(in[i]);
+            }
+            block_pos_ += n;
+            filled += n;
+        }
+    } catch (...) {
+        // Hand back the events already converted; the error surfaces on the next read
+        if (filled == 0) throw;
+        pending_error_ = std::current_exception();
     }
+    event_count_ += filled;
+    return filled;
+}
+
+std::span<const MboMsg> DbnMboReader::next_block() {
+    refill();
+    auto block = block_.subspan(block_pos_);
+    block_pos_ = block_.size();
+    event_count_ += block.size();
+    return block;
+}
 
+MarketEvent DbnMboReader::to_event(const MboMsg& mbo) const {
+    MarketEvent event{};
+    // Convert UnixNanos (time_point) to uint64_t by getting time since epoch
+    event.timestamp_ns = mbo.ts_recv.time_since_epoch().count();
+    event.symbol = symbol_;
+    event.action = static_cast<char>(mbo.action);
+    // databento::Side is already the 'B'/'A'/'N' character
+    event.side = static_cast<char>(mbo.side);
+    event.price = mbo.price;
+    event.size = static_cast<int>(mbo.size);
+    event.order_id = mbo.order_id;
+    event.flags = static_cast<uint8_t>(mbo.flags);
+    // Get the instrument_id from the record's header
+    event.instrument_id = mbo.hd.instrument_id;
+    event.channel_id = mbo.channel_id;
+    event.sequence = mbo.sequence;
     return event;
-}
\ No newline at end of file
+}
@@ -0,0 +1,191 @@
+#include "event_cache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace event_cache {
+
+namespace {
+
+// Bytes per event in each column, in Column order
+constexpr size_t kWidth[ColumnCount] = {
+    sizeof(uint64_t), sizeof(int64_t), sizeof(uint64_t), sizeof(uint32_t), sizeof(uint32_t),
+    sizeof(int32_t), sizeof(char), sizeof(char), sizeof(uint8_t), sizeof(uint8_t),
+};
+
+size_t align_up(size_t offset) {
+    return (offset + kColumnAlignment - 1) / kColumnAlignment * kColumnAlignment;
+}
+
+} // namespace
+
+std::string path_for(const std::string& dbn_path) {
+    fs::path path(dbn_path);
+    if (path.extension() == ".zst") path.replace_extension();
+    if (path.extension() == ".dbn") path.replace_extension();
+    return path.string() + kExtension;
+}
+
+} // namespace event_cache
+
+using namespace event_cache;
+
+EventCacheWriter::EventCacheWriter(const std::string& filepath, const std::string& instrument)
+    : filepath_{filepath}, instrument_{instrument} {
+    if (instrument.size() >= sizeof(Header::instrument)) {
+        throw std::invalid_argument("Instrument name too long for event cache: " + instrument);
+    }
+    for (size_t c = 0; c < ColumnCount; ++c) {
+        spill_paths_.push_back(filepath + ".col" + std::to_string(c) + ".tmp");
+        spill_.emplace_back(spill_paths_.back(), std::ios::binary | std::ios::trunc);
+        if (!spill_.back()) {
+            throw std::runtime_error("Failed to open event cache spill file: " + spill_paths_.back());
+        }
+    }
+}
+
+EventCacheWriter::~EventCacheWriter() {
+    try {
+        finish();
+    } catch (...) {
+        // Destructors must not throw; an unfinished cache is just missing
+    }
+}
+
+void EventCacheWriter::append(const MarketEvent& event) {
+    auto put = [this](Column column, const auto& value) {
+        spill_[column].write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    put(Timestamp, event.timestamp_ns);
+    put(Price, event.price);
+    put(OrderId, event.order_id);
+    put(InstrumentId, event.instrument_id);
+    put(Sequence, event.sequence);
+    put(Size, static_cast<int32_t>(event.size));
+    put(Action, event.action);
+    put(Side, event.side);
+    put(Flags, event.flags);
+    put(ChannelId, event.channel_id);
+    ++event_count_;
+}
+
+void EventCacheWriter::finish() {
+    if (finished_) return;
+    finished_ = true;
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.column_count = ColumnCount;
+    header.event_count = event_count_;
+    std::memcpy(header.instrument, instrument_.data(), instrument_.size());
+
+    size_t offset = align_up(sizeof(Header));
+    for (size_t c = 0; c < ColumnCount; ++c) {
+        header.column_offset[c] = offset;
+        offset = align_up(offset + event_count_ * kWidth[c]);
+    }
+
+    // Write to a temporary name so readers never see a half-built cache
+    std::string partial_path = filepath_ + ".tmp";
+    {
+        std::ofstream out(partial_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Failed to create event cache: " + partial_path);
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::vector<char> buffer(1 << 20);
+        for (size_t c = 0; c < ColumnCount; ++c) {
+            spill_[c].close();
+            // Pad up to the column's aligned offset
+            size_t position = static_cast<size_t>(out.tellp());
+            std::fill_n(std::ostreambuf_iterator<char>(out), header.column_offset[c] - position, '\0');
+
+            std::ifstream in(spill_paths_[c], std::ios::binary);
+            while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0) {
+                out.write(buffer.data(), in.gcount());
+            }
+        }
+        if (!out) {
+            throw std::runtime_error("Failed to write event cache: " + partial_path);
+        }
+    }
+    for (const auto& spill_path : spill_paths_) {
+        fs::remove(spill_path);
+    }
+    fs::rename(partial_path, filepath_);
+}
+
+EventCacheReader::EventCacheReader(const std::string& filepath) : file_{filepath} {
+    if (file_.size() < sizeof(Header)) {
+        throw std::runtime_error("Not an event cache (too small): " + filepath);
+    }
+    Header header;
+    std::memcpy(&header, file_.bytes().data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.column_count != ColumnCount) {
+        throw std::runtime_error("Not an event cache: " + filepath);
+    }
+    if (header.version != kVersion) {
+        throw std::runtime_error("Unsupported event cache version " + std::to_string(header.version) +
+                                 ", rebuild " + filepath);
+    }
+
+    event_count_ = static_cast<size_t>(header.event_count);
+    instrument_.assign(header.instrument, strnlen(header.instrument, sizeof(header.instrument)));
+    symbol_ = microregime::intern_symbol(instrument_);
+
+    timestamp_ = column<uint64_t>(header, Timestamp);
+    price_ = column<int64_t>(header, Price);
+    order_id_ = column<uint64_t>(header, OrderId);
+    instrument_id_ = column<uint32_t>(header, InstrumentId);
+    sequence_ = column<uint32_t>(header, Sequence);
+    size_ = column<int32_t>(header, Size);
+    action_ = column<char>(header, Action);
+    side_ = column<char>(header, Side);
+    flags_ = column<uint8_t>(header, Flags);
+    channel_id_ = column<uint8_t>(header, ChannelId);
+}
+
+template <typename T>
+const T* EventCacheReader::column(const Header& header, Column column) const {
+    uint64_t offset = header.column_offset[column];
+    if (offset % alignof(T) != 0 || offset + event_count_ * sizeof(T) > file_.size()) {
+        throw std::runtime_error("Corrupt event cache column");
+    }
+    return reinterpret_cast<const T*>(file_.bytes().data() + offset);
+}
+
+MarketEvent EventCacheReader::next_event() {
+    MarketEvent event;
+    if (next_batch({&event, 1}) == 0) {
+        throw std::runtime_error("No more events to read");
+    }
+    return event;
+}
+
+size_t EventCacheReader::next_batch(std::span<MarketEvent> out) {
+    size_t n = std::min(out.size(), event_count_ - pos_);
+    MarketEvent* dst = out.data();
+    const size_t base = pos_;
+    // Sequential reads of every column; bound by memory bandwidth
+    for (size_t i = 0; i < n; ++i) {
+        MarketEvent& event = dst[i];
+        event.timestamp_ns = timestamp_[base + i];
+        event.price = price_[base + i];
+        event.order_id = order_id_[base + i];
+        event.instrument_id = instrument_id_[base + i];
+        event.sequence = sequence_[base + i];
+        event.size = size_[base + i];
+        event.symbol = symbol_;
+        event.action = action_[base + i];
+        event.side = side_[base + i];
+        event.flags = flags_[base + i];
+        event.channel_id = channel_id_[base + i];
+    }
+    pos_ += n;
+    return n;
+}
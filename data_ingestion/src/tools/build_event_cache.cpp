@@ -0,0 +1,51 @@
+#include "dbn_reader.hpp"
+#include "event_cache.hpp"
+#include "order_engine.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// One-time conversion of a DBN day file into an event cache (see event_cache.hpp).
+// Parameter sweeps then replay the cache instead of decompressing the DBN file again.
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <dbn_file> <instrument> [output_file]\n"
+                  << "Example: " << argv[0] << " data/ES/glbx-mdp3-20250505.mbo.dbn.zst ES\n"
+                  << "Writes data/ES/glbx-mdp3-20250505.mbo" << event_cache::kExtension
+                  << " unless output_file is given.\n";
+        return 1;
+    }
+
+    std::string dbn_file = argv[1];
+    std::string instrument = argv[2];
+    std::string output_file = (argc > 3) ? argv[3] : event_cache::path_for(dbn_file);
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+
+        DbnMboReader reader(dbn_file, instrument, DbnReadMode::Prefetch);
+        EventCacheWriter writer(output_file, instrument);
+        OrderEngine filter;  // Only its instrument filter is used
+
+        std::vector<MarketEvent> batch(4096);
+        size_t read = 0;
+        while (size_t count = reader.next_batch(batch)) {
+            for (size_t i = 0; i < count; ++i) {
+                if (filter.accepts(batch[i])) {
+                    writer.append(batch[i]);
+                }
+            }
+            read += count;
+        }
+        writer.finish();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Wrote " << writer.event_count() << " of " << read << " events to " << output_file
+                  << " in " << seconds << "s\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,14 @@
+#include "logger.hpp"
+#include <iostream>
+#include <mutex>
+
+namespace microregime {
+
+LogLine::~LogLine() {
+    static std::mutex mutex;
+    buffer_ << '\n';
+    std::lock_guard<std::mutex> lock(mutex);
+    std::cout << buffer_.str() << std::flush;
+}
+
+} // namespace microregime
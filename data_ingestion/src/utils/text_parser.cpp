@@ -0,0 +1,42 @@
+#include "text_parser.hpp"
+#include <cmath>
+
+namespace microregime {
+
+void check_distribution(std::span<const double> p, const std::string& what) {
+    double total = 0.0;
+    for (double value : p) {
+        if (!(value >= 0.0)) throw std::invalid_argument(what + " has a negative or NaN entry");
+        total += value;
+    }
+    if (std::abs(total - 1.0) > kProbabilityTolerance) {
+        throw std::invalid_argument(what + " doesn't sum to 1");
+    }
+}
+
+TextParser::TextParser(const std::string& filepath, std::string what)
+    : in_{filepath}, filepath_{filepath}, what_{std::move(what)} {
+    if (!in_) {
+        throw std::runtime_error("Failed to open " + what_ + ": " + filepath_);
+    }
+}
+
+std::runtime_error TextParser::fail(const std::string& why) const {
+    return std::runtime_error("Bad " + what_ + " " + filepath_ + ": " + why);
+}
+
+void TextParser::expect(const char* keyword) {
+    std::string word;
+    if (!(in_ >> word) || word != keyword) throw fail(std::string("expected '") + keyword + "'");
+}
+
+std::vector<double> TextParser::read_values(const char* keyword, size_t count) {
+    expect(keyword);
+    std::vector<double> values(count);
+    for (auto& value : values) {
+        if (!(in_ >> value)) throw fail(std::string("too few values for ") + keyword);
+    }
+    return values;
+}
+
+} // namespace microregime
@@ -0,0 +1,112 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace microregime {
+
+namespace {
+
+// Which pool and worker the current thread belongs to, so nested submits stay local
+thread_local const ThreadPool* tls_pool = nullptr;
+thread_local size_t tls_index = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this, i] { run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::wait_idle() {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    idle_.wait(lock, [this] { return unfinished_ == 0; });
+}
+
+void ThreadPool::push(std::function<void()> task) {
+    // Count before publishing so a worker never sees a task it can't account for
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        ++queued_;
+        ++unfinished_;
+    }
+    if (tls_pool == this) {
+        std::lock_guard<std::mutex> lock(workers_[tls_index]->mutex);
+        workers_[tls_index]->tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(injected_mutex_);
+        injected_.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+bool ThreadPool::try_pop(size_t index, std::function<void()>& task) {
+    Worker& worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) return false;
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::try_pop_injected(std::function<void()>& task) {
+    std::lock_guard<std::mutex> lock(injected_mutex_);
+    if (injected_.empty()) return false;
+    task = std::move(injected_.front());
+    injected_.pop_front();
+    return true;
+}
+
+bool ThreadPool::try_steal(size_t index, std::function<void()>& task) {
+    for (size_t offset = 1; offset < workers_.size(); ++offset) {
+        Worker& victim = *workers_[(index + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::run(size_t index) {
+    tls_pool = this;
+    tls_index = index;
+
+    for (;;) {
+        std::function<void()> task;
+        if (try_pop(index, task) || try_pop_injected(task) || try_steal(index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex_);
+                --queued_;
+            }
+            task();
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            if (--unfinished_ == 0) {
+                idle_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return queued_ > 0 || stop_; });
+        if (stop_ && queued_ == 0) return;
+    }
+}
+
+} // namespace microregime
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <dbn_reader.hpp>
+#include <order_engine.hpp>
+#include <feature_engine.hpp>
+#include <event_parser.hpp>
 #include <filesystem>
 #include <fstream>
 #include <chrono>
@@ -52,3 +55,86 @@ TEST_F(DbnReaderBenchmark, TestDbnParseSpeed) {
     std::cout << "Processed " << event_count << " events in " 
               << duration << "ms (" << events_per_second << " events/s)" << std::endl;
 }
+
+// Block API throughput for each read mode. MB/s is of the file read (compressed
+// for .zst); Mapped mode needs the file decompressed alongside (zstd -d).
+TEST_F(DbnReaderBenchmark, TestReadModeThroughput) {
+    fs::path decompressed = fs::path(test_file_).replace_extension();
+    struct Run { const char* name; DbnReadMode mode; fs::path file; };
+    const Run runs[] = {
+        {"Streaming", DbnReadMode::Streaming, test_file_},
+        {"Prefetch", DbnReadMode::Prefetch, test_file_},
+        {"Mapped", DbnReadMode::Mapped, decompressed},
+    };
+
+    for (const auto& run : runs) {
+        if (!fs::exists(run.file)) {
+            std::cout << run.name << ": skipped, " << run.file << " not found" << std::endl;
+            continue;
+        }
+        size_t event_count = 0;
+        uint64_t checksum = 0;
+
+        auto start = high_resolution_clock::now();
+        DbnMboReader reader(run.file.string(), "ES", run.mode);
+        for (auto block = reader.next_block(); !block.empty(); block = reader.next_block()) {
+            for (const auto& mbo : block) {
+                checksum += mbo.order_id;  // Touch every record
+            }
+            event_count += block.size();
+        }
+        double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+        double megabytes = static_cast<double>(fs::file_size(run.file)) / (1024.0 * 1024.0);
+        std::cout << run.name << ": " << event_count << " events in " << seconds << "s ("
+                  << megabytes / seconds << " MB/s, " << event_count / seconds << " events/s, checksum "
+                  << checksum << ")" << std::endl;
+    }
+}
+
+// Reader -> OrderEngine -> FeatureEngine, the per-event path of the feature pipeline
+TEST_F(DbnReaderBenchmark, TestIngestSpeed) {
+    OrderEngine engine;
+    FeatureEngine feature_engine(engine.get_or_create_order_book("ES"), "ES");
+    size_t event_count = 0;
+
+    auto start = high_resolution_clock::now();
+
+    DbnMboReader reader(test_file_.string(), "ES");
+    while (reader.has_next()) {
+        engine.process_event(reader.next_event(), &feature_engine);
+        event_count++;
+    }
+
+    auto end = high_resolution_clock::now();
+    double seconds = duration_cast<duration<double>>(end - start).count();
+
+    std::cout << "Ingested " << event_count << " events (" << sizeof(MarketEvent) << " bytes each) in "
+              << seconds << "s (" << event_count / seconds << " events/s)" << std::endl;
+}
+
+// The same ingest through EventParser one event at a time versus in batches
+TEST_F(DbnReaderBenchmark, TestBatchIngestSpeed) {
+    auto time_ingest = [&](bool batched) {
+        OrderEngine engine;
+        FeatureEngine feature_engine(engine.get_or_create_order_book("ES"), "ES");
+        EventParser parser(test_file_.string(), "ES", DbnReadMode::Prefetch);
+
+        auto start = high_resolution_clock::now();
+        if (batched) {
+            while (parser.process_batch(engine, &feature_engine)) {
+            }
+        } else {
+            while (parser.process_next(engine, &feature_engine)) {
+            }
+        }
+        return duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+    };
+
+    double single_seconds = time_ingest(false);
+    double batch_seconds = time_ingest(true);
+    std::cout << "Per-event ingest: " << single_seconds << "s\n"
+              << "Batched ingest:   " << batch_seconds << "s (" << EventParser::kBatchSize
+              << " events per batch)\n"
+              << "Speedup: " << single_seconds / batch_seconds << "x" << std::endl;
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+#include <dbn_reader.hpp>
+#include <order_book.hpp>
+#include <price_ladder_book.hpp>
+#include <filesystem>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <iostream>
+#include "environment.hpp"
+
+namespace fs = std::filesystem;
+using namespace std::chrono;
+using namespace microregime;
+
+// Replays a full ES day of book events through OrderBookManager and
+// PriceLadderBook and reports events/sec for each.
+class OrderBookBenchmark : public ::testing::Test {
+protected:
+    static void SetUpTestSuite() {
+        fs::path test_file = fs::path(get_project_root() / "data" / "ES" / "glbx-mdp3-20250505.mbo.dbn.zst");
+        if (!fs::exists(test_file)) {
+            return;
+        }
+
+        // Decode once up front so only book work is timed. Same filter as OrderEngine.
+        DbnMboReader reader(test_file.string(), "ES");
+        while (reader.has_next()) {
+            MarketEvent event = reader.next_event();
+            if (event.instrument_id != 4916) continue;
+            if (event.action == 'A' || event.action == 'M' || event.action == 'C') {
+                events_.push_back(event);
+            }
+        }
+    }
+
+    void SetUp() override {
+        if (events_.empty()) {
+            GTEST_SKIP() << "ES test file not found";
+        }
+    }
+
+    // OrderBookManager takes prices in instrument units, the ladder takes the raw fixed-point price
+    static double book_price(const OrderBookManager&, const MarketEvent& event) { return event.price_value(); }
+    static int64_t book_price(const PriceLadderBook&, const MarketEvent& event) { return event.price; }
+
+    // Applies book events as OrderEngine::process_event does
+    template <typename Book>
+    static double replay(Book& book, size_t snapshot_every) {
+        L3Snapshot snapshot;
+        auto start = high_resolution_clock::now();
+        size_t n = 0;
+        for (const auto& event : events_) {
+            try {
+                switch (event.action) {
+                    case 'A':
+                        book.ApplyAdd(event.order_id, book_price(book, event), event.size,
+                                      event.side == 'B' ? BookSide::Bid : BookSide::Ask);
+                        break;
+                    case 'M':
+                        book.ApplyModify(event.order_id, book_price(book, event), event.size);
+                        break;
+                    case 'C':
+                        book.ApplyCancel(event.order_id, 0);
+                        break;
+                }
+            } catch (const std::exception&) {
+                // Unknown ids are skipped, as in OrderEngine
+            }
+            if (++n % snapshot_every == 0) {
+                book.GetL3Snapshot(snapshot);
+            }
+        }
+        auto end = high_resolution_clock::now();
+        return duration_cast<duration<double>>(end - start).count();
+    }
+
+    static std::vector<MarketEvent> events_;
+};
+
+std::vector<MarketEvent> OrderBookBenchmark::events_;
+
+TEST_F(OrderBookBenchmark, MapBookVersusPriceLadder) {
+    // Roughly one snapshot per 50ms of ES activity
+    const size_t snapshot_every = 25;
+
+    OrderBookManager map_book;
+    double map_seconds = replay(map_book, snapshot_every);
+
+    PriceLadderBook ladder_book(ES_TICK_SIZE);
+    double ladder_seconds = replay(ladder_book, snapshot_every);
+
+    // Both books must agree at the end of the day
+    L3Snapshot expected, actual;
+    map_book.GetL3Snapshot(expected);
+    ladder_book.GetL3Snapshot(actual);
+    for (size_t i = 0; i < DEPTH_LEVELS; ++i) {
+        EXPECT_EQ(expected.bid[i].price, actual.bid[i].price);
+        EXPECT_EQ(expected.bid[i].size, actual.bid[i].size);
+        EXPECT_EQ(expected.ask[i].price, actual.ask[i].price);
+        EXPECT_EQ(expected.ask[i].size, actual.ask[i].size);
+    }
+
+    std::cout << "Replayed " << events_.size() << " book events\n"
+              << "  OrderBookManager: " << map_seconds << "s ("
+              << events_.size() / map_seconds << " events/s)\n"
+              << "  PriceLadderBook:  " << ladder_seconds << "s ("
+              << events_.size() / ladder_seconds << " events/s)\n"
+              << "  Speedup: " << map_seconds / ladder_seconds << "x" << std::endl;
+}
+
+TEST_F(OrderBookBenchmark, SnapshotFrequencyScaling) {
+    // From one snapshot per ~50ms of ES activity up to a snapshot every few events
+    for (size_t snapshot_every : {250, 25, 3}) {
+        OrderBookManager map_book;
+        double map_seconds = replay(map_book, snapshot_every);
+
+        PriceLadderBook ladder_book(ES_TICK_SIZE);
+        double ladder_seconds = replay(ladder_book, snapshot_every);
+
+        std::cout << "Snapshot every " << snapshot_every << " events: "
+                  << "OrderBookManager " << events_.size() / map_seconds << " events/s, "
+                  << "PriceLadderBook " << events_.size() / ladder_seconds << " events/s" << std::endl;
+    }
+}
+
+// Synthetic stream dominated by modifies (mostly partial size reductions, as
+// on ITCH), applied natively and as the old cancel + re-add. Needs no data file.
+TEST(OrderBookModifyBenchmark, NativeModifyVersusCancelAdd) {
+    struct Message { char action; uint64_t order_id; int64_t price; int size; BookSide side; };
+
+    const size_t resting = 100000;
+    const size_t messages = 4000000;
+    std::mt19937_64 rng(3);
+    auto random_price = [&](BookSide side) {
+        int64_t offset = 1 + static_cast<int64_t>(rng() % 200);
+        return (20000 + (side == BookSide::Bid ? -offset : offset)) * ES_TICK_SIZE;
+    };
+
+    // Track each order's state so the generated stream is self-consistent
+    std::vector<Message> stream;
+    std::vector<Message> live;
+    for (uint64_t id = 1; id <= resting; ++id) {
+        BookSide side = (id & 1) ? BookSide::Bid : BookSide::Ask;
+        live.push_back({'A', id, random_price(side), 100, side});
+        stream.push_back(live.back());
+    }
+    for (size_t n = 0; n < messages; ++n) {
+        Message& order = live[rng() % live.size()];
+        if (rng() % 10 < 8 && order.size > 1) {
+            order.size -= 1 + static_cast<int>(rng() % (order.size - 1));  // partial reduction
+        } else {
+            order.price = random_price(order.side);
+            order.size = 1 + static_cast<int>(rng() % 100);
+        }
+        stream.push_back({'M', order.order_id, order.price, order.size, order.side});
+    }
+
+    auto run = [&](PriceLadderBook& book, bool native) {
+        auto start = high_resolution_clock::now();
+        for (const auto& msg : stream) {
+            if (msg.action == 'A') {
+                book.ApplyAdd(msg.order_id, msg.price, msg.size, msg.side);
+            } else if (native) {
+                book.ApplyModify(msg.order_id, msg.price, msg.size);
+            } else {
+                book.ApplyCancel(msg.order_id, 0);
+                book.ApplyAdd(msg.order_id, msg.price, msg.size, msg.side);
+            }
+        }
+        return duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+    };
+
+    PriceLadderBook cancel_add_book(ES_TICK_SIZE);
+    double cancel_add_seconds = run(cancel_add_book, false);
+    PriceLadderBook native_book(ES_TICK_SIZE);
+    double native_seconds = run(native_book, true);
+
+    // Queue order differs, aggregated levels must not
+    L3Snapshot expected, actual;
+    cancel_add_book.GetL3Snapshot(expected);
+    native_book.GetL3Snapshot(actual);
+    for (size_t i = 0; i < DEPTH_LEVELS; ++i) {
+        EXPECT_EQ(expected.bid[i].price, actual.bid[i].price);
+        EXPECT_EQ(expected.bid[i].size, actual.bid[i].size);
+        EXPECT_EQ(expected.ask[i].price, actual.ask[i].price);
+        EXPECT_EQ(expected.ask[i].size, actual.ask[i].size);
+    }
+
+    std::cout << "Replayed " << stream.size() << " messages (" << messages << " modifies)\n"
+              << "  Cancel + add:  " << stream.size() / cancel_add_seconds << " msgs/s\n"
+              << "  Native modify: " << stream.size() / native_seconds << " msgs/s\n"
+              << "  Speedup: " << cancel_add_seconds / native_seconds << "x" << std::endl;
+}
+
+// A thin ask side: a full top-N at the touch and one level far behind it.
+// Every cancel at the edge of the view pulls the far level in, so the ladder
+// has to find it across the empty stretch. Needs no data file.
+TEST(OrderBookSparseBenchmark, RefillAcrossAnEmptyLadder) {
+    const int64_t touch = 20000, far = touch + 15000;
+    const size_t rounds = 1000000;
+
+    auto run = [&](auto& book, auto price) {
+        for (uint64_t i = 0; i < DEPTH_LEVELS; ++i) {
+            book.ApplyAdd(i + 1, price(touch + static_cast<int64_t>(i)), 10, BookSide::Ask);
+        }
+        book.ApplyAdd(DEPTH_LEVELS + 1, price(far), 10, BookSide::Ask);
+        const uint64_t edge = DEPTH_LEVELS;
+        auto start = high_resolution_clock::now();
+        for (size_t n = 0; n < rounds; ++n) {
+            book.ApplyCancel(edge, 0);
+            book.ApplyAdd(edge, price(touch + static_cast<int64_t>(DEPTH_LEVELS) - 1), 10, BookSide::Ask);
+        }
+        return duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+    };
+
+    OrderBookManager map_book;
+    double map_seconds =
+        run(map_book, [](int64_t tick) { return static_cast<double>(tick * ES_TICK_SIZE) / PRICE_SCALE; });
+    PriceLadderBook ladder_book(ES_TICK_SIZE);
+    double ladder_seconds = run(ladder_book, [](int64_t tick) { return tick * ES_TICK_SIZE; });
+
+    // The far level comes in when the edge goes and leaves again when it returns
+    ladder_book.ApplyCancel(DEPTH_LEVELS, 0);
+    L3Snapshot snapshot;
+    ladder_book.GetL3Snapshot(snapshot);
+    EXPECT_EQ(snapshot.ask[DEPTH_LEVELS - 1].price, static_cast<double>(far * ES_TICK_SIZE) / PRICE_SCALE);
+    map_book.ApplyCancel(DEPTH_LEVELS, 0);
+    L3Snapshot expected;
+    map_book.GetL3Snapshot(expected);
+    for (size_t i = 0; i < DEPTH_LEVELS; ++i) {
+        EXPECT_EQ(expected.ask[i].price, snapshot.ask[i].price);
+        EXPECT_EQ(expected.ask[i].size, snapshot.ask[i].size);
+    }
+
+    std::cout << "Refilled a thin top-" << DEPTH_LEVELS << " " << rounds << " times\n"
+              << "  OrderBookManager: " << 2 * rounds / map_seconds << " msgs/s\n"
+              << "  PriceLadderBook:  " << 2 * rounds / ladder_seconds << " msgs/s" << std::endl;
+}
@@ -2,7 +2,9 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <vector>
 #include <dbn_reader.hpp>
+#include <event_parser.hpp>
 
 namespace fs = std::filesystem;
 
@@ -48,7 +50,7 @@ TEST_F(DbnReaderTest, TestReadEvents) {
         try {
             auto event = reader.next_event();
             // Basic validation of the event
-            EXPECT_EQ(event.instrument, "ES") << "Unexpected instrument ID";
+            EXPECT_EQ(microregime::symbol_name(event.symbol), "ES") << "Unexpected instrument ID";
             EXPECT_GT(event.timestamp_ns, 0) << "Invalid timestamp";
             EXPECT_NE(event.action, '\0') << "Action should be set";
             
@@ -58,7 +60,7 @@ TEST_F(DbnReaderTest, TestReadEvents) {
                           << "ts=" << event.timestamp_ns
                           << " action=" << event.action
                           << " side=" << event.side
-                          << " price=" << event.price
+                          << " price=" << event.price_value()
                           << " size=" << event.size
                           << " order_id=" << event.order_id
                           << std::endl;
@@ -84,6 +86,122 @@ TEST_F(DbnReaderTest, TestNonExistentFile) {
     }, databento::InvalidArgumentError) << "Should throw for non-existent file";
 }
 
+TEST_F(DbnReaderTest, TestPrefetchMatchesStreaming) {
+    DbnMboReader streaming(test_file_.string(), "ES");
+    DbnMboReader prefetch(test_file_.string(), "ES", DbnReadMode::Prefetch);
+
+    size_t event_count = 0;
+    while (streaming.has_next()) {
+        ASSERT_TRUE(prefetch.has_next()) << "Prefetch reader ended early at event " << event_count;
+        MarketEvent expected = streaming.next_event();
+        MarketEvent actual = prefetch.next_event();
+        ASSERT_EQ(expected.timestamp_ns, actual.timestamp_ns);
+        ASSERT_EQ(expected.order_id, actual.order_id);
+        ASSERT_EQ(expected.price, actual.price);
+        event_count++;
+    }
+    EXPECT_FALSE(prefetch.has_next());
+    EXPECT_GT(event_count, 0);
+}
+
+// Mapped mode parses the DBN framing itself, so it can be checked against a
+// hand-built file without the sample data. Writes one MBO record per order id,
+// with a non-MBO record (e.g. a status message) wherever an id is 0 and a
+// corrupt zero-length record wherever it is kCorruptRecord.
+constexpr uint64_t kCorruptRecord = UINT64_MAX;
+
+static fs::path write_test_dbn(const std::string& name, const std::vector<uint64_t>& order_ids) {
+    fs::path file = fs::temp_directory_path() / name;
+    std::ofstream out(file, std::ios::binary);
+    // Prelude: magic, version, metadata length, then (padded) metadata
+    const uint32_t metadata_length = 8;
+    out.write("DBN\x02", 4);
+    out.write(reinterpret_cast<const char*>(&metadata_length), sizeof(metadata_length));
+    out.write("\0\0\0\0\0\0\0\0", metadata_length);
+
+    for (uint64_t order_id : order_ids) {
+        if (order_id == 0 || order_id == kCorruptRecord) {
+            databento::RecordHeader other{};
+            other.length = order_id == 0 ? sizeof(other) / databento::RecordHeader::kLengthMultiplier : 0;
+            other.rtype = static_cast<databento::RType>(0x17);
+            out.write(reinterpret_cast<const char*>(&other), sizeof(other));
+            continue;
+        }
+        databento::MboMsg mbo{};
+        mbo.hd.length = static_cast<uint8_t>(sizeof(mbo) / databento::RecordHeader::kLengthMultiplier);
+        mbo.hd.rtype = databento::RType::Mbo;
+        mbo.hd.instrument_id = 4916;
+        mbo.order_id = order_id;
+        mbo.price = 5000'250'000'000;
+        mbo.side = databento::Side::Bid;
+        out.write(reinterpret_cast<const char*>(&mbo), sizeof(mbo));
+    }
+    return file;
+}
+
+TEST(DbnReaderMappedTest, TestMappedRunsSkipNonMboRecords) {
+    fs::path file = write_test_dbn("mapped_reader_test.dbn", {1, 2, 0, 3});
+    {
+        DbnMboReader reader(file.string(), "ES", DbnReadMode::Mapped);
+        auto first = reader.next_block();
+        ASSERT_EQ(first.size(), 2u);
+        EXPECT_EQ(first[1].order_id, 2u);
+
+        ASSERT_TRUE(reader.has_next());
+        MarketEvent event = reader.next_event();
+        EXPECT_EQ(event.order_id, 3u);
+        EXPECT_EQ(event.price, 5000'250'000'000);
+        EXPECT_EQ(event.side, 'B');
+        EXPECT_EQ(event.instrument_id, 4916u);
+        EXPECT_FALSE(reader.has_next());
+        EXPECT_EQ(reader.event_count(), 3u);
+    }
+    fs::remove(file);
+}
+
+TEST(DbnReaderMappedTest, TestNextBatchSpansBlocks) {
+    fs::path file = write_test_dbn("batch_reader_test.dbn", {1, 2, 3, 0, 4, 5});
+    {
+        DbnMboReader reader(file.string(), "ES", DbnReadMode::Mapped);
+        MarketEvent first = reader.next_event();
+        EXPECT_EQ(first.order_id, 1u);
+
+        // One batch crosses the non-MBO record between blocks
+        std::vector<MarketEvent> batch(3);
+        ASSERT_EQ(reader.next_batch(batch), 3u);
+        EXPECT_EQ(batch[0].order_id, 2u);
+        EXPECT_EQ(batch[2].order_id, 4u);
+
+        ASSERT_EQ(reader.next_batch(batch), 1u);
+        EXPECT_EQ(batch[0].order_id, 5u);
+        EXPECT_EQ(reader.next_batch(batch), 0u);
+        EXPECT_EQ(reader.event_count(), 5u);
+    }
+    fs::remove(file);
+}
+
+TEST(DbnReaderMappedTest, TestNextBatchKeepsEventsBeforeAnError) {
+    fs::path file = write_test_dbn("corrupt_reader_test.dbn", {1, 2, 3, kCorruptRecord, 4});
+    {
+        DbnMboReader reader(file.string(), "ES", DbnReadMode::Mapped);
+        std::vector<MarketEvent> batch(8);
+        ASSERT_EQ(reader.next_batch(batch), 3u);
+        EXPECT_EQ(batch[2].order_id, 3u);
+        EXPECT_EQ(reader.event_count(), 3u);
+        EXPECT_THROW(reader.next_batch(batch), std::runtime_error);
+    }
+    {
+        // The parser hands on the events ahead of the bad record, then stops
+        EventParser parser(file.string(), "ES", DbnReadMode::Mapped);
+        std::vector<MarketEvent> batch(8);
+        ASSERT_EQ(parser.next_batch(batch), 3u);
+        EXPECT_EQ(batch[0].order_id, 1u);
+        EXPECT_EQ(batch[2].order_id, 3u);
+        EXPECT_FALSE(parser.has_more_events());
+    }
+    fs::remove(file);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <vector>
+#include <event_cache.hpp>
+#include <event_parser.hpp>
+#include <order_engine.hpp>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+MarketEvent make_event(uint64_t i) {
+    MarketEvent event{};
+    event.timestamp_ns = 1'000'000'000ull + i;
+    event.price = static_cast<int64_t>(5000 + i % 8) * microregime::ES_TICK_SIZE;
+    event.order_id = i + 1;
+    event.instrument_id = 4916;
+    event.sequence = static_cast<uint32_t>(i * 3);
+    event.size = static_cast<int>(i % 50) + 1;
+    event.symbol = microregime::intern_symbol("ES");
+    event.action = 'A';
+    event.side = (i & 1) ? 'A' : 'B';
+    event.flags = static_cast<uint8_t>(i);
+    event.channel_id = 7;
+    return event;
+}
+
+} // namespace
+
+TEST(EventCacheTest, PathSitsNextToDbnFile) {
+    EXPECT_EQ(event_cache::path_for("data/ES/glbx-mdp3-20250505.mbo.dbn.zst"),
+              fs::path("data/ES/glbx-mdp3-20250505.mbo.events").string());
+    EXPECT_EQ(event_cache::path_for("x.dbn"), "x.events");
+}
+
+TEST(EventCacheTest, RoundTripsEveryField) {
+    fs::path file = fs::temp_directory_path() / "round_trip.events";
+    const size_t count = 10007;  // Not a multiple of the batch size
+    {
+        EventCacheWriter writer(file.string(), "ES");
+        for (size_t i = 0; i < count; ++i) {
+            writer.append(make_event(i));
+        }
+    }
+
+    {
+        EventCacheReader reader(file.string());
+        EXPECT_EQ(reader.instrument(), "ES");
+        ASSERT_EQ(reader.event_count(), count);
+
+        std::vector<MarketEvent> batch(4096);
+        size_t seen = 0;
+        while (size_t n = reader.next_batch(batch)) {
+            for (size_t i = 0; i < n; ++i, ++seen) {
+                MarketEvent expected = make_event(seen);
+                const MarketEvent& actual = batch[i];
+                ASSERT_EQ(actual.timestamp_ns, expected.timestamp_ns);
+                ASSERT_EQ(actual.price, expected.price);
+                ASSERT_EQ(actual.order_id, expected.order_id);
+                ASSERT_EQ(actual.instrument_id, expected.instrument_id);
+                ASSERT_EQ(actual.sequence, expected.sequence);
+                ASSERT_EQ(actual.size, expected.size);
+                ASSERT_EQ(actual.symbol, expected.symbol);
+                ASSERT_EQ(actual.action, expected.action);
+                ASSERT_EQ(actual.side, expected.side);
+                ASSERT_EQ(actual.flags, expected.flags);
+                ASSERT_EQ(actual.channel_id, expected.channel_id);
+            }
+        }
+        EXPECT_EQ(seen, count);
+        EXPECT_FALSE(reader.has_next());
+    }
+    fs::remove(file);
+}
+
+TEST(EventCacheTest, EventParserReplaysCache) {
+    fs::path file = fs::temp_directory_path() / "parser_replay.events";
+    {
+        EventCacheWriter writer(file.string(), "ES");
+        for (size_t i = 0; i < 100; ++i) {
+            writer.append(make_event(i));
+        }
+    }
+
+    {
+        OrderEngine engine;
+        EventParser parser(file.string(), "ES");
+        parser.process_all(engine);
+        EXPECT_EQ(engine.get_order_book("ES").order_count(), 100u);
+        EXPECT_THROW(EventParser(file.string(), "SPY"), std::runtime_error);
+    }
+    fs::remove(file);
+}
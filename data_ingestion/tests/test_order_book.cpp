@@ -0,0 +1,304 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <order_book.hpp>
+#include <order_index.hpp>
+#include <price_ladder_book.hpp>
+
+// The map-based OrderBookManager is the reference implementation; the ladder
+// book must produce identical snapshots for the same stream of operations.
+
+namespace {
+
+double random_price(std::mt19937_64& rng, BookSide side) {
+    std::uniform_int_distribution<int> tick_offset(0, 400);
+    // Keep the book uncrossed: bids below 500.00, asks above
+    int offset = 1 + tick_offset(rng);
+    int ticks = 50000 + (side == BookSide::Bid ? -offset : offset);
+    return static_cast<double>(ticks * microregime::DEFAULT_TICK_SIZE) / microregime::PRICE_SCALE;
+}
+
+void expect_same_book(const OrderBookManager& reference, const PriceLadderBook& ladder) {
+    L3Snapshot expected, actual;
+    reference.GetL3Snapshot(expected);
+    ladder.GetL3Snapshot(actual);
+    for (size_t i = 0; i < DEPTH_LEVELS; ++i) {
+        EXPECT_EQ(expected.bid[i].price, actual.bid[i].price) << "bid level " << i;
+        EXPECT_EQ(expected.bid[i].size, actual.bid[i].size) << "bid level " << i;
+        EXPECT_EQ(expected.ask[i].price, actual.ask[i].price) << "ask level " << i;
+        EXPECT_EQ(expected.ask[i].size, actual.ask[i].size) << "ask level " << i;
+    }
+
+    double expected_mid = reference.GetMidPrice();
+    double actual_mid = ladder.GetMidPrice();
+    if (std::isnan(expected_mid)) {
+        EXPECT_TRUE(std::isnan(actual_mid));
+    } else {
+        EXPECT_EQ(expected_mid, actual_mid);
+        EXPECT_EQ(reference.GetSpread(), ladder.GetSpread());
+    }
+}
+
+} // namespace
+
+TEST(PriceLadderBookTest, AggregatesLevelsBestFirst) {
+    PriceLadderBook book(microregime::ES_TICK_SIZE);
+    book.ApplyAdd(1, 5000.00, 3, BookSide::Bid);
+    book.ApplyAdd(2, 5000.00, 4, BookSide::Bid);
+    book.ApplyAdd(3, 4999.75, 1, BookSide::Bid);
+    book.ApplyAdd(4, 5000.50, 2, BookSide::Ask);
+    book.ApplyAdd(5, 5000.25, 5, BookSide::Ask);
+
+    L3Snapshot snapshot;
+    book.GetL3Snapshot(snapshot);
+    EXPECT_EQ(snapshot.bid[0].price, 5000.00);
+    EXPECT_EQ(snapshot.bid[0].size, 7);
+    EXPECT_EQ(snapshot.bid[1].price, 4999.75);
+    EXPECT_EQ(snapshot.ask[0].price, 5000.25);
+    EXPECT_EQ(snapshot.ask[1].price, 5000.50);
+    EXPECT_EQ(snapshot.bid[2].size, 0);
+    EXPECT_DOUBLE_EQ(book.GetMidPrice(), 5000.125);
+    EXPECT_DOUBLE_EQ(book.GetSpread(), 0.25);
+
+    book.ApplyCancel(5, 0);
+    book.GetL3Snapshot(snapshot);
+    EXPECT_EQ(snapshot.ask[0].price, 5000.50);
+    EXPECT_THROW(book.ApplyCancel(5, 0), std::runtime_error);
+    EXPECT_THROW(book.ApplyAdd(1, 5000.00, 1, BookSide::Bid), std::runtime_error);
+}
+
+TEST(PriceLadderBookTest, PricesOutsideTheArraySpillToOverflow) {
+    PriceLadderBook book(microregime::DEFAULT_TICK_SIZE);
+    const double span = static_cast<double>(PriceLadderBook::kLadderLevels) / 100.0;
+
+    book.ApplyAdd(1, 500.00, 10, BookSide::Bid);
+    book.ApplyAdd(2, 500.00 - span, 20, BookSide::Bid);  // below the array
+    book.ApplyAdd(3, 500.00 + span, 30, BookSide::Bid);  // above it, becomes the best bid
+    book.ApplyAdd(4, 500.00 + 2 * span, 5, BookSide::Ask);
+
+    L3Snapshot snapshot;
+    book.GetL3Snapshot(snapshot);
+    EXPECT_DOUBLE_EQ(snapshot.bid[0].price, 500.00 + span);
+    EXPECT_DOUBLE_EQ(snapshot.bid[1].price, 500.00);
+    EXPECT_DOUBLE_EQ(snapshot.bid[2].price, 500.00 - span);
+    EXPECT_EQ(snapshot.bid[0].size, 30);
+
+    book.ApplyCancel(3, 0);
+    EXPECT_DOUBLE_EQ(book.GetSpread(), 2 * span);
+}
+
+TEST(PriceLadderBookTest, RecentersOnTheTouchAsPricesDrift) {
+    // A stub first quote anchors the ladder far from the market, which then
+    // drifts up by several ladder widths
+    OrderBookManager reference;
+    PriceLadderBook ladder(microregime::DEFAULT_TICK_SIZE);
+    auto price = [](int64_t ticks) {
+        return static_cast<double>(ticks * microregime::DEFAULT_TICK_SIZE) / microregime::PRICE_SCALE;
+    };
+    reference.ApplyAdd(1, price(100), 1, BookSide::Bid);
+    ladder.ApplyAdd(1, price(100), 1, BookSide::Bid);
+
+    const int64_t width = static_cast<int64_t>(PriceLadderBook::kLadderLevels);
+    std::vector<uint64_t> live;
+    uint64_t next_id = 2;
+    for (int64_t mid = 50'000; mid < 50'000 + 3 * width; mid += 7) {
+        for (int64_t offset = 1; offset <= 3; ++offset) {
+            reference.ApplyAdd(next_id, price(mid - offset), 10, BookSide::Bid);
+            ladder.ApplyAdd(next_id, price(mid - offset), 10, BookSide::Bid);
+            live.push_back(next_id++);
+            reference.ApplyAdd(next_id, price(mid + offset), 10, BookSide::Ask);
+            ladder.ApplyAdd(next_id, price(mid + offset), 10, BookSide::Ask);
+            live.push_back(next_id++);
+        }
+        // Keep a short book: the oldest, now furthest, orders are pulled
+        while (live.size() > 60) {
+            reference.ApplyCancel(live.front(), 0);
+            ladder.ApplyCancel(live.front(), 0);
+            live.erase(live.begin());
+        }
+    }
+    expect_same_book(reference, ladder);
+
+    // Only the stub bid is left outside the array
+    EXPECT_EQ(ladder.overflow_levels(BookSide::Bid), 1u);
+    EXPECT_EQ(ladder.overflow_levels(BookSide::Ask), 0u);
+
+    // Dropping back to the stub pulls it into the array again
+    for (uint64_t id : live) {
+        ladder.ApplyCancel(id, 0);
+    }
+    EXPECT_EQ(ladder.overflow_levels(BookSide::Bid), 0u);
+    L3Snapshot snapshot;
+    ladder.GetL3Snapshot(snapshot);
+    EXPECT_DOUBLE_EQ(snapshot.bid[0].price, price(100));
+}
+
+TEST(PriceLadderBookTest, FixedPointAndDoublePricesAgree) {
+    PriceLadderBook fixed(microregime::ES_TICK_SIZE);
+    PriceLadderBook floating(microregime::ES_TICK_SIZE);
+    fixed.ApplyAdd(1, int64_t{5000'250'000'000}, 2, BookSide::Bid);
+    floating.ApplyAdd(1, 5000.25, 2, BookSide::Bid);
+    fixed.ApplyModify(1, int64_t{5000'000'000'000}, 3);
+    floating.ApplyModify(1, 5000.00, 3);
+
+    L3Snapshot expected, actual;
+    floating.GetL3Snapshot(expected);
+    fixed.GetL3Snapshot(actual);
+    EXPECT_EQ(expected.bid[0].price, actual.bid[0].price);
+    EXPECT_EQ(actual.bid[0].price, 5000.00);
+    EXPECT_EQ(actual.bid[0].size, 3);
+}
+
+TEST(PriceLadderBookTest, FindOrderReportsRestingOrders) {
+    PriceLadderBook book(microregime::ES_TICK_SIZE);
+    book.ApplyAdd(42, int64_t{5000'250'000'000}, 7, BookSide::Ask);
+
+    auto order = book.FindOrder(42);
+    ASSERT_TRUE(order.has_value());
+    EXPECT_EQ(order->side, BookSide::Ask);
+    EXPECT_EQ(order->price, 5000'250'000'000);
+    EXPECT_EQ(order->size, 7);
+
+    EXPECT_TRUE(book.TryModify(42, int64_t{5000'500'000'000}, 5));
+    EXPECT_EQ(book.FindOrder(42)->price, 5000'500'000'000);
+    EXPECT_FALSE(book.TryModify(43, int64_t{5000'500'000'000}, 5));
+    EXPECT_FALSE(book.TryCancel(43));
+
+    book.ApplyCancel(42, 0);
+    EXPECT_FALSE(book.FindOrder(42).has_value());
+    EXPECT_FALSE(book.TryCancel(42));
+    EXPECT_EQ(book.order_count(), 0u);
+}
+
+TEST(PriceLadderBookTest, ModifyKeepsPriorityOnlyForSamePriceReduction) {
+    PriceLadderBook book(microregime::ES_TICK_SIZE);
+    book.ApplyAdd(1, 5000.00, 10, BookSide::Bid);
+    book.ApplyAdd(2, 5000.00, 10, BookSide::Bid);
+    book.ApplyAdd(3, 5000.00, 10, BookSide::Bid);
+
+    // Size reduction at the same price stays at the front
+    book.ApplyModify(1, 5000.00, 4);
+    EXPECT_EQ(book.QueuePosition(1), 0u);
+    L3Snapshot snapshot;
+    book.GetL3Snapshot(snapshot);
+    EXPECT_EQ(snapshot.bid[0].size, 24);
+
+    // Size increase goes to the back
+    book.ApplyModify(1, 5000.00, 5);
+    EXPECT_EQ(book.QueuePosition(1), 2u);
+    EXPECT_EQ(book.QueuePosition(2), 0u);
+
+    // Price change moves levels, and back again lands behind the others
+    book.ApplyModify(2, 4999.75, 1);
+    book.ApplyModify(2, 5000.00, 1);
+    EXPECT_EQ(book.QueuePosition(2), 2u);
+    book.GetL3Snapshot(snapshot);
+    EXPECT_EQ(snapshot.bid[0].size, 16);
+    EXPECT_EQ(snapshot.bid[1].size, 0);
+}
+
+TEST(OrderIndexTest, MatchesUnorderedMapUnderChurn) {
+    // Tiny initial table so growth and long probe runs are both exercised
+    OrderIndex index(4);
+    std::unordered_map<uint64_t, uint32_t> reference;
+    std::mt19937_64 rng(11);
+
+    for (uint32_t step = 0; step < 200000; ++step) {
+        // Narrow id range so inserts, hits and misses all happen often
+        uint64_t id = rng() % 5000;
+        if (rng() % 3 != 0) {
+            bool inserted;
+            OrderIndex::Slot* slot = index.insert(id, inserted);
+            EXPECT_EQ(inserted, reference.find(id) == reference.end());
+            if (inserted) {
+                slot->handle = step;
+                reference.emplace(id, step);
+            }
+        } else if (OrderIndex::Slot* slot = index.find(id)) {
+            ASSERT_TRUE(reference.count(id));
+            EXPECT_EQ(slot->handle, reference[id]);
+            index.erase(slot);
+            reference.erase(id);
+        } else {
+            EXPECT_FALSE(reference.count(id));
+        }
+    }
+
+    EXPECT_EQ(index.size(), reference.size());
+    for (const auto& [id, handle] : reference) {
+        const OrderIndex::Slot* slot = index.find(id);
+        ASSERT_NE(slot, nullptr);
+        EXPECT_EQ(slot->handle, handle);
+    }
+}
+
+TEST(PriceLadderBookTest, TopLevelsRefillAfterCancel) {
+    PriceLadderBook book(microregime::ES_TICK_SIZE);
+    for (uint64_t i = 0; i < DEPTH_LEVELS + 5; ++i) {
+        book.ApplyAdd(i + 1, 5000.00 - 0.25 * i, 1, BookSide::Bid);
+    }
+    uint64_t version = book.top_version();
+
+    // Clearing the best level pulls the 11th level into view
+    book.ApplyCancel(1, 0);
+    L3Snapshot snapshot;
+    book.GetL3Snapshot(snapshot);
+    EXPECT_GT(book.top_version(), version);
+    EXPECT_DOUBLE_EQ(snapshot.bid[0].price, 4999.75);
+    EXPECT_DOUBLE_EQ(snapshot.bid[DEPTH_LEVELS - 1].price, 5000.00 - 0.25 * DEPTH_LEVELS);
+
+    // Changes beyond the top levels leave the view untouched
+    version = book.top_version();
+    book.ApplyCancel(DEPTH_LEVELS + 5, 0);
+    EXPECT_EQ(book.top_version(), version);
+}
+
+TEST(PriceLadderBookTest, MatchesReferenceBookOnRandomStream) {
+    OrderBookManager reference;
+    PriceLadderBook ladder(microregime::DEFAULT_TICK_SIZE);
+
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int> size_dist(1, 500);
+    std::uniform_int_distribution<int> action_dist(0, 9);
+    std::vector<std::pair<uint64_t, BookSide>> live;
+    uint64_t next_id = 1;
+
+    for (int step = 0; step < 20000; ++step) {
+        int action = action_dist(rng);
+        if (live.empty() || action < 5) {
+            BookSide side = (rng() & 1) ? BookSide::Bid : BookSide::Ask;
+            double price = random_price(rng, side);
+            int size = size_dist(rng);
+            reference.ApplyAdd(next_id, price, size, side);
+            ladder.ApplyAdd(next_id, price, size, side);
+            live.emplace_back(next_id++, side);
+        } else if (action < 7) {
+            auto [id, side] = live[rng() % live.size()];
+            double price = random_price(rng, side);
+            int size = size_dist(rng);
+            reference.ApplyModify(id, price, size);
+            ladder.ApplyModify(id, price, size);
+        } else {
+            size_t pick = rng() % live.size();
+            uint64_t id = live[pick].first;
+            live[pick] = live.back();
+            live.pop_back();
+            reference.ApplyCancel(id, 0);
+            ladder.ApplyCancel(id, 0);
+        }
+
+        if (step % 97 == 0) {
+            expect_same_book(reference, ladder);
+
+            L3Delta expected_delta, actual_delta;
+            reference.GetDepthChange(expected_delta);
+            ladder.GetDepthChange(actual_delta);
+            EXPECT_EQ(expected_delta.bid_dir, actual_delta.bid_dir);
+            EXPECT_EQ(expected_delta.ask_dir, actual_delta.ask_dir);
+        }
+    }
+    expect_same_book(reference, ladder);
+    EXPECT_EQ(ladder.order_count(), live.size());
+}
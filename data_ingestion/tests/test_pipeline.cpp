@@ -107,7 +107,7 @@ TEST_F(MarketDataPipelineTest, FullPipelineTest) {
     size_t event_count = 0;
     size_t snapshot_count = 0;
     
-    FeatureEngine feature_engine(const_cast<OrderBookManager&>(order_engine.get_or_create_order_book(instrument_)), instrument_);
+    FeatureEngine feature_engine(const_cast<PriceLadderBook&>(order_engine.get_or_create_order_book(instrument_)), instrument_);
     std::cout << "Starting pipeline test...\n";
     while (parser.has_more_events() && event_count < max_events) {            
         // Process next event
@@ -138,4 +138,32 @@ TEST_F(MarketDataPipelineTest, FullPipelineTest) {
     EXPECT_GT(snapshot_count, 0) << "No snapshots were generated";
 }
 
+TEST_F(MarketDataPipelineTest, BatchProcessingMatchesSingleEvents) {
+    OrderEngine single_engine;
+    EventParser single_parser(test_file_.string(), instrument_);
+    FeatureEngine single_features(single_engine.get_or_create_order_book(instrument_), instrument_);
+    while (single_parser.process_next(single_engine, &single_features)) {
+    }
+
+    OrderEngine batch_engine;
+    EventParser batch_parser(test_file_.string(), instrument_, DbnReadMode::Prefetch);
+    FeatureEngine batch_features(batch_engine.get_or_create_order_book(instrument_), instrument_);
+    size_t batches = 0;
+    while (batch_parser.process_batch(batch_engine, &batch_features)) {
+        batches++;
+    }
+
+    L3Snapshot expected, actual;
+    single_engine.get_order_book(instrument_).GetL3Snapshot(expected);
+    batch_engine.get_order_book(instrument_).GetL3Snapshot(actual);
+    for (size_t i = 0; i < DEPTH_LEVELS; ++i) {
+        EXPECT_EQ(expected.bid[i].price, actual.bid[i].price);
+        EXPECT_EQ(expected.bid[i].size, actual.bid[i].size);
+        EXPECT_EQ(expected.ask[i].price, actual.ask[i].price);
+        EXPECT_EQ(expected.ask[i].size, actual.ask[i].size);
+    }
+    EXPECT_EQ(single_engine.current_timestamp(), batch_engine.current_timestamp());
+    EXPECT_GT(batches, 0);
+}
+
 // main() is defined in test_dbn_reader.cpp
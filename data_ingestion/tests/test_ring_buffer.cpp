@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <ring_buffer.hpp>
+
+using microregime::RingBuffer;
+
+TEST(RingBufferTest, EvictsOldestAtCapacity) {
+    RingBuffer<int> ring(3);
+    EXPECT_TRUE(ring.empty());
+    for (int i = 0; i < 5; ++i) ring.push_back(i);
+    EXPECT_TRUE(ring.full());
+    ASSERT_EQ(ring.size(), 3u);
+    EXPECT_EQ(ring.front(), 2);
+    EXPECT_EQ(ring.back(), 4);
+    EXPECT_EQ(ring[1], 3);
+}
+
+TEST(RingBufferTest, ViewIsContiguousAcrossWraparound) {
+    std::mt19937_64 rng(17);
+    RingBuffer<double> ring(100);  // 128 slots, so the window wraps every 128 pushes
+    std::deque<double> expected;
+    for (size_t step = 0; step < 1000; ++step) {
+        double x = static_cast<double>(rng() % 1000);
+        ring.push_back(x);
+        expected.push_back(x);
+        if (expected.size() > 100) expected.pop_front();
+        if (rng() % 4 == 0) {
+            ring.pop_front();
+            expected.pop_front();
+        }
+
+        auto view = ring.view();
+        ASSERT_EQ(view.size(), expected.size());
+        for (size_t i = 0; i < view.size(); ++i) {
+            ASSERT_EQ(view[i], expected[i]) << "step " << step << " index " << i;
+        }
+    }
+}
+
+TEST(RingBufferTest, StorageIsCacheLineAligned) {
+    RingBuffer<int8_t> ring(10);
+    ring.push_back(1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ring.begin()) % RingBuffer<int8_t>::kAlignment, 0u);
+}
+
+TEST(RingBufferTest, CopiesAreIndependent) {
+    RingBuffer<int> ring(4);
+    for (int i = 0; i < 6; ++i) ring.push_back(i);
+    RingBuffer<int> copy = ring;
+    ring.push_back(99);
+    ASSERT_EQ(copy.size(), 4u);
+    EXPECT_EQ(copy.front(), 2);
+    EXPECT_EQ(copy.back(), 5);
+    EXPECT_EQ(ring.back(), 99);
+}
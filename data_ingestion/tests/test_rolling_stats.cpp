@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <random>
+#include <span>
+#include <feature_engine.hpp>
+#include <price_ladder_book.hpp>
+#include <rolling_stats.hpp>
+
+namespace {
+
+// The per-snapshot loops FeatureProcessor::ProcessVolatility used to run
+struct BruteForceVolatility {
+    double realized_variance = 0.0;
+    double ewm_square = 0.0;
+    double up_mean_square = 0.0;
+    double down_mean_square = 0.0;
+    double spread_variance = 0.0;
+
+    BruteForceVolatility(std::span<const double> midprices, std::span<const double> spreads) {
+        const double alpha = 2.0 / (ROLLING_WINDOW + 1);
+        double sum_sq = 0.0, up = 0.0, down = 0.0;
+        int count = 0, up_count = 0, down_count = 0;
+        for (size_t i = 1; i < midprices.size(); ++i) {
+            if (!usable(midprices[i - 1]) || !usable(midprices[i])) continue;
+            double ret = std::log(midprices[i]) - std::log(midprices[i - 1]);
+            sum_sq += ret * ret;
+            ewm_square = (count == 0) ? ret * ret : (1 - alpha) * ewm_square + alpha * ret * ret;
+            ++count;
+            if (ret > 0) {
+                up += ret * ret;
+                ++up_count;
+            } else {
+                down += ret * ret;
+                ++down_count;
+            }
+        }
+        realized_variance = count ? sum_sq / count : 0.0;
+        up_mean_square = up_count ? up / up_count : 0.0;
+        down_mean_square = down_count ? down / down_count : 0.0;
+
+        double mean = 0.0;
+        for (double s : spreads) mean += std::isfinite(s) ? s : 0.0;
+        mean /= ROLLING_WINDOW;
+        for (double s : spreads) spread_variance += std::isfinite(s) ? (s - mean) * (s - mean) : 0.0;
+        spread_variance /= ROLLING_WINDOW;
+    }
+
+    static bool usable(double price) { return std::isfinite(price) && price > 0.0; }
+};
+
+void expect_close(double actual, double expected, const char* what, size_t step) {
+    EXPECT_LE(std::abs(actual - expected), 1e-9 * std::abs(expected) + 1e-300)
+        << what << " at sample " << step << ": " << actual << " vs " << expected;
+}
+
+} // namespace
+
+TEST(RollingStatsTest, RollingMomentsMatchesRecomputation) {
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> noise(-1e-4, 1e-4);
+    std::deque<double> window;
+    RollingMoments moments;
+    for (size_t step = 0; step < 20000; ++step) {
+        double x = 0.25 + noise(rng);
+        window.push_back(x);
+        moments.add(x);
+        if (window.size() > 500) {
+            moments.remove(window.front());
+            window.pop_front();
+        }
+        double sum = 0.0;
+        for (double v : window) sum += v;
+        double mean = sum / window.size();
+        double dev = 0.0;
+        for (double v : window) dev += (v - mean) * (v - mean);
+
+        ASSERT_EQ(moments.count(), window.size());
+        expect_close(moments.sum(), sum, "sum", step);
+        EXPECT_NEAR(moments.sum_sq_dev(mean), dev, 1e-9 * dev + 1e-18);
+    }
+}
+
+TEST(RollingStatsTest, FeatureEngineVolatilityMatchesFullRecomputation) {
+    PriceLadderBook book(microregime::DEFAULT_TICK_SIZE);
+    FeatureEngine engine(book, "SPY");
+
+    std::mt19937_64 rng(11);
+    double mid = 560.0;
+    for (size_t step = 0; step < 3 * microregime::MIDPRICE_WINDOW + 777; ++step) {
+        unsigned roll = rng() % 100;
+        if (roll < 20) mid += 0.01;
+        else if (roll < 40) mid -= 0.01;
+        double spread = 0.01 * (1 + rng() % 3);
+        // An empty book reports 0; those samples must be skipped like before
+        bool empty_book = step < 40 || (step % 997) < 3;
+        engine.UpdateMidpriceAndSpread(empty_book ? 0.0 : mid, empty_book ? 0.0 : spread);
+
+        if (step % 13 != 0) continue;
+        FeatureInputSnapshot snapshot = engine.generate_snapshot();
+        BruteForceVolatility expected(snapshot.rolling_midprices, snapshot.rolling_spreads);
+        expect_close(snapshot.midprice_returns->mean_square(), expected.realized_variance, "realized variance", step);
+        expect_close(snapshot.midprice_returns->ewm_square(), expected.ewm_square, "ewm", step);
+        expect_close(snapshot.midprice_returns->up_mean_square(), expected.up_mean_square, "up", step);
+        expect_close(snapshot.midprice_returns->down_mean_square(), expected.down_mean_square, "down", step);
+        double mean = snapshot.spread_moments->sum() / ROLLING_WINDOW;
+        expect_close(snapshot.spread_moments->sum_sq_dev(mean) / ROLLING_WINDOW, expected.spread_variance,
+                     "spread variance", step);
+    }
+}
+
+TEST(RollingStatsTest, NonFiniteSamplesAreSkippedLikeAnEmptyBook) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    RollingMoments moments;
+    for (double x : {1.0, nan, 2.0, inf, 3.0}) moments.add(x);
+    EXPECT_EQ(moments.count(), 3u);
+    EXPECT_DOUBLE_EQ(moments.sum(), 6.0);
+    moments.remove(nan);
+    moments.remove(1.0);
+    EXPECT_EQ(moments.count(), 2u);
+    EXPECT_DOUBLE_EQ(moments.sum_sq_dev(2.5), 0.5);
+
+    PriceLadderBook book(microregime::DEFAULT_TICK_SIZE);
+    FeatureEngine engine(book, "SPY");
+    std::mt19937_64 rng(13);
+    double mid = 560.0;
+    for (size_t step = 0; step < 3 * microregime::MIDPRICE_WINDOW + 321; ++step) {
+        mid += 0.01 * (static_cast<int>(rng() % 3) - 1);
+        double spread = 0.01 * (1 + rng() % 3);
+        double bad = (step % 2) ? nan : inf;
+        bool bad_mid = (step % 211) < 2, bad_spread = (step % 157) == 5;
+        engine.UpdateMidpriceAndSpread(bad_mid ? bad : mid, bad_spread ? bad : spread);
+
+        if (step % 11 != 0) continue;
+        FeatureInputSnapshot snapshot = engine.generate_snapshot();
+        BruteForceVolatility expected(snapshot.rolling_midprices, snapshot.rolling_spreads);
+        ASSERT_TRUE(std::isfinite(snapshot.midprice_returns->mean_square())) << step;
+        ASSERT_TRUE(std::isfinite(snapshot.midprice_returns->ewm_square())) << step;
+        ASSERT_TRUE(std::isfinite(snapshot.spread_moments->sum())) << step;
+        expect_close(snapshot.midprice_returns->mean_square(), expected.realized_variance, "realized variance", step);
+        expect_close(snapshot.midprice_returns->ewm_square(), expected.ewm_square, "ewm", step);
+        expect_close(snapshot.midprice_returns->up_mean_square(), expected.up_mean_square, "up", step);
+        expect_close(snapshot.midprice_returns->down_mean_square(), expected.down_mean_square, "down", step);
+        double mean = snapshot.spread_moments->sum() / ROLLING_WINDOW;
+        expect_close(snapshot.spread_moments->sum_sq_dev(mean) / ROLLING_WINDOW, expected.spread_variance,
+                     "spread variance", step);
+    }
+}
+
+TEST(RollingStatsTest, RollingDirectionsMatchesRecount) {
+    std::mt19937_64 rng(5);
+    RollingDirections window(ROLLING_WINDOW);
+    std::deque<int8_t> expected;
+    for (size_t step = 0; step < 3 * ROLLING_WINDOW + 101; ++step) {
+        int8_t direction = static_cast<int8_t>(static_cast<int>(rng() % 3) - 1);
+        window.push(direction);
+        expected.push_back(direction);
+        if (expected.size() > ROLLING_WINDOW) expected.pop_front();
+
+        if (step % 7 != 0) continue;
+        size_t up = 0, down = 0, zero = 0, reversals = 0;
+        int64_t sum = 0;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            if (expected[i] > 0) ++up;
+            else if (expected[i] < 0) ++down;
+            else ++zero;
+            sum += expected[i];
+            if (i > 0 && expected[i] != 0 && expected[i] == -expected[i - 1]) ++reversals;
+        }
+        ASSERT_EQ(window.size(), expected.size());
+        ASSERT_EQ(window.up(), up) << step;
+        ASSERT_EQ(window.down(), down) << step;
+        ASSERT_EQ(window.zero(), zero) << step;
+        ASSERT_EQ(window.sum(), sum) << step;
+        ASSERT_EQ(window.reversals(), reversals) << step;
+    }
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <spsc_queue.hpp>
+
+using microregime::SpscQueue;
+
+TEST(SpscQueueTest, CapacityRoundsUpToPowerOfTwo) {
+    EXPECT_EQ(SpscQueue<int>(5).capacity(), 8u);
+    EXPECT_EQ(SpscQueue<int>(64).capacity(), 64u);
+}
+
+TEST(SpscQueueTest, FifoAndFullEmpty) {
+    SpscQueue<std::string> queue(4);
+    std::string out;
+    EXPECT_FALSE(queue.try_pop(out));
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_push(std::to_string(i)));
+    }
+    EXPECT_FALSE(queue.try_push(std::string("overflow")));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.try_pop(out));
+        EXPECT_EQ(out, std::to_string(i));
+    }
+    EXPECT_FALSE(queue.try_pop(out));
+}
+
+TEST(SpscQueueTest, TwoThreadsSeeEveryValueInOrder) {
+    constexpr uint64_t kCount = 200'000;
+    SpscQueue<uint64_t> queue(256);
+
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < kCount; ++i) {
+            while (!queue.try_push(uint64_t{i})) std::this_thread::yield();
+        }
+    });
+
+    uint64_t expected = 0;
+    uint64_t value;
+    while (expected < kCount) {
+        if (queue.try_pop(value)) {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        }
+    }
+    producer.join();
+}
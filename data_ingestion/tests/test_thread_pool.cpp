@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <thread_pool.hpp>
+
+using microregime::ThreadPool;
+
+TEST(ThreadPoolTest, RunsEveryTaskAndReturnsResults) {
+    ThreadPool pool(4);
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 1000; ++i) {
+        results.push_back(pool.submit([i] { return i * i; }));
+    }
+    long long sum = 0;
+    for (auto& result : results) sum += result.get();
+
+    long long expected = 0;
+    for (int i = 0; i < 1000; ++i) expected += i * i;
+    EXPECT_EQ(sum, expected);
+}
+
+TEST(ThreadPoolTest, ExceptionsReachTheFuture) {
+    ThreadPool pool(2);
+    auto failing = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    auto fine = pool.submit([] { return 7; });
+    EXPECT_THROW(failing.get(), std::runtime_error);
+    EXPECT_EQ(fine.get(), 7);
+}
+
+TEST(ThreadPoolTest, IdleWorkersStealFromBusyOnes) {
+    ThreadPool pool(4);
+    std::mutex mutex;
+    std::set<std::thread::id> ran_on;
+
+    // Every child is queued on the parent's own deque; the other workers can only get them by stealing
+    pool.submit([&] {
+        for (int i = 0; i < 64; ++i) {
+            pool.submit([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                std::lock_guard<std::mutex> lock(mutex);
+                ran_on.insert(std::this_thread::get_id());
+            });
+        }
+    });
+    pool.wait_idle();
+    EXPECT_GT(ran_on.size(), 1u);
+}
+
+TEST(ThreadPoolTest, OutsideSubmissionsStartInOrder) {
+    // Callers order jobs longest first; the pool must not reverse that
+    ThreadPool pool(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    pool.submit([released] { released.wait(); });
+
+    std::mutex mutex;
+    std::vector<int> order;
+    for (int i = 0; i < 16; ++i) {
+        pool.submit([&, i] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(i);
+        });
+    }
+    release.set_value();
+    pool.wait_idle();
+    ASSERT_EQ(order.size(), 16u);
+    for (int i = 0; i < 16; ++i) EXPECT_EQ(order[i], i);
+}
+
+TEST(ThreadPoolTest, WaitIdleAndDestructorDrainTheQueue) {
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool(3);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&] { done.fetch_add(1); });
+        }
+        pool.wait_idle();
+        EXPECT_EQ(done.load(), 100);
+
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&] { done.fetch_add(1); });
+        }
+    }
+    EXPECT_EQ(done.load(), 200);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "data_reciever.hpp"
+#include "feature_set.hpp"
+#include "spsc_queue.hpp"
+
+namespace microregime {
+
+// Counters of an AsyncReciever. `stalled` rows found the queue full and made
+// the pipeline wait (Block); `dropped` rows found it full and were discarded (Drop).
+struct AsyncRecieverStats {
+    uint64_t queued = 0;
+    uint64_t delivered = 0;
+    uint64_t stalled = 0;
+    uint64_t dropped = 0;
+};
+
+// Puts a writer thread between the pipeline and a slow DataReciever. Each
+// snapshot (with its normalization variants and components) is copied into a
+// fixed-size slot of a bounded lock-free SpscQueue, so queueing never
+// allocates; the writer thread drains it in batches and calls the wrapped
+// reciever, which is only ever touched from that thread.
+//
+// A row is queued when the next one arrives (its variants come right after
+// it), so call finish() or destroy the adapter before the wrapped reciever.
+class AsyncReciever : public DataReciever {
+public:
+    enum class Overflow { Block, Drop };
+
+    static constexpr size_t kDefaultCapacity = 4096;
+    static constexpr size_t kBatchRows = 256;
+    // Normalization horizons a row has room for; more are rejected
+    static constexpr size_t kMaxHorizons = 8;
+
+    explicit AsyncReciever(DataReciever& inner, size_t capacity = kDefaultCapacity,
+                           Overflow overflow = Overflow::Block);
+    ~AsyncReciever() override;
+
+    AsyncReciever(const AsyncReciever&) = delete;
+    AsyncReciever& operator=(const AsyncReciever&) = delete;
+
+    void ingest_feature_set(const std::string& symbol, uint64_t timestamp_ns,
+                            const FeatureSet& raw_features, const FeatureSet& normalized) override;
+
+    void ingest_normalization_variants(const std::string& symbol, uint64_t timestamp_ns,
+                                       std::span<const NormalizationHorizon> horizons,
+                                       std::span<const FeatureSet> normalized) override;
+
+    void ingest_components(const std::string& symbol, uint64_t timestamp_ns,
+                           std::span<const double> components) override;
+
+    // Deliver everything queued and stop the writer thread. Rethrows a failure
+    // of the wrapped reciever; later rows are rejected.
+    void finish();
+
+    // Pipeline thread, or after finish()
+    AsyncRecieverStats stats() const;
+    size_t capacity() const { return queue_.capacity(); }
+
+private:
+    struct Row {
+        SymbolId symbol = 0;
+        uint64_t timestamp_ns = 0;
+        uint32_t variant_count = 0;    // 0 with a single horizon
+        uint32_t component_count = 0;  // 0 without a PcaReciever
+        FeatureSet raw;
+        FeatureSet normalized;
+        std::array<FeatureSet, kMaxHorizons> variants;
+        std::array<double, kFeatureCount> components;  // At most one per feature
+    };
+
+    DataReciever& inner_;
+    Overflow overflow_;
+    SpscQueue<Row> queue_;
+
+    // Pipeline thread
+    Row pending_;
+    bool has_pending_ = false;
+    bool finished_ = false;
+    std::vector<NormalizationHorizon> horizons_;  // Written before the first row with variants is queued
+    std::string last_symbol_;                      // Last name interned, and its id
+    SymbolId last_id_ = 0;
+    uint64_t queued_ = 0;
+    uint64_t stalled_ = 0;
+    uint64_t dropped_ = 0;
+
+    // Writer thread
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;  // Set before failed_
+    std::thread writer_;
+
+    SymbolId symbol_id(const std::string& symbol);
+    void publish();
+    void drain();
+    void rethrow_failure();
+};
+
+} // namespace microregime
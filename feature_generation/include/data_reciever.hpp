@@ -1,6 +1,8 @@
 #pragma once
 
+#include <span>
 #include "feature_set.hpp"
+#include "feature_normalizer.hpp"
 
 namespace microregime {
 
@@ -12,6 +14,25 @@ public:
         const FeatureSet& raw_features,
         const FeatureSet& normalized
     ) = 0;
+
+    // Called right after ingest_feature_set when the pipeline normalizes over
+    // more than one horizon: one set per horizon, in configuration order (the
+    // first is the `normalized` already passed). Ignored by default.
+    virtual void ingest_normalization_variants(
+        const std::string& /*symbol*/,
+        uint64_t /*timestamp_ns*/,
+        std::span<const NormalizationHorizon> /*horizons*/,
+        std::span<const FeatureSet> /*normalized*/
+    ) {}
+
+    // Called right after ingest_feature_set, before any variants, when a
+    // PcaReciever projects the snapshot onto principal components. Ignored by default.
+    virtual void ingest_components(
+        const std::string& /*symbol*/,
+        uint64_t /*timestamp_ns*/,
+        std::span<const double> /*components*/
+    ) {}
+
     virtual ~DataReciever() = default;
 };
 
@@ -9,44 +9,99 @@
 #include "order_engine.hpp"
 #include "order_book.hpp"
 #include "data_reciever.hpp"
+#include "pipeline_config.hpp"
 #include "common_constants.hpp"
 
+#include <deque>
+#include <filesystem>
+#include <span>
 #include <string>
 #include <functional>
+#include <vector>
 
 namespace microregime {
 
+// Where one configuration's snapshots are delivered
+struct PipelineOutput {
+    DataReciever* base;
+    DataReciever* future;
+};
+
 class DualFeaturePipeline {
 public:
+    // Each of `configs` gets its own FeatureEngine and FeatureProcessor per
+    // instrument, all fed from one replay of the day's books. A config's first
+    // horizon is delivered through ingest_feature_set, all of them through
+    // ingest_normalization_variants when it has more than one.
     DualFeaturePipeline(const std::string& timestamp = "YYYYMMDD",
                       const std::string& base_asset = "SPY",
-                      const std::string& future = "ES");
+                      const std::string& future = "ES",
+                      std::vector<PipelineConfig> configs = {PipelineConfig{}});
 
     ~DualFeaturePipeline();
 
-    void run(uint64_t snapshot_interval_ns = SNAPSHOT_INTERVAL_NS,
-             DataReciever& base_data_reciever = *(DataReciever*)nullptr,
-             DataReciever& future_data_reciever = *(DataReciever*)nullptr);
+    // `outputs` holds one entry per config, in the same order
+    void run(std::span<const PipelineOutput> outputs);
+
+    // Same output as run(), pipelined: each instrument decodes and updates its
+    // book on its own thread, and both feature sets are computed concurrently
+    // at every snapshot. The calling thread merges and delivers in run() order.
+    void run_pipelined(std::span<const PipelineOutput> outputs);
+
+    // Single-config pipelines
+    void run(DataReciever& base_data_reciever, DataReciever& future_data_reciever);
+    void run_pipelined(DataReciever& base_data_reciever, DataReciever& future_data_reciever);
+
+    const std::vector<PipelineConfig>& configs() const { return configs_; }
+
+    // Data file replayed for one instrument-day: the event cache if built,
+    // else a decompressed .dbn, else the original .dbn.zst
+    static std::filesystem::path input_path(const std::string& instrument, bool is_base,
+                                            const std::string& timestamp);
 
 private:
     std::string timestamp_;
     std::string base_asset_;
     std::string future_;
+    SymbolId base_symbol_;
+    SymbolId future_symbol_;
     uint64_t getNYSEStartTime(const std::string& date_str);
     uint64_t getNYSEEndTime(const std::string& date_str);
 
-    OrderEngine order_engine_;
+    // One engine per instrument so each book can be driven from its own thread
+    OrderEngine order_engine_base_;
+    OrderEngine order_engine_future_;
 
     EventParser parser_base_;
     EventParser parser_future_;
 
-    FeatureEngine feature_engine_base_;
-    FeatureEngine feature_engine_future_;
+    std::vector<PipelineConfig> configs_;
 
-    FeatureProcessor feature_processor_base_;
-    FeatureProcessor feature_processor_future_;
+    // One of each per config, in configs_ order (deques: engines can't move)
+    std::deque<FeatureEngine> feature_engines_base_;
+    std::deque<FeatureEngine> feature_engines_future_;
+    std::deque<FeatureProcessor> feature_processors_base_;
+    std::deque<FeatureProcessor> feature_processors_future_;
+
+    // The same engines, as OrderEngine::process_event notifies them
+    std::vector<FeatureEngine*> engine_list_base_;
+    std::vector<FeatureEngine*> engine_list_future_;
 
     EventParser construct_parser(const std::string& instrument, const std::string& timestamp);
+
+    // One line per config, instrument and horizon naming the features whose variance was degenerate
+    void report_degenerate_variance() const;
+
+    // The merge / 50ms sampling / snapshot control flow shared by run() and
+    // run_pipelined(); the Stepper supplies events and carries out each step.
+    // Every config keeps its own snapshot schedule over the one merged stream.
+    template <typename Stepper>
+    void drive(Stepper& stepper);
+
+    void check_outputs(std::span<const PipelineOutput> outputs) const;
+
+    struct SequentialStepper;
+    struct PipelinedStepper;
 };
 
 } // namespace microregime
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "data_reciever.hpp"
+#include "feature_set.hpp"
+#include "mapped_file.hpp"
+#include "pipeline_config.hpp"
+
+// Binary, columnar feature output: one file per instrument-day and config
+// holding the raw features and every normalization, readable in place with
+// mmap (FeatureFileReader here, regime_classifier/python/feature_file.py).
+//
+// Layout, all integers little-endian:
+//   Header                      fixed, see below
+//   metadata                    UTF-8 "key=value\n" lines at metadata_offset:
+//                                 instrument, date, config (PipelineConfig::label),
+//                                 groups (raw then one per horizon label),
+//                                 features (registry order)
+//   column 0                    timestamp_ns, uint64
+//   column 1 + g * F + f        feature f of group g, float64 (F = feature count)
+// Column c starts at data_offset + c * column_stride; data_offset and
+// column_stride are multiples of 64, so the data region is one
+// column_count x (column_stride / 8) array of 8-byte values. The stride can
+// hold more than row_count values; whatever follows a column's rows is padding.
+namespace feature_file {
+
+constexpr char kMagic[8] = {'M', 'R', 'F', 'E', 'A', 'T', 'S', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kColumnAlignment = 64;
+constexpr const char* kExtension = ".features";
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t column_count;
+    uint64_t row_count;
+    uint64_t metadata_offset;
+    uint64_t metadata_bytes;
+    uint64_t data_offset;
+    uint64_t column_stride;  // Bytes between consecutive columns
+};
+
+// Name of the group holding the raw features
+constexpr std::string_view kRawGroup = "raw";
+
+} // namespace feature_file
+
+namespace microregime {
+
+// DataReciever that writes a feature file. Rows fill a column-major block on
+// the pipeline thread; full blocks go to a writer thread that writes each
+// column straight to its place in the file, so the pipeline never waits on
+// disk unless the writer falls more than two blocks behind. Columns are sized
+// up front for a regular session of snapshots; a longer day doubles them,
+// moving the rows written so far on the writer thread. finish() only adds the
+// last partial block and the header, then renames the file into place.
+class FeatureFileWriter : public DataReciever {
+public:
+    static constexpr size_t kDefaultBlockRows = 8192;
+
+    FeatureFileWriter(const std::string& filepath, const std::string& instrument, const std::string& date,
+                      const PipelineConfig& config, size_t block_rows = kDefaultBlockRows);
+    ~FeatureFileWriter() override;
+
+    FeatureFileWriter(const FeatureFileWriter&) = delete;
+    FeatureFileWriter& operator=(const FeatureFileWriter&) = delete;
+
+    void ingest_feature_set(const std::string& symbol, uint64_t timestamp_ns,
+                            const FeatureSet& raw_features, const FeatureSet& normalized) override;
+
+    // Fills the extra horizons' columns of the row just ingested
+    void ingest_normalization_variants(const std::string& symbol, uint64_t timestamp_ns,
+                                       std::span<const NormalizationHorizon> horizons,
+                                       std::span<const FeatureSet> normalized) override;
+
+    // Assemble the final file. Called by the destructor if not called
+    // explicitly. Rethrows a failure of the writer thread.
+    void finish();
+
+    size_t row_count() const { return row_count_; }
+
+private:
+    using Block = std::vector<double>;  // column_count_ columns of block_rows_ values
+
+    std::string filepath_;
+    std::string partial_path_;  // Written in place, renamed to filepath_ by finish()
+    std::string metadata_;
+    size_t groups_;
+    size_t column_count_;
+    size_t block_rows_;
+    size_t row_count_ = 0;
+    bool finished_ = false;
+
+    Block current_;
+    size_t current_rows_ = 0;
+
+    // Owned by the writer thread until it stops
+    std::fstream out_;
+    size_t data_offset_;
+    size_t capacity_rows_;   // Rows each column has room for
+    size_t column_stride_;
+    size_t written_rows_ = 0;
+
+    // Pipeline thread -> writer thread
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<Block> full_;
+    std::vector<Block> free_;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+    std::thread writer_;
+
+    void write_group(size_t group, const FeatureSet& features);
+    void hand_off();
+    void write_blocks();
+    void write_block(const Block& block, size_t rows);
+    void reserve(size_t rows);
+    void stop_writer();
+    void write_header();
+};
+
+// Read-only view of a feature file. Columns are spans into the mapping.
+class FeatureFileReader {
+public:
+    explicit FeatureFileReader(const std::string& filepath);
+
+    size_t row_count() const { return row_count_; }
+    const std::string& instrument() const { return instrument_; }
+    const std::string& date() const { return date_; }
+    const std::string& config() const { return config_; }
+
+    // "raw" then one per horizon label, in config order
+    const std::vector<std::string>& groups() const { return groups_; }
+
+    std::span<const uint64_t> timestamps() const;
+    std::span<const double> column(size_t group, Feature feature) const;
+    std::span<const double> column(const std::string& group, Feature feature) const;
+
+    // Row `row` of a group as a FeatureSet (instrument left unset)
+    FeatureSet row(size_t group, size_t row) const;
+
+private:
+    MappedFile file_;
+    size_t row_count_ = 0;
+    size_t column_count_ = 0;
+    const std::byte* data_ = nullptr;
+    size_t column_stride_ = 0;
+    std::string instrument_;
+    std::string date_;
+    std::string config_;
+    std::vector<std::string> groups_;
+
+    const std::byte* column_bytes(size_t column) const { return data_ + column * column_stride_; }
+};
+
+} // namespace microregime
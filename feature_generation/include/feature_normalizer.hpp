@@ -1,39 +1,95 @@
 #pragma once
 
 #include "feature_set.hpp"
-#include <deque>
-#include <utility>
+#include "ring_buffer.hpp"
+#include <array>
+#include <cstdint>
+#include <span>
 #include <string>
-#include <unordered_map>
+#include <vector>
 #include "common_constants.hpp"
 
 namespace microregime {
+
+// One normalization variant: a z-score against the last `length` snapshots,
+// or against an exponentially weighted mean / variance with a half-life of
+// `half_life` snapshots.
+struct NormalizationHorizon {
+    enum class Kind { Window, Ewm };
+
+    Kind kind = Kind::Window;
+    size_t length = WINDOW_SIZE;
+    double half_life = 0.0;
+
+    static NormalizationHorizon window(size_t length) { return {Kind::Window, length, 0.0}; }
+    static NormalizationHorizon ewm(double half_life) { return {Kind::Ewm, 0, half_life}; }
+
+    // "w30000" / "ewm600"; parse() also accepts a bare window length. Throws std::invalid_argument.
+    std::string label() const;
+    static NormalizationHorizon parse(const std::string& text);
+};
+
+// Rolling z-scores of every feature over one or more horizons, all updated in
+// a single pass per snapshot. The first horizon is the primary normalization.
+//
+// Window horizons share one ring buffer of rows. Their means and sums of
+// squared deviations are updated with Welford's sliding add / replace steps,
+// one array slot per feature, and rebuilt exactly from the window once per
+// window length of updates so they cannot drift over a day.
 class FeatureNormalizer {
 public:
-    FeatureNormalizer() = default;
+    // Rows kept for getOldMidprice at the default snapshot interval
+    static constexpr size_t kDefaultMinHistory = LOG_RETURN_LOOKBACK_NS / SNAPSHOT_INTERVAL_NS + 1;
+
+    // Defaults to the single WINDOW_SIZE window. At least `min_history` rows are
+    // kept for getOldMidprice even when every window is shorter.
+    explicit FeatureNormalizer(std::vector<NormalizationHorizon> horizons = {NormalizationHorizon::window(WINDOW_SIZE)},
+                               size_t min_history = kDefaultMinHistory);
     ~FeatureNormalizer() = default;
 
     void AddFeatureSet(const FeatureSet& feature_set);
-    FeatureSet NormalizeFeatureSet(const FeatureSet& feature_set);
+
+    // Primary horizon
+    FeatureSet NormalizeFeatureSet(const FeatureSet& feature_set) { return NormalizeFeatureSet(feature_set, 0); }
+    FeatureSet NormalizeFeatureSet(const FeatureSet& feature_set, size_t horizon);
+
+    // Every horizon, in configuration order; `out` must hold horizons().size() sets
+    void NormalizeAll(const FeatureSet& feature_set, std::span<FeatureSet> out);
+
+    const std::vector<NormalizationHorizon>& horizons() const { return horizons_; }
 
     double getOldMidprice(int index) {
         if (index >= window.size()) {
             return 0.0;
         }
-        return window[window.size() - index - 1].midprice;
+        return window[window.size() - index - 1][feature_index(Feature::midprice)];
+    }
+
+    // Normalizations where the feature's variance was not positive (z-score
+    // taken with a standard deviation of 1), per feature
+    const std::array<uint64_t, kFeatureCount>& degenerate_variance_counts(size_t horizon = 0) const {
+        return states_[horizon].degenerate_variance;
     }
 
 private:
-    std::deque<FeatureSet> window;
+    // Only the feature values of each FeatureSet are kept, in registry order
+    using Row = std::array<double, kFeatureCount>;
+
+    struct HorizonState {
+        Row mean{};
+        Row m2{};             // Window: sum of squared deviations; Ewm: variance
+        double alpha = 0.0;   // Ewm weight of the newest snapshot
+        size_t count = 0;     // Snapshots currently weighed
+        size_t updates_since_rebase = 0;
+        std::array<uint64_t, kFeatureCount> degenerate_variance{};
+    };
 
-    // valid keys:
-    // log_spread, price_impact, log_return, 
-    // ewm_volatility, realized_variance, directional_volatility, spread_volatility, 
-    // ofi, signed_volume_pressure, order_arrival_rate, cancel_rate, 
-    // market_depth, lob_slope, price_gap, 
-    // shannon_entropy, liquidity_stress
+    std::vector<NormalizationHorizon> horizons_;
+    std::vector<HorizonState> states_;
+    RingBuffer<Row> window;  // Longest window horizon (or min_history), newest last
 
-    std::unordered_map<std::string, double> feature_sums;
-    std::unordered_map<std::string, double> feature_sums_2;
+    void UpdateWindow(HorizonState& state, size_t length, const Row& row);
+    void UpdateEwm(HorizonState& state, const Row& row);
+    void Rebase(HorizonState& state, size_t length);
 };
 } // namespace microregime
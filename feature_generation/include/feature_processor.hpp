@@ -3,25 +3,49 @@
 #include "feature_set.hpp"
 #include "feature_snapshot.hpp"
 #include "feature_normalizer.hpp"
+#include "pipeline_config.hpp"
+#include <vector>
 
 namespace microregime {
 
 class FeatureProcessor {
 public:
-    FeatureProcessor() = default;
+    // Features for `config`: its depth, rolling window and snapshot interval, and
+    // normalized over its horizons, the first being the primary normalization
+    explicit FeatureProcessor(const PipelineConfig& config = {});
     ~FeatureProcessor() = default;
 
     FeatureSet GetRawFeatureSet(const FeatureInputSnapshot& snapshot);
     FeatureSet GetProcessedFeatureSet(const FeatureSet& raw_feature_set);
+
+    // One normalized set per horizon, in configuration order (resizes `out`)
+    void GetProcessedFeatureSets(const FeatureSet& raw_feature_set, std::vector<FeatureSet>& out);
+
+    const FeatureNormalizer& normalizer() const { return feature_normalizer_; }
 private:
     void ProcessPriceAndSpread(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set);
     void ProcessVolatility(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set);
-    void ProcessOrderFlow(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set);
-    void ProcessLiquidity(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set);
     void ProcessMicrostructureTransitions(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set);
-    void ProcessEngineeredFeatures(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set);
     double infer_pre_trade_midprice(const FeatureInputSnapshot& snap);
 
+    // The per-level loops, compiled once per depth so they unroll; the
+    // configured depth's instances are picked in the constructor
+    template <size_t Depth> void ProcessOrderFlow(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set);
+    template <size_t Depth> void ProcessLiquidity(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set);
+    template <size_t Depth> void ProcessEngineeredFeatures(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set);
+
+    using Step = void (FeatureProcessor::*)(const FeatureInputSnapshot&, FeatureSet&);
+    struct DepthSteps {
+        Step order_flow;
+        Step liquidity;
+        Step engineered;
+    };
+    static DepthSteps depth_steps(size_t depth);
+
+    DepthSteps depth_steps_;
+    size_t log_return_lag_;
+    double rolling_window_;
+
     struct Cache {
         // 1-step history
         double prev_liquidity = 0.0;
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "data_reciever.hpp"
+#include "feature_set.hpp"
+
+// Live feature feed in POSIX shared memory: one writer (the pipeline) and any
+// number of reader processes tailing it without syscalls.
+//
+// The segment is a Header followed by `capacity` Slots (a power of two).
+// Record n goes to slot n % capacity under a per-slot seqlock: the writer sets
+// the slot's sequence to 2n+1, writes the words, then sets it to 2n+2 and
+// bumps write_index to n+1. A reader wanting record n copies the slot only
+// while its sequence reads 2n+2 before and after the copy; a larger sequence
+// means the writer lapped the reader, which then skips to the oldest intact
+// record and counts what it missed. The writer never waits for readers.
+namespace feature_ring {
+
+constexpr char kMagic[8] = {'M', 'R', 'R', 'I', 'N', 'G', '0', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kSymbolBytes = 16;
+
+// Record words: timestamp_ns, symbol (NUL padded), raw features, normalized features
+constexpr size_t kSymbolWords = kSymbolBytes / sizeof(uint64_t);
+constexpr size_t kRawWord = 1 + kSymbolWords;
+constexpr size_t kNormalizedWord = kRawWord + microregime::kFeatureCount;
+constexpr size_t kRecordWords = kNormalizedWord + microregime::kFeatureCount;
+
+struct alignas(64) Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_words;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> write_index;  // Records published so far
+    std::atomic<uint32_t> closed;                   // Set once the writer is done
+};
+
+struct alignas(64) Slot {
+    std::atomic<uint64_t> sequence;  // 2n+1 while record n is written, 2n+2 once it is complete
+    uint64_t words[kRecordWords];    // Accessed only through std::atomic_ref
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "Shared-memory atomics must be lock-free to work across processes");
+
+} // namespace feature_ring
+
+namespace microregime {
+
+// One record as a reader sees it
+struct RingRecord {
+    uint64_t index = 0;  // Position in the writer's stream
+    uint64_t timestamp_ns = 0;
+    std::string symbol;
+    FeatureSet raw;         // instrument interned from `symbol` in the reading process
+    FeatureSet normalized;
+};
+
+// DataReciever publishing each snapshot's raw and primary normalized features
+// to a shared-memory ring named `name` (e.g. "/microregime_base_SPY"). An
+// existing segment of that name is replaced. The destructor marks the ring
+// closed and unlinks the name; attached readers keep their mapping.
+class FeatureRingWriter : public DataReciever {
+public:
+    static constexpr size_t kDefaultCapacity = 1 << 16;
+
+    explicit FeatureRingWriter(const std::string& name, size_t capacity = kDefaultCapacity);
+    ~FeatureRingWriter() override;
+
+    FeatureRingWriter(const FeatureRingWriter&) = delete;
+    FeatureRingWriter& operator=(const FeatureRingWriter&) = delete;
+
+    void ingest_feature_set(const std::string& symbol, uint64_t timestamp_ns,
+                            const FeatureSet& raw_features, const FeatureSet& normalized) override;
+
+    const std::string& name() const { return name_; }
+    uint64_t published() const { return next_; }
+
+private:
+    std::string name_;
+    void* mapping_ = nullptr;
+    size_t bytes_ = 0;
+    feature_ring::Header* header_ = nullptr;
+    feature_ring::Slot* slots_ = nullptr;
+    uint64_t mask_ = 0;
+    uint64_t next_ = 0;
+};
+
+// Tails a FeatureRingWriter's ring from another thread or process
+class FeatureRingReader {
+public:
+    enum class Start { Latest, Oldest };
+
+    explicit FeatureRingReader(const std::string& name, Start start = Start::Latest);
+    ~FeatureRingReader();
+
+    FeatureRingReader(const FeatureRingReader&) = delete;
+    FeatureRingReader& operator=(const FeatureRingReader&) = delete;
+
+    // Next record, or false if the writer hasn't published it yet. Never blocks.
+    bool try_read(RingRecord& out);
+
+    // True once the writer is done; records already published can still be read
+    bool closed() const;
+
+    uint64_t next_index() const { return next_; }
+    uint64_t missed() const { return missed_; }  // Records overwritten before this reader got to them
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    void* mapping_ = nullptr;
+    size_t bytes_ = 0;
+    const feature_ring::Header* header_ = nullptr;
+    const feature_ring::Slot* slots_ = nullptr;
+    uint64_t mask_ = 0;
+    uint64_t next_ = 0;
+    uint64_t missed_ = 0;
+    std::string last_symbol_;
+    SymbolId last_instrument_ = 0;
+
+    void skip_to_oldest();
+};
+
+} // namespace microregime
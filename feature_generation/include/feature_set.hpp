@@ -1,46 +1,84 @@
 #pragma once
 
-#include <unordered_map>
 #include <array>
 #include <cstddef>
-#include <string>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include "symbol_table.hpp"
 
 namespace microregime {
 
+// Feature registry: every feature, in output column order.
+// FeatureSet's members, the normalizer loops and the writers' columns are all
+// generated from this list, so a feature is added or removed here only.
+#define MICROREGIME_FEATURES(X)   \
+    /* --- Price & Spread */      \
+    X(midprice)                   \
+    X(log_spread)                 \
+    X(log_return)                 \
+    /* --- Volatility */          \
+    X(ewm_volatility)             \
+    X(realized_variance)          \
+    X(directional_volatility)     \
+    X(spread_volatility)          \
+    /* --- Order Flow */          \
+    X(ofi)                        \
+    X(signed_volume_pressure)     \
+    X(order_arrival_rate)         \
+    /* --- Liquidity */           \
+    X(depth_imbalance)            \
+    X(market_depth)               \
+    X(lob_slope)                  \
+    X(price_gap)                  \
+    /* --- Microstructure Transitions */ \
+    X(tick_direction_entropy)     \
+    X(reversal_rate)              \
+    X(aggressor_bias)             \
+    /* --- Engineered */          \
+    X(shannon_entropy)            \
+    X(liquidity_stress)
+
 struct FeatureSet {
     uint64_t timestamp_ns;
-    std::string instrument;
-
-    // --- Price & Spread
-    double midprice;
-    double log_spread;
-    double log_return;
-
-    // --- Volatility
-    double ewm_volatility;
-    double realized_variance;
-    double directional_volatility;
-    double spread_volatility;
-
-    // --- Order Flow
-    double ofi;
-    double signed_volume_pressure;
-    double order_arrival_rate;
-
-    // --- Liquidity
-    double depth_imbalance;
-    double market_depth;
-    double lob_slope;
-    double price_gap;
-
-    // --- Microstructure Transitions
-    double tick_direction_entropy;
-    double reversal_rate;
-    double aggressor_bias;
-
-    // --- Engineered
-    double shannon_entropy;
-    double liquidity_stress;
+    SymbolId instrument;
+
+#define MICROREGIME_FEATURE_MEMBER(name) double name;
+    MICROREGIME_FEATURES(MICROREGIME_FEATURE_MEMBER)
+#undef MICROREGIME_FEATURE_MEMBER
+};
+
+// Column index of each feature
+enum class Feature : size_t {
+#define MICROREGIME_FEATURE_ENUM(name) name,
+    MICROREGIME_FEATURES(MICROREGIME_FEATURE_ENUM)
+#undef MICROREGIME_FEATURE_ENUM
 };
 
-} // namespace microregime
\ No newline at end of file
+#define MICROREGIME_FEATURE_ONE(name) +1
+inline constexpr size_t kFeatureCount = 0 MICROREGIME_FEATURES(MICROREGIME_FEATURE_ONE);
+#undef MICROREGIME_FEATURE_ONE
+
+inline constexpr std::array<std::string_view, kFeatureCount> kFeatureNames{
+#define MICROREGIME_FEATURE_NAME(name) #name,
+    MICROREGIME_FEATURES(MICROREGIME_FEATURE_NAME)
+#undef MICROREGIME_FEATURE_NAME
+};
+
+inline constexpr std::array<double FeatureSet::*, kFeatureCount> kFeatureMembers{
+#define MICROREGIME_FEATURE_POINTER(name) &FeatureSet::name,
+    MICROREGIME_FEATURES(MICROREGIME_FEATURE_POINTER)
+#undef MICROREGIME_FEATURE_POINTER
+};
+
+constexpr size_t feature_index(Feature feature) { return static_cast<size_t>(feature); }
+
+// Feature for a registry name, if there is one
+constexpr std::optional<Feature> feature_from_name(std::string_view name) {
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        if (kFeatureNames[i] == name) return static_cast<Feature>(i);
+    }
+    return std::nullopt;
+}
+
+} // namespace microregime
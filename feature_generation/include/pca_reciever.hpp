@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "data_reciever.hpp"
+#include "streaming_pca.hpp"
+
+namespace microregime {
+
+// DataReciever stage between the pipeline and another reciever: passes every
+// snapshot through and either fits or projects. While the StreamingPca is
+// still fitting, its normalized features are folded in and no components are
+// emitted, since the basis moves as it learns. Once the basis is frozen
+// (loaded, or freeze()), each snapshot's projection goes to the wrapped
+// reciever's ingest_components, so every row of a stream shares one basis.
+// Snapshots with a non-finite feature are passed through without components.
+class PcaReciever : public DataReciever {
+public:
+    // Both must outlive the stage
+    PcaReciever(DataReciever& inner, StreamingPca& pca);
+
+    void ingest_feature_set(const std::string& symbol, uint64_t timestamp_ns,
+                            const FeatureSet& raw_features, const FeatureSet& normalized) override;
+
+    void ingest_normalization_variants(const std::string& symbol, uint64_t timestamp_ns,
+                                       std::span<const NormalizationHorizon> horizons,
+                                       std::span<const FeatureSet> normalized) override;
+
+    const StreamingPca& pca() const { return pca_; }
+    uint64_t projected() const { return projected_; }
+
+private:
+    DataReciever& inner_;
+    StreamingPca& pca_;
+    std::vector<double> components_;
+    uint64_t projected_ = 0;
+};
+
+} // namespace microregime
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common_constants.hpp"
+#include "feature_engine.hpp"
+#include "feature_normalizer.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace microregime {
+
+// Everything that shapes one set of features computed from a replayed day: the
+// snapshot schedule, the FeatureEngine windows, how many book levels the depth
+// features read and the normalization horizons. Defaults are the
+// common_constants.hpp values, so a default config gives the usual output.
+//
+// A DualFeaturePipeline takes several of these and computes all of them from a
+// single replay of the books.
+struct PipelineConfig {
+    uint64_t snapshot_interval_ns = SNAPSHOT_INTERVAL_NS;
+    FeatureWindows windows;
+    size_t depth_levels = DEPTH_LEVELS;  // 2..DEPTH_LEVELS, the levels the book keeps
+    std::vector<NormalizationHorizon> horizons{NormalizationHorizon::window(WINDOW_SIZE)};
+
+    // Snapshots back to the midprice log_return is taken against
+    size_t log_return_lag() const { return LOG_RETURN_LOOKBACK_NS / snapshot_interval_ns; }
+
+    // Throws std::invalid_argument naming the first bad field
+    void validate() const;
+
+    // "interval_ns=500000000,rolling=1500,midprice=1800,depth=10,horizons=w30000+ewm600";
+    // parse() reads any subset of those keys on top of `defaults` and validates the result
+    std::string label() const;
+    static PipelineConfig parse(const std::string& text, const PipelineConfig& defaults);
+    static PipelineConfig parse(const std::string& text);
+};
+
+} // namespace microregime
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "feature_set.hpp"
+
+namespace microregime {
+
+struct StreamingPcaOptions {
+    double retained_variance = 0.99;  // classifier.py's PCA_VAR
+    size_t components = 0;            // Fixed count instead, if non-zero
+    size_t refresh_interval = 4096;   // Observations between eigendecompositions
+    bool whiten = false;              // Scale each component to unit variance
+};
+
+// StandardScaler + PCA over normalized features, one snapshot at a time.
+//
+// update() folds a snapshot into a running mean and co-moment matrix
+// (Welford), so nothing but the D x D accumulator is kept. Every
+// refresh_interval observations the correlation matrix is eigendecomposed
+// with cyclic Jacobi rotations, and project() maps a snapshot onto the
+// leading components of that basis. The component count is fixed by the
+// first refresh, so a stream's width never changes. Accumulators of separate
+// days merge exactly (Chan et al.), giving one panel-wide basis.
+//
+// Text format (save/load), a fitted basis only:
+//   streaming_pca 1
+//   features D name_1 ... name_D
+//   observations N
+//   whiten 0|1
+//   components K
+//   mean D values, scale D values        (the standardization)
+//   eigenvalues D values, descending
+//   vectors K*D values, one component per row
+class StreamingPca {
+public:
+    // Over every feature, in registry order
+    explicit StreamingPca(StreamingPcaOptions options = {});
+    StreamingPca(std::vector<Feature> features, StreamingPcaOptions options = {});
+
+    // A saved basis, frozen. Throws std::runtime_error if it can't be read.
+    static StreamingPca load(const std::string& filepath);
+    void save(const std::string& filepath) const;
+
+    // Fold in one snapshot. Returns false (and counts it) if a value isn't
+    // finite. Throws std::logic_error once frozen.
+    bool update(const FeatureSet& features);
+    bool update(std::span<const double> x);
+
+    // Add another accumulator over the same features
+    void merge(const StreamingPca& other);
+
+    // Eigendecompose now. Throws std::logic_error with fewer than 2 observations.
+    void refresh();
+
+    // Keep the current basis; further updates throw
+    void freeze() { frozen_ = true; }
+
+    bool ready() const { return components_ > 0; }
+    bool frozen() const { return frozen_; }
+    size_t components() const { return components_; }
+    size_t dimensions() const { return features_.size(); }
+    const std::vector<Feature>& features() const { return features_; }
+    uint64_t observations() const { return count_; }
+    uint64_t skipped() const { return skipped_; }
+
+    // Of the current basis: every eigenvalue, descending; component k's loadings
+    std::span<const double> eigenvalues() const { return eigenvalues_; }
+    std::span<const double> component(size_t k) const { return {vectors_.data() + k * dimensions(), dimensions()}; }
+    double retained_variance() const;
+
+    // components() values into out. False if there is no basis yet or the
+    // snapshot has a non-finite value.
+    bool project(const FeatureSet& features, std::span<double> out) const;
+    bool project(std::span<const double> x, std::span<double> out) const;
+
+private:
+    std::vector<Feature> features_;
+    StreamingPcaOptions options_;
+    bool frozen_ = false;
+
+    // Accumulator
+    uint64_t count_ = 0;
+    uint64_t skipped_ = 0;
+    uint64_t since_refresh_ = 0;
+    std::vector<double> mean_;
+    std::vector<double> comoment_;  // Sum of (x - mean)(x - mean)^T, lower triangle
+
+    // Basis from the last refresh
+    size_t components_ = 0;
+    std::vector<double> basis_mean_;
+    std::vector<double> basis_scale_;
+    std::vector<double> eigenvalues_;
+    std::vector<double> vectors_;  // components_ x D
+};
+
+} // namespace microregime
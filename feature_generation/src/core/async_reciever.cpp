@@ -0,0 +1,165 @@
+#include "async_reciever.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include "symbol_table.hpp"
+
+namespace microregime {
+
+namespace {
+
+// Empty polls the writer thread yields through before it starts sleeping
+constexpr size_t kSpinPolls = 64;
+constexpr auto kIdleSleep = std::chrono::microseconds(50);
+
+} // namespace
+
+AsyncReciever::AsyncReciever(DataReciever& inner, size_t capacity, Overflow overflow)
+    : inner_{inner}, overflow_{overflow}, queue_{capacity} {
+    writer_ = std::thread([this] { drain(); });
+}
+
+AsyncReciever::~AsyncReciever() {
+    try {
+        finish();
+    } catch (...) {
+        // Destructors must not throw; call finish() to see the failure
+    }
+}
+
+void AsyncReciever::ingest_feature_set(const std::string& symbol, uint64_t timestamp_ns,
+                                       const FeatureSet& raw_features, const FeatureSet& normalized) {
+    if (finished_) {
+        throw std::logic_error("AsyncReciever already finished");
+    }
+    rethrow_failure();
+    if (has_pending_) {
+        publish();
+    }
+    pending_.symbol = symbol_id(symbol);
+    pending_.timestamp_ns = timestamp_ns;
+    pending_.raw = raw_features;
+    pending_.normalized = normalized;
+    pending_.variant_count = 0;
+    pending_.component_count = 0;
+    has_pending_ = true;
+}
+
+void AsyncReciever::ingest_normalization_variants(const std::string&, uint64_t,
+                                                  std::span<const NormalizationHorizon> horizons,
+                                                  std::span<const FeatureSet> normalized) {
+    if (!has_pending_) {
+        throw std::logic_error("Normalization variants without a feature set");
+    }
+    if (normalized.size() > kMaxHorizons) {
+        throw std::invalid_argument("AsyncReciever carries at most " + std::to_string(kMaxHorizons) +
+                                    " normalization horizons");
+    }
+    if (horizons_.empty()) {
+        horizons_.assign(horizons.begin(), horizons.end());
+    }
+    std::copy(normalized.begin(), normalized.end(), pending_.variants.begin());
+    pending_.variant_count = static_cast<uint32_t>(normalized.size());
+}
+
+void AsyncReciever::ingest_components(const std::string&, uint64_t, std::span<const double> components) {
+    if (!has_pending_) {
+        throw std::logic_error("Components without a feature set");
+    }
+    if (components.size() > kFeatureCount) {
+        throw std::invalid_argument("More principal components than features");
+    }
+    std::copy(components.begin(), components.end(), pending_.components.begin());
+    pending_.component_count = static_cast<uint32_t>(components.size());
+}
+
+// Interning takes a lock, and a reciever nearly always sees one instrument
+SymbolId AsyncReciever::symbol_id(const std::string& symbol) {
+    if (last_symbol_.empty() || symbol != last_symbol_) {
+        last_id_ = intern_symbol(symbol);
+        last_symbol_ = symbol;
+    }
+    return last_id_;
+}
+
+void AsyncReciever::publish() {
+    has_pending_ = false;
+    if (queue_.try_push(std::move(pending_))) {
+        ++queued_;
+        return;
+    }
+    if (overflow_ == Overflow::Drop) {
+        ++dropped_;
+        return;
+    }
+    // Back-pressure: the writer is a whole queue behind, so the pipeline waits
+    ++stalled_;
+    while (!queue_.try_push(std::move(pending_))) {
+        rethrow_failure();
+        std::this_thread::yield();
+    }
+    ++queued_;
+}
+
+void AsyncReciever::drain() {
+    try {
+        Row row;
+        size_t idle = 0;
+        for (;;) {
+            // Read before popping: once set, every row is already in the queue
+            bool stopping = stopping_.load(std::memory_order_acquire);
+            size_t batch = 0;
+            while (batch < kBatchRows && queue_.try_pop(row)) {
+                const std::string& symbol = symbol_name(row.symbol);
+                inner_.ingest_feature_set(symbol, row.timestamp_ns, row.raw, row.normalized);
+                if (row.component_count > 0) {
+                    inner_.ingest_components(symbol, row.timestamp_ns, {row.components.data(), row.component_count});
+                }
+                if (row.variant_count > 0) {
+                    inner_.ingest_normalization_variants(symbol, row.timestamp_ns, horizons_,
+                                                         {row.variants.data(), row.variant_count});
+                }
+                ++batch;
+            }
+            if (batch > 0) {
+                delivered_.fetch_add(batch, std::memory_order_relaxed);
+                idle = 0;
+                continue;
+            }
+            if (stopping) return;
+            if (++idle < kSpinPolls) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(kIdleSleep);
+            }
+        }
+    } catch (...) {
+        error_ = std::current_exception();
+        failed_.store(true, std::memory_order_release);
+    }
+}
+
+void AsyncReciever::rethrow_failure() {
+    if (failed_.load(std::memory_order_acquire)) {
+        std::rethrow_exception(error_);
+    }
+}
+
+void AsyncReciever::finish() {
+    if (finished_) return;
+    finished_ = true;
+    try {
+        if (has_pending_) publish();
+    } catch (...) {
+        // Only the writer's own failure, rethrown below
+    }
+    stopping_.store(true, std::memory_order_release);
+    if (writer_.joinable()) writer_.join();
+    rethrow_failure();
+}
+
+AsyncRecieverStats AsyncReciever::stats() const {
+    return {queued_, delivered_.load(std::memory_order_relaxed), stalled_, dropped_};
+}
+
+} // namespace microregime
@@ -5,17 +5,28 @@
 #include "feature_set.hpp"
 #include "feature_normalizer.hpp"
 #include "event_parser.hpp"
+#include "event_cache.hpp"
 #include "order_engine.hpp"
 #include "order_book.hpp"
 #include "data_reciever.hpp"
 #include "common_constants.hpp"
+#include "spsc_queue.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <stdexcept>
 #include <ctime>
 #include <sstream>
 #include <cstdlib>
-#include <iostream>
+#include <thread>
+#include <span>
+#include <utility>
+#include <vector>
 
 namespace fs = std::filesystem;
 
@@ -23,48 +34,448 @@ namespace microregime {
 
 DualFeaturePipeline::DualFeaturePipeline(const std::string& timestamp,
                                      const std::string& base_asset,
-                                     const std::string& future)
+                                     const std::string& future,
+                                     std::vector<PipelineConfig> configs)
     : timestamp_{timestamp},
       base_asset_{base_asset},
       future_{future},
-      order_engine_{},
+      base_symbol_{intern_symbol(base_asset)},
+      future_symbol_{intern_symbol(future)},
+      order_engine_base_{},
+      order_engine_future_{},
       parser_base_(construct_parser(base_asset_, timestamp_)),
       parser_future_(construct_parser(future_, timestamp_)),
-      feature_engine_base_{const_cast<OrderBookManager&>(order_engine_.get_or_create_order_book(base_asset_)), base_asset_},
-      feature_engine_future_{const_cast<OrderBookManager&>(order_engine_.get_or_create_order_book(future_)), future_},
-      feature_processor_base_{},
-      feature_processor_future_{} {}
+      configs_{std::move(configs)} {
+    if (configs_.empty()) {
+        throw std::invalid_argument("DualFeaturePipeline needs at least one config");
+    }
+    PriceLadderBook& base_book = order_engine_base_.get_or_create_order_book(base_symbol_);
+    PriceLadderBook& future_book = order_engine_future_.get_or_create_order_book(future_symbol_);
+    for (const PipelineConfig& config : configs_) {
+        config.validate();
+        feature_engines_base_.emplace_back(base_book, base_asset_, config.windows);
+        feature_engines_future_.emplace_back(future_book, future_, config.windows);
+        feature_processors_base_.emplace_back(config);
+        feature_processors_future_.emplace_back(config);
+        engine_list_base_.push_back(&feature_engines_base_.back());
+        engine_list_future_.push_back(&feature_engines_future_.back());
+    }
+}
 
 DualFeaturePipeline::~DualFeaturePipeline() = default;
 
-void DualFeaturePipeline::run(uint64_t snapshot_interval_ns,
-                            DataReciever& base_data_reciever,
-                            DataReciever& future_data_reciever) {
-    
-    if (snapshot_interval_ns != SNAPSHOT_INTERVAL_NS) {
-        std::cerr << "Snapshot interval " << snapshot_interval_ns << " is not equal to default " << SNAPSHOT_INTERVAL_NS << std::endl;
+namespace {
+
+// The two instruments a pipeline step can refer to
+enum Stream : size_t { Base, Future };
+
+// What the control loop needs to know about an instrument's next event
+struct EventHead {
+    uint64_t timestamp_ns = 0;
+    bool accepted = false;  // OrderEngine::accepts
+};
+
+// --- run_pipelined() plumbing ---
+
+// Events per timestamp block, and per apply watermark sent back to a lane
+constexpr size_t kLaneBlock = 1024;
+constexpr size_t kLaneTimestampBlocks = 64;
+constexpr size_t kLaneCommands = 1024;
+constexpr size_t kLaneResults = 64;
+
+// Timestamps of a run of a lane's events, in stream order
+struct TimestampBlock {
+    size_t count = 0;
+    bool end = false;  // No events follow this block
+    std::array<uint64_t, kLaneBlock> timestamp_ns;
+    std::array<bool, kLaneBlock> accepted;
+};
+
+// Merge thread -> lane: apply events up to `apply_through`, then act
+struct LaneCommand {
+    enum Kind : uint8_t { Apply, Sample, Snapshot, Finish };
+    Kind kind = Apply;
+    uint32_t config = 0;  // Snapshot: which config's features
+    uint64_t apply_through = 0;
+    uint64_t value = 0;  // Sample: repetitions; Snapshot: snapshot time
+};
+
+struct LaneResult {
+    uint64_t timestamp_ns = 0;
+    size_t config = 0;
+    FeatureSet raw{};
+    std::vector<FeatureSet> norms;  // One per normalization horizon
+};
+
+// Hand one instrument's snapshot to its receiver
+void deliver_snapshot(DataReciever& reciever, const std::string& symbol, uint64_t timestamp_ns,
+                      const FeatureSet& raw, std::span<const FeatureSet> norms,
+                      const FeatureProcessor& processor) {
+    reciever.ingest_feature_set(symbol, timestamp_ns, raw, norms[0]);
+    if (norms.size() > 1) {
+        reciever.ingest_normalization_variants(symbol, timestamp_ns, processor.normalizer().horizons(), norms);
+    }
+}
+
+// Unwinds a waiting thread once the other side of the pipeline has failed
+struct PipelineAborted {};
+
+// Idle rounds a pipeline thread yields through before it sleeps
+constexpr size_t kSpinRounds = 64;
+
+// Lets a pipeline thread with nothing to do sleep until another thread
+// changes something it waits on. Take a ticket before checking; a ring()
+// after that makes sleep(ticket) return at once, so no wake-up is lost.
+class Doorbell {
+public:
+    uint32_t ticket() const { return rings_.load(); }
+
+    // Yield for the first kSpinRounds idle rounds, then block until a ring
+    void idle(uint32_t ticket, size_t& rounds) const {
+        if (++rounds < kSpinRounds) {
+            std::this_thread::yield();
+        } else {
+            rings_.wait(ticket);
+        }
+    }
+
+    void ring() {
+        rings_.fetch_add(1);
+        rings_.notify_one();
+    }
+
+private:
+    std::atomic<uint32_t> rings_{0};
+};
+
+// One instrument's half of run_pipelined(). Decodes ahead and forwards event
+// timestamps to the merge thread, and applies events, samples midprices and
+// takes snapshots on its own book exactly where the merge thread's commands say.
+//
+// Each side rings the other's Doorbell after every push or pop, so a thread
+// that has run out of work can sleep instead of spinning.
+class Lane {
+public:
+    Lane(EventParser& parser, OrderEngine& engine, std::span<FeatureEngine* const> features,
+         std::deque<FeatureProcessor>& processors, SymbolId symbol, std::atomic<bool>& abort, Doorbell& merge_bell)
+        : parser_{parser}, engine_{engine}, features_{features},
+          processors_{processors}, symbol_{symbol}, abort_{abort}, merge_bell_{merge_bell} {}
+
+    // Thread body. A failure is kept in `error` and aborts the pipeline.
+    void run() {
+        try {
+            TimestampBlock block;
+            bool have_block = false;
+            bool forwarded_end = false;
+            for (size_t rounds = 0;;) {
+                const uint32_t ticket = bell.ticket();
+                LaneCommand command;
+                if (commands.try_pop(command)) {
+                    merge_bell_.ring();
+                    if (command.kind == LaneCommand::Finish) return;
+                    execute(command);
+                    rounds = 0;
+                    continue;
+                }
+                if (!forwarded_end) {
+                    if (!have_block) {
+                        decode(block);
+                        have_block = true;
+                    }
+                    bool end = block.end;
+                    if (timestamps.try_push(std::move(block))) {
+                        merge_bell_.ring();
+                        forwarded_end = end;
+                        have_block = false;
+                        rounds = 0;
+                        continue;
+                    }
+                }
+                wait(ticket, rounds);
+            }
+        } catch (const PipelineAborted&) {
+        } catch (...) {
+            error = std::current_exception();
+            abort_ = true;
+            merge_bell_.ring();
+        }
+    }
+
+    SpscQueue<TimestampBlock> timestamps{kLaneTimestampBlocks};  // Lane -> merge
+    SpscQueue<LaneCommand> commands{kLaneCommands};              // Merge -> lane
+    SpscQueue<LaneResult> results{kLaneResults};                 // Lane -> merge
+    Doorbell bell;                                               // Rung by the merge thread
+    std::exception_ptr error;
+
+private:
+    EventParser& parser_;
+    OrderEngine& engine_;
+    std::span<FeatureEngine* const> features_;  // One per config
+    std::deque<FeatureProcessor>& processors_;
+    SymbolId symbol_;
+    std::atomic<bool>& abort_;
+    Doorbell& merge_bell_;
+
+    std::deque<MarketEvent> pending_;  // Forwarded to the merge thread, not yet applied
+    uint64_t applied_ = 0;
+
+    void wait(uint32_t ticket, size_t& rounds) {
+        if (abort_) throw PipelineAborted{};
+        bell.idle(ticket, rounds);
+    }
+
+    void decode(TimestampBlock& block) {
+        block.count = 0;
+        block.end = false;
+        while (block.count < kLaneBlock) {
+            auto event = parser_.get_next_event();
+            if (!event) {
+                block.end = true;
+                break;
+            }
+            block.timestamp_ns[block.count] = event->timestamp_ns;
+            block.accepted[block.count] = engine_.accepts(*event);
+            ++block.count;
+            pending_.push_back(*event);
+        }
+    }
+
+    void execute(const LaneCommand& command) {
+        for (; applied_ < command.apply_through; ++applied_) {
+            engine_.process_event(pending_.front(), features_);
+            pending_.pop_front();
+        }
+        switch (command.kind) {
+            case LaneCommand::Sample: {
+                const PriceLadderBook& book = engine_.get_order_book(symbol_);
+                for (uint64_t i = 0; i < command.value; ++i) {
+                    for (FeatureEngine* features : features_) {
+                        features->UpdateMidpriceAndSpread(book.GetMidPrice(), book.GetSpread());
+                    }
+                }
+                break;
+            }
+            case LaneCommand::Snapshot: {
+                LaneResult result;
+                result.timestamp_ns = command.value;
+                result.config = command.config;
+                FeatureProcessor& processor = processors_[command.config];
+                FeatureInputSnapshot snapshot = features_[command.config]->generate_snapshot();
+                result.raw = processor.GetRawFeatureSet(snapshot);
+                processor.GetProcessedFeatureSets(result.raw, result.norms);
+                for (size_t rounds = 0;;) {
+                    const uint32_t ticket = bell.ticket();
+                    if (results.try_push(std::move(result))) break;
+                    wait(ticket, rounds);
+                }
+                merge_bell_.ring();
+                break;
+            }
+            default:
+                break;
+        }
+    }
+};
+
+} // namespace
+
+// Carries out run()'s steps directly on this thread
+struct DualFeaturePipeline::SequentialStepper {
+    DualFeaturePipeline& pipeline;
+    std::span<const PipelineOutput> outputs;
+    MarketEvent event[2]{};
+    std::vector<FeatureSet> norms;
+
+    bool next(Stream stream, EventHead& head) {
+        EventParser& parser = (stream == Base) ? pipeline.parser_base_ : pipeline.parser_future_;
+        auto next_event = parser.get_next_event();
+        if (!next_event) return false;
+        event[stream] = *next_event;
+        head = {next_event->timestamp_ns, engine(stream).accepts(*next_event)};
+        return true;
+    }
+
+    void process(Stream stream) {
+        engine(stream).process_event(event[stream], stream == Base ? pipeline.engine_list_base_
+                                                                   : pipeline.engine_list_future_);
+    }
+
+    void sample(uint64_t count) {
+        const PriceLadderBook& base_book = pipeline.order_engine_base_.get_order_book(pipeline.base_symbol_);
+        const PriceLadderBook& future_book = pipeline.order_engine_future_.get_order_book(pipeline.future_symbol_);
+        for (uint64_t i = 0; i < count; ++i) {
+            // Update midprice and spread at each 50ms interval
+            for (FeatureEngine* features : pipeline.engine_list_base_) {
+                features->UpdateMidpriceAndSpread(base_book.GetMidPrice(), base_book.GetSpread());
+            }
+            for (FeatureEngine* features : pipeline.engine_list_future_) {
+                features->UpdateMidpriceAndSpread(future_book.GetMidPrice(), future_book.GetSpread());
+            }
+        }
+    }
+
+    void snapshot(size_t config, uint64_t snapshot_time) {
+        // --- BASE asset snapshot ---
+        FeatureProcessor& base_processor = pipeline.feature_processors_base_[config];
+        FeatureInputSnapshot base_snapshot = pipeline.feature_engines_base_[config].generate_snapshot();
+        FeatureSet base_raw = base_processor.GetRawFeatureSet(base_snapshot);
+        base_processor.GetProcessedFeatureSets(base_raw, norms);
+        deliver_snapshot(*outputs[config].base, pipeline.base_asset_, snapshot_time, base_raw, norms, base_processor);
+
+        // --- FUTURE asset snapshot ---
+        FeatureProcessor& future_processor = pipeline.feature_processors_future_[config];
+        FeatureInputSnapshot future_snapshot = pipeline.feature_engines_future_[config].generate_snapshot();
+        FeatureSet fut_raw = future_processor.GetRawFeatureSet(future_snapshot);
+        future_processor.GetProcessedFeatureSets(fut_raw, norms);
+        deliver_snapshot(*outputs[config].future, pipeline.future_, snapshot_time, fut_raw, norms, future_processor);
+    }
+
+    OrderEngine& engine(Stream stream) {
+        return (stream == Base) ? pipeline.order_engine_base_ : pipeline.order_engine_future_;
+    }
+};
+
+// Runs the control loop on the merge thread over timestamps alone and turns each
+// step into lane commands. Results are handed to the receivers in snapshot order.
+struct DualFeaturePipeline::PipelinedStepper {
+    PipelinedStepper(DualFeaturePipeline& pipeline, Lane& base_lane, Lane& future_lane,
+                     std::span<const PipelineOutput> outputs, std::atomic<bool>& abort, Doorbell& bell)
+        : pipeline{pipeline}, lane{&base_lane, &future_lane}, outputs{outputs}, abort{abort}, bell{bell} {}
+
+    DualFeaturePipeline& pipeline;
+    Lane* lane[2];
+    std::span<const PipelineOutput> outputs;
+    std::atomic<bool>& abort;
+    Doorbell& bell;  // Rung by either lane
+
+    TimestampBlock block[2];
+    size_t block_pos[2] = {0, 0};
+    uint64_t merged[2] = {0, 0};  // Events the control loop has processed per lane
+
+    std::deque<LaneResult> ready[2];
+    uint64_t snapshots_issued = 0;
+    uint64_t snapshots_delivered = 0;
+
+    bool next(Stream stream, EventHead& head) {
+        TimestampBlock& current = block[stream];
+        while (block_pos[stream] == current.count) {
+            if (current.end) return false;
+            wait_until([&] { return lane[stream]->timestamps.try_pop(current); });
+            lane[stream]->bell.ring();
+            block_pos[stream] = 0;
+        }
+        head = {current.timestamp_ns[block_pos[stream]], current.accepted[block_pos[stream]]};
+        ++block_pos[stream];
+        return true;
+    }
+
+    void process(Stream stream) {
+        // Let the lane keep applying between samples so its backlog stays short
+        if (++merged[stream] % kLaneBlock == 0) {
+            send(stream, LaneCommand::Apply, 0);
+        }
+    }
+
+    void sample(uint64_t count) {
+        send(Base, LaneCommand::Sample, count);
+        send(Future, LaneCommand::Sample, count);
+    }
+
+    void snapshot(size_t config, uint64_t snapshot_time) {
+        send(Base, LaneCommand::Snapshot, snapshot_time, config);
+        send(Future, LaneCommand::Snapshot, snapshot_time, config);
+        ++snapshots_issued;
+        deliver();
+    }
+
+    // Stop both lanes where the control loop stopped and deliver what is left
+    void finish() {
+        send(Base, LaneCommand::Finish, 0);
+        send(Future, LaneCommand::Finish, 0);
+        wait_until([&] { return snapshots_delivered == snapshots_issued; });
+    }
+
+    void send(Stream stream, LaneCommand::Kind kind, uint64_t value, size_t config = 0) {
+        LaneCommand command{kind, static_cast<uint32_t>(config), merged[stream], value};
+        wait_until([&] { return lane[stream]->commands.try_push(command); });
+        lane[stream]->bell.ring();
+    }
+
+    // Hand over every snapshot both lanes have finished, base then future as in run()
+    void deliver() {
+        for (size_t s = 0; s < 2; ++s) {
+            LaneResult result;
+            bool popped = false;
+            while (lane[s]->results.try_pop(result)) {
+                ready[s].push_back(std::move(result));
+                popped = true;
+            }
+            if (popped) lane[s]->bell.ring();
+        }
+        while (!ready[Base].empty() && !ready[Future].empty()) {
+            const LaneResult& base = ready[Base].front();
+            const LaneResult& future = ready[Future].front();
+            // Both lanes take every config's snapshots in the same order
+            const PipelineOutput& output = outputs[base.config];
+            deliver_snapshot(*output.base, pipeline.base_asset_, base.timestamp_ns, base.raw, base.norms,
+                             pipeline.feature_processors_base_[base.config]);
+            deliver_snapshot(*output.future, pipeline.future_, future.timestamp_ns, future.raw, future.norms,
+                             pipeline.feature_processors_future_[future.config]);
+            ready[Base].pop_front();
+            ready[Future].pop_front();
+            ++snapshots_delivered;
+        }
+    }
+
+    // Keep delivering while waiting so a lane is never stuck on a full result queue
+    template <typename Ready>
+    void wait_until(Ready ready_now) {
+        for (size_t rounds = 0;;) {
+            const uint32_t ticket = bell.ticket();
+            deliver();
+            if (ready_now()) return;
+            if (abort) throw PipelineAborted{};
+            bell.idle(ticket, rounds);
+        }
     }
+};
 
+template <typename Stepper>
+void DualFeaturePipeline::drive(Stepper& stepper) {
     const uint64_t midprice_update_interval_ns = 50'000'000; // 50 ms
     uint64_t last_midprice_update_time = 0;
     
-    auto base_opt = parser_base_.get_next_event();
-    auto future_opt = parser_future_.get_next_event();
+    EventHead base_event;
+    EventHead future_event;
+    bool has_base = stepper.next(Base, base_event);
+    bool has_future = stepper.next(Future, future_event);
 
-    if (!base_opt || !future_opt) return;
-
-    MarketEvent base_event = *base_opt;
-    MarketEvent future_event = *future_opt;
+    if (!has_base || !has_future) return;
     
     uint64_t nyseStart = getNYSEStartTime(timestamp_);
     uint64_t nyseEnd = getNYSEEndTime(timestamp_);
-    uint64_t next_snapshot_time = nyseStart + 100'000'000'000; // 100 seconds after market open begin
+    // Per config; next_due is the earliest of them
+    std::vector<uint64_t> next_snapshot_time(configs_.size(), nyseStart + 100'000'000'000); // 100 seconds after market open begin
+    uint64_t next_due = next_snapshot_time.front();
     
-    std::cout << "NYSE Start Time: " << getNYSEStartTime(timestamp_) << std::endl;
-    std::cout << "NYSE End Time: " << getNYSEEndTime(timestamp_) << std::endl;
+    LogLine() << "NYSE Start Time: " << getNYSEStartTime(timestamp_);
+    LogLine() << "NYSE End Time: " << getNYSEEndTime(timestamp_);
     last_midprice_update_time = std::min(base_event.timestamp_ns, future_event.timestamp_ns);
 
-    while (base_opt && future_opt) {
+    // The books now live in separate engines, so the cross-instrument ordering
+    // check one shared OrderEngine used to make is done here on the merged stream
+    uint64_t last_accepted_time = 0;
+    auto process = [&](Stream stream, const EventHead& event) {
+        if (event.timestamp_ns < last_accepted_time) {
+            throw std::runtime_error("Out-of-order event detected");
+        }
+        if (event.accepted) {
+            last_accepted_time = event.timestamp_ns;
+        }
+        stepper.process(stream);
+    };
+
+    while (has_base && has_future) {
         uint64_t current_event_time = std::min(base_event.timestamp_ns, future_event.timestamp_ns);
         // Calculate how many 50ms intervals have passed since last update
         if (last_midprice_update_time > 0) {
@@ -72,70 +483,184 @@ void DualFeaturePipeline::run(uint64_t snapshot_interval_ns,
             uint64_t intervals_passed = time_since_last_update / midprice_update_interval_ns;
             
             if (intervals_passed > 0) {
+                uint64_t samples = 0;
                 for (uint64_t i = 1; i <= intervals_passed; ++i) {
                     uint64_t update_time = last_midprice_update_time + (i * midprice_update_interval_ns);
                     if (update_time > nyseEnd) break;
-                    
-                    // Update midprice and spread at each 50ms interval
-                    feature_engine_base_.UpdateMidpriceAndSpread(order_engine_.get_order_book(base_asset_).GetMidPrice(), 
-                                                                order_engine_.get_order_book(base_asset_).GetSpread());
-                    feature_engine_future_.UpdateMidpriceAndSpread(order_engine_.get_order_book(future_).GetMidPrice(), 
-                                                                order_engine_.get_order_book(future_).GetSpread());
+                    ++samples;
+                }
+                if (samples > 0) {
+                    stepper.sample(samples);
                 }
                 last_midprice_update_time += intervals_passed * midprice_update_interval_ns;
             }
         }
 
         if (base_event.timestamp_ns <= future_event.timestamp_ns) {
-            order_engine_.process_event(base_event, &feature_engine_base_);
-            base_opt = parser_base_.get_next_event();
-            if (!base_opt) break;
-            base_event = *base_opt;
+            process(Base, base_event);
+            has_base = stepper.next(Base, base_event);
+            if (!has_base) break;
         } else {
-            order_engine_.process_event(future_event, &feature_engine_future_);
-            future_opt = parser_future_.get_next_event();
-            if (!future_opt) break;
-            future_event = *future_opt;
+            process(Future, future_event);
+            has_future = stepper.next(Future, future_event);
+            if (!has_future) break;
         }
-        if (next_snapshot_time > nyseEnd) {
+        if (next_due > nyseEnd) {
             break;
         } 
-        if (base_event.timestamp_ns >= next_snapshot_time &&
-            future_event.timestamp_ns >= next_snapshot_time &&
-            next_snapshot_time > nyseStart) {
-            // --- BASE asset snapshot ---
-            FeatureInputSnapshot base_snapshot = feature_engine_base_.generate_snapshot();
-            FeatureSet base_raw = feature_processor_base_.GetRawFeatureSet(base_snapshot);
-            auto base_norm = feature_processor_base_.GetProcessedFeatureSet(base_raw);
-            base_data_reciever.ingest_feature_set(base_asset_, next_snapshot_time, base_raw, base_norm);
-
-            // --- FUTURE asset snapshot ---
-            FeatureInputSnapshot future_snapshot = feature_engine_future_.generate_snapshot();
-            FeatureSet fut_raw = feature_processor_future_.GetRawFeatureSet(future_snapshot);
-            auto fut_norm = feature_processor_future_.GetProcessedFeatureSet(fut_raw);
-            future_data_reciever.ingest_feature_set(future_, next_snapshot_time, fut_raw, fut_norm);
-
-            next_snapshot_time += snapshot_interval_ns;
-        }
-    }
-    if (base_opt) {
-        std::cout << "Base events left: " << base_opt->timestamp_ns << std::endl;
+        if (base_event.timestamp_ns >= next_due &&
+            future_event.timestamp_ns >= next_due &&
+            next_due > nyseStart) {
+            for (size_t c = 0; c < configs_.size(); ++c) {
+                uint64_t& next = next_snapshot_time[c];
+                if (next <= nyseEnd && base_event.timestamp_ns >= next && future_event.timestamp_ns >= next) {
+                    stepper.snapshot(c, next);
+                    next += configs_[c].snapshot_interval_ns;
+                }
+            }
+            next_due = *std::min_element(next_snapshot_time.begin(), next_snapshot_time.end());
+        }
+    }
+    if (has_base) {
+        LogLine() << "Base events left: " << base_event.timestamp_ns;
     } 
-    if (future_opt) {
-        std::cout << "Future events left: " << future_opt->timestamp_ns << std::endl;
+    if (has_future) {
+        LogLine() << "Future events left: " << future_event.timestamp_ns;
     }
 }
 
+void DualFeaturePipeline::check_outputs(std::span<const PipelineOutput> outputs) const {
+    if (outputs.size() != configs_.size()) {
+        throw std::invalid_argument("DualFeaturePipeline needs one output per config (" +
+                                    std::to_string(configs_.size()) + "), got " + std::to_string(outputs.size()));
+    }
+    for (const PipelineOutput& output : outputs) {
+        if (!output.base || !output.future) {
+            throw std::invalid_argument("DualFeaturePipeline output without a receiver");
+        }
+    }
+}
 
-EventParser DualFeaturePipeline::construct_parser(const std::string& instrument, const std::string& timestamp) {
-    std::string file = (instrument == base_asset_)
+void DualFeaturePipeline::run(DataReciever& base_data_reciever, DataReciever& future_data_reciever) {
+    PipelineOutput output{&base_data_reciever, &future_data_reciever};
+    run(std::span<const PipelineOutput>(&output, 1));
+}
+
+void DualFeaturePipeline::run_pipelined(DataReciever& base_data_reciever, DataReciever& future_data_reciever) {
+    PipelineOutput output{&base_data_reciever, &future_data_reciever};
+    run_pipelined(std::span<const PipelineOutput>(&output, 1));
+}
+
+void DualFeaturePipeline::run(std::span<const PipelineOutput> outputs) {
+    check_outputs(outputs);
+    SequentialStepper stepper{*this, outputs, {}, {}};
+    drive(stepper);
+    report_degenerate_variance();
+}
+
+void DualFeaturePipeline::run_pipelined(std::span<const PipelineOutput> outputs) {
+    check_outputs(outputs);
+    std::atomic<bool> abort{false};
+    Doorbell merge_bell;
+    Lane base_lane(parser_base_, order_engine_base_, engine_list_base_, feature_processors_base_, base_symbol_, abort,
+                   merge_bell);
+    Lane future_lane(parser_future_, order_engine_future_, engine_list_future_, feature_processors_future_,
+                     future_symbol_, abort, merge_bell);
+    PipelinedStepper stepper(*this, base_lane, future_lane, outputs, abort, merge_bell);
+
+    std::thread base_thread([&] { base_lane.run(); });
+    std::thread future_thread([&] { future_lane.run(); });
+
+    std::exception_ptr error;
+    try {
+        try {
+            drive(stepper);
+        } catch (const PipelineAborted&) {
+            throw;
+        } catch (...) {
+            // The control loop itself stopped (e.g. out-of-order data); deliver
+            // what it scheduled before rethrowing, as run() would have
+            error = std::current_exception();
+        }
+        stepper.finish();
+    } catch (const PipelineAborted&) {
+        // A lane failed; its error is reported below
+    } catch (...) {
+        error = std::current_exception();
+        abort = true;
+    }
+    // Wake a lane sleeping on a queue the merge thread will no longer touch
+    base_lane.bell.ring();
+    future_lane.bell.ring();
+    base_thread.join();
+    future_thread.join();
+
+    if (!error) {
+        error = base_lane.error ? base_lane.error : future_lane.error;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    report_degenerate_variance();
+}
+
+void DualFeaturePipeline::report_degenerate_variance() const {
+    for (size_t c = 0; c < configs_.size(); ++c) {
+        // Only name the config when there is more than one
+        std::string config = (configs_.size() > 1) ? " [" + configs_[c].label() + "]" : "";
+        for (const auto& [name, processor] : {std::pair{&base_asset_, &feature_processors_base_[c]},
+                                              std::pair{&future_, &feature_processors_future_[c]}}) {
+            const FeatureNormalizer& normalizer = processor->normalizer();
+            for (size_t h = 0; h < normalizer.horizons().size(); ++h) {
+                const auto& counts = normalizer.degenerate_variance_counts(h);
+                std::ostringstream line;
+                for (size_t i = 0; i < kFeatureCount; ++i) {
+                    if (counts[i] > 0) line << " " << kFeatureNames[i] << "=" << counts[i];
+                }
+                if (!line.str().empty()) {
+                    LogLine() << *name << config << " " << normalizer.horizons()[h].label()
+                              << " snapshots with non-positive variance (stddev set to 1.0):" << line.str();
+                }
+            }
+        }
+    }
+}
+
+
+fs::path DualFeaturePipeline::input_path(const std::string& instrument, bool is_base, const std::string& timestamp) {
+    std::string file = is_base
         ? "xnas-itch-" + timestamp + ".mbo.dbn.zst"
         : "glbx-mdp3-" + timestamp + ".mbo.dbn.zst";
-    fs::path path = fs::path("..") / ".." / "data" / instrument / file;
-    if (!fs::exists(path)) {
-        path = fs::path("..") / "data" / instrument / file;
+    // Prefer a pre-decoded event cache (build_event_cache), then a pre-decompressed
+    // copy (zstd -d) mapped directly; otherwise the compressed file
+    for (const fs::path& root : {fs::path("..") / ".." / "data", fs::path("..") / "data"}) {
+        fs::path path = root / instrument / file;
+        fs::path cache = event_cache::path_for(path.string());
+        if (fs::exists(cache)) {
+            return cache;
+        }
+        fs::path decompressed = fs::path(path).replace_extension();
+        if (fs::exists(decompressed)) {
+            return decompressed;
+        }
+        if (fs::exists(path)) {
+            return path;
+        }
+    }
+    // Missing; opening it reports the error
+    return fs::path("..") / "data" / instrument / file;
+}
+
+EventParser DualFeaturePipeline::construct_parser(const std::string& instrument, const std::string& timestamp) {
+    fs::path path = input_path(instrument, instrument == base_asset_, timestamp);
+    if (path.extension() == event_cache::kExtension) {
+        return EventParser(path.string(), instrument);
+    }
+    if (path.extension() == ".dbn") {
+        return EventParser(path.string(), instrument, DbnReadMode::Mapped);
     }
-    return EventParser(path.string(), instrument);
+    // Compressed input: decompress on a background thread
+    return EventParser(path.string(), instrument, DbnReadMode::Prefetch);
 }
 
 
@@ -1,85 +1,192 @@
 #include "feature_normalizer.hpp"
 #include "common_constants.hpp"
 #include "feature_set.hpp"
-#include <numeric>
-#include <iostream>
-#include <ctime>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
 
 namespace microregime {
 
-const std::vector<std::pair<std::string, double FeatureSet::*>> kFeatures = {
-    {"midprice", &FeatureSet::midprice},
-    {"log_spread", &FeatureSet::log_spread},
-    {"log_return", &FeatureSet::log_return},
-    {"ewm_volatility", &FeatureSet::ewm_volatility},
-    {"realized_variance", &FeatureSet::realized_variance},
-    {"directional_volatility", &FeatureSet::directional_volatility},
-    {"spread_volatility", &FeatureSet::spread_volatility},
-    {"ofi", &FeatureSet::ofi},
-    {"signed_volume_pressure", &FeatureSet::signed_volume_pressure},
-    {"order_arrival_rate", &FeatureSet::order_arrival_rate},
-    {"tick_direction_entropy", &FeatureSet::tick_direction_entropy},
-    {"depth_imbalance", &FeatureSet::depth_imbalance},
-    {"market_depth", &FeatureSet::market_depth},
-    {"lob_slope", &FeatureSet::lob_slope},
-    {"price_gap", &FeatureSet::price_gap},
-    {"shannon_entropy", &FeatureSet::shannon_entropy},
-    {"liquidity_stress", &FeatureSet::liquidity_stress},
-    {"reversal_rate", &FeatureSet::reversal_rate},
-    {"aggressor_bias", &FeatureSet::aggressor_bias}
-};
+std::string NormalizationHorizon::label() const {
+    if (kind == Kind::Window) {
+        return "w" + std::to_string(length);
+    }
+    std::ostringstream text;
+    text << "ewm" << half_life;
+    return text.str();
+}
 
-void FeatureNormalizer::AddFeatureSet(const FeatureSet& feature_set) {
-    auto update_sums = [&](const FeatureSet& fs, 
-                           std::unordered_map<std::string, double>& sum,
-                           std::unordered_map<std::string, double>& sum2,
-                           double sign = 1.0) {
-        for (const auto& [name, ptr] : kFeatures) {
-            double val = fs.*ptr;
-            sum[name] += sign * val;
-            sum2[name] += sign * val * val;
+NormalizationHorizon NormalizationHorizon::parse(const std::string& text) {
+    auto number = [&](size_t offset) -> double {
+        std::string digits = text.substr(offset);
+        size_t used = 0;
+        double value = 0.0;
+        try {
+            value = std::stod(digits, &used);
+        } catch (const std::exception&) {
+            used = 0;
         }
+        if (digits.empty() || used != digits.size() || !(value > 0.0)) {
+            throw std::invalid_argument("Bad normalization horizon '" + text + "', expected e.g. w30000 or ewm600");
+        }
+        return value;
     };
 
-    // --- Long window update ---
-    window.push_back(feature_set);
-    update_sums(feature_set, feature_sums, feature_sums_2);
+    if (text.rfind("ewm", 0) == 0) {
+        return ewm(number(3));
+    }
+    size_t offset = (text.rfind("w", 0) == 0) ? 1 : 0;
+    double length = number(offset);
+    if (length != std::floor(length)) {
+        throw std::invalid_argument("Bad normalization horizon '" + text + "', window length must be whole");
+    }
+    return window(static_cast<size_t>(length));
+}
+
+namespace {
 
-    if (window.size() > WINDOW_SIZE) {
-        update_sums(window.front(), feature_sums, feature_sums_2, -1.0);
-        window.pop_front();
+size_t history_length(const std::vector<NormalizationHorizon>& horizons, size_t min_history) {
+    if (horizons.empty()) {
+        throw std::invalid_argument("FeatureNormalizer needs at least one horizon");
+    }
+    size_t longest = min_history;
+    for (const auto& horizon : horizons) {
+        if (horizon.kind == NormalizationHorizon::Kind::Window) {
+            if (horizon.length == 0) throw std::invalid_argument("Normalization window length must be positive");
+            longest = std::max(longest, horizon.length);
+        } else if (!(horizon.half_life > 0.0)) {
+            throw std::invalid_argument("Normalization half-life must be positive");
+        }
     }
+    return longest;
 }
 
+} // namespace
 
-FeatureSet FeatureNormalizer::NormalizeFeatureSet(const FeatureSet& feature_set) {
-    FeatureSet normalized_feature_set;
+FeatureNormalizer::FeatureNormalizer(std::vector<NormalizationHorizon> horizons, size_t min_history)
+    : horizons_{std::move(horizons)},
+      states_(horizons_.size()),
+      window{history_length(horizons_, min_history)} {
+    for (size_t h = 0; h < horizons_.size(); ++h) {
+        if (horizons_[h].kind == NormalizationHorizon::Kind::Ewm) {
+            states_[h].alpha = 1.0 - std::exp2(-1.0 / horizons_[h].half_life);
+        }
+    }
+}
 
-    normalized_feature_set.timestamp_ns = feature_set.timestamp_ns;
-    normalized_feature_set.instrument = feature_set.instrument;
+void FeatureNormalizer::AddFeatureSet(const FeatureSet& feature_set) {
+    Row row;
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        row[i] = feature_set.*kFeatureMembers[i];
+    }
 
-    auto safe_zscore = [](double x, double sum, double sum2, size_t n, const std::string& field) {
-        double mean = sum / n;
-        double variance = (sum2 / n) - (mean * mean);
-        if (variance <= 0.0) {
-            std::cout << "Warning: Variance is non-positive. Setting to 1.0. Field: " << field << std::endl;
+    for (size_t h = 0; h < horizons_.size(); ++h) {
+        if (horizons_[h].kind == NormalizationHorizon::Kind::Window) {
+            UpdateWindow(states_[h], horizons_[h].length, row);
+        } else {
+            UpdateEwm(states_[h], row);
         }
-        double stddev = (variance > 0.0) ? std::sqrt(variance) : 1.0;
-        return (x - mean) / stddev;
-    };
+    }
+    window.push_back(row);  // Evicts the oldest row once full
+
+    for (size_t h = 0; h < horizons_.size(); ++h) {
+        if (horizons_[h].kind != NormalizationHorizon::Kind::Window) continue;
+        if (++states_[h].updates_since_rebase >= horizons_[h].length) {
+            Rebase(states_[h], horizons_[h].length);
+        }
+    }
+}
+
+void FeatureNormalizer::UpdateWindow(HorizonState& state, size_t length, const Row& row) {
+    if (window.size() >= length) {
+        // Slide: the row `length` back leaves as `row` enters, n stays `length`
+        const Row& oldest = window[window.size() - length];
+        const double inv_n = 1.0 / static_cast<double>(length);
+        for (size_t i = 0; i < kFeatureCount; ++i) {
+            double delta = row[i] - oldest[i];
+            double old_mean = state.mean[i];
+            state.mean[i] += delta * inv_n;
+            state.m2[i] += delta * (row[i] - state.mean[i] + oldest[i] - old_mean);
+        }
+        state.count = length;
+    } else {
+        const double inv_n = 1.0 / static_cast<double>(window.size() + 1);
+        for (size_t i = 0; i < kFeatureCount; ++i) {
+            double delta = row[i] - state.mean[i];
+            state.mean[i] += delta * inv_n;
+            state.m2[i] += delta * (row[i] - state.mean[i]);
+        }
+        state.count = window.size() + 1;
+    }
+}
+
+void FeatureNormalizer::UpdateEwm(HorizonState& state, const Row& row) {
+    if (state.count++ == 0) {
+        state.mean = row;
+        state.m2.fill(0.0);
+        return;
+    }
+    const double alpha = state.alpha;
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        double delta = row[i] - state.mean[i];
+        double increment = alpha * delta;
+        state.mean[i] += increment;
+        state.m2[i] = (1.0 - alpha) * (state.m2[i] + delta * increment);
+    }
+}
+
+void FeatureNormalizer::Rebase(HorizonState& state, size_t length) {
+    const size_t n = std::min(length, window.size());
+    const size_t first = window.size() - n;
+    const double inv_n = 1.0 / static_cast<double>(n);
+    state.mean.fill(0.0);
+    state.m2.fill(0.0);
+    for (size_t r = first; r < window.size(); ++r) {
+        for (size_t i = 0; i < kFeatureCount; ++i) state.mean[i] += window[r][i];
+    }
+    for (size_t i = 0; i < kFeatureCount; ++i) state.mean[i] *= inv_n;
+    for (size_t r = first; r < window.size(); ++r) {
+        for (size_t i = 0; i < kFeatureCount; ++i) {
+            double d = window[r][i] - state.mean[i];
+            state.m2[i] += d * d;
+        }
+    }
+    state.updates_since_rebase = 0;
+}
 
-    const size_t n = window.size();
+FeatureSet FeatureNormalizer::NormalizeFeatureSet(const FeatureSet& feature_set, size_t horizon) {
+    FeatureSet normalized_feature_set;
+
+    normalized_feature_set.timestamp_ns = feature_set.timestamp_ns;
+    normalized_feature_set.instrument = feature_set.instrument;
 
-    for (const auto& [name, member] : kFeatures) {
-        double x = feature_set.*member;
+    HorizonState& state = states_[horizon];
+    // Window m2 is a sum over `count` rows; Ewm m2 is already a variance
+    const double scale = (horizons_[horizon].kind == NormalizationHorizon::Kind::Window)
+        ? 1.0 / static_cast<double>(state.count)
+        : 1.0;
 
-        // Long window
-        double sum = feature_sums[name];
-        double sum2 = feature_sums_2[name];
-        normalized_feature_set.*member = safe_zscore(x, sum, sum2, n, name);
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        double x = feature_set.*kFeatureMembers[i];
+        double variance = std::max(0.0, state.m2[i]) * scale;
+        // Non-positive variance: counted, not logged, and normalized with stddev 1
+        state.degenerate_variance[i] += (variance <= 0.0);
+        double stddev = (variance > 0.0) ? std::sqrt(variance) : 1.0;
+        normalized_feature_set.*kFeatureMembers[i] = (x - state.mean[i]) / stddev;
     }
 
     return normalized_feature_set;
 }
 
-} // namespace microregime
\ No newline at end of file
+void FeatureNormalizer::NormalizeAll(const FeatureSet& feature_set, std::span<FeatureSet> out) {
+    if (out.size() != horizons_.size()) {
+        throw std::invalid_argument("NormalizeAll needs one output FeatureSet per horizon");
+    }
+    for (size_t h = 0; h < horizons_.size(); ++h) {
+        out[h] = NormalizeFeatureSet(feature_set, h);
+    }
+}
+
+} // namespace microregime
@@ -2,22 +2,46 @@
 #include "feature_set.hpp"
 #include "common_constants.hpp"
 #include "feature_snapshot.hpp"
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <numeric>
+#include <span>
+#include <stdexcept>
 #include <utility>
 
 namespace microregime {
 
+FeatureProcessor::FeatureProcessor(const PipelineConfig& config)
+    : depth_steps_{depth_steps(config.depth_levels)},
+      log_return_lag_{config.log_return_lag()},
+      rolling_window_{static_cast<double>(config.windows.rolling_events)},
+      feature_normalizer_(config.horizons, config.log_return_lag() + 1) {}
+
+FeatureProcessor::DepthSteps FeatureProcessor::depth_steps(size_t depth) {
+    static constexpr auto table = []<size_t... I>(std::index_sequence<I...>) {
+        return std::array<DepthSteps, sizeof...(I)>{DepthSteps{&FeatureProcessor::ProcessOrderFlow<I + 1>,
+                                                               &FeatureProcessor::ProcessLiquidity<I + 1>,
+                                                               &FeatureProcessor::ProcessEngineeredFeatures<I + 1>}...};
+    }(std::make_index_sequence<DEPTH_LEVELS>{});
+
+    // price_gap reads the second level
+    if (depth < 2 || depth > DEPTH_LEVELS) {
+        throw std::invalid_argument("FeatureProcessor depth must be between 2 and " + std::to_string(DEPTH_LEVELS));
+    }
+    return table[depth - 1];
+}
+
 FeatureSet FeatureProcessor::GetRawFeatureSet(const FeatureInputSnapshot& snapshot) {
     FeatureSet feature_set;
     feature_set.timestamp_ns = snapshot.timestamp_ns;
     feature_set.instrument = snapshot.instrument;
     ProcessPriceAndSpread(snapshot, feature_set);
     ProcessVolatility(snapshot, feature_set);
-    ProcessOrderFlow(snapshot, feature_set);
-    ProcessLiquidity(snapshot, feature_set);
+    (this->*depth_steps_.order_flow)(snapshot, feature_set);
+    (this->*depth_steps_.liquidity)(snapshot, feature_set);
     ProcessMicrostructureTransitions(snapshot, feature_set);
-    ProcessEngineeredFeatures(snapshot, feature_set);
+    (this->*depth_steps_.engineered)(snapshot, feature_set);
     
     feature_normalizer_.AddFeatureSet(feature_set);
     
@@ -28,13 +52,18 @@ FeatureSet FeatureProcessor::GetProcessedFeatureSet(const FeatureSet& raw_featur
     return feature_normalizer_.NormalizeFeatureSet(raw_feature_set);
 }
 
+void FeatureProcessor::GetProcessedFeatureSets(const FeatureSet& raw_feature_set, std::vector<FeatureSet>& out) {
+    out.resize(feature_normalizer_.horizons().size());
+    feature_normalizer_.NormalizeAll(raw_feature_set, out);
+}
+
 // Log Spread, Price Impact, Log Return: USES CACHE OBJECTS
 void FeatureProcessor::ProcessPriceAndSpread(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set) {
     feature_set.log_spread = std::log(snapshot.best_ask_price) - std::log(snapshot.best_bid_price);
     double midprice = (snapshot.best_ask_price + snapshot.best_bid_price) / 2;
     feature_set.midprice = midprice;
 
-    double old_midprice = feature_normalizer_.getOldMidprice(10'000'000'000 / SNAPSHOT_INTERVAL_NS);
+    double old_midprice = feature_normalizer_.getOldMidprice(log_return_lag_);
     if (old_midprice > 0.0) {
         feature_set.log_return = std::log(midprice) - std::log(old_midprice);
     } else {
@@ -46,68 +75,28 @@ void FeatureProcessor::ProcessPriceAndSpread(const FeatureInputSnapshot& snapsho
 
 // EWM Volatility, Realized Variance, Directional Volatility, Spread Volatility: NO CACHE OBJECTS
 void FeatureProcessor::ProcessVolatility(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set) {
-    const auto& midprices = *snapshot.rolling_midprices;
-    const auto& spreads = *snapshot.rolling_spreads;
+    // Maintained per 50ms sample by FeatureEngine; see rolling_stats.hpp for tolerance
+    const RollingLogReturns& returns = *snapshot.midprice_returns;
+    const RollingMoments& spreads = *snapshot.spread_moments;
 
     // Realized Variance
-    double realized_variance = 0.0;
-    int count = 0;
-    for (size_t i = 1; i < midprices.size(); ++i) {
-        if (midprices[i - 1] == 0.0 || midprices[i] == 0.0) continue;
-        double ret = std::log(midprices[i]) - std::log(midprices[i - 1]);
-        realized_variance += ret * ret;
-        count ++;
-    }
-    feature_set.realized_variance = (count > 0) ? realized_variance / count : 0.0;
-
-    // Exponential Weighted Volatility
-    constexpr double alpha = 2.0 / (ROLLING_WINDOW + 1); // typical smoothing factor formulae
-    double ewm_var = 0.0, ewm_mean = 0.0;
-    int ewm_count = 0;
-    for (size_t i = 1; i < midprices.size(); ++i) {
-        if (midprices[i - 1] == 0.0 || midprices[i] == 0.0) continue;
-        double ret = std::log(midprices[i]) - std::log(midprices[i - 1]);
-        if (ewm_count == 0) {
-            ewm_mean = ret;
-            ewm_var = ret * ret;
-        } else {
-            ewm_var = (1 - alpha) * ewm_var + alpha * (ret * ret);
-            ewm_mean = (1 - alpha) * ewm_mean + alpha * ret;
-        }
-        ewm_count ++;
-    }
-    feature_set.ewm_volatility = (ewm_count > 0) ? std::sqrt(ewm_var) : 0.0;
+    feature_set.realized_variance = returns.mean_square();
+
+    // Exponential Weighted Volatility (alpha = 2 / (rolling window + 1))
+    feature_set.ewm_volatility = std::sqrt(returns.ewm_square());
 
     // Directional Volatility
-    double up_var = 0.0, down_var = 0.0;
-    int up_count = 0, down_count = 0;
-    for (size_t i = 1; i < midprices.size(); ++i) {
-        if (midprices[i - 1] == 0.0 || midprices[i] == 0.0) continue;
-        double ret = std::log(midprices[i]) - std::log(midprices[i - 1]);
-        if (ret > 0) {
-            up_var += ret * ret;
-            up_count++;
-        } else {
-            down_var += ret * ret;
-            down_count++;
-        }
-    }
-    double avg_up_var = (up_count > 0) ? up_var / up_count : 0.0;
-    double avg_down_var = (down_count > 0) ? down_var / down_count : 0.0;
-    double diff = avg_up_var - avg_down_var;
+    double diff = returns.up_mean_square() - returns.down_mean_square();
     feature_set.directional_volatility = std::sqrt(std::abs(diff)) * ((diff >= 0) ? 1.0 : -1.0);
 
     // Spread Volatility
-    double mean_spread = std::accumulate(spreads.begin(), spreads.end(), 0.0) / ROLLING_WINDOW;
-    double spread_var = 0.0;
-    for (double s : spreads) {
-        spread_var += (s - mean_spread) * (s - mean_spread);
-    }
-    spread_var /= ROLLING_WINDOW;
+    double mean_spread = spreads.sum() / rolling_window_;
+    double spread_var = spreads.sum_sq_dev(mean_spread) / rolling_window_;
     feature_set.spread_volatility = std::sqrt(spread_var);
 }
 
 // Volume Weighted OFI, Signed Volume Pressure, Order Arrival Rate: USES CACHE OBJECTS
+template <size_t Depth>
 void FeatureProcessor::ProcessOrderFlow(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set) {
     // --- Improved Order Flow Imbalance (OFI) ---
     // Parameters
@@ -117,7 +106,7 @@ void FeatureProcessor::ProcessOrderFlow(const FeatureInputSnapshot& snapshot, Fe
 
     double raw_ofi = 0.0;
 
-    for (int i = 0; i < DEPTH_LEVELS; ++i) {
+    for (int i = 0; i < static_cast<int>(Depth); ++i) {
         double weight = std::exp(-i * DEPTH_DECAY);  // top level = 1.0, decays exponentially
         double bid_contrib = snapshot.bid_depth_change_direction[i] * snapshot.bid_sizes[i] * weight;
         double ask_contrib = snapshot.ask_depth_change_direction[i] * snapshot.ask_sizes[i] * weight;
@@ -154,6 +143,7 @@ void FeatureProcessor::ProcessOrderFlow(const FeatureInputSnapshot& snapshot, Fe
 
 
 // Market Depth, Depth Imbalance, LOB Slope, Price Gap: NO CACHE OBJECTS
+template <size_t Depth>
 void FeatureProcessor::ProcessLiquidity(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set) {
     double bid_depth = 0.0, ask_depth = 0.0;
     double bid_weighted = 0.0, ask_weighted = 0.0;
@@ -161,7 +151,7 @@ void FeatureProcessor::ProcessLiquidity(const FeatureInputSnapshot& snapshot, Fe
     double mid = (snapshot.best_ask_price + snapshot.best_bid_price) / 2;
     double log_mid = std::log(mid);
 
-    for (size_t i = 0; i < DEPTH_LEVELS; ++i) {
+    for (size_t i = 0; i < Depth; ++i) {
         if (snapshot.bid_prices[i] > 0) {
             double dist = std::abs(log_mid - std::log(snapshot.bid_prices[i]));
             bid_weighted += dist * snapshot.bid_sizes[i];
@@ -186,7 +176,7 @@ void FeatureProcessor::ProcessLiquidity(const FeatureInputSnapshot& snapshot, Fe
     double bid_log_weighted = 0.0, ask_log_weighted = 0.0;
     double bid_sum = 0.0, ask_sum = 0.0;
     
-    for (size_t i = 0; i < DEPTH_LEVELS; ++i) {
+    for (size_t i = 0; i < Depth; ++i) {
         if (snapshot.bid_prices[i] > 0) {
             double dist = std::abs(log_mid - std::log(snapshot.bid_prices[i]));
             bid_log_weighted += dist * snapshot.bid_sizes[i];
@@ -213,14 +203,10 @@ void FeatureProcessor::ProcessLiquidity(const FeatureInputSnapshot& snapshot, Fe
 
 // Tick Direction Entropy, Reversal Rate, Aggressor Bias: USES CACHE OBJECTS
 void FeatureProcessor::ProcessMicrostructureTransitions(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set) {
-    int up = 0, down = 0, zero = 0;
-    for (auto dir : *snapshot.rolling_tick_directions) {
-        if (dir > 0) ++up;
-        else if (dir < 0) ++down;
-        else ++zero;
-    }
-    double total = up + down + zero;
-    double p_up = up / total, p_down = down / total, p_zero = zero / total;
+    // Counts are maintained by FeatureEngine as directions enter and leave the window
+    const RollingDirections& ticks = *snapshot.rolling_tick_directions;
+    double total = ticks.size();
+    double p_up = ticks.up() / total, p_down = ticks.down() / total, p_zero = ticks.zero() / total;
 
     double tick_entropy = 0.0;
     if (p_up > 0) tick_entropy -= p_up * std::log2(p_up);
@@ -229,34 +215,22 @@ void FeatureProcessor::ProcessMicrostructureTransitions(const FeatureInputSnapsh
     feature_set.tick_direction_entropy = tick_entropy;
 
     // --- Reversal Rate ---
-    const auto& dirs = *snapshot.rolling_trade_directions;
-    int reversals = 0;
-    for (size_t i = 1; i < dirs.size(); ++i) {
-        if (dirs[i] != 0 && dirs[i] == -dirs[i - 1]) {
-            ++reversals;
-        }
-    }
-    feature_set.reversal_rate = (dirs.size() > 1) ? static_cast<double>(reversals) / dirs.size() : 0.0;
+    const RollingDirections& dirs = *snapshot.rolling_trade_directions;
+    feature_set.reversal_rate = (dirs.size() > 1) ? static_cast<double>(dirs.reversals()) / dirs.size() : 0.0;
 
     // --- Aggressor Bias ---
-    double sum = std::accumulate(
-        snapshot.rolling_trade_directions->begin(),
-        snapshot.rolling_trade_directions->end(), 0
-    );
-    double aggressor_bias = static_cast<double>(sum) / snapshot.rolling_trade_directions->size();
+    double aggressor_bias = static_cast<double>(dirs.sum()) / dirs.size();
     feature_set.aggressor_bias = aggressor_bias;
 }
 
 
 // Shannon Entropy, and Liquidity Stress
+template <size_t Depth>
 void FeatureProcessor::ProcessEngineeredFeatures(const FeatureInputSnapshot& snapshot, FeatureSet& feature_set) {
     // --- Shannon Entropy of Order Flow ---
-    int pos = 0, neg = 0;
-    for (auto dir : *snapshot.rolling_trade_directions) {
-        if (dir > 0) ++pos;
-        else if (dir < 0) ++neg;
-        // Ignore 0s entirely
-    }
+    // Zero directions are ignored entirely
+    int pos = static_cast<int>(snapshot.rolling_trade_directions->up());
+    int neg = static_cast<int>(snapshot.rolling_trade_directions->down());
 
     int total = pos + neg;
     double p_pos = total > 0 ? static_cast<double>(pos) / total : 0.0;
@@ -271,7 +245,7 @@ void FeatureProcessor::ProcessEngineeredFeatures(const FeatureInputSnapshot& sna
     // --- Liquidity Stress Index with Smoothing ---
 
     // === Parameters ===
-    constexpr int LEVELS_TO_USE = 5;
+    constexpr int LEVELS_TO_USE = static_cast<int>(std::min<size_t>(5, Depth));
     constexpr double MIN_QUOTE_SIZE = 5.0;
     constexpr double DISTANCE_DECAY = 10.0;
     constexpr double STRESS_SMOOTH_ALPHA = 0.1;  // smoothing factor (0.05–0.2 is reasonable)
@@ -319,8 +293,8 @@ void FeatureProcessor::ProcessEngineeredFeatures(const FeatureInputSnapshot& sna
 }
 
 double FeatureProcessor::infer_pre_trade_midprice(const FeatureInputSnapshot& snap) {
-    const auto& mids = *snap.rolling_midprices;
-    const auto& dirs = *snap.rolling_trade_directions;
+    std::span<const double> mids = snap.rolling_midprices;
+    std::span<const int8_t> dirs = snap.rolling_trade_directions->view();
 
     for (int i = static_cast<int>(dirs.size()) - 1; i > 0; --i) {
         if (dirs[i] != 0 && i - 1 < static_cast<int>(mids.size())) {
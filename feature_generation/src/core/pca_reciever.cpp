@@ -0,0 +1,27 @@
+#include "pca_reciever.hpp"
+
+namespace microregime {
+
+PcaReciever::PcaReciever(DataReciever& inner, StreamingPca& pca)
+    : inner_{inner}, pca_{pca}, components_(pca.dimensions()) {}
+
+void PcaReciever::ingest_feature_set(const std::string& symbol, uint64_t timestamp_ns,
+                                     const FeatureSet& raw_features, const FeatureSet& normalized) {
+    inner_.ingest_feature_set(symbol, timestamp_ns, raw_features, normalized);
+    if (!pca_.frozen()) {
+        pca_.update(normalized);
+        return;
+    }
+    if (pca_.project(normalized, components_)) {
+        ++projected_;
+        inner_.ingest_components(symbol, timestamp_ns, {components_.data(), pca_.components()});
+    }
+}
+
+void PcaReciever::ingest_normalization_variants(const std::string& symbol, uint64_t timestamp_ns,
+                                                std::span<const NormalizationHorizon> horizons,
+                                                std::span<const FeatureSet> normalized) {
+    inner_.ingest_normalization_variants(symbol, timestamp_ns, horizons, normalized);
+}
+
+} // namespace microregime
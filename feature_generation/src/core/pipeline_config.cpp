@@ -0,0 +1,86 @@
+#include "pipeline_config.hpp"
+#include <sstream>
+#include <stdexcept>
+
+namespace microregime {
+
+void PipelineConfig::validate() const {
+    if (snapshot_interval_ns == 0) {
+        throw std::invalid_argument("Pipeline config: snapshot interval must be positive");
+    }
+    if (windows.rolling_events == 0 || windows.midprice_samples == 0) {
+        throw std::invalid_argument("Pipeline config: rolling and midprice windows must be positive");
+    }
+    if (depth_levels < 2 || depth_levels > DEPTH_LEVELS) {
+        throw std::invalid_argument("Pipeline config: depth must be between 2 and " + std::to_string(DEPTH_LEVELS));
+    }
+    if (horizons.empty()) {
+        throw std::invalid_argument("Pipeline config: at least one normalization horizon is needed");
+    }
+}
+
+std::string PipelineConfig::label() const {
+    std::string text = "interval_ns=" + std::to_string(snapshot_interval_ns) +
+                       ",rolling=" + std::to_string(windows.rolling_events) +
+                       ",midprice=" + std::to_string(windows.midprice_samples) +
+                       ",depth=" + std::to_string(depth_levels) + ",horizons=";
+    for (size_t h = 0; h < horizons.size(); ++h) {
+        text += (h ? "+" : "") + horizons[h].label();
+    }
+    return text;
+}
+
+PipelineConfig PipelineConfig::parse(const std::string& text, const PipelineConfig& defaults) {
+    auto count = [&](const std::string& key, const std::string& value) -> uint64_t {
+        size_t used = 0;
+        uint64_t number = 0;
+        try {
+            number = std::stoull(value, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (value.empty() || used != value.size() || value[0] == '-') {
+            throw std::invalid_argument("Bad pipeline config value " + key + "=" + value + " in '" + text + "'");
+        }
+        return number;
+    };
+
+    PipelineConfig config = defaults;
+    std::stringstream fields(text);
+    std::string field;
+    while (std::getline(fields, field, ',')) {
+        size_t equals = field.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument("Bad pipeline config field '" + field + "', expected key=value");
+        }
+        std::string key = field.substr(0, equals);
+        std::string value = field.substr(equals + 1);
+        if (key == "interval_ns") {
+            config.snapshot_interval_ns = count(key, value);
+        } else if (key == "rolling") {
+            config.windows.rolling_events = count(key, value);
+        } else if (key == "midprice") {
+            config.windows.midprice_samples = count(key, value);
+        } else if (key == "depth") {
+            config.depth_levels = count(key, value);
+        } else if (key == "horizons") {
+            config.horizons.clear();
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, '+')) {
+                config.horizons.push_back(NormalizationHorizon::parse(item));
+            }
+        } else {
+            throw std::invalid_argument("Unknown pipeline config key '" + key +
+                                        "', expected interval_ns, rolling, midprice, depth or horizons");
+        }
+    }
+    config.validate();
+    return config;
+}
+
+PipelineConfig PipelineConfig::parse(const std::string& text) {
+    return parse(text, PipelineConfig{});
+}
+
+} // namespace microregime
@@ -0,0 +1,310 @@
+#include "streaming_pca.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <stdexcept>
+#include "text_parser.hpp"
+
+namespace microregime {
+
+namespace {
+
+constexpr size_t kMaxJacobiSweeps = 100;
+
+std::vector<Feature> every_feature() {
+    std::vector<Feature> features;
+    for (size_t i = 0; i < kFeatureCount; ++i) features.push_back(static_cast<Feature>(i));
+    return features;
+}
+
+// Eigendecompose the symmetric D x D matrix a (destroyed) by cyclic Jacobi
+// rotations. Eigenvector k ends up in column k of v.
+void jacobi_eigen(std::vector<double>& a, size_t D, std::vector<double>& values, std::vector<double>& v) {
+    v.assign(D * D, 0.0);
+    for (size_t i = 0; i < D; ++i) v[i * D + i] = 1.0;
+    double norm = 0.0;
+    for (double x : a) norm += x * x;
+
+    for (size_t sweep = 0; sweep < kMaxJacobiSweeps; ++sweep) {
+        double off = 0.0;
+        for (size_t p = 0; p < D; ++p) {
+            for (size_t q = p + 1; q < D; ++q) off += a[p * D + q] * a[p * D + q];
+        }
+        if (off <= 1e-30 * norm) break;
+
+        for (size_t p = 0; p < D; ++p) {
+            for (size_t q = p + 1; q < D; ++q) {
+                double apq = a[p * D + q];
+                if (apq == 0.0) continue;
+                // Rotation that zeroes a[p][q]: t = tan of its angle, the smaller root
+                double theta = (a[q * D + q] - a[p * D + p]) / (2.0 * apq);
+                double t = std::copysign(1.0, theta) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+                for (size_t k = 0; k < D; ++k) {
+                    double akp = a[k * D + p], akq = a[k * D + q];
+                    a[k * D + p] = c * akp - s * akq;
+                    a[k * D + q] = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < D; ++k) {
+                    double apk = a[p * D + k], aqk = a[q * D + k];
+                    a[p * D + k] = c * apk - s * aqk;
+                    a[q * D + k] = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < D; ++k) {
+                    double vkp = v[k * D + p], vkq = v[k * D + q];
+                    v[k * D + p] = c * vkp - s * vkq;
+                    v[k * D + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    values.resize(D);
+    for (size_t i = 0; i < D; ++i) values[i] = a[i * D + i];
+}
+
+} // namespace
+
+StreamingPca::StreamingPca(StreamingPcaOptions options) : StreamingPca(every_feature(), options) {}
+
+StreamingPca::StreamingPca(std::vector<Feature> features, StreamingPcaOptions options)
+    : features_{std::move(features)}, options_{options} {
+    const size_t D = features_.size();
+    if (D == 0) {
+        throw std::invalid_argument("StreamingPca needs at least one feature");
+    }
+    if (options_.components > D) {
+        throw std::invalid_argument("StreamingPca can't keep " + std::to_string(options_.components) +
+                                    " components of " + std::to_string(D) + " features");
+    }
+    if (options_.components == 0 && !(options_.retained_variance > 0.0 && options_.retained_variance <= 1.0)) {
+        throw std::invalid_argument("StreamingPca retained_variance must be in (0, 1]");
+    }
+    mean_.assign(D, 0.0);
+    comoment_.assign(D * D, 0.0);
+}
+
+bool StreamingPca::update(const FeatureSet& features) {
+    std::array<double, kFeatureCount> x;
+    for (size_t i = 0; i < dimensions(); ++i) x[i] = features.*kFeatureMembers[feature_index(features_[i])];
+    return update({x.data(), dimensions()});
+}
+
+bool StreamingPca::update(std::span<const double> x) {
+    if (frozen_) {
+        throw std::logic_error("StreamingPca is frozen");
+    }
+    const size_t D = dimensions();
+    for (size_t i = 0; i < D; ++i) {
+        if (!std::isfinite(x[i])) {
+            ++skipped_;
+            return false;
+        }
+    }
+
+    // Welford: C += (x - old mean)(x - new mean)^T
+    ++count_;
+    std::array<double, kFeatureCount> before, after;
+    const double n = static_cast<double>(count_);
+    for (size_t i = 0; i < D; ++i) {
+        before[i] = x[i] - mean_[i];
+        mean_[i] += before[i] / n;
+        after[i] = x[i] - mean_[i];
+    }
+    for (size_t i = 0; i < D; ++i) {
+        double* row = comoment_.data() + i * D;
+        for (size_t j = 0; j <= i; ++j) row[j] += before[i] * after[j];
+    }
+
+    if (++since_refresh_ >= options_.refresh_interval && count_ >= 2) {
+        refresh();
+    }
+    return true;
+}
+
+void StreamingPca::merge(const StreamingPca& other) {
+    if (frozen_) {
+        throw std::logic_error("StreamingPca is frozen");
+    }
+    if (other.features_ != features_) {
+        throw std::invalid_argument("Can't merge StreamingPcas over different features");
+    }
+    skipped_ += other.skipped_;
+    if (other.count_ == 0) return;
+    const size_t D = dimensions();
+    const double na = static_cast<double>(count_), nb = static_cast<double>(other.count_);
+    const double n = na + nb;
+    std::array<double, kFeatureCount> delta;
+    for (size_t i = 0; i < D; ++i) {
+        delta[i] = other.mean_[i] - mean_[i];
+        mean_[i] += delta[i] * nb / n;
+    }
+    for (size_t i = 0; i < D; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            comoment_[i * D + j] += other.comoment_[i * D + j] + delta[i] * delta[j] * na * nb / n;
+        }
+    }
+    count_ += other.count_;
+}
+
+void StreamingPca::refresh() {
+    if (count_ < 2) {
+        throw std::logic_error("StreamingPca needs 2 observations for a basis");
+    }
+    since_refresh_ = 0;
+    const size_t D = dimensions();
+    const double n = static_cast<double>(count_);
+
+    // Standardize as StandardScaler does: population deviation, 1 for a constant feature
+    basis_mean_ = mean_;
+    basis_scale_.resize(D);
+    for (size_t i = 0; i < D; ++i) {
+        double deviation = std::sqrt(comoment_[i * D + i] / n);
+        basis_scale_[i] = deviation > 0.0 ? deviation : 1.0;
+    }
+    std::vector<double> correlation(D * D);
+    for (size_t i = 0; i < D; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            double value = comoment_[i * D + j] / (n * basis_scale_[i] * basis_scale_[j]);
+            correlation[i * D + j] = value;
+            correlation[j * D + i] = value;
+        }
+    }
+
+    std::vector<double> values, v;
+    jacobi_eigen(correlation, D, values, v);
+    std::vector<size_t> order(D);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] > values[b]; });
+    eigenvalues_.resize(D);
+    for (size_t k = 0; k < D; ++k) eigenvalues_[k] = std::max(values[order[k]], 0.0);
+
+    // Width is set once: a fixed count, else the fewest components whose
+    // share of the variance exceeds the target (sklearn's rule)
+    if (components_ == 0) {
+        components_ = options_.components;
+        if (components_ == 0) {
+            double total = std::accumulate(eigenvalues_.begin(), eigenvalues_.end(), 0.0);
+            double kept = 0.0;
+            while (components_ < D && !(kept > options_.retained_variance * total)) {
+                kept += eigenvalues_[components_++];
+            }
+        }
+    }
+
+    // One component per row, signed so its largest loading is positive
+    vectors_.resize(components_ * D);
+    for (size_t k = 0; k < components_; ++k) {
+        double* row = vectors_.data() + k * D;
+        size_t largest = 0;
+        for (size_t i = 0; i < D; ++i) {
+            row[i] = v[i * D + order[k]];
+            if (std::abs(row[i]) > std::abs(row[largest])) largest = i;
+        }
+        if (row[largest] < 0.0) {
+            for (size_t i = 0; i < D; ++i) row[i] = -row[i];
+        }
+    }
+}
+
+double StreamingPca::retained_variance() const {
+    double total = std::accumulate(eigenvalues_.begin(), eigenvalues_.end(), 0.0);
+    double kept = std::accumulate(eigenvalues_.begin(), eigenvalues_.begin() + components_, 0.0);
+    return total > 0.0 ? kept / total : 0.0;
+}
+
+bool StreamingPca::project(const FeatureSet& features, std::span<double> out) const {
+    std::array<double, kFeatureCount> x;
+    for (size_t i = 0; i < dimensions(); ++i) x[i] = features.*kFeatureMembers[feature_index(features_[i])];
+    return project({x.data(), dimensions()}, out);
+}
+
+bool StreamingPca::project(std::span<const double> x, std::span<double> out) const {
+    if (!ready()) return false;
+    const size_t D = dimensions();
+    std::array<double, kFeatureCount> z;
+    for (size_t i = 0; i < D; ++i) {
+        if (!std::isfinite(x[i])) return false;
+        z[i] = (x[i] - basis_mean_[i]) / basis_scale_[i];
+    }
+    for (size_t k = 0; k < components_; ++k) {
+        const double* row = vectors_.data() + k * D;
+        double sum = 0.0;
+        for (size_t i = 0; i < D; ++i) sum += row[i] * z[i];
+        out[k] = (options_.whiten && eigenvalues_[k] > 0.0) ? sum / std::sqrt(eigenvalues_[k]) : sum;
+    }
+    return true;
+}
+
+void StreamingPca::save(const std::string& filepath) const {
+    if (!ready()) {
+        throw std::logic_error("StreamingPca has no basis to save");
+    }
+    std::ofstream out(filepath);
+    if (!out) {
+        throw std::runtime_error("Failed to create PCA basis: " + filepath);
+    }
+    out << std::setprecision(17);
+    auto write_values = [&](const char* keyword, std::span<const double> values) {
+        out << keyword;
+        for (size_t i = 0; i < values.size(); ++i) out << ((i % dimensions() == 0) ? "\n" : " ") << values[i];
+        out << "\n";
+    };
+    out << "streaming_pca 1\nfeatures " << dimensions();
+    for (Feature feature : features_) out << " " << kFeatureNames[feature_index(feature)];
+    out << "\nobservations " << count_ << "\nwhiten " << options_.whiten << "\ncomponents " << components_ << "\n";
+    write_values("mean", basis_mean_);
+    write_values("scale", basis_scale_);
+    write_values("eigenvalues", eigenvalues_);
+    write_values("vectors", vectors_);
+    if (!out) {
+        throw std::runtime_error("Failed to write PCA basis: " + filepath);
+    }
+}
+
+StreamingPca StreamingPca::load(const std::string& filepath) {
+    TextParser parser(filepath, "PCA basis");
+
+    size_t version = 0, D = 0, K = 0;
+    uint64_t observations = 0;
+    bool whiten = false;
+    parser.expect("streaming_pca");
+    if (!parser.read(version) || version != 1) throw parser.fail("unsupported version");
+    parser.expect("features");
+    if (!parser.read(D) || D == 0 || D > kFeatureCount) throw parser.fail("bad feature count");
+    std::vector<Feature> features;
+    for (size_t i = 0; i < D; ++i) {
+        std::string name;
+        if (!parser.read(name)) throw parser.fail("too few feature names");
+        auto feature = feature_from_name(name);
+        if (!feature) throw parser.fail("unknown feature '" + name + "'");
+        features.push_back(*feature);
+    }
+    parser.expect("observations");
+    if (!parser.read(observations)) throw parser.fail("bad observation count");
+    parser.expect("whiten");
+    if (!parser.read(whiten)) throw parser.fail("bad whiten flag");
+    parser.expect("components");
+    if (!parser.read(K) || K == 0 || K > D) throw parser.fail("bad component count");
+
+    StreamingPcaOptions options;
+    options.components = K;
+    options.whiten = whiten;
+    StreamingPca pca(std::move(features), options);
+    pca.count_ = observations;
+    pca.components_ = K;
+    pca.basis_mean_ = parser.read_values("mean", D);
+    pca.basis_scale_ = parser.read_values("scale", D);
+    pca.eigenvalues_ = parser.read_values("eigenvalues", D);
+    pca.vectors_ = parser.read_values("vectors", K * D);
+    for (double scale : pca.basis_scale_) {
+        if (!(scale > 0.0)) throw parser.fail("non-positive scale");
+    }
+    pca.freeze();
+    return pca;
+}
+
+} // namespace microregime
@@ -0,0 +1,341 @@
+#include "feature_file.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace feature_file {
+
+namespace {
+
+size_t align_up(size_t offset) {
+    return (offset + kColumnAlignment - 1) / kColumnAlignment * kColumnAlignment;
+}
+
+} // namespace
+
+} // namespace feature_file
+
+namespace microregime {
+
+using namespace feature_file;
+
+namespace {
+
+// Full blocks allowed to wait on the writer thread before ingest blocks
+constexpr size_t kMaxPendingBlocks = 2;
+
+// Rows reserved per column up front: 9:30 to 16:00 of snapshots
+constexpr uint64_t kSessionNs = 23'400'000'000'000;
+
+} // namespace
+
+FeatureFileWriter::FeatureFileWriter(const std::string& filepath, const std::string& instrument,
+                                     const std::string& date, const PipelineConfig& config, size_t block_rows)
+    : filepath_{filepath},
+      partial_path_{filepath + ".tmp"},
+      groups_{1 + config.horizons.size()},
+      column_count_{1 + groups_ * kFeatureCount},
+      block_rows_{block_rows} {
+    if (block_rows_ == 0) {
+        throw std::invalid_argument("Feature file block size must be positive");
+    }
+
+    std::ostringstream metadata;
+    metadata << "instrument=" << instrument << "\n"
+             << "date=" << date << "\n"
+             << "config=" << config.label() << "\n"
+             << "groups=" << kRawGroup;
+    for (const auto& horizon : config.horizons) metadata << "," << horizon.label();
+    metadata << "\nfeatures=";
+    for (size_t i = 0; i < kFeatureCount; ++i) metadata << (i ? "," : "") << kFeatureNames[i];
+    metadata << "\n";
+    metadata_ = metadata.str();
+
+    // Written under a temporary name so readers never see a half-built file;
+    // the header goes in last, once the row count is known
+    out_.open(partial_path_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        throw std::runtime_error("Failed to create feature file: " + partial_path_);
+    }
+    data_offset_ = align_up(sizeof(Header) + metadata_.size());
+    size_t session_rows = static_cast<size_t>(kSessionNs / config.snapshot_interval_ns);
+    capacity_rows_ = std::max<size_t>(1, (session_rows + block_rows_ - 1) / block_rows_) * block_rows_;
+    column_stride_ = align_up(capacity_rows_ * sizeof(double));
+    out_.seekp(static_cast<std::streamoff>(sizeof(Header)));
+    out_.write(metadata_.data(), static_cast<std::streamsize>(metadata_.size()));
+    out_.flush();
+    fs::resize_file(partial_path_, data_offset_ + column_count_ * column_stride_);
+    if (!out_) {
+        throw std::runtime_error("Failed to write feature file: " + partial_path_);
+    }
+
+    current_.resize(column_count_ * block_rows_);
+    writer_ = std::thread([this] { write_blocks(); });
+}
+
+FeatureFileWriter::~FeatureFileWriter() {
+    try {
+        finish();
+    } catch (...) {
+        // Destructors must not throw; an unfinished file is just missing
+    }
+    stop_writer();
+    if (out_.is_open()) {
+        out_.close();
+        std::error_code ignored;
+        fs::remove(partial_path_, ignored);
+    }
+}
+
+void FeatureFileWriter::ingest_feature_set(const std::string&, uint64_t timestamp_ns,
+                                           const FeatureSet& raw_features, const FeatureSet& normalized) {
+    if (finished_) {
+        throw std::logic_error("Feature file already finished: " + filepath_);
+    }
+    // Hand a full block over only now, so variants of its last row have landed
+    if (current_rows_ == block_rows_) {
+        hand_off();
+    }
+    current_[current_rows_] = std::bit_cast<double>(timestamp_ns);
+    ++current_rows_;
+    ++row_count_;
+    write_group(0, raw_features);
+    write_group(1, normalized);
+}
+
+void FeatureFileWriter::ingest_normalization_variants(const std::string&, uint64_t,
+                                                      std::span<const NormalizationHorizon>,
+                                                      std::span<const FeatureSet> normalized) {
+    if (normalized.size() != groups_ - 1 || current_rows_ == 0) {
+        throw std::invalid_argument("Normalization variants don't match the feature file's config");
+    }
+    for (size_t h = 1; h < normalized.size(); ++h) {
+        write_group(1 + h, normalized[h]);
+    }
+}
+
+void FeatureFileWriter::write_group(size_t group, const FeatureSet& features) {
+    double* out = current_.data() + (1 + group * kFeatureCount) * block_rows_ + (current_rows_ - 1);
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        out[i * block_rows_] = features.*kFeatureMembers[i];
+    }
+}
+
+void FeatureFileWriter::hand_off() {
+    Block next;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [&] { return full_.size() < kMaxPendingBlocks || error_; });
+        if (error_) std::rethrow_exception(error_);
+        full_.push_back(std::move(current_));
+        if (!free_.empty()) {
+            next = std::move(free_.back());
+            free_.pop_back();
+        }
+    }
+    changed_.notify_all();
+    if (next.empty()) next.resize(column_count_ * block_rows_);
+    current_ = std::move(next);
+    current_rows_ = 0;
+}
+
+void FeatureFileWriter::write_blocks() {
+    for (;;) {
+        Block block;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [&] { return !full_.empty() || stopping_; });
+            if (full_.empty()) return;
+            block = std::move(full_.front());
+            full_.pop_front();
+        }
+        std::exception_ptr error;
+        try {
+            write_block(block, block_rows_);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = error;
+            free_.push_back(std::move(block));
+        }
+        changed_.notify_all();
+        if (error) return;
+    }
+}
+
+// The block's first `rows` rows, each column at its final offset
+void FeatureFileWriter::write_block(const Block& block, size_t rows) {
+    reserve(written_rows_ + rows);
+    for (size_t c = 0; c < column_count_; ++c) {
+        out_.seekp(static_cast<std::streamoff>(data_offset_ + c * column_stride_ + written_rows_ * sizeof(double)));
+        out_.write(reinterpret_cast<const char*>(block.data() + c * block_rows_),
+                   static_cast<std::streamsize>(rows * sizeof(double)));
+    }
+    if (!out_) {
+        throw std::runtime_error("Failed to write feature file: " + partial_path_);
+    }
+    written_rows_ += rows;
+}
+
+// Make room for `rows` per column: double the stride and move the rows
+// written so far, last column first and each back to front, so nothing is
+// overwritten before it has been copied
+void FeatureFileWriter::reserve(size_t rows) {
+    if (rows <= capacity_rows_) return;
+    const size_t capacity = std::max(rows, 2 * capacity_rows_);
+    const size_t stride = align_up(capacity * sizeof(double));
+    out_.flush();
+    fs::resize_file(partial_path_, data_offset_ + column_count_ * stride);
+
+    std::vector<char> buffer(block_rows_ * sizeof(double));
+    for (size_t c = column_count_; c-- > 1;) {
+        const size_t from = data_offset_ + c * column_stride_;
+        const size_t to = data_offset_ + c * stride;
+        for (size_t end = written_rows_ * sizeof(double); end > 0;) {
+            const size_t bytes = std::min(end, buffer.size());
+            end -= bytes;
+            out_.seekg(static_cast<std::streamoff>(from + end));
+            out_.read(buffer.data(), static_cast<std::streamsize>(bytes));
+            out_.seekp(static_cast<std::streamoff>(to + end));
+            out_.write(buffer.data(), static_cast<std::streamsize>(bytes));
+        }
+    }
+    if (!out_) {
+        throw std::runtime_error("Failed to grow feature file: " + partial_path_);
+    }
+    capacity_rows_ = capacity;
+    column_stride_ = stride;
+}
+
+void FeatureFileWriter::stop_writer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    if (writer_.joinable()) writer_.join();
+}
+
+void FeatureFileWriter::finish() {
+    if (finished_) return;
+    finished_ = true;
+
+    stop_writer();
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    write_block(current_, current_rows_);
+    write_header();
+    out_.close();
+    if (!out_) {
+        throw std::runtime_error("Failed to write feature file: " + partial_path_);
+    }
+    fs::rename(partial_path_, filepath_);
+}
+
+void FeatureFileWriter::write_header() {
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.column_count = static_cast<uint32_t>(column_count_);
+    header.row_count = row_count_;
+    header.metadata_offset = sizeof(Header);
+    header.metadata_bytes = metadata_.size();
+    header.data_offset = data_offset_;
+    header.column_stride = column_stride_;
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+FeatureFileReader::FeatureFileReader(const std::string& filepath) : file_{filepath} {
+    if (file_.size() < sizeof(Header)) {
+        throw std::runtime_error("Not a feature file (too small): " + filepath);
+    }
+    Header header;
+    std::memcpy(&header, file_.bytes().data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a feature file: " + filepath);
+    }
+    if (header.version != kVersion) {
+        throw std::runtime_error("Unsupported feature file version " + std::to_string(header.version) + ": " + filepath);
+    }
+    if (header.metadata_offset + header.metadata_bytes > file_.size() ||
+        header.data_offset % kColumnAlignment != 0 ||
+        header.column_stride < header.row_count * sizeof(double) ||
+        header.data_offset + header.column_count * header.column_stride > file_.size()) {
+        throw std::runtime_error("Corrupt feature file: " + filepath);
+    }
+
+    std::string features;
+    std::istringstream metadata(std::string(reinterpret_cast<const char*>(file_.bytes().data()) + header.metadata_offset,
+                                            header.metadata_bytes));
+    std::string line;
+    while (std::getline(metadata, line)) {
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) continue;
+        std::string key = line.substr(0, equals);
+        std::string value = line.substr(equals + 1);
+        if (key == "instrument") instrument_ = value;
+        else if (key == "date") date_ = value;
+        else if (key == "config") config_ = value;
+        else if (key == "features") features = value;
+        else if (key == "groups") {
+            std::istringstream list(value);
+            std::string group;
+            while (std::getline(list, group, ',')) groups_.push_back(group);
+        }
+    }
+
+    // Columns are addressed by registry position, so the registry must match
+    std::string expected;
+    for (size_t i = 0; i < kFeatureCount; ++i) expected += std::string(i ? "," : "") + std::string(kFeatureNames[i]);
+    if (features != expected) {
+        throw std::runtime_error("Feature file was written with a different feature list: " + filepath);
+    }
+    if (groups_.empty() || header.column_count != 1 + groups_.size() * kFeatureCount) {
+        throw std::runtime_error("Corrupt feature file: " + filepath);
+    }
+
+    row_count_ = header.row_count;
+    column_count_ = header.column_count;
+    column_stride_ = header.column_stride;
+    data_ = file_.bytes().data() + header.data_offset;
+}
+
+std::span<const uint64_t> FeatureFileReader::timestamps() const {
+    return {reinterpret_cast<const uint64_t*>(column_bytes(0)), row_count_};
+}
+
+std::span<const double> FeatureFileReader::column(size_t group, Feature feature) const {
+    if (group >= groups_.size()) {
+        throw std::out_of_range("Feature file has no group " + std::to_string(group));
+    }
+    size_t column = 1 + group * kFeatureCount + feature_index(feature);
+    return {reinterpret_cast<const double*>(column_bytes(column)), row_count_};
+}
+
+std::span<const double> FeatureFileReader::column(const std::string& group, Feature feature) const {
+    auto it = std::find(groups_.begin(), groups_.end(), group);
+    if (it == groups_.end()) {
+        throw std::out_of_range("Feature file has no group " + group);
+    }
+    return column(static_cast<size_t>(it - groups_.begin()), feature);
+}
+
+FeatureSet FeatureFileReader::row(size_t group, size_t row) const {
+    FeatureSet out{};
+    out.timestamp_ns = timestamps()[row];
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        out.*kFeatureMembers[i] = column(group, static_cast<Feature>(i))[row];
+    }
+    return out;
+}
+
+} // namespace microregime
@@ -0,0 +1,218 @@
+#include "feature_ring.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include "symbol_table.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace microregime {
+
+using namespace feature_ring;
+
+namespace {
+
+size_t segment_bytes(size_t capacity) {
+    return sizeof(Header) + capacity * sizeof(Slot);
+}
+
+// Payload words are plain memory to the other process but racy to this one,
+// so both sides touch them only through relaxed atomics
+inline void store_word(uint64_t& word, uint64_t value) {
+    std::atomic_ref<uint64_t>(word).store(value, std::memory_order_relaxed);
+}
+
+inline uint64_t load_word(const uint64_t& word) {
+    return std::atomic_ref<uint64_t>(const_cast<uint64_t&>(word)).load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+#ifdef _WIN32
+
+FeatureRingWriter::FeatureRingWriter(const std::string& name, size_t capacity) : name_{name} {
+    throw std::runtime_error("Shared-memory feature rings need POSIX shared memory");
+}
+
+FeatureRingWriter::~FeatureRingWriter() = default;
+
+void FeatureRingWriter::ingest_feature_set(const std::string&, uint64_t, const FeatureSet&, const FeatureSet&) {}
+
+FeatureRingReader::FeatureRingReader(const std::string& name, Start start) {
+    throw std::runtime_error("Shared-memory feature rings need POSIX shared memory");
+}
+
+FeatureRingReader::~FeatureRingReader() = default;
+
+bool FeatureRingReader::try_read(RingRecord&) { return false; }
+
+bool FeatureRingReader::closed() const { return true; }
+
+#else
+
+FeatureRingWriter::FeatureRingWriter(const std::string& name, size_t capacity)
+    : name_{name}, mask_{std::bit_ceil(capacity < 2 ? size_t{2} : capacity) - 1} {
+    bytes_ = segment_bytes(mask_ + 1);
+
+    // A fresh segment every run, so readers of an old one see it closed rather than reused
+    shm_unlink(name_.c_str());
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create shared memory: " + name_);
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+        close(fd);
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("Failed to size shared memory: " + name_);
+    }
+    void* view = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);  // The mapping keeps the segment alive
+    if (view == MAP_FAILED) {
+        shm_unlink(name_.c_str());
+        throw std::runtime_error("Failed to map shared memory: " + name_);
+    }
+    mapping_ = view;
+
+    // ftruncate zero-fills, so every slot starts at sequence 0 ("never written")
+    header_ = new (view) Header{};
+    slots_ = reinterpret_cast<Slot*>(static_cast<std::byte*>(view) + sizeof(Header));
+    header_->version = kVersion;
+    header_->record_words = static_cast<uint32_t>(kRecordWords);
+    header_->capacity = mask_ + 1;
+    // Magic last: a reader attaching mid-setup is turned away rather than misled
+    std::memcpy(header_->magic, kMagic, sizeof(kMagic));
+}
+
+FeatureRingWriter::~FeatureRingWriter() {
+    if (!mapping_) return;
+    header_->closed.store(1, std::memory_order_release);
+    munmap(mapping_, bytes_);
+    shm_unlink(name_.c_str());
+}
+
+void FeatureRingWriter::ingest_feature_set(const std::string& symbol, uint64_t timestamp_ns,
+                                           const FeatureSet& raw_features, const FeatureSet& normalized) {
+    const uint64_t n = next_++;
+    Slot& slot = slots_[n & mask_];
+    slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    store_word(slot.words[0], timestamp_ns);
+    char name[kSymbolBytes] = {};
+    std::memcpy(name, symbol.data(), std::min(symbol.size(), kSymbolBytes - 1));
+    for (size_t w = 0; w < kSymbolWords; ++w) {
+        uint64_t word;
+        std::memcpy(&word, name + w * sizeof(uint64_t), sizeof(word));
+        store_word(slot.words[1 + w], word);
+    }
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        store_word(slot.words[kRawWord + i], std::bit_cast<uint64_t>(raw_features.*kFeatureMembers[i]));
+        store_word(slot.words[kNormalizedWord + i], std::bit_cast<uint64_t>(normalized.*kFeatureMembers[i]));
+    }
+
+    slot.sequence.store(2 * n + 2, std::memory_order_release);
+    header_->write_index.store(n + 1, std::memory_order_release);
+}
+
+FeatureRingReader::FeatureRingReader(const std::string& name, Start start) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("No shared-memory feature ring named " + name);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error("Not a feature ring (too small): " + name);
+    }
+    bytes_ = static_cast<size_t>(st.st_size);
+    void* view = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Failed to map shared memory: " + name);
+    }
+    mapping_ = view;
+    header_ = static_cast<const Header*>(view);
+    slots_ = reinterpret_cast<const Slot*>(static_cast<const std::byte*>(view) + sizeof(Header));
+
+    if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0 || header_->version != kVersion ||
+        header_->record_words != kRecordWords || !std::has_single_bit(header_->capacity) ||
+        segment_bytes(header_->capacity) != bytes_) {
+        munmap(mapping_, bytes_);
+        throw std::runtime_error("Not a compatible feature ring: " + name);
+    }
+    mask_ = header_->capacity - 1;
+
+    next_ = header_->write_index.load(std::memory_order_acquire);
+    if (start == Start::Oldest) {
+        next_ = (next_ > mask_) ? next_ - mask_ : 0;
+    }
+}
+
+FeatureRingReader::~FeatureRingReader() {
+    if (mapping_) munmap(mapping_, bytes_);
+}
+
+bool FeatureRingReader::closed() const {
+    return header_->closed.load(std::memory_order_acquire) != 0;
+}
+
+void FeatureRingReader::skip_to_oldest() {
+    // The slot of write_index may be mid-overwrite, so start one past it
+    uint64_t head = header_->write_index.load(std::memory_order_acquire);
+    uint64_t oldest = (head > mask_) ? head - mask_ : 0;
+    if (oldest > next_) {
+        missed_ += oldest - next_;
+        next_ = oldest;
+    }
+}
+
+bool FeatureRingReader::try_read(RingRecord& out) {
+    uint64_t words[kRecordWords];
+    for (;;) {
+        const uint64_t n = next_;
+        const Slot& slot = slots_[n & mask_];
+        const uint64_t expected = 2 * n + 2;
+
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before < expected) return false;  // Not published yet (or being written)
+        if (before == expected) {
+            for (size_t w = 0; w < kRecordWords; ++w) words[w] = load_word(slot.words[w]);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == expected) break;
+        }
+        // Lapped before or during the copy
+        skip_to_oldest();
+    }
+
+    out.index = next_++;
+    out.timestamp_ns = words[0];
+    char name[kSymbolBytes];
+    std::memcpy(name, &words[1], kSymbolBytes);
+    name[kSymbolBytes - 1] = '\0';
+    if (last_symbol_ != name) {
+        last_symbol_ = name;
+        last_instrument_ = intern_symbol(last_symbol_);
+    }
+    out.symbol = last_symbol_;
+
+    out.raw = FeatureSet{};
+    out.normalized = FeatureSet{};
+    out.raw.timestamp_ns = out.normalized.timestamp_ns = out.timestamp_ns;
+    out.raw.instrument = out.normalized.instrument = last_instrument_;
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        out.raw.*kFeatureMembers[i] = std::bit_cast<double>(words[kRawWord + i]);
+        out.normalized.*kFeatureMembers[i] = std::bit_cast<double>(words[kNormalizedWord + i]);
+    }
+    return true;
+}
+
+#endif
+
+} // namespace microregime
@@ -1,33 +1,76 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <deque>
 #include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
 #include <iomanip>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
 #include "dual_feature_pipeline.hpp"
 #include "feature_set.hpp"
+#include "feature_normalizer.hpp"
+#include "async_reciever.hpp"
 #include "data_reciever.hpp"
+#include "feature_file.hpp"
+#include "feature_ring.hpp"
+#include "pca_reciever.hpp"
+#include "pipeline_config.hpp"
 #include "common_constants.hpp"
 #include "environment.hpp"
+#include "logger.hpp"
+#include "streaming_pca.hpp"
+#include "symbol_table.hpp"
+#include "thread_pool.hpp"
 
 namespace microregime {
 
+// Output directory for one config's CSVs; the midprice window and depth only
+// appear when they differ from the defaults, so default runs keep their old paths
+std::string output_dir_name(const PipelineConfig& config) {
+    std::string seconds = std::to_string(static_cast<double>(config.snapshot_interval_ns) / 1000000000);
+    const NormalizationHorizon& primary = config.horizons.front();
+    std::string window = (primary.kind == NormalizationHorizon::Kind::Window) ? std::to_string(primary.length)
+                                                                               : primary.label();
+    std::string dir_name = "output_Snapshot" + seconds +
+        "_Window" + window +
+        "_Events" + std::to_string(config.windows.rolling_events);
+    if (config.windows.midprice_samples != MIDPRICE_WINDOW) {
+        dir_name += "_Midprice" + std::to_string(config.windows.midprice_samples);
+    }
+    if (config.depth_levels != DEPTH_LEVELS) {
+        dir_name += "_Depth" + std::to_string(config.depth_levels);
+    }
+    return dir_name;
+}
+
+// Output directory for one config and day, created if it doesn't exist
+std::filesystem::path output_dir(const PipelineConfig& config, const std::string& date) {
+    std::filesystem::path dir = get_project_root() / "data" / output_dir_name(config) / date;
+    LogLine() << "Creating directory: " << dir.string();
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
 // Custom DataReceiver that writes features to CSV files
 class CsvWriter : public DataReciever {
 public:
-    CsvWriter(const std::string& base_filename, const uint64_t snapshot_interval_ns, const std::string& date) {
-        // Create output directory if it doesn't exist
-        std::string seconds = std::to_string(static_cast<double>(snapshot_interval_ns) / 1000000000);
-        std::string dir_name = "output_Snapshot" + seconds + 
-            "_Window" + std::to_string(WINDOW_SIZE) + 
-            "_Events" + std::to_string(ROLLING_WINDOW);
-        std::filesystem::path dir = get_project_root() / "data" / dir_name / date;
-        std::cout << "Creating directory: " << dir.string() << std::endl;
-        std::filesystem::create_directories(dir);
+    CsvWriter(const std::filesystem::path& dir, const std::string& base_filename)
+        : base_filename_{base_filename}, dir_{dir} {
         
         // Open CSV files for writing
-        raw_csv_.open(dir / (base_filename + "_raw.csv"), std::ios::out);
-        norm_csv_.open(dir / (base_filename + "_norm.csv"), std::ios::out);
+        raw_csv_.open(dir_ / (base_filename + "_raw.csv"), std::ios::out);
+        norm_csv_.open(dir_ / (base_filename + "_norm.csv"), std::ios::out);
         
         // Write CSV headers
         writeCsvHeader(raw_csv_);
@@ -48,103 +91,474 @@ public:
         writeFeatureSet(norm_csv_, timestamp_ns, normalized);
     }
 
+    // Extra horizons go to <base>_norm_<label>.csv; the first is already in _norm.csv
+    void ingest_normalization_variants(const std::string&,
+                                       uint64_t timestamp_ns,
+                                       std::span<const NormalizationHorizon> horizons,
+                                       std::span<const FeatureSet> normalized) override {
+        if (variant_csvs_.empty()) {
+            for (size_t h = 1; h < horizons.size(); ++h) {
+                auto& csv = variant_csvs_.emplace_back(dir_ / (base_filename_ + "_norm_" + horizons[h].label() + ".csv"),
+                                                       std::ios::out);
+                writeCsvHeader(csv);
+            }
+        }
+        for (size_t h = 1; h < normalized.size(); ++h) {
+            writeFeatureSet(variant_csvs_[h - 1], timestamp_ns, normalized[h]);
+        }
+    }
+
+    // Principal components go to <base>_pca.csv, opened with the first row
+    void ingest_components(const std::string& symbol,
+                           uint64_t timestamp_ns,
+                           std::span<const double> components) override {
+        if (!pca_csv_.is_open()) {
+            pca_csv_.open(dir_ / (base_filename_ + "_pca.csv"), std::ios::out);
+            pca_csv_ << "timestamp_ns,instrument";
+            for (size_t k = 1; k <= components.size(); ++k) {
+                pca_csv_ << ",pc" << k;
+            }
+            pca_csv_ << '\n' << std::setprecision(15) << std::scientific;
+        }
+        pca_csv_ << timestamp_ns << ',' << symbol;
+        for (double value : components) {
+            pca_csv_ << ',' << value;
+        }
+        pca_csv_ << '\n';
+    }
+
 private:
+    std::string base_filename_;
+    std::filesystem::path dir_;
     std::ofstream raw_csv_;
     std::ofstream norm_csv_;
+    std::vector<std::ofstream> variant_csvs_;
+    std::ofstream pca_csv_;
     
     void writeCsvHeader(std::ofstream& csv) {
         if (!csv.is_open()) return;
         
         // Common fields
-        csv << "timestamp_ns,instrument,";
+        csv << "timestamp_ns,instrument";
         
-        // Feature fields
-        csv << "midprice,"
-            << "log_spread,"
-            << "log_return,"
-            << "ewm_volatility,"
-            << "realized_variance,"
-            << "directional_volatility,"
-            << "spread_volatility,"
-            << "ofi,"
-            << "signed_volume_pressure,"
-            << "order_arrival_rate,"
-            << "depth_imbalance,"
-            << "market_depth,"
-            << "lob_slope,"
-            << "price_gap,"
-            << "tick_direction_entropy,"
-            << "reversal_rate,"
-            << "aggressor_bias,"
-            << "shannon_entropy,"
-            << "liquidity_stress\n";
+        // Feature fields, in registry order
+        for (std::string_view name : kFeatureNames) {
+            csv << ',' << name;
+        }
+        csv << '\n';
     }
     
     void writeFeatureSet(std::ofstream& csv, uint64_t timestamp_ns, const FeatureSet& fs) {
         if (!csv.is_open()) return;
         
         // Write timestamp and instrument
-        csv << timestamp_ns << "," << fs.instrument << ",";
+        csv << timestamp_ns << "," << symbol_name(fs.instrument);
         
         // Write all feature values
-        csv << std::setprecision(15) << std::scientific
-            << fs.midprice << ","
-            << fs.log_spread << ","
-            << fs.log_return << ","
-            << fs.ewm_volatility << ","
-            << fs.realized_variance << ","
-            << fs.directional_volatility << ","
-            << fs.spread_volatility << ","
-            << fs.ofi << ","
-            << fs.signed_volume_pressure << ","
-            << fs.order_arrival_rate << ","
-            << fs.depth_imbalance << ","
-            << fs.market_depth << ","
-            << fs.lob_slope << ","
-            << fs.price_gap << ","
-            << fs.tick_direction_entropy << ","
-            << fs.reversal_rate << ","
-            << fs.aggressor_bias << ","
-            << fs.shannon_entropy << ","
-            << fs.liquidity_stress << "\n";
+        csv << std::setprecision(15) << std::scientific;
+        for (auto member : kFeatureMembers) {
+            csv << ',' << fs.*member;
+        }
+        csv << '\n';
+    }
+};
+
+// Throws if two configs would write the same CSV files
+void check_output_dirs(const std::vector<PipelineConfig>& configs) {
+    std::vector<std::string> names;
+    for (const auto& config : configs) {
+        std::string name = output_dir_name(config);
+        if (std::find(names.begin(), names.end(), name) != names.end()) {
+            throw std::invalid_argument("Two configs write to " + name +
+                                        "; list their extra horizons in one config instead");
+        }
+        names.push_back(name);
     }
+}
+
+// Where each instrument's features go
+enum class OutputFormat {
+    Csv,           // <base_filename>_raw.csv, _norm.csv, ...
+    Binary,        // <base_filename>.features
+    SharedMemory,  // Live ring /microregime_<base_filename>[_<config>], nothing on disk
 };
 
+// PCA over each instrument's normalized features, per config, in two passes.
+// --pca fits: every day accumulates its own statistics, merged into one basis
+// per instrument at the end of the run and saved as
+// data/<config dir>/<base_filename>.pca; nothing is projected. --pca-basis
+// loads those saved bases frozen and writes every snapshot's components, so
+// each column means the same thing on every row of every day.
+struct PcaStage {
+    StreamingPcaOptions options;
+    bool fixed_basis = false;
+
+    std::mutex mutex;
+    std::map<std::string, StreamingPca> fitted;  // By basis path
+
+    static std::string basis_path(const PipelineConfig& config, const std::string& base_filename) {
+        return (get_project_root() / "data" / output_dir_name(config) / (base_filename + ".pca")).string();
+    }
+
+    StreamingPca start(const std::string& path) const {
+        if (fixed_basis) return StreamingPca::load(path);
+        // Nothing is projected while fitting, so a day is only eigendecomposed once merged
+        StreamingPcaOptions day = options;
+        day.refresh_interval = std::numeric_limits<size_t>::max();
+        return StreamingPca(day);
+    }
+
+    void finish_day(const std::string& path, const StreamingPca& day) {
+        if (fixed_basis) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        fitted.try_emplace(path, options).first->second.merge(day);
+    }
+
+    void save() {
+        for (auto& [path, pca] : fitted) {
+            pca.refresh();
+            pca.save(path);
+            std::cout << "Saved " << pca.components() << " components (" << std::fixed << std::setprecision(1)
+                      << 100.0 * pca.retained_variance() << "% of the variance) to " << path << "\n";
+        }
+    }
+};
+
+// One replay of the day, one output directory per config. With `async`, every
+// writer runs on its own thread behind an AsyncReciever; with `pca`, behind a
+// PcaReciever (on the writer thread when async).
 void run_feature_extraction(const std::string& timestamp,
                           const std::string& base_asset,
                           const std::string& future,
-                          uint64_t snapshot_interval_ns) {
-    // Create CSV writers for both instruments
-    CsvWriter base_writer("base_" + base_asset, snapshot_interval_ns, timestamp);
-    CsvWriter future_writer("future_" + future, snapshot_interval_ns, timestamp);
+                          const std::vector<PipelineConfig>& configs,
+                          bool pipelined = false,
+                          OutputFormat format = OutputFormat::Csv,
+                          bool async = false,
+                          PcaStage* pca = nullptr) {
+    check_output_dirs(configs);
+
+    // Create writers for both instruments, per config
+    std::deque<CsvWriter> csv_writers;
+    std::deque<FeatureFileWriter> binary_writers;
+    std::deque<FeatureRingWriter> ring_writers;
+    std::vector<PipelineOutput> outputs;
+    for (size_t c = 0; c < configs.size(); ++c) {
+        const PipelineConfig& config = configs[c];
+        if (format == OutputFormat::SharedMemory) {
+            std::string suffix = (configs.size() > 1) ? "_" + std::to_string(c) : "";
+            auto& base_writer = ring_writers.emplace_back("/microregime_base_" + base_asset + suffix);
+            auto& future_writer = ring_writers.emplace_back("/microregime_future_" + future + suffix);
+            LogLine() << "Publishing to shared memory " << base_writer.name() << " and " << future_writer.name()
+                      << " (" << config.label() << ")";
+            outputs.push_back({&base_writer, &future_writer});
+            continue;
+        }
+        // Both instruments' files share the config's directory, created once here
+        std::filesystem::path dir = output_dir(config, timestamp);
+        if (format == OutputFormat::Binary) {
+            auto& base_writer = binary_writers.emplace_back(
+                (dir / ("base_" + base_asset + feature_file::kExtension)).string(), base_asset, timestamp, config);
+            auto& future_writer = binary_writers.emplace_back(
+                (dir / ("future_" + future + feature_file::kExtension)).string(), future, timestamp, config);
+            outputs.push_back({&base_writer, &future_writer});
+        } else {
+            CsvWriter& base_writer = csv_writers.emplace_back(dir, "base_" + base_asset);
+            CsvWriter& future_writer = csv_writers.emplace_back(dir, "future_" + future);
+            outputs.push_back({&base_writer, &future_writer});
+        }
+    }
+
+    // One basis and stage per instrument and config, in output order
+    std::deque<StreamingPca> bases;
+    std::deque<PcaReciever> pca_stages;
+    std::vector<std::string> basis_paths;
+    auto add_pca_stage = [&](DataReciever*& reciever, const PipelineConfig& config, const std::string& name) {
+        basis_paths.push_back(PcaStage::basis_path(config, name));
+        StreamingPca& basis = bases.emplace_back(pca->start(basis_paths.back()));
+        reciever = &pca_stages.emplace_back(*reciever, basis);
+    };
+    if (pca) {
+        for (size_t c = 0; c < configs.size(); ++c) {
+            add_pca_stage(outputs[c].base, configs[c], "base_" + base_asset);
+            add_pca_stage(outputs[c].future, configs[c], "future_" + future);
+        }
+    }
+
+    // Declared after the writers so they are finished before the writers close
+    std::deque<AsyncReciever> async_writers;
+    if (async) {
+        for (auto& output : outputs) {
+            output = {&async_writers.emplace_back(*output.base), &async_writers.emplace_back(*output.future)};
+        }
+    }
     
     // Create and run the pipeline
-    DualFeaturePipeline pipeline(timestamp, base_asset, future);
-    pipeline.run(snapshot_interval_ns, base_writer, future_writer);
+    DualFeaturePipeline pipeline(timestamp, base_asset, future, configs);
+    if (pipelined) {
+        pipeline.run_pipelined(outputs);
+    } else {
+        pipeline.run(outputs);
+    }
+    // Finish explicitly so a failed write is reported rather than swallowed
+    for (auto& writer : async_writers) {
+        writer.finish();
+        if (writer.stats().stalled > 0) {
+            LogLine() << timestamp << ": " << writer.stats().stalled << " snapshots waited on a full output queue";
+        }
+    }
+    for (auto& writer : binary_writers) {
+        writer.finish();
+    }
+    for (size_t i = 0; i < basis_paths.size(); ++i) {
+        pca->finish_day(basis_paths[i], bases[i]);
+    }
+}
+
+// Expand a date argument: "YYYYMMDD", a comma list "YYYYMMDD,YYYYMMDD,..."
+// or an inclusive calendar range "YYYYMMDD-YYYYMMDD"
+std::vector<std::string> parse_dates(const std::string& spec) {
+    auto parse_day = [](const std::string& text) {
+        if (text.size() != 8 || !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            throw std::invalid_argument("Bad date '" + text + "', expected YYYYMMDD");
+        }
+        std::chrono::year_month_day day{std::chrono::year{std::stoi(text.substr(0, 4))},
+                                        std::chrono::month{static_cast<unsigned>(std::stoi(text.substr(4, 2)))},
+                                        std::chrono::day{static_cast<unsigned>(std::stoi(text.substr(6, 2)))}};
+        if (!day.ok()) {
+            throw std::invalid_argument("Bad date '" + text + "'");
+        }
+        return std::chrono::sys_days{day};
+    };
+    auto format_day = [](std::chrono::sys_days day) {
+        std::chrono::year_month_day ymd{day};
+        // Sized for any int year so the compiler can prove no truncation
+        char text[32];
+        std::snprintf(text, sizeof(text), "%04d%02u%02u", static_cast<int>(ymd.year()),
+                      static_cast<unsigned>(ymd.month()), static_cast<unsigned>(ymd.day()));
+        return std::string(text);
+    };
+
+    std::vector<std::string> dates;
+    size_t dash = spec.find('-');
+    if (dash != std::string::npos) {
+        auto first = parse_day(spec.substr(0, dash));
+        auto last = parse_day(spec.substr(dash + 1));
+        for (auto day = first; day <= last; day += std::chrono::days{1}) {
+            dates.push_back(format_day(day));
+        }
+        return dates;
+    }
+    std::stringstream list(spec);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        parse_day(item);
+        dates.push_back(item);
+    }
+    return dates;
+}
+
+// Run one DualFeaturePipeline per day on a work-stealing pool, biggest inputs first.
+// Returns the number of days that failed.
+size_t run_multi_day_extraction(const std::vector<std::string>& dates,
+                                const std::string& base_asset,
+                                const std::string& future,
+                                const std::vector<PipelineConfig>& configs,
+                                size_t jobs,
+                                bool pipelined,
+                                OutputFormat format,
+                                bool async,
+                                PcaStage* pca) {
+    namespace fs = std::filesystem;
+    using Clock = std::chrono::steady_clock;
+
+    struct Day {
+        std::string date;
+        uintmax_t input_bytes;
+    };
+
+    // Resolve every input once up front; ranges cover weekends and holidays with no data
+    std::vector<Day> days;
+    for (const auto& date : dates) {
+        fs::path base_path = DualFeaturePipeline::input_path(base_asset, true, date);
+        fs::path future_path = DualFeaturePipeline::input_path(future, false, date);
+        if (!fs::exists(base_path) || !fs::exists(future_path)) {
+            std::cout << "Skipping " << date << ": no " << base_asset << "/" << future << " data\n";
+            continue;
+        }
+        days.push_back({date, fs::file_size(base_path) + fs::file_size(future_path)});
+    }
+    // Longest days start first so the tail of the run isn't one big day on one core
+    std::stable_sort(days.begin(), days.end(),
+                     [](const Day& a, const Day& b) { return a.input_bytes > b.input_bytes; });
+
+    // Symbols are interned before any worker starts, so every day shares the same ids
+    intern_symbol(base_asset);
+    intern_symbol(future);
+
+    ThreadPool pool(std::min(jobs, std::max<size_t>(days.size(), 1)));
+    std::cout << "Processing " << days.size() << " days on " << pool.size() << " threads\n";
+
+    std::mutex report_mutex;
+    size_t finished = 0;
+    size_t failed = 0;
+    double busy_seconds = 0.0;
+    const auto run_start = Clock::now();
+
+    for (const auto& day : days) {
+        pool.submit([&, day] {
+            const auto start = Clock::now();
+            std::string error;
+            try {
+                run_feature_extraction(day.date, base_asset, future, configs, pipelined, format, async, pca);
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(report_mutex);
+            ++finished;
+            busy_seconds += seconds;
+            LogLine line;
+            line << "[" << finished << "/" << days.size() << "] " << day.date << " " << std::fixed
+                 << std::setprecision(1) << seconds << " s, " << day.input_bytes / (1024 * 1024) << " MB input";
+            if (!error.empty()) {
+                ++failed;
+                line << " FAILED: " << error;
+            }
+        });
+    }
+    pool.wait_idle();
+
+    double wall_seconds = std::chrono::duration<double>(Clock::now() - run_start).count();
+    std::cout << "Processed " << days.size() - failed << "/" << days.size() << " days in "
+              << std::fixed << std::setprecision(1) << wall_seconds << " s ("
+              << busy_seconds << " s of day time, "
+              << std::setprecision(2) << (wall_seconds > 0 ? busy_seconds / wall_seconds : 0.0)
+              << "x parallel)\n";
+    return failed;
 }
 
 } // namespace microregime
 
 int main(int argc, char** argv) {
-    if (argc < 4) {
-        std::cerr << "Usage: " << argv[0] 
-                  << " <timestamp> <base_asset> <future> [snapshot_interval_ns]\n"
-                  << "Example: " << argv[0] << " 20250505 SPY ES 1000000000\n";
+    // Pull out "--jobs N", "--pipelined", "--binary", "--shm", "--async", "--pca VARIANCE", "--pca-basis",
+    // "--horizons LIST" and "--config SPEC"s; everything else is positional
+    size_t jobs = std::thread::hardware_concurrency();
+    bool pipelined = false;
+    microregime::OutputFormat format = microregime::OutputFormat::Csv;
+    bool async = false;
+    microregime::PcaStage pca;
+    bool pca_enabled = false;
+    bool pca_variance = false;  // --pca given
+    std::string horizon_list;
+    std::vector<std::string> config_specs;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--jobs" && i + 1 < argc) {
+            jobs = std::stoul(argv[++i]);
+        } else if (arg == "--pipelined") {
+            pipelined = true;
+        } else if (arg == "--binary") {
+            format = microregime::OutputFormat::Binary;
+        } else if (arg == "--shm") {
+            format = microregime::OutputFormat::SharedMemory;
+        } else if (arg == "--async") {
+            async = true;
+        } else if (arg == "--pca" && i + 1 < argc) {
+            pca_enabled = pca_variance = true;
+            pca.options.retained_variance = std::stod(argv[++i]);
+        } else if (arg == "--pca-basis") {
+            pca_enabled = true;
+            pca.fixed_basis = true;
+        } else if (arg == "--horizons" && i + 1 < argc) {
+            horizon_list = argv[++i];
+        } else if (arg == "--config" && i + 1 < argc) {
+            config_specs.push_back(argv[++i]);
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    if (args.size() < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <dates> <base_asset> <future> [snapshot_interval_ns] [--jobs N] [--pipelined] [--horizons LIST]\n"
+                  << "       [--config SPEC]... [--binary | --shm] [--async] [--pca VARIANCE | --pca-basis]\n"
+                  << "  <dates> is YYYYMMDD, a list YYYYMMDD,YYYYMMDD,... or a range YYYYMMDD-YYYYMMDD\n"
+                  << "  --pipelined decodes and updates each instrument on its own thread (same output)\n"
+                  << "  --binary writes one columnar <base|future>_<asset>.features file per instrument instead of CSVs\n"
+                  << "  --shm publishes each instrument live to a shared-memory ring (/microregime_<base|future>_<asset>,\n"
+                  << "    read with FeatureRingReader) instead of writing files; one date only\n"
+                  << "  --async writes each output file on its own thread, so slow disks don't hold up the replay\n"
+                  << "  --pca fits principal components keeping VARIANCE (e.g. 0.99) of the normalized features' standardized\n"
+                  << "    variance. The run's days are merged into one basis per instrument, saved as\n"
+                  << "    data/<output dir>/<base|future>_<asset>.pca; no components are written on this pass\n"
+                  << "  --pca-basis is the second pass: it projects onto those saved bases and writes\n"
+                  << "    <base|future>_<asset>_pca.csv, the same components on every row of every day (CSV only)\n"
+                  << "  --horizons normalizes over each of e.g. w30000,w1000,ewm600 (rolling windows in snapshots,\n"
+                  << "    EWM half-lives in snapshots) in one pass; the first goes to _norm.csv, the rest to _norm_<label>.csv\n"
+                  << "  --config adds a feature configuration computed from the same replay, each in its own output\n"
+                  << "    directory. SPEC sets any of interval_ns, rolling, midprice, depth and horizons (joined by +)\n"
+                  << "    over the interval and horizons given above, e.g. interval_ns=250000000,rolling=500,horizons=w1000+ewm600\n"
+                  << "Example: " << argv[0] << " 20250505 SPY ES 1000000000\n"
+                  << "Example: " << argv[0] << " 20250501-20250531 SPY ES --jobs 8\n"
+                  << "Example: " << argv[0] << " 20250505 SPY ES --horizons w30000,w10000,w1000,ewm600\n"
+                  << "Example: " << argv[0] << " 20250505 SPY ES --config rolling=1500 --config rolling=500,depth=5\n";
         return 1;
     }
-    
-    std::string timestamp = argv[1];
-    std::string base_asset = argv[2];
-    std::string future = argv[3];
-    uint64_t snapshot_interval_ns = (argc > 4) ? std::stoull(argv[4]) : microregime::SNAPSHOT_INTERVAL_NS;
-    
+
+    std::string base_asset = args[1];
+    std::string future = args[2];
+
     try {
-        microregime::run_feature_extraction(timestamp, base_asset, future, snapshot_interval_ns);
-        std::cout << "Feature extraction completed successfully. Check the 'output' directory for CSV files.\n";
+        std::vector<std::string> dates = microregime::parse_dates(args[0]);
+
+        // The positional interval and --horizons make the default config
+        microregime::PipelineConfig defaults;
+        if (args.size() > 3) {
+            defaults.snapshot_interval_ns = std::stoull(args[3]);
+        }
+        if (!horizon_list.empty()) {
+            defaults.horizons.clear();
+            std::stringstream list(horizon_list);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                defaults.horizons.push_back(microregime::NormalizationHorizon::parse(item));
+            }
+        }
+        defaults.validate();
+
+        std::vector<microregime::PipelineConfig> configs;
+        for (const auto& spec : config_specs) {
+            configs.push_back(microregime::PipelineConfig::parse(spec, defaults));
+        }
+        if (configs.empty()) {
+            configs.push_back(defaults);
+        }
+
+        if (format == microregime::OutputFormat::SharedMemory && dates.size() != 1) {
+            throw std::invalid_argument("--shm publishes one day at a time");
+        }
+        if (pca.fixed_basis && pca_variance) {
+            throw std::invalid_argument("--pca and --pca-basis are mutually exclusive");
+        }
+        if (pca.fixed_basis && format != microregime::OutputFormat::Csv) {
+            throw std::invalid_argument("--pca-basis writes CSV only");
+        }
+        microregime::PcaStage* pca_stage = pca_enabled ? &pca : nullptr;
+        if (dates.size() == 1) {
+            microregime::run_feature_extraction(dates.front(), base_asset, future, configs, pipelined, format, async,
+                                                pca_stage);
+            pca.save();
+            std::cout << "Feature extraction completed successfully. Check the 'output' directory for CSV files.\n";
+            return 0;
+        }
+        size_t failed = microregime::run_multi_day_extraction(dates, base_asset, future,
+                                                              configs, jobs, pipelined, format, async, pca_stage);
+        pca.save();
+        return failed == 0 ? 0 : 1;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
         return 1;
     }
-    
-    return 0;
-}
\ No newline at end of file
+}
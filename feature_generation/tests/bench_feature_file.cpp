@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <common_constants.hpp>
+#include <feature_file.hpp>
+#include <feature_set.hpp>
+#include <pipeline_config.hpp>
+
+using namespace std::chrono;
+using namespace microregime;
+namespace fs = std::filesystem;
+
+namespace {
+
+// features_to_csv's row formatting: raw and normalized rows, every value in
+// %.15e, as the baseline
+void write_csv_row(std::ofstream& csv, uint64_t timestamp_ns, const FeatureSet& fs) {
+    csv << timestamp_ns << ",SPY";
+    csv << std::setprecision(15) << std::scientific;
+    for (auto member : kFeatureMembers) csv << ',' << fs.*member;
+    csv << '\n';
+}
+
+} // namespace
+
+// Time spent on the pipeline thread per snapshot, for a day of snapshots
+TEST(FeatureFileBenchmark, PerSnapshotIngestCost) {
+    std::mt19937_64 rng(3);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<FeatureSet> inputs(50'000);
+    for (size_t t = 0; t < inputs.size(); ++t) {
+        inputs[t].timestamp_ns = t * SNAPSHOT_INTERVAL_NS;
+        for (auto member : kFeatureMembers) inputs[t].*member = noise(rng);
+    }
+    fs::path dir = fs::temp_directory_path() / "feature_file_bench";
+    fs::create_directories(dir);
+
+    auto start = high_resolution_clock::now();
+    {
+        std::ofstream raw(dir / "SPY.csv"), norm(dir / "SPY_norm.csv");
+        for (const auto& fs : inputs) {
+            write_csv_row(raw, fs.timestamp_ns, fs);
+            write_csv_row(norm, fs.timestamp_ns, fs);
+        }
+    }
+    double csv_ns = duration_cast<duration<double, std::nano>>(high_resolution_clock::now() - start).count();
+
+    start = high_resolution_clock::now();
+    double ingest_ns = 0.0;
+    {
+        FeatureFileWriter writer((dir / "SPY.features").string(), "SPY", "20250505", PipelineConfig{});
+        for (const auto& fs : inputs) writer.ingest_feature_set("SPY", fs.timestamp_ns, fs, fs);
+        ingest_ns = duration_cast<duration<double, std::nano>>(high_resolution_clock::now() - start).count();
+        writer.finish();
+    }
+    double binary_ns = duration_cast<duration<double, std::nano>>(high_resolution_clock::now() - start).count();
+
+    FeatureFileReader reader((dir / "SPY.features").string());
+    EXPECT_EQ(reader.row_count(), inputs.size());
+    uintmax_t csv_bytes = fs::file_size(dir / "SPY.csv") + fs::file_size(dir / "SPY_norm.csv");
+    uintmax_t binary_bytes = fs::file_size(dir / "SPY.features");
+    fs::remove_all(dir);
+
+    const double n = static_cast<double>(inputs.size());
+    std::cout << "Wrote " << inputs.size() << " snapshots of " << kFeatureCount << " features, raw + normalized\n"
+              << "  CSV:            " << csv_ns / n << " ns/snapshot, " << csv_bytes / 1024 << " KB\n"
+              << "  Feature file:   " << ingest_ns / n << " ns/snapshot on the pipeline thread, "
+              << binary_ns / n << " ns/snapshot with finish(), " << binary_bytes / 1024 << " KB\n"
+              << "  Pipeline thread speedup: " << csv_ns / ingest_ns << "x" << std::endl;
+}
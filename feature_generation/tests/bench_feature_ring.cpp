@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <feature_ring.hpp>
+#include <feature_set.hpp>
+
+using namespace std::chrono;
+using namespace microregime;
+
+namespace {
+
+uint64_t now_ns() {
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// Publish cost on the pipeline thread, and publish-to-read latency for a
+// reader spinning on try_read (the timestamp field carries the publish time)
+TEST(FeatureRingBenchmark, ThroughputAndLatency) {
+    const std::string name = "/microregime_bench_" + std::to_string(getpid());
+    FeatureSet fs{};
+    for (auto member : kFeatureMembers) fs.*member = 1.5;
+
+    constexpr uint64_t kThroughputRecords = 1'000'000;
+    double publish_ns = 0.0;
+    {
+        FeatureRingWriter writer(name);
+        auto start = steady_clock::now();
+        for (uint64_t n = 0; n < kThroughputRecords; ++n) writer.ingest_feature_set("SPY", n, fs, fs);
+        publish_ns = duration_cast<duration<double, std::nano>>(steady_clock::now() - start).count();
+    }
+
+    // Paced at one record per ~2 us so the reader is never lapped
+    constexpr uint64_t kLatencyRecords = 100'000;
+    FeatureRingWriter writer(name);
+    FeatureRingReader reader(name);
+    std::thread producer([&] {
+        for (uint64_t n = 0; n < kLatencyRecords; ++n) {
+            uint64_t due = now_ns() + 2'000;
+            while (now_ns() < due) {}
+            writer.ingest_feature_set("SPY", now_ns(), fs, fs);
+        }
+    });
+    std::vector<uint64_t> latencies;
+    latencies.reserve(kLatencyRecords);
+    RingRecord record;
+    while (reader.next_index() < kLatencyRecords) {
+        if (reader.try_read(record)) latencies.push_back(now_ns() - record.timestamp_ns);
+    }
+    producer.join();
+    EXPECT_EQ(latencies.size() + reader.missed(), kLatencyRecords);
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies[static_cast<size_t>(p * (latencies.size() - 1))]; };
+    std::cout << "Shared-memory ring, " << sizeof(feature_ring::Slot) << "-byte records\n"
+              << "  Publish:  " << publish_ns / kThroughputRecords << " ns/record ("
+              << kThroughputRecords / (publish_ns / 1e9) / 1e6 << " M records/s)\n"
+              << "  Latency:  p50 " << percentile(0.5) << " ns, p99 " << percentile(0.99)
+              << " ns, max " << latencies.back() << " ns, missed " << reader.missed() << std::endl;
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <feature_set.hpp>
+#include <streaming_pca.hpp>
+
+using namespace std::chrono;
+using namespace microregime;
+
+// Per snapshot over all 19 features: one Welford update (what a --pca fit
+// adds) and one projection (what --pca-basis adds), plus a 19x19 Jacobi
+// eigendecomposition every 4096 snapshots
+TEST(StreamingPcaBenchmark, PerSnapshotCost) {
+    constexpr size_t kSnapshots = 200'000;
+    std::mt19937_64 rng(6);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<FeatureSet> snapshots(1024);
+    for (auto& snapshot : snapshots) {
+        double common = noise(rng);
+        for (auto member : kFeatureMembers) snapshot.*member = common + 0.5 * noise(rng);
+    }
+
+    StreamingPca pca;
+    std::vector<double> components(kFeatureCount);
+    double sum = 0.0;
+    auto start = high_resolution_clock::now();
+    for (size_t t = 0; t < kSnapshots; ++t) {
+        const FeatureSet& snapshot = snapshots[t % snapshots.size()];
+        pca.update(snapshot);
+        if (pca.project(snapshot, components)) sum += components[0];
+    }
+    double ns = duration_cast<duration<double, std::nano>>(high_resolution_clock::now() - start).count();
+    EXPECT_TRUE(pca.ready());
+    EXPECT_TRUE(std::isfinite(sum));
+
+    start = high_resolution_clock::now();
+    for (int i = 0; i < 100; ++i) pca.refresh();
+    double refresh_us = duration_cast<duration<double, std::micro>>(high_resolution_clock::now() - start).count() / 100;
+
+    std::cout << "Streaming PCA, " << kFeatureCount << " features -> " << pca.components()
+              << " components: " << ns / kSnapshots << " ns/snapshot, " << refresh_us << " us/refresh" << std::endl;
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <async_reciever.hpp>
+#include <data_reciever.hpp>
+#include <feature_normalizer.hpp>
+#include <feature_set.hpp>
+
+using namespace microregime;
+
+namespace {
+
+// Keeps timestamps and variant counts; can be held shut, slowed down or made to fail
+class GatedReceiver : public DataReciever {
+public:
+    std::vector<uint64_t> timestamps;
+    std::vector<std::string> symbols;
+    std::vector<size_t> variant_counts;
+    std::atomic<bool> open{true};
+    std::chrono::microseconds delay{0};
+    uint64_t fail_at = UINT64_MAX;
+
+    void ingest_feature_set(const std::string& symbol, uint64_t timestamp_ns, const FeatureSet&,
+                            const FeatureSet&) override {
+        while (!open) std::this_thread::yield();
+        if (timestamp_ns == fail_at) throw std::runtime_error("sink failed");
+        if (delay.count() > 0) std::this_thread::sleep_for(delay);
+        timestamps.push_back(timestamp_ns);
+        symbols.push_back(symbol);
+        variant_counts.push_back(0);
+    }
+
+    void ingest_normalization_variants(const std::string&, uint64_t,
+                                       std::span<const NormalizationHorizon> horizons,
+                                       std::span<const FeatureSet> normalized) override {
+        ASSERT_EQ(horizons.size(), normalized.size());
+        variant_counts.back() = normalized.size();
+    }
+};
+
+void ingest(DataReciever& reciever, uint64_t timestamp_ns, size_t variants = 0, const std::string& symbol = "SPY") {
+    FeatureSet fs{};
+    fs.timestamp_ns = timestamp_ns;
+    reciever.ingest_feature_set(symbol, timestamp_ns, fs, fs);
+    if (variants > 0) {
+        std::vector<NormalizationHorizon> horizons(variants);
+        std::vector<FeatureSet> normalized(variants, fs);
+        reciever.ingest_normalization_variants(symbol, timestamp_ns, horizons, normalized);
+    }
+}
+
+} // namespace
+
+TEST(AsyncRecieverTest, DeliversEveryRowInOrderWithItsVariants) {
+    GatedReceiver inner;
+    inner.delay = std::chrono::microseconds(20);
+    {
+        AsyncReciever async(inner, 16);
+        for (uint64_t t = 0; t < 500; ++t) ingest(async, t, t % 2 ? 3 : 0);
+        async.finish();
+
+        AsyncRecieverStats stats = async.stats();
+        EXPECT_EQ(stats.queued, 500u);
+        EXPECT_EQ(stats.delivered, 500u);
+        EXPECT_EQ(stats.dropped, 0u);
+        EXPECT_GT(stats.stalled, 0u);  // A slow sink pushes back on the pipeline
+    }
+    ASSERT_EQ(inner.timestamps.size(), 500u);
+    for (uint64_t t = 0; t < 500; ++t) {
+        EXPECT_EQ(inner.timestamps[t], t);
+        EXPECT_EQ(inner.variant_counts[t], t % 2 ? 3u : 0u);
+    }
+}
+
+TEST(AsyncRecieverTest, DropPolicyNeverBlocksAndCountsWhatItLoses) {
+    GatedReceiver inner;
+    inner.open = false;
+    AsyncReciever async(inner, 8, AsyncReciever::Overflow::Drop);
+    for (uint64_t t = 0; t < 100; ++t) ingest(async, t);
+    inner.open = true;
+    async.finish();
+
+    AsyncRecieverStats stats = async.stats();
+    EXPECT_EQ(stats.queued + stats.dropped, 100u);
+    EXPECT_GT(stats.dropped, 0u);
+    EXPECT_EQ(stats.stalled, 0u);
+    EXPECT_EQ(stats.delivered, stats.queued);
+    EXPECT_EQ(inner.timestamps.size(), stats.delivered);
+    // A full queue, the row the writer was stuck on, and the last row queued by finish()
+    EXPECT_LE(stats.queued, async.capacity() + 2);
+}
+
+TEST(AsyncRecieverTest, SinkFailureReachesThePipelineThread) {
+    GatedReceiver inner;
+    inner.fail_at = 10;
+    AsyncReciever async(inner, 4);
+    EXPECT_THROW(
+        {
+            for (uint64_t t = 0; t < 100'000; ++t) ingest(async, t);
+        },
+        std::runtime_error);
+    EXPECT_THROW(async.finish(), std::runtime_error);
+    EXPECT_EQ(inner.timestamps.size(), 10u);
+    EXPECT_THROW(ingest(async, 1), std::logic_error);
+}
+
+TEST(AsyncRecieverTest, SymbolsSurviveTheQueueAndRowsHaveABoundedWidth) {
+    GatedReceiver inner;
+    AsyncReciever async(inner, 8);
+    for (uint64_t t = 0; t < 40; ++t) ingest(async, t, 0, t % 3 ? "SPY" : "ES");
+    EXPECT_THROW(ingest(async, 40, AsyncReciever::kMaxHorizons + 1), std::invalid_argument);
+    async.finish();
+    ASSERT_EQ(inner.symbols.size(), 41u);
+    for (uint64_t t = 0; t < 40; ++t) EXPECT_EQ(inner.symbols[t], t % 3 ? "SPY" : "ES");
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <feature_file.hpp>
+#include <feature_set.hpp>
+#include <pipeline_config.hpp>
+
+using namespace microregime;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Row {
+    uint64_t timestamp_ns;
+    std::vector<FeatureSet> groups;  // raw, then one per horizon
+};
+
+FeatureSet random_feature_set(std::mt19937_64& rng, uint64_t t) {
+    std::normal_distribution<double> noise(0.0, 100.0);
+    FeatureSet fs{};
+    fs.timestamp_ns = t;
+    for (size_t i = 0; i < kFeatureCount; ++i) fs.*kFeatureMembers[i] = noise(rng);
+    return fs;
+}
+
+// Feeds `rows` the way DualFeaturePipeline does and returns what was fed
+std::vector<Row> write_rows(FeatureFileWriter& writer, const PipelineConfig& config, size_t rows) {
+    std::mt19937_64 rng(17);
+    std::vector<Row> written;
+    for (size_t r = 0; r < rows; ++r) {
+        Row row{1'746'000'000'000'000'000ull + r * config.snapshot_interval_ns, {}};
+        for (size_t g = 0; g <= config.horizons.size(); ++g) row.groups.push_back(random_feature_set(rng, row.timestamp_ns));
+        writer.ingest_feature_set("SPY", row.timestamp_ns, row.groups[0], row.groups[1]);
+        if (config.horizons.size() > 1) {
+            std::vector<FeatureSet> variants(row.groups.begin() + 1, row.groups.end());
+            writer.ingest_normalization_variants("SPY", row.timestamp_ns, config.horizons, variants);
+        }
+        written.push_back(std::move(row));
+    }
+    return written;
+}
+
+PipelineConfig three_horizons() {
+    PipelineConfig config;
+    config.horizons = {NormalizationHorizon::window(WINDOW_SIZE), NormalizationHorizon::window(200),
+                       NormalizationHorizon::ewm(50.0)};
+    return config;
+}
+
+class FeatureFileTest : public ::testing::Test {
+protected:
+    fs::path dir_ = fs::temp_directory_path() / "feature_file_test";
+    std::string path_ = (dir_ / "SPY.features").string();
+
+    void SetUp() override {
+        fs::remove_all(dir_);
+        fs::create_directories(dir_);
+    }
+    void TearDown() override { fs::remove_all(dir_); }
+};
+
+} // namespace
+
+TEST_F(FeatureFileTest, RoundTripsEveryGroupBitForBit) {
+    PipelineConfig config = three_horizons();
+    std::vector<Row> written;
+    {
+        // A block size that leaves a partial last block
+        FeatureFileWriter writer(path_, "SPY", "20250505", config, 7);
+        written = write_rows(writer, config, 52);
+    }
+    EXPECT_FALSE(fs::exists(path_ + ".tmp"));
+
+    FeatureFileReader reader(path_);
+    ASSERT_EQ(reader.row_count(), written.size());
+    EXPECT_EQ(reader.instrument(), "SPY");
+    EXPECT_EQ(reader.date(), "20250505");
+    EXPECT_EQ(reader.config(), config.label());
+    EXPECT_EQ(reader.groups(), (std::vector<std::string>{"raw", "w30000", "w200", "ewm50"}));
+
+    for (size_t r = 0; r < written.size(); ++r) {
+        EXPECT_EQ(reader.timestamps()[r], written[r].timestamp_ns);
+        for (size_t g = 0; g < written[r].groups.size(); ++g) {
+            FeatureSet read = reader.row(g, r);
+            for (size_t i = 0; i < kFeatureCount; ++i) {
+                ASSERT_EQ(std::bit_cast<uint64_t>(read.*kFeatureMembers[i]),
+                          std::bit_cast<uint64_t>(written[r].groups[g].*kFeatureMembers[i]))
+                    << reader.groups()[g] << " " << kFeatureNames[i] << " row " << r;
+            }
+        }
+    }
+    EXPECT_EQ(reader.column("w200", Feature::ofi)[3], written[3].groups[2].ofi);
+    EXPECT_THROW(reader.column("ewm600", Feature::ofi), std::out_of_range);
+}
+
+TEST_F(FeatureFileTest, ColumnsAre64ByteAligned) {
+    PipelineConfig config;
+    {
+        FeatureFileWriter writer(path_, "ES", "20250505", config, 4);
+        write_rows(writer, config, 13);  // In columns sized for a whole session
+    }
+    FeatureFileReader reader(path_);
+    EXPECT_EQ(reader.groups().size(), 2u);
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        auto column = reader.column(1, static_cast<Feature>(i));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(column.data()) % feature_file::kColumnAlignment, 0u);
+    }
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(reader.timestamps().data()) % feature_file::kColumnAlignment, 0u);
+}
+
+TEST_F(FeatureFileTest, ExactlyFullBlocksAndEmptyFilesRoundTrip) {
+    PipelineConfig config;
+    for (size_t rows : {0u, 8u, 16u}) {
+        std::vector<Row> written;
+        {
+            FeatureFileWriter writer(path_, "SPY", "20250505", config, 8);
+            written = write_rows(writer, config, rows);
+            writer.finish();
+            EXPECT_EQ(writer.row_count(), rows);
+        }
+        FeatureFileReader reader(path_);
+        ASSERT_EQ(reader.row_count(), rows);
+        for (size_t r = 0; r < rows; ++r) {
+            EXPECT_EQ(reader.row(1, r).log_spread, written[r].groups[1].log_spread);
+        }
+    }
+}
+
+TEST_F(FeatureFileTest, DaysLongerThanTheReservedSessionRoundTrip) {
+    PipelineConfig config = three_horizons();
+    config.snapshot_interval_ns = 2'340'000'000'000;  // 10 snapshots a session, 12 rows reserved
+    std::vector<Row> written;
+    {
+        FeatureFileWriter writer(path_, "SPY", "20250505", config, 4);
+        written = write_rows(writer, config, 101);  // Columns move four times
+    }
+    FeatureFileReader reader(path_);
+    ASSERT_EQ(reader.row_count(), written.size());
+    for (size_t r = 0; r < written.size(); ++r) {
+        ASSERT_EQ(reader.timestamps()[r], written[r].timestamp_ns);
+        for (size_t g = 0; g < written[r].groups.size(); ++g) {
+            for (size_t i = 0; i < kFeatureCount; ++i) {
+                ASSERT_EQ(std::bit_cast<uint64_t>(reader.column(g, static_cast<Feature>(i))[r]),
+                          std::bit_cast<uint64_t>(written[r].groups[g].*kFeatureMembers[i]))
+                    << reader.groups()[g] << " " << kFeatureNames[i] << " row " << r;
+            }
+        }
+    }
+}
+
+TEST_F(FeatureFileTest, RejectsCorruptFiles) {
+    PipelineConfig config;
+    {
+        FeatureFileWriter writer(path_, "SPY", "20250505", config);
+        write_rows(writer, config, 10);
+    }
+    auto size = fs::file_size(path_);
+
+    // Wrong magic
+    {
+        std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+        file.write("NOTFEATS", 8);
+    }
+    EXPECT_THROW(FeatureFileReader{path_}, std::runtime_error);
+
+    // Right magic, truncated data
+    {
+        std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+        file.write(feature_file::kMagic, 8);
+    }
+    EXPECT_NO_THROW(FeatureFileReader{path_});
+    fs::resize_file(path_, size - 64);
+    EXPECT_THROW(FeatureFileReader{path_}, std::runtime_error);
+}
+
+TEST_F(FeatureFileTest, RejectsVariantsThatDontMatchTheConfig) {
+    PipelineConfig config = three_horizons();
+    FeatureFileWriter writer(path_, "SPY", "20250505", config);
+    FeatureSet fs{};
+    writer.ingest_feature_set("SPY", 1, fs, fs);
+    std::vector<FeatureSet> two(2);
+    EXPECT_THROW(writer.ingest_normalization_variants("SPY", 1, config.horizons, two), std::invalid_argument);
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <common_constants.hpp>
+#include <feature_normalizer.hpp>
+#include <feature_set.hpp>
+
+using namespace microregime;
+
+namespace {
+
+// Features with very different scales, some with a level far above their
+// spread (like midprice), which is what makes naive sum / sum-of-squares cancel
+FeatureSet random_feature_set(std::mt19937_64& rng, uint64_t t) {
+    std::normal_distribution<double> noise(0.0, 1.0);
+    FeatureSet fs{};
+    fs.timestamp_ns = t;
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        double scale = std::pow(10.0, static_cast<double>(i % 7) - 3.0);
+        double offset = (i % 3 == 0) ? 5000.0 * scale : 0.0;
+        fs.*kFeatureMembers[i] = offset + scale * noise(rng);
+    }
+    fs.order_arrival_rate = 4.0;  // Constant: variance is exactly zero
+    return fs;
+}
+
+} // namespace
+
+TEST(FeatureNormalizerTest, MatchesTwoPassZScoresOverAFullDay) {
+    std::mt19937_64 rng(21);
+    FeatureNormalizer normalizer;
+    std::deque<FeatureSet> window;
+
+    // A day of 0.5s snapshots is ~47k, so this covers several rebases and evictions
+    for (uint64_t t = 0; t < 2 * WINDOW_SIZE + 12345; ++t) {
+        FeatureSet fs = random_feature_set(rng, t);
+        normalizer.AddFeatureSet(fs);
+        window.push_back(fs);
+        if (window.size() > WINDOW_SIZE) window.pop_front();
+        FeatureSet z = normalizer.NormalizeFeatureSet(fs);
+
+        if (t % 4999 != 0 && t + 1 != 2 * WINDOW_SIZE + 12345) continue;
+        for (size_t i = 0; i < kFeatureCount; ++i) {
+            auto member = kFeatureMembers[i];
+            double mean = 0.0;
+            for (const auto& row : window) mean += row.*member;
+            mean /= window.size();
+            double m2 = 0.0;
+            for (const auto& row : window) m2 += (row.*member - mean) * (row.*member - mean);
+            double variance = m2 / window.size();
+            double expected = (variance > 0.0) ? (fs.*member - mean) / std::sqrt(variance) : fs.*member - mean;
+            EXPECT_NEAR(z.*member, expected, 1e-9 * std::max(1.0, std::abs(expected)))
+                << kFeatureNames[i] << " at snapshot " << t;
+        }
+    }
+}
+
+TEST(FeatureNormalizerTest, CountsDegenerateVarianceInsteadOfLogging) {
+    std::mt19937_64 rng(4);
+    FeatureNormalizer normalizer;
+    for (uint64_t t = 0; t < 100; ++t) {
+        FeatureSet fs = random_feature_set(rng, t);
+        normalizer.AddFeatureSet(fs);
+        FeatureSet z = normalizer.NormalizeFeatureSet(fs);
+        EXPECT_EQ(z.order_arrival_rate, 0.0);
+    }
+
+    const auto& counts = normalizer.degenerate_variance_counts();
+    EXPECT_EQ(counts[feature_index(Feature::order_arrival_rate)], 100u);
+    // Every other feature is degenerate only for the first, single-row window
+    EXPECT_EQ(counts[feature_index(Feature::ofi)], 1u);
+}
+
+TEST(FeatureNormalizerTest, EveryHorizonMatchesItsOwnSingleHorizonRun) {
+    const std::vector<NormalizationHorizon> horizons = {
+        NormalizationHorizon::window(500), NormalizationHorizon::window(50), NormalizationHorizon::ewm(20.0)};
+    FeatureNormalizer combined(horizons);
+    std::vector<FeatureNormalizer> single;
+    for (const auto& horizon : horizons) single.emplace_back(std::vector<NormalizationHorizon>{horizon});
+
+    std::mt19937_64 rng(9);
+    std::vector<FeatureSet> all(horizons.size());
+    for (uint64_t t = 0; t < 1700; ++t) {
+        FeatureSet fs = random_feature_set(rng, t);
+        combined.AddFeatureSet(fs);
+        combined.NormalizeAll(fs, all);
+        for (size_t h = 0; h < horizons.size(); ++h) {
+            single[h].AddFeatureSet(fs);
+            FeatureSet expected = single[h].NormalizeFeatureSet(fs);
+            for (size_t i = 0; i < kFeatureCount; ++i) {
+                ASSERT_EQ(all[h].*kFeatureMembers[i], expected.*kFeatureMembers[i])
+                    << horizons[h].label() << " " << kFeatureNames[i] << " at snapshot " << t;
+            }
+        }
+    }
+}
+
+TEST(FeatureNormalizerTest, EwmMeanMovesHalfwayInOneHalfLife) {
+    FeatureNormalizer normalizer({NormalizationHorizon::ewm(10.0)});
+    FeatureSet fs{};
+    for (int t = 0; t < 100; ++t) normalizer.AddFeatureSet(fs);
+    fs.ofi = 1.0;
+    for (int t = 0; t < 10; ++t) normalizer.AddFeatureSet(fs);
+
+    // z = (1 - mean) / stddev with mean = 0.5 after one half-life; undo the scaling via a second point
+    FeatureSet at_one = normalizer.NormalizeFeatureSet(fs);
+    fs.ofi = 0.0;
+    FeatureSet at_zero = normalizer.NormalizeFeatureSet(fs);
+    double stddev = 1.0 / (at_one.ofi - at_zero.ofi);
+    EXPECT_NEAR(-at_zero.ofi * stddev, 0.5, 1e-12);
+}
+
+TEST(FeatureNormalizerTest, HorizonLabelsRoundTrip) {
+    for (const char* text : {"w30000", "w1000", "ewm600", "ewm12.5"}) {
+        EXPECT_EQ(NormalizationHorizon::parse(text).label(), text);
+    }
+    EXPECT_EQ(NormalizationHorizon::parse("1000").label(), "w1000");
+    for (const char* bad : {"", "w", "w0", "w1.5", "ewm", "ewm-3", "x100", "w100x"}) {
+        EXPECT_THROW(NormalizationHorizon::parse(bad), std::invalid_argument) << bad;
+    }
+}
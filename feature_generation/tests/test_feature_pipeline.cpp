@@ -5,10 +5,18 @@
 #include <string>
 #include <deque>
 #include <cmath>
+#include <bit>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
 
+#include <async_reciever.hpp>
 #include <dual_feature_pipeline.hpp>
+#include <pipeline_config.hpp>
 #include <feature_set.hpp>
 #include <data_reciever.hpp>
+#include <event_cache.hpp>
 
 using namespace microregime;
 namespace fs = std::filesystem;
@@ -17,7 +25,7 @@ namespace fs = std::filesystem;
 void print_features(const FeatureSet& fs, const std::string& label) {
     std::cout << "\n=== " << label << " ===\n"
               << "Timestamp: " << fs.timestamp_ns << "\n"
-              << "Symbol:    " << fs.instrument << "\n"
+              << "Symbol:    " << symbol_name(fs.instrument) << "\n"
               << "Log Spread: " << fs.log_spread << "\n"
               << "Order Flow Imbalance: " << fs.ofi << "\n"
               << "Market Depth: " << fs.market_depth << "\n"
@@ -57,16 +65,14 @@ TEST(DualFeaturePipelineTest, AlignedSnapshots) {
     //     GTEST_SKIP() << "Missing required data files";
     // }
 
-    DualFeaturePipeline pipeline("20250505", "SPY", "ES");
+    PipelineConfig config;
+    config.snapshot_interval_ns = 50'000'000'000;   // 50 s snapshot interval
+    DualFeaturePipeline pipeline("20250505", "SPY", "ES", {config});
 
     TestReceiver base_recv;
     TestReceiver fut_recv;
 
-    pipeline.run(
-        50'000'000'000,   // 50 s snapshot interval
-        base_recv,
-        fut_recv
-    );
+    pipeline.run(base_recv, fut_recv);
 
     ASSERT_EQ(base_recv.snapshots.size(), fut_recv.snapshots.size());
 
@@ -86,6 +92,235 @@ TEST(DualFeaturePipelineTest, AlignedSnapshots) {
               << "- Aligned snapshots: " << count << "\n";
 }
 
+namespace {
+
+// Receiver that keeps every snapshot, bit for bit
+class RecordingReceiver : public DataReciever {
+public:
+    std::vector<std::string> rows;
+
+    void ingest_feature_set(const std::string& symbol,
+                            uint64_t timestamp_ns,
+                            const FeatureSet& raw_features,
+                            const FeatureSet& norm_features) override {
+        rows.push_back(symbol + " " + std::to_string(timestamp_ns) + " " +
+                       bits(raw_features) + " | " + bits(norm_features));
+    }
+
+    void ingest_normalization_variants(const std::string& symbol,
+                                       uint64_t timestamp_ns,
+                                       std::span<const NormalizationHorizon> horizons,
+                                       std::span<const FeatureSet> normalized) override {
+        for (size_t h = 0; h < horizons.size(); ++h) {
+            rows.push_back(symbol + " " + std::to_string(timestamp_ns) + " " + horizons[h].label() + " " +
+                           bits(normalized[h]));
+        }
+    }
+
+private:
+    static std::string bits(const FeatureSet& fs) {
+        std::string out = symbol_name(fs.instrument);
+        for (auto member : kFeatureMembers) {
+            out += " " + std::to_string(std::bit_cast<uint64_t>(fs.*member));
+        }
+        return out;
+    }
+};
+
+// Random but well-formed MBO stream for one instrument around the 2025-05-05 open
+void write_synthetic_day(const fs::path& file, const std::string& instrument, int64_t tick,
+                         int64_t start_price, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    EventCacheWriter writer(file.string(), instrument);
+
+    const uint64_t open_ns = 1746451800ull * 1'000'000'000;  // 2025-05-05 13:30 UTC
+    uint64_t timestamp = open_ns - 60'000'000'000;
+    const uint64_t end = open_ns + 240'000'000'000;
+    int64_t mid = start_price;
+    uint64_t next_order_id = 1;
+    std::vector<std::pair<uint64_t, MarketEvent>> live;
+
+    while (timestamp < end) {
+        timestamp += rng() % 6'000'000;
+        if (rng() % 50 == 0) mid += (rng() % 2 ? tick : -tick);
+
+        MarketEvent event{};
+        event.timestamp_ns = timestamp;
+        event.symbol = intern_symbol(instrument);
+        event.instrument_id = 4916;
+
+        unsigned roll = rng() % 10;
+        if (roll < 5 || live.empty()) {
+            bool bid = rng() % 2;
+            event.action = 'A';
+            event.side = bid ? 'B' : 'A';
+            int64_t offset = static_cast<int64_t>(1 + rng() % 10) * tick;
+            event.price = bid ? mid - offset : mid + offset;
+            event.size = static_cast<int>(1 + rng() % 100);
+            event.order_id = next_order_id++;
+            live.push_back({event.order_id, event});
+        } else {
+            size_t pick = rng() % live.size();
+            MarketEvent& order = live[pick].second;
+            event.order_id = order.order_id;
+            event.side = order.side;
+            event.price = order.price;
+            if (roll < 8) {
+                event.action = 'C';
+                event.size = order.size;
+                live[pick] = live.back();
+                live.pop_back();
+            } else if (roll < 9) {
+                event.action = 'M';
+                event.size = std::max(1, order.size - 1);
+                order.size = event.size;
+            } else {
+                event.action = 'T';
+                event.size = static_cast<int>(1 + rng() % 10);
+                // Some ES trades in another contract month, which the engine filters out
+                if (instrument == "ES" && rng() % 4 == 0) event.instrument_id = 1234;
+            }
+        }
+        writer.append(event);
+    }
+    writer.finish();
+}
+
+// Synthetic SPY / ES event caches for 20250505, with the working directory
+// moved to where input_path looks for them (../../data) until destruction
+class SyntheticDay {
+public:
+    SyntheticDay() : root_{fs::temp_directory_path() / "dual_pipeline_test"}, original_dir_{fs::current_path()} {
+        fs::remove_all(root_);
+        fs::create_directories(root_ / "data" / "SPY");
+        fs::create_directories(root_ / "data" / "ES");
+        fs::create_directories(root_ / "run" / "here");
+        write_synthetic_day(root_ / "data" / "SPY" / "xnas-itch-20250505.mbo.events", "SPY",
+                            10'000'000, 560'000'000'000, 1);
+        write_synthetic_day(root_ / "data" / "ES" / "glbx-mdp3-20250505.mbo.events", "ES",
+                            ES_TICK_SIZE, 5'600'000'000'000, 2);
+        fs::current_path(root_ / "run" / "here");
+    }
+
+    ~SyntheticDay() {
+        fs::current_path(original_dir_);
+        fs::remove_all(root_);
+    }
+
+private:
+    fs::path root_;
+    fs::path original_dir_;
+};
+
+} // namespace
+
+TEST(DualFeaturePipelineTest, PipelinedMatchesSequential) {
+    SyntheticDay day;
+
+    // Several horizons, so the variant deliveries are compared too
+    PipelineConfig config;
+    config.horizons = {
+        NormalizationHorizon::window(WINDOW_SIZE), NormalizationHorizon::window(200), NormalizationHorizon::ewm(50.0)};
+
+    RecordingReceiver sequential_base, sequential_future;
+    {
+        DualFeaturePipeline pipeline("20250505", "SPY", "ES", {config});
+        pipeline.run(sequential_base, sequential_future);
+    }
+    RecordingReceiver pipelined_base, pipelined_future;
+    {
+        DualFeaturePipeline pipeline("20250505", "SPY", "ES", {config});
+        pipeline.run_pipelined(pipelined_base, pipelined_future);
+    }
+
+    ASSERT_GT(sequential_base.rows.size(), 400u);
+    EXPECT_EQ(pipelined_base.rows, sequential_base.rows);
+    EXPECT_EQ(pipelined_future.rows, sequential_future.rows);
+}
+
+TEST(DualFeaturePipelineTest, FannedOutConfigsMatchSeparateRuns) {
+    SyntheticDay day;
+
+    // Different intervals, windows, depths and horizons over the same replay
+    std::vector<PipelineConfig> configs = {
+        PipelineConfig{},
+        PipelineConfig::parse("interval_ns=250000000,rolling=400,midprice=600,depth=5,horizons=w200+ewm50"),
+        PipelineConfig::parse("interval_ns=1300000000,rolling=3000,depth=2,horizons=ewm20"),
+    };
+
+    std::vector<std::vector<std::string>> separate(configs.size());
+    for (size_t c = 0; c < configs.size(); ++c) {
+        RecordingReceiver base, future;
+        DualFeaturePipeline pipeline("20250505", "SPY", "ES", {configs[c]});
+        pipeline.run(base, future);
+        separate[c] = base.rows;
+        separate[c].insert(separate[c].end(), future.rows.begin(), future.rows.end());
+    }
+    ASSERT_NE(separate[1].size(), separate[0].size());
+
+    for (bool pipelined : {false, true}) {
+        std::vector<RecordingReceiver> base(configs.size()), future(configs.size());
+        std::vector<PipelineOutput> outputs;
+        for (size_t c = 0; c < configs.size(); ++c) outputs.push_back({&base[c], &future[c]});
+
+        DualFeaturePipeline pipeline("20250505", "SPY", "ES", configs);
+        if (pipelined) {
+            pipeline.run_pipelined(outputs);
+        } else {
+            pipeline.run(outputs);
+        }
+        for (size_t c = 0; c < configs.size(); ++c) {
+            std::vector<std::string> rows = base[c].rows;
+            rows.insert(rows.end(), future[c].rows.begin(), future[c].rows.end());
+            EXPECT_EQ(rows, separate[c]) << configs[c].label() << (pipelined ? " pipelined" : "");
+        }
+    }
+
+    EXPECT_THROW(DualFeaturePipeline("20250505", "SPY", "ES", {}), std::invalid_argument);
+}
+
+TEST(DualFeaturePipelineTest, AsyncRecieversMatchDirectDelivery) {
+    SyntheticDay day;
+
+    PipelineConfig config;
+    config.horizons = {NormalizationHorizon::window(WINDOW_SIZE), NormalizationHorizon::ewm(50.0)};
+
+    RecordingReceiver direct_base, direct_future;
+    DualFeaturePipeline("20250505", "SPY", "ES", {config}).run(direct_base, direct_future);
+
+    RecordingReceiver base, future;
+    {
+        // Small queues so the run goes through back-pressure too
+        AsyncReciever async_base(base, 8), async_future(future, 8);
+        DualFeaturePipeline("20250505", "SPY", "ES", {config}).run_pipelined(async_base, async_future);
+        async_base.finish();
+        async_future.finish();
+        // One row plus one per horizon for every snapshot
+        EXPECT_EQ(async_base.stats().delivered, direct_base.rows.size() / 3);
+        EXPECT_EQ(async_base.stats().dropped, 0u);
+    }
+    EXPECT_EQ(base.rows, direct_base.rows);
+    EXPECT_EQ(future.rows, direct_future.rows);
+}
+
+TEST(PipelineConfigTest, LabelsRoundTrip) {
+    PipelineConfig defaults;
+    EXPECT_EQ(defaults.label(), "interval_ns=500000000,rolling=1500,midprice=1800,depth=10,horizons=w30000");
+    EXPECT_EQ(defaults.log_return_lag(), 20u);
+
+    std::string text = "interval_ns=250000000,rolling=400,midprice=600,depth=5,horizons=w200+ewm50";
+    EXPECT_EQ(PipelineConfig::parse(text).label(), text);
+
+    // Unset keys come from the defaults given
+    PipelineConfig partial = PipelineConfig::parse("depth=4", PipelineConfig::parse(text));
+    EXPECT_EQ(partial.label(), "interval_ns=250000000,rolling=400,midprice=600,depth=4,horizons=w200+ewm50");
+
+    for (const char* bad : {"depth=1", "depth=11", "interval_ns=0", "rolling=-5", "rolling=", "horizons=",
+                            "horizons=w0", "window=5", "depth"}) {
+        EXPECT_THROW(PipelineConfig::parse(bad), std::invalid_argument) << bad;
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
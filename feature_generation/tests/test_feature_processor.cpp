@@ -20,7 +20,7 @@ using namespace microregime;
 void print_feature_set(const FeatureSet& fs, const std::string& title) {
     std::cout << "\n\n\n=== " << title << " ===\n";
     std::cout << "Timestamp: " << fs.timestamp_ns << " ns\n";
-    std::cout << "Symbol: " << fs.instrument << "\n";
+    std::cout << "Symbol: " << symbol_name(fs.instrument) << "\n";
     
     // Price & Spread
     std::cout << "\n--- Price & Spread ---\n";
@@ -89,7 +89,7 @@ TEST_F(FeatureProcessorTest, ProcessSnapshots) {
     EventParser parser(test_file_.string(), instrument_);
     
     // 2. Initialize feature engine and processor
-    FeatureEngine feature_engine(const_cast<OrderBookManager&>(order_engine.get_or_create_order_book(instrument_)), instrument_);
+    FeatureEngine feature_engine(const_cast<PriceLadderBook&>(order_engine.get_or_create_order_book(instrument_)), instrument_);
     FeatureProcessor feature_processor;
     
     // 3. Process events and collect snapshots
@@ -120,7 +120,7 @@ TEST_F(FeatureProcessorTest, ProcessSnapshots) {
             
             // Get raw features first
             auto raw_features = feature_processor.GetRawFeatureSet(snapshot);
-            raw_features.instrument = instrument_;
+            raw_features.instrument = intern_symbol(instrument_);
             raw_features.timestamp_ns = snapshot.timestamp_ns;
             
             // Then get normalized features
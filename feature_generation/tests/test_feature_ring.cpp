@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <bit>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <feature_ring.hpp>
+#include <feature_set.hpp>
+#include <symbol_table.hpp>
+
+using namespace microregime;
+
+namespace {
+
+std::string ring_name(const char* test) {
+    return "/microregime_test_" + std::string(test) + "_" + std::to_string(getpid());
+}
+
+// Every word of record n derives from n, so a torn read can't go unnoticed
+void write_record(FeatureRingWriter& writer, uint64_t n) {
+    FeatureSet raw{}, normalized{};
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        raw.*kFeatureMembers[i] = static_cast<double>(n * 100 + i);
+        normalized.*kFeatureMembers[i] = -static_cast<double>(n * 100 + i) / 7.0;
+    }
+    writer.ingest_feature_set(n % 2 ? "SPY" : "ES", 1'000 + n, raw, normalized);
+}
+
+void expect_record(const RingRecord& record) {
+    const uint64_t n = record.index;
+    ASSERT_EQ(record.timestamp_ns, 1'000 + n);
+    ASSERT_EQ(record.symbol, n % 2 ? "SPY" : "ES");
+    ASSERT_EQ(symbol_name(record.raw.instrument), record.symbol);
+    for (size_t i = 0; i < kFeatureCount; ++i) {
+        ASSERT_EQ(record.raw.*kFeatureMembers[i], static_cast<double>(n * 100 + i)) << "record " << n;
+        ASSERT_EQ(std::bit_cast<uint64_t>(record.normalized.*kFeatureMembers[i]),
+                  std::bit_cast<uint64_t>(-static_cast<double>(n * 100 + i) / 7.0)) << "record " << n;
+    }
+}
+
+} // namespace
+
+TEST(FeatureRingTest, ReaderSeesEveryRecordBitForBit) {
+    FeatureRingWriter writer(ring_name("roundtrip"), 64);
+    FeatureRingReader reader(writer.name());
+    RingRecord record;
+    EXPECT_FALSE(reader.try_read(record));
+
+    for (uint64_t n = 0; n < 50; ++n) write_record(writer, n);
+    for (uint64_t n = 0; n < 50; ++n) {
+        ASSERT_TRUE(reader.try_read(record));
+        EXPECT_EQ(record.index, n);
+        expect_record(record);
+    }
+    EXPECT_FALSE(reader.try_read(record));
+    EXPECT_EQ(reader.missed(), 0u);
+}
+
+TEST(FeatureRingTest, StartPositionsAndLappedReaders) {
+    FeatureRingWriter writer(ring_name("lapped"), 8);
+    FeatureRingReader behind(writer.name());
+    for (uint64_t n = 0; n < 100; ++n) write_record(writer, n);
+
+    // The slot the writer would overwrite next is not trusted, so capacity - 1 survive
+    RingRecord record;
+    ASSERT_TRUE(behind.try_read(record));
+    EXPECT_EQ(record.index, 93u);
+    EXPECT_EQ(behind.missed(), 93u);
+    expect_record(record);
+
+    FeatureRingReader oldest(writer.name(), FeatureRingReader::Start::Oldest);
+    ASSERT_TRUE(oldest.try_read(record));
+    EXPECT_EQ(record.index, 93u);
+    EXPECT_EQ(oldest.missed(), 0u);
+
+    FeatureRingReader latest(writer.name());
+    EXPECT_FALSE(latest.try_read(record));
+    write_record(writer, 100);
+    ASSERT_TRUE(latest.try_read(record));
+    EXPECT_EQ(record.index, 100u);
+}
+
+TEST(FeatureRingTest, ConcurrentReaderNeverSeesATornRecord) {
+    constexpr uint64_t kRecords = 200'000;
+    FeatureRingWriter writer(ring_name("concurrent"), 64);
+    FeatureRingReader reader(writer.name());
+
+    std::thread producer([&] {
+        for (uint64_t n = 0; n < kRecords; ++n) write_record(writer, n);
+    });
+    RingRecord record;
+    uint64_t read = 0;
+    uint64_t last = 0;
+    while (reader.next_index() < kRecords) {
+        if (!reader.try_read(record)) continue;
+        if (read > 0) {
+            EXPECT_GT(record.index, last);
+        }
+        expect_record(record);
+        last = record.index;
+        ++read;
+    }
+    producer.join();
+    EXPECT_EQ(read + reader.missed(), kRecords);
+}
+
+TEST(FeatureRingTest, ClosedOnceTheWriterIsGone) {
+    std::string name = ring_name("closed");
+    auto writer = std::make_unique<FeatureRingWriter>(name, 16);
+    FeatureRingReader reader(name, FeatureRingReader::Start::Oldest);
+    write_record(*writer, 0);
+    EXPECT_FALSE(reader.closed());
+    writer.reset();
+
+    // Still readable through the existing mapping, but the name is gone
+    EXPECT_TRUE(reader.closed());
+    RingRecord record;
+    EXPECT_TRUE(reader.try_read(record));
+    EXPECT_THROW(FeatureRingReader{name}, std::runtime_error);
+}
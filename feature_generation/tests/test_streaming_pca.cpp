@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <async_reciever.hpp>
+#include <data_reciever.hpp>
+#include <feature_set.hpp>
+#include <pca_reciever.hpp>
+#include <streaming_pca.hpp>
+
+using namespace microregime;
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::vector<Feature> kFeatures = {Feature::ewm_volatility, Feature::realized_variance, Feature::ofi,
+                                        Feature::shannon_entropy, Feature::lob_slope, Feature::depth_imbalance};
+
+// Rows driven by two latent factors plus a little noise, in different units per feature
+std::vector<double> two_factor_rows(size_t rows, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    const double loadings[6][2] = {{1.0, 0.0}, {0.8, 0.3}, {0.0, 1.0}, {-0.5, 0.7}, {0.6, -0.6}, {0.2, 0.9}};
+    const double units[6] = {1.0, 1e-3, 50.0, 2.0, 1e4, 0.1};
+    std::vector<double> x(rows * 6);
+    for (size_t r = 0; r < rows; ++r) {
+        double f0 = noise(rng), f1 = noise(rng);
+        for (size_t i = 0; i < 6; ++i) {
+            x[r * 6 + i] = units[i] * (3.0 + loadings[i][0] * f0 + loadings[i][1] * f1 + 0.05 * noise(rng));
+        }
+    }
+    return x;
+}
+
+// Correlation matrix by two passes, independent of the streaming update
+std::vector<double> correlation(const std::vector<double>& x, size_t D) {
+    const size_t N = x.size() / D;
+    std::vector<double> mean(D, 0.0), C(D * D, 0.0), R(D * D);
+    for (size_t r = 0; r < N; ++r) {
+        for (size_t i = 0; i < D; ++i) mean[i] += x[r * D + i] / N;
+    }
+    for (size_t r = 0; r < N; ++r) {
+        for (size_t i = 0; i < D; ++i) {
+            for (size_t j = 0; j < D; ++j) C[i * D + j] += (x[r * D + i] - mean[i]) * (x[r * D + j] - mean[j]) / N;
+        }
+    }
+    for (size_t i = 0; i < D; ++i) {
+        for (size_t j = 0; j < D; ++j) R[i * D + j] = C[i * D + j] / std::sqrt(C[i * D + i] * C[j * D + j]);
+    }
+    return R;
+}
+
+class ComponentRecorder : public DataReciever {
+public:
+    std::vector<uint64_t> rows;
+    std::vector<uint64_t> projected;
+    std::vector<double> components;
+
+    void ingest_feature_set(const std::string&, uint64_t timestamp_ns, const FeatureSet&,
+                            const FeatureSet&) override {
+        rows.push_back(timestamp_ns);
+    }
+
+    void ingest_components(const std::string&, uint64_t timestamp_ns,
+                           std::span<const double> values) override {
+        ASSERT_EQ(rows.back(), timestamp_ns);
+        projected.push_back(timestamp_ns);
+        components.insert(components.end(), values.begin(), values.end());
+    }
+};
+
+} // namespace
+
+TEST(StreamingPcaTest, ComponentsAreEigenvectorsOfTheCorrelationMatrix) {
+    auto x = two_factor_rows(5'000, 1);
+    StreamingPcaOptions options;
+    options.components = 6;
+    options.refresh_interval = SIZE_MAX;
+    StreamingPca pca(kFeatures, options);
+    for (size_t r = 0; r < 5'000; ++r) ASSERT_TRUE(pca.update({x.data() + r * 6, 6}));
+    EXPECT_FALSE(pca.ready());
+    pca.refresh();
+    ASSERT_TRUE(pca.ready());
+
+    auto R = correlation(x, 6);
+    double trace = 0.0;
+    for (size_t k = 0; k < 6; ++k) {
+        auto v = pca.component(k);
+        double lambda = pca.eigenvalues()[k];
+        trace += lambda;
+        if (k > 0) {
+            EXPECT_GE(pca.eigenvalues()[k - 1], lambda);
+        }
+        double norm = 0.0;
+        for (size_t i = 0; i < 6; ++i) {
+            double Rv = 0.0;
+            for (size_t j = 0; j < 6; ++j) Rv += R[i * 6 + j] * v[j];
+            EXPECT_NEAR(Rv, lambda * v[i], 1e-9) << "component " << k;
+            norm += v[i] * v[i];
+        }
+        EXPECT_NEAR(norm, 1.0, 1e-12);
+    }
+    EXPECT_NEAR(trace, 6.0, 1e-9);
+}
+
+TEST(StreamingPcaTest, KeepsTheFewestComponentsAboveTheVarianceTarget) {
+    auto x = two_factor_rows(5'000, 2);
+    StreamingPcaOptions options;
+    options.retained_variance = 0.95;
+    options.refresh_interval = 1'000;
+    StreamingPca pca(kFeatures, options);
+    for (size_t r = 0; r < 999; ++r) pca.update({x.data() + r * 6, 6});
+    EXPECT_FALSE(pca.ready());
+    pca.update({x.data() + 999 * 6, 6});
+    ASSERT_TRUE(pca.ready());
+    EXPECT_EQ(pca.components(), 2u);
+    EXPECT_GT(pca.retained_variance(), 0.95);
+
+    // Projections are the standardized row against each component
+    std::vector<double> out(2);
+    ASSERT_TRUE(pca.project({x.data(), 6}, out));
+    for (size_t r = 1'000; r < 5'000; ++r) pca.update({x.data() + r * 6, 6});
+    EXPECT_EQ(pca.components(), 2u);
+
+    double bad[6] = {1, 2, 3, std::numeric_limits<double>::quiet_NaN(), 5, 6};
+    EXPECT_FALSE(pca.update(bad));
+    EXPECT_FALSE(pca.project(bad, out));
+    EXPECT_EQ(pca.skipped(), 1u);
+    EXPECT_EQ(pca.observations(), 5'000u);
+}
+
+TEST(StreamingPcaTest, MergedDaysMatchOneStream) {
+    auto x = two_factor_rows(6'000, 3);
+    StreamingPcaOptions options;
+    options.refresh_interval = SIZE_MAX;
+    StreamingPca whole(kFeatures, options), merged(kFeatures, options);
+    for (size_t r = 0; r < 6'000; ++r) whole.update({x.data() + r * 6, 6});
+    for (size_t begin : {0, 1'000, 3'500}) {
+        StreamingPca day(kFeatures, options);
+        size_t end = begin == 0 ? 1'000 : begin == 1'000 ? 3'500 : 6'000;
+        for (size_t r = begin; r < end; ++r) day.update({x.data() + r * 6, 6});
+        merged.merge(day);
+    }
+    whole.refresh();
+    merged.refresh();
+    EXPECT_EQ(merged.observations(), 6'000u);
+    ASSERT_EQ(merged.components(), whole.components());
+    std::vector<double> a(whole.components()), b(whole.components());
+    for (size_t r = 0; r < 6'000; r += 97) {
+        whole.project({x.data() + r * 6, 6}, a);
+        merged.project({x.data() + r * 6, 6}, b);
+        for (size_t k = 0; k < a.size(); ++k) EXPECT_NEAR(a[k], b[k], 1e-9);
+    }
+    EXPECT_THROW(merged.merge(StreamingPca(options)), std::invalid_argument);
+}
+
+TEST(StreamingPcaTest, SavedBasisProjectsIdenticallyAndStaysFrozen) {
+    fs::path path = fs::temp_directory_path() / "streaming_pca_test.pca";
+    auto x = two_factor_rows(2'000, 4);
+    StreamingPcaOptions options;
+    options.whiten = true;
+    options.refresh_interval = 2'000;
+    StreamingPca pca(kFeatures, options);
+    for (size_t r = 0; r < 2'000; ++r) pca.update({x.data() + r * 6, 6});
+    pca.save(path.string());
+
+    StreamingPca loaded = StreamingPca::load(path.string());
+    EXPECT_TRUE(loaded.frozen());
+    EXPECT_EQ(loaded.features(), kFeatures);
+    ASSERT_EQ(loaded.components(), pca.components());
+    std::vector<double> a(pca.components()), b(pca.components());
+    double variance = 0.0;
+    for (size_t r = 0; r < 2'000; ++r) {
+        pca.project({x.data() + r * 6, 6}, a);
+        loaded.project({x.data() + r * 6, 6}, b);
+        for (size_t k = 0; k < a.size(); ++k) ASSERT_EQ(a[k], b[k]);
+        variance += a[0] * a[0] / 2'000;
+    }
+    EXPECT_NEAR(variance, 1.0, 1e-9);  // Whitened
+    EXPECT_THROW(loaded.update({x.data(), 6}), std::logic_error);
+
+    std::ofstream(path) << "streaming_pca 1\nfeatures 1 ofi\nobservations 3\nwhiten 0\ncomponents 2\n";
+    EXPECT_THROW(StreamingPca::load(path.string()), std::runtime_error);
+    fs::remove(path);
+}
+
+TEST(PcaRecieverTest, FitsWithoutComponentsThenProjectsOnTheFrozenBasis) {
+    auto x = two_factor_rows(300, 5);
+    StreamingPcaOptions options;
+    options.components = 3;
+    options.refresh_interval = 100;
+
+    auto replay = [&](DataReciever& reciever) {
+        for (uint64_t t = 0; t < 300; ++t) {
+            FeatureSet normalized{};
+            for (size_t i = 0; i < 6; ++i) normalized.*kFeatureMembers[feature_index(kFeatures[i])] = x[t * 6 + i];
+            if (t == 150) normalized.ofi = std::numeric_limits<double>::infinity();
+            reciever.ingest_feature_set("SPY", t, normalized, normalized);
+        }
+    };
+
+    // Fitting emits nothing, even after the basis has been refreshed
+    ComponentRecorder fitting;
+    StreamingPca pca(kFeatures, options);
+    {
+        PcaReciever stage(fitting, pca);
+        replay(stage);
+        EXPECT_EQ(stage.projected(), 0u);
+    }
+    ASSERT_EQ(fitting.rows.size(), 300u);
+    EXPECT_TRUE(fitting.projected.empty());
+    EXPECT_EQ(pca.observations(), 299u);
+    EXPECT_EQ(pca.skipped(), 1u);
+
+    // Frozen, every finite row is projected onto that one basis
+    pca.refresh();
+    pca.freeze();
+    ComponentRecorder direct;
+    PcaReciever stage(direct, pca);
+    replay(stage);
+    ASSERT_EQ(direct.rows.size(), 300u);
+    ASSERT_EQ(direct.projected.size(), 299u);  // All but the infinite row
+    EXPECT_EQ(direct.projected.front(), 0u);
+    EXPECT_EQ(stage.projected(), direct.projected.size());
+    ASSERT_EQ(direct.components.size(), 3 * direct.projected.size());
+    std::vector<double> expected(6);
+    ASSERT_TRUE(pca.project({x.data(), 6}, expected));
+    for (size_t k = 0; k < 3; ++k) EXPECT_EQ(direct.components[k], expected[k]);
+    EXPECT_EQ(pca.observations(), 299u);
+
+    // The same through a writer thread
+    ComponentRecorder queued;
+    {
+        PcaReciever queued_stage(queued, pca);
+        AsyncReciever async(queued_stage, 16);
+        replay(async);
+        async.finish();
+    }
+    EXPECT_EQ(queued.rows, direct.rows);
+    EXPECT_EQ(queued.projected, direct.projected);
+    EXPECT_EQ(queued.components, direct.components);
+}
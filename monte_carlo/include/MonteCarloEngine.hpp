@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MonteCarloResults.hpp"
+#include "RegimeParameterMap.hpp"
+#include "thread_pool.hpp"
+
+namespace microregime {
+
+enum class Sampling {
+    Pseudo,      // Independent Philox draws for every path
+    Antithetic,  // Paths in pairs; the second negates the first's normals and uses 1 - u for its regime draws
+    Sobol,       // Brownian bridge knots from randomly shifted Sobol' points, Philox normals between them
+};
+
+struct MonteCarloConfig {
+    static constexpr size_t kMostVolatile = SIZE_MAX;
+
+    size_t paths = 1'000'000;
+    std::vector<size_t> horizons{1, 120, 1200};  // In steps (snapshots), ascending
+    std::vector<double> confidence{0.95, 0.99};
+    uint64_t seed = 45;
+    std::vector<double> initial;  // Regime distribution at the first step; startprob if empty
+
+    // Variance reduction
+    Sampling sampling = Sampling::Pseudo;
+    bool control_variate = false;  // Against a single-regime Gaussian path on the same normals
+    double crisis_tilt = 1.0;      // Importance sampling: odds of entering the crisis regime times this
+    size_t crisis_regime = kMostVolatile;
+    size_t batches = 32;           // Independent batches (Sobol: shifted replicates) for standard errors
+};
+
+// Regime-switching log-price paths on the CPU.
+//
+// Each step a path draws its regime (from `initial`, then from its previous
+// regime's transmat row) and a log return N(drift, volatility^2) of that
+// regime. Every random number of path p at step t comes from Philox keyed by
+// the seed with counter (p, t / 2), so a path is the same whatever block or
+// thread simulates it and any pool size gives bit-identical losses.
+//
+// Variance reduction, all of it reproducible the same way:
+//  - Antithetic pairs share a Philox stream.
+//  - Sobol' replaces the first normals of each path with a Brownian bridge:
+//    up to SobolSequence::kMaxDimensions knots of the path's summed normals
+//    (the last step first, then bisecting) come from one Sobol' point through
+//    the normal quantile, so the coarse shape of every path is stratified, and
+//    Philox fills in between knots conditionally. Each batch is a replicate
+//    with its own random digital shift, which keeps the estimate unbiased and
+//    gives its error.
+//  - Importance sampling draws regimes from a transmat (and initial
+//    distribution) whose odds of moving into the crisis regime are scaled by
+//    crisis_tilt, and weights each loss by the likelihood ratio of its
+//    regime path so far. The ratio compounds over steps, so long horizons
+//    want a milder tilt than short ones.
+//  - The control variate is the loss of a single-regime Gaussian path on the
+//    same normals, with the true model's average drift and variance up to the
+//    horizon. Its VaR and CVaR are closed-form, and MonteCarloResults
+//    regresses the simulated tail estimates on their control counterparts
+//    across batches.
+//
+// Paths are stepped kBlockPaths at a time in structure-of-arrays form: one
+// loop generates the block's Philox words, one turns them into a Box-Muller
+// pair of normals (vector_math's log and sincos) and two uniforms per path,
+// covering two steps, and one advances regimes (branchless compares against
+// cumulative transmat rows) and log prices. Each loop runs over contiguous
+// arrays with no dependence between paths, so the compiler vectorizes it.
+// Blocks are ThreadPool tasks.
+class MonteCarloEngine {
+public:
+    static constexpr size_t kBlockPaths = 2048;
+
+    MonteCarloEngine(const RegimeParameterMap& parameters, ThreadPool& pool);
+
+    // Throws std::invalid_argument on an empty or unsorted horizon list, a
+    // confidence level outside (0, 1), a bad initial distribution, a crisis
+    // tilt that isn't positive, or fewer paths than two per batch
+    MonteCarloResults run(const MonteCarloConfig& config) const;
+
+    // Losses of paths [first, first + count) on the calling thread, as
+    // horizons x count values
+    std::vector<double> simulate(const MonteCarloConfig& config, uint64_t first, size_t count) const;
+
+    const RegimeParameterMap& parameters() const { return parameters_; }
+
+private:
+    const RegimeParameterMap& parameters_;
+    ThreadPool& pool_;
+
+    struct Plan;
+    struct Output {
+        double* losses;
+        double* weights;  // Null without importance sampling
+        double* control;  // Null without the control variate
+        size_t stride;
+    };
+
+    Plan plan(const MonteCarloConfig& config) const;
+    void simulate_block(const MonteCarloConfig& config, const Plan& plan, uint64_t first, size_t count,
+                        const Output& output) const;
+};
+
+} // namespace microregime
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace microregime {
+
+// Simulated losses and their tail statistics, per horizon and confidence level.
+//
+// A path's loss at a horizon is the fraction of a long position's value lost
+// by then, 1 - P_h / P_0. VaR at level a is the empirical a-quantile of the
+// losses (the ceil(a n)-th smallest) and CVaR the mean of the losses from that
+// one up, so CVaR >= VaR.
+//
+// With LossEstimation weights (importance sampling) the quantile and tail mean
+// are of the weighted empirical distribution. With batches, each statistic is
+// also estimated per batch: the spread of those gives its standard error, and
+// with a control variate the batch estimates regress the simulated statistic
+// on the control's, whose exact value corrects the overall estimate.
+// cvar_gain() is the variance plain Monte Carlo would have with the same
+// paths (from the tail's variance) over the achieved one, so paths() times it
+// is the effective sample size.
+struct LossEstimation {
+    std::vector<double> weights;  // Likelihood ratio per loss, same layout; all 1 if empty
+    size_t batches = 1;
+    size_t batch_size = 0;         // Batch b is [b size, (b + 1) size), the last one running to the end
+    std::vector<double> control;   // Control variate's loss per loss; none if empty
+    std::vector<double> control_var;   // Its exact VaR and CVaR, horizons x levels
+    std::vector<double> control_cvar;
+};
+
+class MonteCarloResults {
+public:
+    // losses is horizons.size() rows of `paths` values, row-major. Throws
+    // std::invalid_argument if it isn't a whole number of non-empty rows, or
+    // if the estimation's arrays or batches don't fit it.
+    MonteCarloResults(std::vector<size_t> horizons, std::vector<double> confidence, std::vector<double> losses,
+                      LossEstimation estimation = {});
+
+    size_t paths() const { return paths_; }
+    const std::vector<size_t>& horizons() const { return horizons_; }
+    const std::vector<double>& confidence() const { return confidence_; }
+
+    // Indices into horizons() and confidence()
+    std::span<const double> losses(size_t horizon) const { return {losses_.data() + horizon * paths_, paths_}; }
+    double mean(size_t horizon) const { return mean_[horizon]; }
+    double var(size_t horizon, size_t level) const { return var_[horizon * confidence_.size() + level]; }
+    double cvar(size_t horizon, size_t level) const { return cvar_[horizon * confidence_.size() + level]; }
+
+    // Standard errors and CVaR's variance reduction over plain sampling; NaN
+    // with a single batch
+    size_t batches() const { return batches_; }
+    double var_error(size_t horizon, size_t level) const { return var_error_[horizon * confidence_.size() + level]; }
+    double cvar_error(size_t horizon, size_t level) const { return cvar_error_[horizon * confidence_.size() + level]; }
+    double cvar_gain(size_t horizon, size_t level) const { return cvar_gain_[horizon * confidence_.size() + level]; }
+
+    // horizon_steps,confidence,VaR,CVaR,mean_loss,VaR_se,CVaR_se,CVaR_gain; a
+    // row per horizon and level
+    void write_csv(const std::string& filepath) const;
+
+private:
+    std::vector<size_t> horizons_;
+    std::vector<double> confidence_;
+    size_t paths_;
+    std::vector<double> losses_;
+    std::vector<double> mean_;
+    std::vector<double> var_;
+    std::vector<double> cvar_;
+    size_t batches_;
+    std::vector<double> var_error_;
+    std::vector<double> cvar_error_;
+    std::vector<double> cvar_gain_;
+};
+
+} // namespace microregime
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace microregime {
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+//
+// A counter-based generator: the 128 output bits are a keyed bijection of a
+// 128-bit counter, so any draw can be computed directly from (key, counter)
+// with no stream state. Paths seeded by their own index give the same numbers
+// however they are split across blocks and threads.
+namespace philox {
+
+inline constexpr uint32_t kMultiplier0 = 0xD2511F53;
+inline constexpr uint32_t kMultiplier1 = 0xCD9E8D57;
+inline constexpr uint32_t kWeyl0 = 0x9E3779B9;
+inline constexpr uint32_t kWeyl1 = 0xBB67AE85;
+inline constexpr int kRounds = 10;
+
+using Counter = std::array<uint32_t, 4>;
+using Key = std::array<uint32_t, 2>;
+
+// Plain 32-bit arithmetic only, so a loop calling this over independent
+// counters vectorizes
+inline Counter generate(Counter counter, Key key) {
+    for (int round = 0; round < kRounds; ++round) {
+        if (round > 0) {
+            key[0] += kWeyl0;
+            key[1] += kWeyl1;
+        }
+        const uint64_t product0 = uint64_t{kMultiplier0} * counter[0];
+        const uint64_t product1 = uint64_t{kMultiplier1} * counter[2];
+        counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(product1),
+                   static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(product0)};
+    }
+    return counter;
+}
+
+// Open interval (0, 1), so log() and inverse CDFs never see 0 or 1
+inline double to_uniform(uint32_t bits) {
+    return (static_cast<double>(bits) + 0.5) * 0x1p-32;
+}
+
+inline Key key(uint64_t seed) {
+    return {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+}
+
+} // namespace philox
+
+} // namespace microregime
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "gaussian_hmm.hpp"
+
+namespace microregime {
+
+// What the simulator needs from a regime model: the HMM's start and transition
+// probabilities, and the drift and volatility of the per-snapshot log return
+// of the midprice in each regime. One step is one snapshot interval.
+//
+// Text format (fit_regime_parameters writes it):
+//   regime_parameters 1
+//   regimes K
+//   startprob   K values
+//   transmat    K*K values, row-major (row = from regime)
+//   drift       K values, mean log return per step
+//   volatility  K values, its standard deviation
+class RegimeParameterMap {
+public:
+    // Throws std::invalid_argument on inconsistent sizes, rows that don't sum
+    // to 1, or a negative or non-finite drift or volatility
+    RegimeParameterMap(std::vector<double> startprob, std::vector<double> transmat, std::vector<double> drift,
+                       std::vector<double> volatility);
+
+    // Throws std::runtime_error if the file can't be read or parsed
+    static RegimeParameterMap load(const std::string& filepath);
+    void save(const std::string& filepath) const;
+
+    size_t regimes() const { return startprob_.size(); }
+    std::span<const double> startprob() const { return startprob_; }
+    std::span<const double> transmat() const { return transmat_; }
+    std::span<const double> drift() const { return drift_; }
+    std::span<const double> volatility() const { return volatility_; }
+
+private:
+    std::vector<double> startprob_;
+    std::vector<double> transmat_;
+    std::vector<double> drift_;
+    std::vector<double> volatility_;
+};
+
+// Per-regime moments of the midprice log return, each snapshot labelled by the
+// forward filter's most likely regime (what a live run would have known then).
+class RegimeReturnEstimator {
+public:
+    explicit RegimeReturnEstimator(const GaussianHmm& model);
+
+    // One day: rows x model.dimensions() observations and a midprice per row.
+    // The filter restarts from startprob, and the first row has no return.
+    void add_day(std::span<const double> observations, std::span<const double> midprices);
+
+    // One labelled return (Welford)
+    void add(size_t regime, double log_return);
+
+    uint64_t count(size_t regime) const { return count_[regime]; }
+
+    // The model's startprob and transmat with the estimated moments. Throws
+    // std::runtime_error if a regime has fewer than 2 returns.
+    RegimeParameterMap parameters() const;
+
+private:
+    const GaussianHmm& model_;
+    std::vector<uint64_t> count_;
+    std::vector<double> mean_;
+    std::vector<double> m2_;
+};
+
+} // namespace microregime
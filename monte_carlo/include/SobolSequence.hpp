@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace microregime {
+
+// Sobol' low-discrepancy points, 32 bits per coordinate, with Joe and Kuo's
+// direction numbers (new-joe-kuo-6.21201) for the first kMaxDimensions.
+//
+// point() computes any index directly from its Gray code, so blocks of paths
+// need no shared generator state. Each coordinate of the first 2^m points
+// falls once in every interval [k / 2^m, (k + 1) / 2^m).
+class SobolSequence {
+public:
+    static constexpr size_t kMaxDimensions = 21;
+    static constexpr int kBits = 32;
+
+    // Throws std::invalid_argument beyond kMaxDimensions
+    explicit SobolSequence(size_t dimensions);
+
+    size_t dimensions() const { return directions_.size(); }
+
+    // Coordinate `dimension` of point `index`, as an integer to scale by 2^-32
+    uint32_t point(uint64_t index, size_t dimension) const {
+        const uint64_t gray = index ^ (index >> 1);
+        const auto& v = directions_[dimension];
+        uint32_t x = 0;
+        for (int bit = 0; bit < kBits; ++bit) x ^= ((gray >> bit) & 1) ? v[bit] : 0u;
+        return x;
+    }
+
+private:
+    std::vector<std::array<uint32_t, kBits>> directions_;
+};
+
+} // namespace microregime
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+
+namespace microregime {
+
+// Branch-free log and sin/cos for the Box-Muller step.
+//
+// libm's calls keep a path loop scalar; these are straight-line integer and
+// floating-point arithmetic (plus selects), so a loop over them vectorizes
+// at whatever width the target has. Both are within a few ulp of libm over
+// the ranges used here.
+namespace vector_math {
+
+// c[0] + c[1] x + ... by Horner's rule; the loop unrolls at compile time
+template <size_t N>
+inline double polynomial(double x, const double (&c)[N]) {
+    double y = c[N - 1];
+    for (size_t i = N - 1; i-- > 0;) y = y * x + c[i];
+    return y;
+}
+
+// log(x) for positive, normal x. x = 2^k z with z in [sqrt(1/2), sqrt(2)),
+// and log z = 2 atanh(f) with f = (z - 1) / (z + 1), |f| < 0.172, by its
+// odd series through f^17.
+inline double log(double x) {
+    constexpr uint64_t kSqrtHalf = 0x3fe6a09e667f3bcd;
+    constexpr uint64_t kOffset = 0x3ff0000000000000 - kSqrtHalf;
+    const uint64_t t = std::bit_cast<uint64_t>(x) + kOffset;
+    const double z = std::bit_cast<double>((t & 0x000fffffffffffff) + kSqrtHalf);
+    // Biased exponent in the low bits of 2^52, so the conversion is a subtraction
+    const double k = std::bit_cast<double>(0x4330000000000000 | (t >> 52)) - (0x1p52 + 1023.0);
+
+    const double f = (z - 1.0) / (z + 1.0);
+    const double s = f * f;
+    constexpr double kSeries[] = {1.0, 1.0 / 3, 1.0 / 5, 1.0 / 7, 1.0 / 9, 1.0 / 11, 1.0 / 13, 1.0 / 15, 1.0 / 17};
+    return k * std::numbers::ln2 + 2.0 * f * polynomial(s, kSeries);
+}
+
+// sin(2 pi u) and cos(2 pi u) for |u| < 2^48. 4u is split into the nearest
+// quarter turn q and a remainder r in [-pi/4, pi/4], where the Taylor series
+// through r^17 and r^16 are exact to double precision.
+inline void sincos_2pi(double u, double& sin_out, double& cos_out) {
+    constexpr double kRound = 0x1.8p52;  // Adding it rounds to an integer, held in the low bits
+    const double v = 4.0 * u;
+    const double rounded = v + kRound;
+    const uint64_t q = std::bit_cast<uint64_t>(rounded);
+    const double r = (v - (rounded - kRound)) * (std::numbers::pi / 2);
+    const double s2 = r * r;
+
+    constexpr double kSin[] = {1.0, -1.0 / 6, 1.0 / 120, -1.0 / 5040, 1.0 / 362880, -1.0 / 39916800,
+                               1.0 / 6227020800, -1.0 / 1307674368000, 1.0 / 355687428096000};
+    constexpr double kCos[] = {1.0, -1.0 / 2, 1.0 / 24, -1.0 / 720, 1.0 / 40320, -1.0 / 3628800,
+                               1.0 / 479001600, -1.0 / 87178291200, 1.0 / 20922789888000};
+    const double sin_r = r * polynomial(s2, kSin);
+    const double cos_r = polynomial(s2, kCos);
+
+    // Rotate by q quarter turns
+    const double sin_q = (q & 1) ? cos_r : sin_r;
+    const double cos_q = (q & 1) ? sin_r : cos_r;
+    sin_out = (q & 2) ? -sin_q : sin_q;
+    cos_out = ((q + 1) & 2) ? -cos_q : cos_q;
+}
+
+} // namespace vector_math
+
+} // namespace microregime
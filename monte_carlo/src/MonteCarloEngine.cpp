@@ -0,0 +1,379 @@
+#include "MonteCarloEngine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include "NormalDistribution.hpp"
+#include "Philox.hpp"
+#include "SobolSequence.hpp"
+#include "VectorMath.hpp"
+
+namespace microregime {
+
+namespace {
+
+// Cumulative sums of a distribution, for drawing by comparison
+void accumulate(std::span<const double> p, double* cdf) {
+    double total = 0.0;
+    for (size_t j = 0; j < p.size(); ++j) cdf[j] = (total += p[j]);
+}
+
+// Counter word 3 of the Sobol' shifts; path streams keep it at step / 2^33
+constexpr uint32_t kShiftStream = 0xffffffff;
+
+} // namespace
+
+// Everything a block needs that depends only on the config
+struct MonteCarloEngine::Plan {
+    size_t batch_size = 0;
+
+    // Sampling distributions (tilted under importance sampling), cumulative
+    std::vector<double> initial_cdf;
+    std::vector<double> cumulative;  // K x K
+    // log p / q of the initial regime and of each transition; empty when untilted
+    std::vector<double> initial_log_ratio;
+    std::vector<double> log_ratio;
+
+    // Control path drift and volatility per step, for each horizon
+    std::vector<double> control_drift;
+    std::vector<double> control_volatility;
+    std::vector<double> control_var;  // Its exact VaR and CVaR, horizons x levels
+    std::vector<double> control_cvar;
+
+    // Brownian bridge knots in construction order: time, and the knots either
+    // side of it already built (kNoKnot for time 0 or nothing to the right)
+    static constexpr size_t kNoKnot = SIZE_MAX;
+    std::vector<size_t> knot_time;
+    std::vector<size_t> knot_left;
+    std::vector<size_t> knot_right;
+    std::vector<size_t> knot_order;  // Knot indices by time
+    std::vector<uint32_t> shifts;    // Batches x knots
+    std::unique_ptr<SobolSequence> sobol;
+};
+
+MonteCarloEngine::MonteCarloEngine(const RegimeParameterMap& parameters, ThreadPool& pool)
+    : parameters_{parameters}, pool_{pool} {}
+
+MonteCarloEngine::Plan MonteCarloEngine::plan(const MonteCarloConfig& config) const {
+    const size_t K = parameters_.regimes();
+    const size_t L = config.confidence.size();
+    if (config.horizons.empty() || config.horizons.front() == 0 ||
+        !std::is_sorted(config.horizons.begin(), config.horizons.end(), std::less_equal<>())) {
+        throw std::invalid_argument("Horizons must be non-empty, positive and strictly ascending");
+    }
+    for (double level : config.confidence) {
+        if (!(level > 0.0 && level < 1.0)) throw std::invalid_argument("Confidence levels must be in (0, 1)");
+    }
+    std::span<const double> initial = config.initial.empty() ? parameters_.startprob() : config.initial;
+    if (initial.size() != K) {
+        throw std::invalid_argument("Initial distribution needs " + std::to_string(K) + " values");
+    }
+    double total = 0.0;
+    for (double p : initial) {
+        if (!(p >= 0.0)) throw std::invalid_argument("Initial distribution has a negative or NaN entry");
+        total += p;
+    }
+    if (std::abs(total - 1.0) > 1e-6) {
+        throw std::invalid_argument("Initial distribution doesn't sum to 1");
+    }
+    if (!(config.crisis_tilt > 0.0 && std::isfinite(config.crisis_tilt))) {
+        throw std::invalid_argument("Crisis tilt must be positive");
+    }
+    const size_t batches = std::max<size_t>(config.batches, 1);
+    if (config.paths < 2 * batches) {
+        throw std::invalid_argument("Monte Carlo run needs at least two paths per batch");
+    }
+
+    Plan plan;
+    plan.batch_size = config.paths / batches;
+    if (config.sampling == Sampling::Antithetic) plan.batch_size &= ~size_t{1};  // Pairs never straddle batches
+
+    // Importance sampling: q_kj = p_kj g_j / (1 + (tilt - 1) p_kc), g_c = tilt and 1 elsewhere
+    const std::span<const double> P = parameters_.transmat();
+    std::vector<double> sampling_initial(initial.begin(), initial.end());
+    std::vector<double> sampling_transmat(P.begin(), P.end());
+    if (config.crisis_tilt != 1.0) {
+        size_t crisis = config.crisis_regime;
+        if (crisis == MonteCarloConfig::kMostVolatile) {
+            auto volatility = parameters_.volatility();
+            crisis = std::max_element(volatility.begin(), volatility.end()) - volatility.begin();
+        }
+        if (crisis >= K) throw std::invalid_argument("Crisis regime " + std::to_string(crisis) + " doesn't exist");
+        const double log_tilt = std::log(config.crisis_tilt);
+        auto tilt = [&](double* p, double* log_ratio) {
+            const double normalizer = 1.0 + (config.crisis_tilt - 1.0) * p[crisis];
+            for (size_t j = 0; j < K; ++j) {
+                p[j] *= (j == crisis ? config.crisis_tilt : 1.0) / normalizer;
+                log_ratio[j] = std::log(normalizer) - (j == crisis ? log_tilt : 0.0);
+            }
+        };
+        plan.initial_log_ratio.resize(K);
+        plan.log_ratio.resize(K * K);
+        tilt(sampling_initial.data(), plan.initial_log_ratio.data());
+        for (size_t k = 0; k < K; ++k) tilt(sampling_transmat.data() + k * K, plan.log_ratio.data() + k * K);
+    }
+    plan.initial_cdf.resize(K);
+    accumulate(sampling_initial, plan.initial_cdf.data());
+    plan.cumulative.resize(K * K);
+    for (size_t k = 0; k < K; ++k) {
+        accumulate({sampling_transmat.data() + k * K, K}, plan.cumulative.data() + k * K);
+    }
+
+    // Control: average drift and variance over the true regime distribution of steps 1..h
+    if (config.control_variate) {
+        std::vector<double> occupancy(initial.begin(), initial.end()), next(K);
+        double drift_sum = 0.0, variance_sum = 0.0;
+        size_t horizon = 0;
+        for (size_t t = 1; t <= config.horizons.back(); ++t) {
+            for (size_t k = 0; k < K; ++k) {
+                drift_sum += occupancy[k] * parameters_.drift()[k];
+                variance_sum += occupancy[k] * parameters_.volatility()[k] * parameters_.volatility()[k];
+            }
+            if (t == config.horizons[horizon]) {
+                const double drift = drift_sum / t, volatility = std::sqrt(variance_sum / t);
+                plan.control_drift.push_back(drift);
+                plan.control_volatility.push_back(volatility);
+                // loss = 1 - e^X with X ~ N(m, s^2): VaR from X's lower quantile, CVaR from E[e^X; X <= q]
+                const double m = drift * t, s = volatility * std::sqrt(static_cast<double>(t));
+                for (size_t l = 0; l < L; ++l) {
+                    const double tail = 1.0 - config.confidence[l];
+                    const double q = m + s * normal_quantile(tail);
+                    plan.control_var.push_back(-std::expm1(q));
+                    plan.control_cvar.push_back(s > 0.0 ? 1.0 - std::exp(m + s * s / 2) * normal_cdf((q - m) / s - s) / tail
+                                                        : -std::expm1(m));
+                }
+                ++horizon;
+            }
+            std::fill(next.begin(), next.end(), 0.0);
+            for (size_t k = 0; k < K; ++k) {
+                for (size_t j = 0; j < K; ++j) next[j] += occupancy[k] * P[k * K + j];
+            }
+            occupancy.swap(next);
+        }
+    }
+
+    // Bridge knots: the last step, then midpoints breadth first
+    if (config.sampling == Sampling::Sobol) {
+        const size_t T = config.horizons.back();
+        const size_t knots = std::min(SobolSequence::kMaxDimensions, T);
+        struct Interval {
+            size_t left_time, right_time, left, right;
+        };
+        plan.knot_time = {T};
+        plan.knot_left = {Plan::kNoKnot};
+        plan.knot_right = {Plan::kNoKnot};
+        std::vector<Interval> queue{{0, T, Plan::kNoKnot, 0}};
+        for (size_t head = 0; head < queue.size() && plan.knot_time.size() < knots; ++head) {
+            const Interval interval = queue[head];
+            if (interval.right_time - interval.left_time < 2) continue;
+            const size_t mid = (interval.left_time + interval.right_time) / 2;
+            const size_t index = plan.knot_time.size();
+            plan.knot_time.push_back(mid);
+            plan.knot_left.push_back(interval.left);
+            plan.knot_right.push_back(interval.right);
+            queue.push_back({interval.left_time, mid, interval.left, index});
+            queue.push_back({mid, interval.right_time, index, interval.right});
+        }
+        plan.knot_order.resize(plan.knot_time.size());
+        for (size_t j = 0; j < plan.knot_order.size(); ++j) plan.knot_order[j] = j;
+        std::sort(plan.knot_order.begin(), plan.knot_order.end(),
+                  [&](size_t a, size_t b) { return plan.knot_time[a] < plan.knot_time[b]; });
+
+        plan.sobol = std::make_unique<SobolSequence>(plan.knot_time.size());
+        const philox::Key key = philox::key(config.seed);
+        for (size_t b = 0; b < batches; ++b) {
+            for (size_t j = 0; j < plan.knot_time.size(); ++j) {
+                plan.shifts.push_back(philox::generate({static_cast<uint32_t>(b), static_cast<uint32_t>(uint64_t{b} >> 32),
+                                                        static_cast<uint32_t>(j), kShiftStream},
+                                                       key)[0]);
+            }
+        }
+    }
+    return plan;
+}
+
+MonteCarloResults MonteCarloEngine::run(const MonteCarloConfig& config) const {
+    const Plan plan = this->plan(config);
+    const size_t paths = config.paths;
+    const size_t values = config.horizons.size() * paths;
+    std::vector<double> losses(values);
+    LossEstimation estimation;
+    estimation.batches = std::max<size_t>(config.batches, 1);
+    estimation.batch_size = plan.batch_size;
+    if (!plan.log_ratio.empty()) estimation.weights.resize(values);
+    if (config.control_variate) {
+        estimation.control.resize(values);
+        estimation.control_var = plan.control_var;
+        estimation.control_cvar = plan.control_cvar;
+    }
+
+    std::vector<std::future<void>> blocks;
+    blocks.reserve((paths + kBlockPaths - 1) / kBlockPaths);
+    for (size_t first = 0; first < paths; first += kBlockPaths) {
+        const size_t count = std::min(kBlockPaths, paths - first);
+        Output output{losses.data() + first, estimation.weights.empty() ? nullptr : estimation.weights.data() + first,
+                      estimation.control.empty() ? nullptr : estimation.control.data() + first, paths};
+        blocks.push_back(pool_.submit([this, &config, &plan, output, first, count] {
+            simulate_block(config, plan, first, count, output);
+        }));
+    }
+    // Every block writes into losses, so none may still be running when this throws
+    for (auto& block : blocks) block.wait();
+    for (auto& block : blocks) block.get();
+    return MonteCarloResults(config.horizons, config.confidence, std::move(losses), std::move(estimation));
+}
+
+std::vector<double> MonteCarloEngine::simulate(const MonteCarloConfig& config, uint64_t first, size_t count) const {
+    const Plan plan = this->plan(config);
+    const size_t values = config.horizons.size() * count;
+    std::vector<double> losses(values), weights, control;
+    if (!plan.log_ratio.empty()) weights.resize(values);
+    if (config.control_variate) control.resize(values);
+    for (size_t begin = 0; begin < count; begin += kBlockPaths) {
+        Output output{losses.data() + begin, weights.empty() ? nullptr : weights.data() + begin,
+                      control.empty() ? nullptr : control.data() + begin, count};
+        simulate_block(config, plan, first + begin, std::min(kBlockPaths, count - begin), output);
+    }
+    return losses;
+}
+
+void MonteCarloEngine::simulate_block(const MonteCarloConfig& config, const Plan& plan, uint64_t first,
+                                      size_t count, const Output& output) const {
+    const size_t K = parameters_.regimes();
+    const double* drift = parameters_.drift().data();
+    const double* volatility = parameters_.volatility().data();
+    const double* cumulative = plan.cumulative.data();
+    const philox::Key key = philox::key(config.seed);
+    const bool antithetic = config.sampling == Sampling::Antithetic;
+    const bool tilted = !plan.log_ratio.empty();
+    const size_t n = count;
+
+    // Structure of arrays for the block
+    std::vector<uint32_t> words(4 * n);
+    std::vector<double> draws(4 * n);  // Normal and uniform for an even step, then for the odd one
+    std::vector<double> log_price(n, 0.0);
+    std::vector<uint32_t> regime(n, 0), next(n);
+    std::vector<double> log_weight(tilted ? n : 0, 0.0);
+    std::vector<double> normal_sum(output.control ? n : 0, 0.0);
+    uint32_t* w0 = words.data();
+    uint32_t* w1 = w0 + n;
+    uint32_t* w2 = w1 + n;
+    uint32_t* w3 = w2 + n;
+
+    // Sobol': bridge knot values per path, then the running bridge
+    const size_t knots = plan.knot_time.size();
+    std::vector<double> knot(knots * n), bridge(knots ? n : 0, 0.0);
+    for (size_t i = 0; i < n && knots; ++i) {
+        const uint64_t path = first + i;
+        const size_t batch = std::min(path / plan.batch_size, plan.shifts.size() / knots - 1);
+        const uint64_t point = path - batch * plan.batch_size;
+        for (size_t j = 0; j < knots; ++j) {
+            const uint32_t bits = plan.sobol->point(point, j) ^ plan.shifts[batch * knots + j];
+            const double z = normal_quantile(philox::to_uniform(bits));
+            const size_t m = plan.knot_time[j];
+            const size_t left = plan.knot_left[j], right = plan.knot_right[j];
+            const size_t l = left == Plan::kNoKnot ? 0 : plan.knot_time[left];
+            const double left_value = left == Plan::kNoKnot ? 0.0 : knot[left * n + i];
+            if (right == Plan::kNoKnot) {
+                knot[j * n + i] = std::sqrt(static_cast<double>(m)) * z;
+                continue;
+            }
+            const size_t r = plan.knot_time[right];
+            const double weight = static_cast<double>(m - l) / static_cast<double>(r - l);
+            knot[j * n + i] = left_value + weight * (knot[right * n + i] - left_value) +
+                              std::sqrt(weight * static_cast<double>(r - m)) * z;
+        }
+    }
+    size_t segment = 0;  // Into knot_order: the next knot at or after t + 1
+
+    const size_t steps = config.horizons.back();
+    size_t horizon = 0;
+    for (size_t t = 0; t < steps; ++t) {
+        if (t % 2 == 0) {
+            const uint64_t pair = t / 2;
+            for (size_t i = 0; i < n; ++i) {
+                const uint64_t path = antithetic ? (first + i) >> 1 : first + i;
+                auto bits = philox::generate({static_cast<uint32_t>(path), static_cast<uint32_t>(path >> 32),
+                                              static_cast<uint32_t>(pair), static_cast<uint32_t>(pair >> 32)},
+                                             key);
+                // The antithetic partner's regime uniforms are 1 - u
+                const uint32_t flip = (antithetic && ((first + i) & 1)) ? 0xffffffff : 0;
+                w0[i] = bits[0];
+                w1[i] = bits[1];
+                w2[i] = bits[2] ^ flip;
+                w3[i] = bits[3] ^ flip;
+            }
+            double* normal0 = draws.data();
+            double* uniform0 = normal0 + n;
+            double* normal1 = uniform0 + n;
+            double* uniform1 = normal1 + n;
+            for (size_t i = 0; i < n; ++i) {
+                const double sign = (antithetic && ((first + i) & 1)) ? -1.0 : 1.0;
+                const double radius = sign * std::sqrt(-2.0 * vector_math::log(philox::to_uniform(w0[i])));
+                double sin_angle, cos_angle;
+                vector_math::sincos_2pi(philox::to_uniform(w1[i]), sin_angle, cos_angle);
+                normal0[i] = radius * cos_angle;
+                normal1[i] = radius * sin_angle;
+                uniform0[i] = philox::to_uniform(w2[i]);
+                uniform1[i] = philox::to_uniform(w3[i]);
+            }
+        }
+        double* normal = draws.data() + (t % 2) * 2 * n;
+        const double* uniform = normal + n;
+
+        // Bridge from t to t + 1 toward the next knot: the conditional increment
+        if (knots) {
+            if (plan.knot_time[plan.knot_order[segment]] == t) ++segment;
+            const size_t target = plan.knot_order[segment];
+            const double remaining = static_cast<double>(plan.knot_time[target] - t);
+            const double pull = 1.0 / remaining, spread = std::sqrt((remaining - 1.0) / remaining);
+            const double* value = knot.data() + target * n;
+            for (size_t i = 0; i < n; ++i) {
+                normal[i] = (value[i] - bridge[i]) * pull + spread * normal[i];
+                bridge[i] += normal[i];
+            }
+        }
+
+        // Regime: how many cumulative probabilities the uniform clears
+        std::fill(next.begin(), next.end(), 0u);
+        for (size_t j = 0; j + 1 < K; ++j) {
+            if (t == 0) {
+                const double bound = plan.initial_cdf[j];
+                for (size_t i = 0; i < n; ++i) next[i] += uniform[i] >= bound;
+            } else {
+                const double* column = cumulative + j;
+                for (size_t i = 0; i < n; ++i) next[i] += uniform[i] >= column[regime[i] * K];
+            }
+        }
+        if (tilted) {
+            if (t == 0) {
+                for (size_t i = 0; i < n; ++i) log_weight[i] += plan.initial_log_ratio[next[i]];
+            } else {
+                for (size_t i = 0; i < n; ++i) log_weight[i] += plan.log_ratio[regime[i] * K + next[i]];
+            }
+        }
+        regime.swap(next);
+
+        for (size_t i = 0; i < n; ++i) log_price[i] += drift[regime[i]] + volatility[regime[i]] * normal[i];
+        if (output.control) {
+            for (size_t i = 0; i < n; ++i) normal_sum[i] += normal[i];
+        }
+
+        if (t + 1 == config.horizons[horizon]) {
+            const size_t offset = horizon * output.stride;
+            for (size_t i = 0; i < n; ++i) output.losses[offset + i] = -std::expm1(log_price[i]);
+            if (output.weights) {
+                for (size_t i = 0; i < n; ++i) output.weights[offset + i] = std::exp(log_weight[i]);
+            }
+            if (output.control) {
+                const double mean = plan.control_drift[horizon] * static_cast<double>(t + 1);
+                const double scale = plan.control_volatility[horizon];
+                for (size_t i = 0; i < n; ++i) output.control[offset + i] = -std::expm1(mean + scale * normal_sum[i]);
+            }
+            ++horizon;
+        }
+    }
+}
+
+} // namespace microregime
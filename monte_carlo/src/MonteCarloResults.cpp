@@ -0,0 +1,227 @@
+#include "MonteCarloResults.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace microregime {
+
+namespace {
+
+struct Tail {
+    double var;
+    double cvar;
+    double variance;  // Of the losses beyond VaR
+};
+
+// Tail statistics of a set of losses at every level. Unweighted, VaR is the
+// ceil(a n)-th smallest; weighted, it's the largest loss with less than a of
+// the total weight strictly below it, which reduces to the same.
+class TailEstimator {
+public:
+    void estimate(std::span<const double> losses, std::span<const double> weights,
+                  const std::vector<double>& confidence, std::vector<Tail>& out) {
+        const size_t n = losses.size();
+        out.resize(confidence.size());
+        if (weights.empty()) {
+            // Partition around each level in turn; the tail above the quantile
+            // is what CVaR averages
+            sorted_.assign(losses.begin(), losses.end());
+            for (size_t l = 0; l < confidence.size(); ++l) {
+                double position = std::ceil(confidence[l] * static_cast<double>(n));
+                size_t index = std::min(n - 1, static_cast<size_t>(std::max(position, 1.0)) - 1);
+                std::nth_element(sorted_.begin(), sorted_.begin() + index, sorted_.end());
+                double tail = 0.0, square = 0.0;
+                for (size_t i = index; i < n; ++i) {
+                    tail += sorted_[i];
+                    square += sorted_[i] * sorted_[i];
+                }
+                const double count = static_cast<double>(n - index), mean = tail / count;
+                out[l] = {sorted_[index], mean, std::max(square / count - mean * mean, 0.0)};
+            }
+            return;
+        }
+
+        pairs_.resize(n);
+        double total = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            pairs_[i] = {losses[i], weights[i]};
+            total += weights[i];
+        }
+        std::sort(pairs_.begin(), pairs_.end());
+        for (size_t l = 0; l < confidence.size(); ++l) {
+            const double below = confidence[l] * total;
+            double tail = 0.0, weighted = 0.0, square = 0.0;
+            size_t i = n;
+            while (i > 0) {
+                --i;
+                tail += pairs_[i].second;
+                weighted += pairs_[i].second * pairs_[i].first;
+                square += pairs_[i].second * pairs_[i].first * pairs_[i].first;
+                if (total - tail < below) break;
+            }
+            const double mean = weighted / tail;
+            out[l] = {pairs_[i].first, mean, std::max(square / tail - mean * mean, 0.0)};
+        }
+    }
+
+private:
+    std::vector<double> sorted_;
+    std::vector<std::pair<double, double>> pairs_;
+};
+
+// The control-variate corrected estimate and its standard error from batch
+// pairs (y_b, c_b): y - beta (c - exact), beta from the batch covariance
+std::pair<double, double> batch_estimate(double overall, double control_overall, double exact,
+                                         const std::vector<double>& y, const std::vector<double>& c) {
+    const size_t B = y.size();
+    if (B < 2) return {overall, std::numeric_limits<double>::quiet_NaN()};
+    double mean_y = 0.0, mean_c = 0.0;
+    for (size_t b = 0; b < B; ++b) {
+        mean_y += y[b] / static_cast<double>(B);
+        if (!c.empty()) mean_c += c[b] / static_cast<double>(B);
+    }
+    double beta = 0.0;
+    if (!c.empty()) {
+        double covariance = 0.0, variance = 0.0;
+        for (size_t b = 0; b < B; ++b) {
+            covariance += (y[b] - mean_y) * (c[b] - mean_c);
+            variance += (c[b] - mean_c) * (c[b] - mean_c);
+        }
+        if (variance > 0.0) beta = covariance / variance;
+    }
+    double spread = 0.0;
+    for (size_t b = 0; b < B; ++b) {
+        const double adjusted = y[b] - mean_y - (c.empty() ? 0.0 : beta * (c[b] - mean_c));
+        spread += adjusted * adjusted;
+    }
+    const double error = std::sqrt(spread / static_cast<double>(B - 1) / static_cast<double>(B));
+    return {c.empty() ? overall : overall - beta * (control_overall - exact), error};
+}
+
+} // namespace
+
+MonteCarloResults::MonteCarloResults(std::vector<size_t> horizons, std::vector<double> confidence,
+                                     std::vector<double> losses, LossEstimation estimation)
+    : horizons_{std::move(horizons)},
+      confidence_{std::move(confidence)},
+      paths_{horizons_.empty() ? 0 : losses.size() / horizons_.size()},
+      losses_{std::move(losses)},
+      batches_{std::max<size_t>(estimation.batches, 1)} {
+    if (paths_ == 0 || losses_.size() != horizons_.size() * paths_) {
+        throw std::invalid_argument("MonteCarloResults needs the same non-zero number of losses per horizon");
+    }
+    for (double level : confidence_) {
+        if (!(level > 0.0 && level < 1.0)) {
+            throw std::invalid_argument("Confidence levels must be in (0, 1)");
+        }
+    }
+    const size_t H = horizons_.size();
+    const size_t L = confidence_.size();
+    const bool weighted = !estimation.weights.empty();
+    const bool controlled = !estimation.control.empty();
+    if ((weighted && estimation.weights.size() != losses_.size()) ||
+        (controlled && (estimation.control.size() != losses_.size() || estimation.control_var.size() != H * L ||
+                        estimation.control_cvar.size() != H * L))) {
+        throw std::invalid_argument("Loss weights and control values must match the losses");
+    }
+    const size_t batch_size = batches_ == 1 ? paths_ : estimation.batch_size;
+    if (batch_size == 0 || batch_size * batches_ > paths_) {
+        throw std::invalid_argument("Batches don't fit in " + std::to_string(paths_) + " paths");
+    }
+
+    mean_.assign(H, 0.0);
+    var_.assign(H * L, 0.0);
+    cvar_.assign(H * L, 0.0);
+    var_error_.assign(H * L, std::numeric_limits<double>::quiet_NaN());
+    cvar_error_.assign(H * L, std::numeric_limits<double>::quiet_NaN());
+    cvar_gain_.assign(H * L, std::numeric_limits<double>::quiet_NaN());
+    TailEstimator estimator;
+    std::vector<Tail> tails, control_tails;
+    std::vector<double> batch_var(batches_), batch_cvar(batches_), control_var, control_cvar;
+    if (controlled) {
+        control_var.resize(batches_);
+        control_cvar.resize(batches_);
+    }
+    auto slice = [&](const std::vector<double>& values, size_t h, size_t begin, size_t end) {
+        return values.empty() ? std::span<const double>{}
+                              : std::span<const double>{values.data() + h * paths_ + begin, end - begin};
+    };
+
+    for (size_t h = 0; h < H; ++h) {
+        auto row = this->losses(h);
+        auto weights = slice(estimation.weights, h, 0, paths_);
+        double total = 0.0, weight = 0.0;
+        for (size_t i = 0; i < paths_; ++i) {
+            total += weighted ? weights[i] * row[i] : row[i];
+            weight += weighted ? weights[i] : 1.0;
+        }
+        mean_[h] = total / weight;
+
+        estimator.estimate(row, weights, confidence_, tails);
+        if (controlled) estimator.estimate(slice(estimation.control, h, 0, paths_), weights, confidence_, control_tails);
+        for (size_t l = 0; l < L; ++l) {
+            var_[h * L + l] = tails[l].var;
+            cvar_[h * L + l] = tails[l].cvar;
+        }
+        if (batches_ == 1) continue;
+
+        std::vector<std::vector<Tail>> per_batch(batches_), per_batch_control(batches_);
+        for (size_t b = 0; b < batches_; ++b) {
+            const size_t begin = b * batch_size, end = b + 1 == batches_ ? paths_ : begin + batch_size;
+            estimator.estimate(row.subspan(begin, end - begin), slice(estimation.weights, h, begin, end), confidence_,
+                               per_batch[b]);
+            if (controlled) {
+                estimator.estimate(slice(estimation.control, h, begin, end), slice(estimation.weights, h, begin, end),
+                                   confidence_, per_batch_control[b]);
+            }
+        }
+        for (size_t l = 0; l < L; ++l) {
+            const size_t at = h * L + l;
+            for (size_t b = 0; b < batches_; ++b) {
+                batch_var[b] = per_batch[b][l].var;
+                batch_cvar[b] = per_batch[b][l].cvar;
+                if (controlled) {
+                    control_var[b] = per_batch_control[b][l].var;
+                    control_cvar[b] = per_batch_control[b][l].cvar;
+                }
+            }
+            const double exact_var = controlled ? estimation.control_var[at] : 0.0;
+            const double exact_cvar = controlled ? estimation.control_cvar[at] : 0.0;
+            std::tie(var_[at], var_error_[at]) =
+                batch_estimate(var_[at], controlled ? control_tails[l].var : 0.0, exact_var, batch_var, control_var);
+            std::tie(cvar_[at], cvar_error_[at]) = batch_estimate(
+                cvar_[at], controlled ? control_tails[l].cvar : 0.0, exact_cvar, batch_cvar, control_cvar);
+
+            // Plain Monte Carlo's asymptotic CVaR variance: the tail's variance
+            // plus a (CVaR - VaR)^2 from the quantile, over the tail count
+            const double tail = 1.0 - confidence_[l];
+            const double gap = tails[l].cvar - tails[l].var;
+            const double plain = (tails[l].variance + confidence_[l] * gap * gap) / (static_cast<double>(paths_) * tail);
+            cvar_gain_[at] = plain / (cvar_error_[at] * cvar_error_[at]);
+        }
+    }
+}
+
+void MonteCarloResults::write_csv(const std::string& filepath) const {
+    std::ofstream out(filepath);
+    if (!out) {
+        throw std::runtime_error("Failed to create " + filepath);
+    }
+    out << "horizon_steps,confidence,VaR,CVaR,mean_loss,VaR_se,CVaR_se,CVaR_gain\n" << std::setprecision(17);
+    for (size_t h = 0; h < horizons_.size(); ++h) {
+        for (size_t l = 0; l < confidence_.size(); ++l) {
+            out << horizons_[h] << ',' << confidence_[l] << ',' << var(h, l) << ',' << cvar(h, l) << ',' << mean(h)
+                << ',' << var_error(h, l) << ',' << cvar_error(h, l) << ',' << cvar_gain(h, l) << '\n';
+        }
+    }
+    if (!out) {
+        throw std::runtime_error("Failed to write " + filepath);
+    }
+}
+
+} // namespace microregime
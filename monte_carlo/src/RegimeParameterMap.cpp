@@ -0,0 +1,108 @@
+#include "RegimeParameterMap.hpp"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include "text_parser.hpp"
+
+namespace microregime {
+
+RegimeParameterMap::RegimeParameterMap(std::vector<double> startprob, std::vector<double> transmat,
+                                       std::vector<double> drift, std::vector<double> volatility)
+    : startprob_{std::move(startprob)},
+      transmat_{std::move(transmat)},
+      drift_{std::move(drift)},
+      volatility_{std::move(volatility)} {
+    const size_t K = startprob_.size();
+    if (K == 0) {
+        throw std::invalid_argument("RegimeParameterMap needs at least one regime");
+    }
+    if (transmat_.size() != K * K || drift_.size() != K || volatility_.size() != K) {
+        throw std::invalid_argument("RegimeParameterMap sizes don't match " + std::to_string(K) + " regimes");
+    }
+    check_distribution(startprob_, "startprob");
+    for (size_t i = 0; i < K; ++i) {
+        check_distribution({transmat_.data() + i * K, K}, "transmat row " + std::to_string(i));
+        if (!std::isfinite(drift_[i]) || !std::isfinite(volatility_[i]) || volatility_[i] < 0.0) {
+            throw std::invalid_argument("Regime " + std::to_string(i) + " needs a finite drift and volatility >= 0");
+        }
+    }
+}
+
+RegimeParameterMap RegimeParameterMap::load(const std::string& filepath) {
+    TextParser parser(filepath, "regime parameters");
+
+    size_t version = 0, K = 0;
+    parser.expect("regime_parameters");
+    if (!parser.read(version) || version != 1) throw parser.fail("unsupported version");
+    parser.expect("regimes");
+    if (!parser.read(K) || K == 0) throw parser.fail("bad regime count");
+    auto startprob = parser.read_values("startprob", K);
+    auto transmat = parser.read_values("transmat", K * K);
+    auto drift = parser.read_values("drift", K);
+    auto volatility = parser.read_values("volatility", K);
+    try {
+        return RegimeParameterMap(std::move(startprob), std::move(transmat), std::move(drift), std::move(volatility));
+    } catch (const std::invalid_argument& e) {
+        throw parser.fail(e.what());
+    }
+}
+
+void RegimeParameterMap::save(const std::string& filepath) const {
+    std::ofstream out(filepath);
+    if (!out) {
+        throw std::runtime_error("Failed to create regime parameters: " + filepath);
+    }
+    out << std::setprecision(17);
+    auto write_values = [&](const char* keyword, std::span<const double> values) {
+        out << keyword;
+        for (size_t i = 0; i < values.size(); ++i) out << ((i % regimes() == 0) ? "\n" : " ") << values[i];
+        out << "\n";
+    };
+    out << "regime_parameters 1\nregimes " << regimes() << "\n";
+    write_values("startprob", startprob_);
+    write_values("transmat", transmat_);
+    write_values("drift", drift_);
+    write_values("volatility", volatility_);
+    if (!out) {
+        throw std::runtime_error("Failed to write regime parameters: " + filepath);
+    }
+}
+
+RegimeReturnEstimator::RegimeReturnEstimator(const GaussianHmm& model)
+    : model_{model}, count_(model.states(), 0), mean_(model.states(), 0.0), m2_(model.states(), 0.0) {}
+
+void RegimeReturnEstimator::add(size_t regime, double log_return) {
+    const double delta = log_return - mean_[regime];
+    mean_[regime] += delta / static_cast<double>(++count_[regime]);
+    m2_[regime] += delta * (log_return - mean_[regime]);
+}
+
+void RegimeReturnEstimator::add_day(std::span<const double> observations, std::span<const double> midprices) {
+    const size_t D = model_.dimensions();
+    if (observations.size() != midprices.size() * D) {
+        throw std::invalid_argument("add_day needs " + std::to_string(D) + " observations per midprice");
+    }
+    RegimeFilter filter(model_);
+    for (size_t t = 0; t < midprices.size(); ++t) {
+        filter.update(observations.subspan(t * D, D));
+        if (t == 0 || !(midprices[t] > 0.0) || !(midprices[t - 1] > 0.0)) continue;
+        add(filter.most_likely(), std::log(midprices[t]) - std::log(midprices[t - 1]));
+    }
+}
+
+RegimeParameterMap RegimeReturnEstimator::parameters() const {
+    const size_t K = model_.states();
+    std::vector<double> volatility(K);
+    for (size_t k = 0; k < K; ++k) {
+        if (count_[k] < 2) {
+            throw std::runtime_error("Regime " + std::to_string(k) + " has " + std::to_string(count_[k]) +
+                                     " labelled returns, need at least 2");
+        }
+        volatility[k] = std::sqrt(m2_[k] / static_cast<double>(count_[k] - 1));
+    }
+    return RegimeParameterMap({model_.startprob().begin(), model_.startprob().end()},
+                              {model_.transmat().begin(), model_.transmat().end()}, mean_, std::move(volatility));
+}
+
+} // namespace microregime
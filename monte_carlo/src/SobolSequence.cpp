@@ -0,0 +1,63 @@
+#include "SobolSequence.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace microregime {
+
+namespace {
+
+// Joe and Kuo's primitive polynomials (degree s, interior coefficients a) and
+// initial direction numbers m_1..m_s for dimensions 2 onwards
+struct Primitive {
+    int degree;
+    uint32_t coefficients;
+    uint32_t initial[7];
+};
+
+constexpr Primitive kPrimitives[SobolSequence::kMaxDimensions - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+};
+
+} // namespace
+
+SobolSequence::SobolSequence(size_t dimensions) : directions_(dimensions) {
+    if (dimensions == 0 || dimensions > kMaxDimensions) {
+        throw std::invalid_argument("SobolSequence supports 1 to " + std::to_string(kMaxDimensions) + " dimensions");
+    }
+    // The first dimension is van der Corput's
+    for (int i = 0; i < kBits; ++i) directions_[0][i] = uint32_t{1} << (kBits - 1 - i);
+
+    for (size_t d = 1; d < dimensions; ++d) {
+        const Primitive& p = kPrimitives[d - 1];
+        auto& v = directions_[d];
+        const int s = p.degree;
+        for (int i = 0; i < s; ++i) v[i] = p.initial[i] << (kBits - 1 - i);
+        for (int i = s; i < kBits; ++i) {
+            v[i] = v[i - s] ^ (v[i - s] >> s);
+            for (int k = 1; k < s; ++k) {
+                if ((p.coefficients >> (s - 1 - k)) & 1) v[i] ^= v[i - k];
+            }
+        }
+    }
+}
+
+} // namespace microregime
@@ -0,0 +1,51 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "RegimeParameterMap.hpp"
+#include "feature_file.hpp"
+#include "gaussian_hmm.hpp"
+
+// Labels each snapshot of the given days with a fitted model's forward filter
+// and writes the model's transition probabilities with each regime's
+// midprice log-return drift and volatility, for monte_carlo_var.
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <model.hmm> <output.regimes> <day.features>...\n"
+                  << "Day files are features_to_csv --binary output for the model's instrument, one per date.\n"
+                  << "Example: " << argv[0]
+                  << " run_outputs/output_Snapshot0.50_Window30000_Events1500/base_SPY/4/model.hmm spy_4.regimes"
+                     " data/output_Snapshot0.50_Window30000_Events1500/2025*/base_SPY.features\n";
+        return 1;
+    }
+
+    try {
+        using namespace microregime;
+        GaussianHmm model = GaussianHmm::load(argv[1]);
+        RegimeReturnEstimator estimator(model);
+        const size_t D = model.dimensions();
+        for (int i = 3; i < argc; ++i) {
+            FeatureFileReader reader(argv[i]);
+            if (reader.groups().size() < 2) {
+                throw std::runtime_error(std::string("Feature file has no normalized features: ") + argv[i]);
+            }
+            const size_t rows = reader.row_count();
+            std::vector<double> observations(rows * D);
+            for (size_t d = 0; d < D; ++d) {
+                auto column = reader.column(1, model.features()[d]);
+                for (size_t r = 0; r < rows; ++r) observations[r * D + d] = column[r];
+            }
+            estimator.add_day(observations, reader.column(0, Feature::midprice));
+        }
+
+        RegimeParameterMap parameters = estimator.parameters();
+        parameters.save(argv[2]);
+        for (size_t k = 0; k < parameters.regimes(); ++k) {
+            std::cerr << "Regime " << k << ": " << estimator.count(k) << " returns, drift " << parameters.drift()[k]
+                      << ", volatility " << parameters.volatility()[k] << "\n";
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,114 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MonteCarloEngine.hpp"
+#include "RegimeParameterMap.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+template <typename T>
+std::vector<T> parse_list(const std::string& text) {
+    std::vector<T> values;
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) values.push_back(static_cast<T>(std::stod(item)));
+    return values;
+}
+
+} // namespace
+
+// Simulates regime-switching price paths from fit_regime_parameters output
+// and prints VaR / CVaR of a long position for each horizon and level.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <parameters.regimes> [--paths N] [--horizons S,S,...] [--confidence A,A,...] [--seed N]"
+                     " [--regime K] [--threads N] [--csv FILE] [--sampling pseudo|antithetic|sobol] [--control]"
+                     " [--crisis-tilt X] [--crisis-regime K] [--batches N]\n"
+                  << "Horizons are in snapshot steps; --regime starts every path in regime K instead of startprob.\n"
+                  << "--crisis-tilt multiplies the odds of entering the crisis regime (default: the most volatile)\n"
+                  << "and reweights; --control corrects against a single-regime Gaussian path. Standard errors\n"
+                  << "and the CVaR gain over plain sampling come from --batches independent batches.\n"
+                  << "Example: " << argv[0] << " spy_4.regimes --paths 4000000 --horizons 120,1200,7200"
+                  << " --confidence 0.99,0.999 --regime 2 --sampling sobol --control --crisis-tilt 4\n";
+        return 1;
+    }
+
+    try {
+        using namespace microregime;
+        RegimeParameterMap parameters = RegimeParameterMap::load(argv[1]);
+        MonteCarloConfig config;
+        size_t threads = std::thread::hardware_concurrency();
+        std::string csv;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--control") {
+                config.control_variate = true;
+                continue;
+            }
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+            std::string value = argv[++i];
+            if (arg == "--paths") {
+                config.paths = std::stoull(value);
+            } else if (arg == "--horizons") {
+                config.horizons = parse_list<size_t>(value);
+            } else if (arg == "--confidence") {
+                config.confidence = parse_list<double>(value);
+            } else if (arg == "--seed") {
+                config.seed = std::stoull(value);
+            } else if (arg == "--regime") {
+                config.initial.assign(parameters.regimes(), 0.0);
+                config.initial.at(std::stoul(value)) = 1.0;
+            } else if (arg == "--threads") {
+                threads = std::stoul(value);
+            } else if (arg == "--csv") {
+                csv = value;
+            } else if (arg == "--sampling") {
+                if (value == "pseudo") {
+                    config.sampling = Sampling::Pseudo;
+                } else if (value == "antithetic") {
+                    config.sampling = Sampling::Antithetic;
+                } else if (value == "sobol") {
+                    config.sampling = Sampling::Sobol;
+                } else {
+                    throw std::invalid_argument("Unknown sampling " + value);
+                }
+            } else if (arg == "--crisis-tilt") {
+                config.crisis_tilt = std::stod(value);
+            } else if (arg == "--crisis-regime") {
+                config.crisis_regime = std::stoul(value);
+            } else if (arg == "--batches") {
+                config.batches = std::stoul(value);
+            } else {
+                throw std::invalid_argument("Unknown option " + arg);
+            }
+        }
+
+        ThreadPool pool(threads);
+        MonteCarloEngine engine(parameters, pool);
+        auto start = std::chrono::steady_clock::now();
+        MonteCarloResults results = engine.run(config);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "horizon_steps,confidence,VaR,CVaR,VaR_se,CVaR_se,CVaR_gain\n" << std::setprecision(6);
+        for (size_t h = 0; h < results.horizons().size(); ++h) {
+            for (size_t l = 0; l < results.confidence().size(); ++l) {
+                std::cout << results.horizons()[h] << ',' << results.confidence()[l] << ',' << results.var(h, l)
+                          << ',' << results.cvar(h, l) << ',' << results.var_error(h, l) << ','
+                          << results.cvar_error(h, l) << ',' << results.cvar_gain(h, l) << '\n';
+            }
+        }
+        if (!csv.empty()) results.write_csv(csv);
+        std::cerr << config.paths << " paths x " << config.horizons.back() << " steps on " << pool.size()
+                  << " threads in " << std::setprecision(3) << seconds << " s\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
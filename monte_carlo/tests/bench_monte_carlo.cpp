@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <MonteCarloEngine.hpp>
+#include <RegimeParameterMap.hpp>
+#include <thread_pool.hpp>
+
+using namespace std::chrono;
+using namespace microregime;
+
+// A million four-regime paths over 240 steps (two minutes of half-second
+// snapshots), with one worker and with one per hardware thread
+TEST(MonteCarloBenchmark, PathStepsPerSecondByPoolSize) {
+    RegimeParameterMap parameters({0.4, 0.3, 0.2, 0.1},
+                                  {0.97, 0.01, 0.01, 0.01,
+                                   0.02, 0.95, 0.02, 0.01,
+                                   0.01, 0.03, 0.94, 0.02,
+                                   0.01, 0.01, 0.03, 0.95},
+                                  {0.0, 1e-6, -2e-6, -1e-5}, {5e-5, 1e-4, 2e-4, 6e-4});
+    MonteCarloConfig config;
+    config.paths = 1'000'000;
+    config.horizons = {1, 24, 240};
+    config.confidence = {0.99, 0.999};
+
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads : {size_t{1}, hardware}) {
+        ThreadPool pool(threads);
+        MonteCarloEngine engine(parameters, pool);
+        auto start = high_resolution_clock::now();
+        MonteCarloResults results = engine.run(config);
+        double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        EXPECT_TRUE(std::isfinite(results.cvar(2, 1)));
+
+        double steps = static_cast<double>(config.paths) * config.horizons.back();
+        std::cout << "Monte Carlo, " << config.paths << " paths x " << config.horizons.back() << " steps, "
+                  << threads << " threads: " << seconds << " s, " << seconds * 1e9 / steps << " ns/path-step"
+                  << std::endl;
+    }
+}
+
+// Each variance reduction on a calm regime and a rare, violent one: cost per
+// path-step and the effective sample size (paths x CVaR gain) at 99%
+TEST(MonteCarloBenchmark, EffectiveSamplesByVarianceReduction) {
+    RegimeParameterMap parameters({0.99, 0.01}, {0.995, 0.005, 0.1, 0.9}, {0.0, -2e-5}, {1e-4, 1e-3});
+    struct Method {
+        const char* name;
+        Sampling sampling;
+        bool control_variate;
+        double crisis_tilt;
+    };
+    const Method methods[] = {{"plain", Sampling::Pseudo, false, 1.0},
+                              {"antithetic", Sampling::Antithetic, false, 1.0},
+                              {"sobol bridge", Sampling::Sobol, false, 1.0},
+                              {"control variate", Sampling::Pseudo, true, 1.0},
+                              {"crisis tilt 2", Sampling::Pseudo, false, 2.0},
+                              {"sobol + control + tilt 2", Sampling::Sobol, true, 2.0}};
+    ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    MonteCarloEngine engine(parameters, pool);
+    for (const Method& method : methods) {
+        MonteCarloConfig config;
+        config.paths = 500'000;
+        config.horizons = {1, 24, 240};
+        config.confidence = {0.99};
+        config.sampling = method.sampling;
+        config.control_variate = method.control_variate;
+        config.crisis_tilt = method.crisis_tilt;
+        auto start = high_resolution_clock::now();
+        MonteCarloResults results = engine.run(config);
+        double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+        EXPECT_TRUE(std::isfinite(results.cvar_gain(2, 0)));
+
+        double steps = static_cast<double>(config.paths) * config.horizons.back();
+        std::cout << "Monte Carlo, " << method.name << ": " << seconds * 1e9 / steps << " ns/path-step, CVaR 99% ESS";
+        for (size_t h = 0; h < config.horizons.size(); ++h) {
+            std::cout << " " << config.horizons[h] << " steps "
+                      << static_cast<double>(config.paths) * results.cvar_gain(h, 0);
+        }
+        std::cout << std::endl;
+    }
+}
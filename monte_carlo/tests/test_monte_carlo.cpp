@@ -0,0 +1,420 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <MonteCarloEngine.hpp>
+#include <MonteCarloResults.hpp>
+#include <NormalDistribution.hpp>
+#include <Philox.hpp>
+#include <RegimeParameterMap.hpp>
+#include <SobolSequence.hpp>
+#include <VectorMath.hpp>
+#include <gaussian_hmm.hpp>
+#include <thread_pool.hpp>
+
+using namespace microregime;
+namespace fs = std::filesystem;
+
+namespace {
+
+// A calm regime, a drifting one and a volatile one that is hard to leave
+RegimeParameterMap three_regimes() {
+    return RegimeParameterMap({0.5, 0.3, 0.2},
+                              {0.90, 0.08, 0.02,
+                               0.10, 0.85, 0.05,
+                               0.02, 0.03, 0.95},
+                              {0.0, 0.002, -0.003}, {0.002, 0.004, 0.012});
+}
+
+// A calm regime and a rare, violent one: plain sampling sees few crisis paths
+RegimeParameterMap rare_crisis() {
+    return RegimeParameterMap({0.99, 0.01}, {0.995, 0.005, 0.1, 0.9}, {0.0, -0.002}, {0.001, 0.01});
+}
+
+} // namespace
+
+TEST(PhiloxTest, MatchesKnownAnswers) {
+    // Random123's kat_vectors for philox4x32_10
+    using philox::Counter;
+    EXPECT_EQ(philox::generate({0, 0, 0, 0}, {0, 0}), (Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(philox::generate({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+              (Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(philox::generate({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+              (Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+    EXPECT_GT(philox::to_uniform(0), 0.0);
+    EXPECT_LT(philox::to_uniform(0xffffffff), 1.0);
+}
+
+TEST(VectorMathTest, MatchesLibm) {
+    double worst_log = 0.0, worst_sin = 0.0, worst_cos = 0.0;
+    for (uint64_t bits = 0; bits <= 0xffffffff; bits += 65'521) {
+        const double u = philox::to_uniform(static_cast<uint32_t>(bits));
+        worst_log = std::max(worst_log, std::abs(vector_math::log(u) / std::log(u) - 1.0));
+        double s, c;
+        vector_math::sincos_2pi(u, s, c);
+        worst_sin = std::max(worst_sin, std::abs(s - std::sin(2.0 * std::numbers::pi * u)));
+        worst_cos = std::max(worst_cos, std::abs(c - std::cos(2.0 * std::numbers::pi * u)));
+    }
+    EXPECT_LT(worst_log, 4e-15);
+    EXPECT_LT(worst_sin, 4e-15);
+    EXPECT_LT(worst_cos, 4e-15);
+    for (double x : {1e-300, 0.5, 1.0, 3.0, 1e300}) {
+        EXPECT_NEAR(vector_math::log(x), std::log(x), 1e-15 * std::abs(std::log(x)));
+    }
+}
+
+TEST(MonteCarloEngineTest, SingleRegimeMatchesTheClosedForm) {
+    // log P_h / P_0 ~ N(h mu, h sigma^2), so loss = 1 - e^L has closed-form tails
+    const double mu = 1e-4, sigma = 2e-3;
+    RegimeParameterMap parameters({1.0}, {1.0}, {mu}, {sigma});
+    ThreadPool pool(2);
+    MonteCarloConfig config;
+    config.paths = 100'000;
+    config.horizons = {1, 25, 100};
+    config.confidence = {0.95, 0.99};
+    MonteCarloResults results = MonteCarloEngine(parameters, pool).run(config);
+    ASSERT_EQ(results.paths(), 100'000u);
+
+    const double z[] = {1.6448536269514722, 2.3263478740408408};
+    for (size_t h = 0; h < 3; ++h) {
+        const double m = mu * config.horizons[h], s = sigma * std::sqrt(static_cast<double>(config.horizons[h]));
+        EXPECT_NEAR(results.mean(h), 1.0 - std::exp(m + s * s / 2), 0.01 * s);
+        for (size_t l = 0; l < 2; ++l) {
+            const double a = config.confidence[l];
+            const double q = m - s * z[l];
+            const double var = 1.0 - std::exp(q);
+            const double cvar = 1.0 - std::exp(m + s * s / 2) * normal_cdf((q - m - s * s) / s) / (1.0 - a);
+            EXPECT_NEAR(results.var(h, l), var, 0.02 * var) << "horizon " << config.horizons[h] << ", " << a;
+            EXPECT_NEAR(results.cvar(h, l), cvar, 0.02 * cvar) << "horizon " << config.horizons[h] << ", " << a;
+            EXPECT_GE(results.cvar(h, l), results.var(h, l));
+        }
+    }
+}
+
+TEST(MonteCarloEngineTest, SwitchingMatchesTheExactExpectedGrowth) {
+    // v_k(t) = E[e^{L_t}; regime_t = k] runs forward exactly:
+    // v(1) = initial .* g, v(t + 1) = (v(t) A) .* g with g_k = exp(mu_k + sigma_k^2 / 2)
+    RegimeParameterMap parameters = three_regimes();
+    const size_t K = 3;
+    ThreadPool pool(2);
+    MonteCarloEngine engine(parameters, pool);
+
+    for (std::vector<double> initial : {std::vector<double>{}, std::vector<double>{0.0, 0.0, 1.0}}) {
+        MonteCarloConfig config;
+        config.paths = 100'000;
+        config.horizons = {1, 10, 60};
+        config.initial = initial;
+        MonteCarloResults results = engine.run(config);
+
+        std::vector<double> g(K), v(K), w(K);
+        for (size_t k = 0; k < K; ++k) {
+            g[k] = std::exp(parameters.drift()[k] + parameters.volatility()[k] * parameters.volatility()[k] / 2);
+            v[k] = (initial.empty() ? parameters.startprob()[k] : initial[k]) * g[k];
+        }
+        size_t h = 0;
+        for (size_t t = 1; t <= 60; ++t) {
+            if (t > 1) {
+                for (size_t j = 0; j < K; ++j) {
+                    w[j] = 0.0;
+                    for (size_t k = 0; k < K; ++k) w[j] += v[k] * parameters.transmat()[k * K + j];
+                    w[j] *= g[j];
+                }
+                v = w;
+            }
+            if (t == config.horizons[h]) {
+                double growth = v[0] + v[1] + v[2];
+                double spread = std::sqrt(t * 1.44e-4);  // Loose bound on the loss's standard deviation
+                EXPECT_NEAR(results.mean(h), 1.0 - growth, 4.0 * spread / std::sqrt(100'000.0)) << "step " << t;
+                ++h;
+            }
+        }
+    }
+}
+
+TEST(MonteCarloEngineTest, SameLossesOnAnyPoolSizeAndSplit) {
+    RegimeParameterMap parameters = three_regimes();
+    MonteCarloConfig config;
+    config.paths = 3 * MonteCarloEngine::kBlockPaths + 123;  // A partial last block
+    config.horizons = {3, 17};
+    config.seed = 7;
+
+    ThreadPool one(1), four(4);
+    MonteCarloResults serial = MonteCarloEngine(parameters, one).run(config);
+    MonteCarloResults parallel = MonteCarloEngine(parameters, four).run(config);
+    for (size_t h = 0; h < 2; ++h) {
+        auto a = serial.losses(h), b = parallel.losses(h);
+        ASSERT_TRUE(std::equal(a.begin(), a.end(), b.begin(), b.end())) << "horizon " << h;
+        EXPECT_EQ(serial.var(h, 1), parallel.var(h, 1));
+    }
+
+    // Paths don't depend on where a block starts
+    const uint64_t first = 1'000;
+    const size_t count = 3'000;
+    auto slice = MonteCarloEngine(parameters, one).simulate(config, first, count);
+    for (size_t h = 0; h < 2; ++h) {
+        for (size_t i = 0; i < count; ++i) ASSERT_EQ(slice[h * count + i], serial.losses(h)[first + i]);
+    }
+
+    config.seed = 8;
+    MonteCarloResults reseeded = MonteCarloEngine(parameters, one).run(config);
+    EXPECT_NE(reseeded.losses(1)[0], serial.losses(1)[0]);
+}
+
+TEST(MonteCarloEngineTest, RejectsBadConfigs) {
+    RegimeParameterMap parameters = three_regimes();
+    ThreadPool pool(1);
+    MonteCarloEngine engine(parameters, pool);
+    MonteCarloConfig config;
+    config.paths = 10;
+    config.batches = 1;
+    config.horizons = {5, 5};
+    EXPECT_THROW(engine.run(config), std::invalid_argument);
+    config.horizons = {0, 5};
+    EXPECT_THROW(engine.run(config), std::invalid_argument);
+    config.horizons = {5};
+    config.confidence = {1.0};
+    EXPECT_THROW(engine.run(config), std::invalid_argument);
+    config.confidence = {0.9};
+    config.initial = {0.5, 0.5};
+    EXPECT_THROW(engine.run(config), std::invalid_argument);
+    config.initial = {0.5, 0.5, 0.5};
+    EXPECT_THROW(engine.run(config), std::invalid_argument);
+    config.initial.clear();
+    config.paths = 0;
+    EXPECT_THROW(engine.run(config), std::invalid_argument);
+    config.paths = 10;
+    config.batches = 6;
+    EXPECT_THROW(engine.run(config), std::invalid_argument);
+    config.batches = 1;
+    config.crisis_tilt = 0.0;
+    EXPECT_THROW(engine.run(config), std::invalid_argument);
+    config.crisis_tilt = 2.0;
+    config.crisis_regime = 3;
+    EXPECT_THROW(engine.run(config), std::invalid_argument);
+}
+
+TEST(NormalDistributionTest, QuantileInvertsTheCdf) {
+    EXPECT_NEAR(normal_quantile(0.975), 1.959963984540054, 1e-15);
+    EXPECT_NEAR(normal_quantile(0.01), -2.3263478740408408, 1e-15);
+    for (double p : {1e-300, 1e-20, 1e-6, 0.02, 0.3, 0.5, 0.7, 0.98, 1.0 - 1e-12}) {
+        EXPECT_NEAR(normal_cdf(normal_quantile(p)), p, 1e-12 * std::min(p, 1.0 - p)) << p;
+    }
+}
+
+TEST(SobolSequenceTest, StratifiesEveryDimension) {
+    SobolSequence sobol(SobolSequence::kMaxDimensions);
+    EXPECT_THROW(SobolSequence(SobolSequence::kMaxDimensions + 1), std::invalid_argument);
+    // The standard sequence starts 0, 1/2, then (3/4, 1/4) and (1/4, 3/4)
+    EXPECT_EQ(sobol.point(1, 0), 0x80000000u);
+    EXPECT_EQ(sobol.point(2, 0), 0xc0000000u);
+    EXPECT_EQ(sobol.point(2, 1), 0x40000000u);
+    EXPECT_EQ(sobol.point(3, 1), 0xc0000000u);
+
+    const size_t m = 10, n = size_t{1} << m;
+    for (size_t j = 0; j < sobol.dimensions(); ++j) {
+        std::vector<int> cells(n, 0);
+        for (uint64_t i = 0; i < n; ++i) ++cells[sobol.point(i, j) >> (32 - m)];
+        EXPECT_TRUE(std::all_of(cells.begin(), cells.end(), [](int c) { return c == 1; })) << "dimension " << j;
+    }
+    // The first two dimensions are a (0, 2)-sequence: one point in each square too
+    std::vector<int> squares(n, 0);
+    for (uint64_t i = 0; i < n; ++i) {
+        ++squares[(sobol.point(i, 0) >> (32 - m / 2)) * (size_t{1} << m / 2) + (sobol.point(i, 1) >> (32 - m / 2))];
+    }
+    EXPECT_TRUE(std::all_of(squares.begin(), squares.end(), [](int c) { return c == 1; }));
+}
+
+TEST(MonteCarloEngineTest, PlainSamplingErrorMatchesTheAsymptotic) {
+    // Batch errors of plain sampling should agree with the textbook CVaR variance
+    RegimeParameterMap parameters = three_regimes();
+    ThreadPool pool(2);
+    MonteCarloConfig config;
+    config.paths = 200'000;
+    config.horizons = {1, 40};
+    config.confidence = {0.95, 0.99};
+    config.batches = 40;
+    MonteCarloResults results = MonteCarloEngine(parameters, pool).run(config);
+    EXPECT_EQ(results.batches(), 40u);
+    for (size_t h = 0; h < 2; ++h) {
+        for (size_t l = 0; l < 2; ++l) {
+            EXPECT_GT(results.cvar_error(h, l), 0.0);
+            EXPECT_GT(results.var_error(h, l), 0.0);
+            EXPECT_GT(results.cvar_gain(h, l), 0.5) << h << ", " << l;
+            EXPECT_LT(results.cvar_gain(h, l), 2.0) << h << ", " << l;
+        }
+    }
+}
+
+TEST(MonteCarloEngineTest, VarianceReductionAgreesWithPlainSampling) {
+    RegimeParameterMap parameters = rare_crisis();
+    ThreadPool pool(2);
+    MonteCarloEngine engine(parameters, pool);
+    MonteCarloConfig plain;
+    plain.paths = 400'000;
+    plain.horizons = {1, 30, 200};
+    plain.confidence = {0.95, 0.99};
+    plain.seed = 3;
+    MonteCarloResults reference = engine.run(plain);
+
+    auto check = [&](const MonteCarloConfig& config, const char* name) {
+        MonteCarloResults results = engine.run(config);
+        for (size_t h = 0; h < 3; ++h) {
+            for (size_t l = 0; l < 2; ++l) {
+                const double error = std::hypot(reference.cvar_error(h, l), results.cvar_error(h, l));
+                EXPECT_NEAR(results.cvar(h, l), reference.cvar(h, l), 4.0 * error) << name << " " << h << ", " << l;
+                const double var_error = std::hypot(reference.var_error(h, l), results.var_error(h, l));
+                EXPECT_NEAR(results.var(h, l), reference.var(h, l), 4.0 * var_error) << name << " " << h << ", " << l;
+            }
+        }
+        return results;
+    };
+    MonteCarloConfig config = plain;
+    config.paths = 100'000;
+    config.seed = 4;
+    config.sampling = Sampling::Antithetic;
+    check(config, "antithetic");
+    config.sampling = Sampling::Sobol;
+    check(config, "sobol");
+    config.sampling = Sampling::Pseudo;
+    config.crisis_tilt = 2.0;
+    MonteCarloResults tilted = check(config, "importance");
+    config.crisis_tilt = 1.0;
+    config.control_variate = true;
+    check(config, "control");
+
+    // Crisis paths make the tail, so tilting toward them pays off there
+    EXPECT_GT(tilted.cvar_gain(1, 1), 2.0);
+    EXPECT_GT(tilted.cvar_gain(2, 1), 2.0);
+}
+
+TEST(MonteCarloEngineTest, ControlVariateIsExactForASingleRegime) {
+    // The control path is then the simulated path, so the correction leaves
+    // the closed form and no error
+    const double mu = 1e-4, sigma = 2e-3;
+    RegimeParameterMap parameters({1.0}, {1.0}, {mu}, {sigma});
+    ThreadPool pool(1);
+    MonteCarloConfig config;
+    config.paths = 20'000;
+    config.horizons = {1, 50};
+    config.confidence = {0.99};
+    config.control_variate = true;
+    MonteCarloResults results = MonteCarloEngine(parameters, pool).run(config);
+    for (size_t h = 0; h < 2; ++h) {
+        const double m = mu * config.horizons[h], s = sigma * std::sqrt(static_cast<double>(config.horizons[h]));
+        const double q = m - s * 2.3263478740408408;
+        EXPECT_NEAR(results.var(h, 0), 1.0 - std::exp(q), 1e-12);
+        EXPECT_NEAR(results.cvar(h, 0), 1.0 - std::exp(m + s * s / 2) * normal_cdf((q - m - s * s) / s) / 0.01, 1e-12);
+        EXPECT_LT(results.cvar_error(h, 0), 1e-12);
+    }
+}
+
+TEST(MonteCarloEngineTest, VarianceReductionIsReproducibleOnAnyPoolSize) {
+    RegimeParameterMap parameters = three_regimes();
+    MonteCarloConfig config;
+    config.paths = 2 * MonteCarloEngine::kBlockPaths + 301;
+    config.horizons = {3, 17, 40};
+    config.crisis_tilt = 3.0;
+    config.control_variate = true;
+    config.batches = 8;
+    ThreadPool one(1), four(4);
+    for (Sampling sampling : {Sampling::Antithetic, Sampling::Sobol}) {
+        config.sampling = sampling;
+        MonteCarloResults serial = MonteCarloEngine(parameters, one).run(config);
+        MonteCarloResults parallel = MonteCarloEngine(parameters, four).run(config);
+        for (size_t h = 0; h < 3; ++h) {
+            auto a = serial.losses(h), b = parallel.losses(h);
+            ASSERT_TRUE(std::equal(a.begin(), a.end(), b.begin(), b.end())) << "horizon " << h;
+            EXPECT_EQ(serial.cvar(h, 0), parallel.cvar(h, 0));
+            EXPECT_EQ(serial.cvar_error(h, 0), parallel.cvar_error(h, 0));
+        }
+        auto slice = MonteCarloEngine(parameters, one).simulate(config, 1'001, 2'000);
+        for (size_t i = 0; i < 2'000; ++i) ASSERT_EQ(slice[2 * 2'000 + i], serial.losses(2)[1'001 + i]);
+    }
+}
+
+TEST(MonteCarloResultsTest, TailStatisticsAreOrderStatistics) {
+    std::vector<double> losses;
+    for (int i = 100; i >= 1; --i) losses.push_back(i * 0.01);
+    MonteCarloResults results({4}, {0.9, 0.95}, losses);
+    EXPECT_DOUBLE_EQ(results.var(0, 0), 0.90);  // The 90th smallest of 100
+    EXPECT_DOUBLE_EQ(results.cvar(0, 0), 0.95);  // Mean of 0.90 ... 1.00
+    EXPECT_DOUBLE_EQ(results.var(0, 1), 0.95);
+    EXPECT_DOUBLE_EQ(results.cvar(0, 1), 0.975);
+    EXPECT_DOUBLE_EQ(results.mean(0), 0.505);
+    EXPECT_EQ(results.losses(0)[0], 1.0);  // Path order is kept
+    EXPECT_THROW(MonteCarloResults({1, 2}, {0.9}, {1.0, 2.0, 3.0}), std::invalid_argument);
+    EXPECT_TRUE(std::isnan(results.cvar_error(0, 0)));
+
+    // Weight 3 on the top ten losses of a total of 120: the top eight hold
+    // exactly the 20% tail, so the 80% quantile is the ninth
+    LossEstimation estimation;
+    estimation.weights.assign(100, 1.0);
+    std::fill(estimation.weights.begin(), estimation.weights.begin() + 10, 3.0);
+    MonteCarloResults weighted({4}, {0.8}, losses, estimation);
+    EXPECT_DOUBLE_EQ(weighted.var(0, 0), 0.92);
+    EXPECT_DOUBLE_EQ(weighted.cvar(0, 0), 0.96);
+    estimation.weights.pop_back();
+    EXPECT_THROW(MonteCarloResults({4}, {0.8}, losses, estimation), std::invalid_argument);
+}
+
+TEST(RegimeParameterMapTest, SavesAndLoadsAtFullPrecision) {
+    fs::path path = fs::temp_directory_path() / "regime_parameter_map_test.regimes";
+    RegimeParameterMap parameters = three_regimes();
+    parameters.save(path.string());
+    RegimeParameterMap loaded = RegimeParameterMap::load(path.string());
+    ASSERT_EQ(loaded.regimes(), 3u);
+    for (size_t i = 0; i < 9; ++i) EXPECT_EQ(loaded.transmat()[i], parameters.transmat()[i]);
+    for (size_t k = 0; k < 3; ++k) {
+        EXPECT_EQ(loaded.startprob()[k], parameters.startprob()[k]);
+        EXPECT_EQ(loaded.drift()[k], parameters.drift()[k]);
+        EXPECT_EQ(loaded.volatility()[k], parameters.volatility()[k]);
+    }
+
+    std::ofstream(path) << "regime_parameters 1\nregimes 2\nstartprob 1 0\ntransmat 1 0 0.5 0.6\ndrift 0 0\n"
+                           "volatility 1 1\n";
+    EXPECT_THROW(RegimeParameterMap::load(path.string()), std::runtime_error);
+    std::ofstream(path) << "regime_parameters 1\nregimes 2\nstartprob 1 0\ntransmat 1 0\n";
+    EXPECT_THROW(RegimeParameterMap::load(path.string()), std::runtime_error);
+    EXPECT_THROW(RegimeParameterMap({1.0}, {1.0}, {0.0}, {-1.0}), std::invalid_argument);
+    EXPECT_THROW(RegimeParameterMap({1.0}, {1.0, 0.0}, {0.0}, {1.0}), std::invalid_argument);
+    fs::remove(path);
+}
+
+TEST(RegimeReturnEstimatorTest, RecoversEachRegimesReturnMoments) {
+    // Two sticky regimes far apart in one feature; returns drawn per true regime
+    GaussianHmm model({Feature::ewm_volatility}, {0.5, 0.5}, {0.99, 0.01, 0.01, 0.99}, {0.0, 5.0}, {0.1, 0.1});
+    const double drift[] = {1e-5, -2e-5}, volatility[] = {1e-4, 5e-4};
+    std::mt19937_64 rng(11);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    RegimeReturnEstimator estimator(model);
+    for (int day = 0; day < 2; ++day) {
+        std::vector<double> observations, midprices;
+        size_t state = day;
+        double log_price = std::log(500.0);
+        for (int t = 0; t < 20'000; ++t) {
+            if (uniform(rng) < 0.01) state = 1 - state;
+            observations.push_back(model.mean(state)[0] + std::sqrt(0.1) * noise(rng));
+            if (t > 0) log_price += drift[state] + volatility[state] * noise(rng);
+            midprices.push_back(std::exp(log_price));
+        }
+        estimator.add_day(observations, midprices);
+    }
+    EXPECT_EQ(estimator.count(0) + estimator.count(1), 2u * 19'999u);
+
+    RegimeParameterMap parameters = estimator.parameters();
+    EXPECT_EQ(parameters.transmat()[1], 0.01);
+    for (size_t k = 0; k < 2; ++k) {
+        EXPECT_NEAR(parameters.volatility()[k], volatility[k], 0.03 * volatility[k]) << "regime " << k;
+        EXPECT_NEAR(parameters.drift()[k], drift[k], 4.0 * volatility[k] / std::sqrt(estimator.count(k)));
+    }
+
+    RegimeReturnEstimator empty(model);
+    EXPECT_THROW(empty.parameters(), std::runtime_error);
+}
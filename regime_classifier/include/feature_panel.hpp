@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+#include "feature_set.hpp"
+
+namespace microregime {
+
+// One instrument's normalized features over several days, in a fixed feature
+// order, for fitting. Each day is its own sequence (classifier.py's
+// `lengths`), so nothing links the close of one day to the next open.
+class FeaturePanel {
+public:
+    explicit FeaturePanel(std::vector<Feature> features);
+
+    // Append one day: a features_to_csv --binary file (primary normalization)
+    // or a features_to_csv _norm.csv. Throws std::runtime_error if the file
+    // can't be read, lacks one of the features, or holds a non-finite value.
+    void load(const std::string& filepath);
+
+    // Append one sequence of rows x dimensions() values, row-major
+    void append(std::span<const double> sequence);
+
+    const std::vector<Feature>& features() const { return features_; }
+    size_t dimensions() const { return features_.size(); }
+    size_t rows() const { return values_.size() / dimensions(); }
+    size_t sequences() const { return offsets_.size() - 1; }
+
+    std::span<const double> values() const { return values_; }
+    std::span<const double> sequence(size_t index) const;
+
+private:
+    std::vector<Feature> features_;
+    std::vector<double> values_;
+    std::vector<size_t> offsets_{0};  // First row of each sequence, then rows()
+
+    void load_feature_file(const std::string& filepath);
+    void load_csv(const std::string& filepath);
+};
+
+} // namespace microregime
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+#include "feature_set.hpp"
+
+namespace microregime {
+
+// A fitted Gaussian HMM with full covariances (hmmlearn's GaussianHMM with
+// covariance_type="full"), over a named subset of the features.
+//
+// Each covariance is Cholesky-factored once at construction, so an emission
+// log-density is one triangular solve: log N(x; mu, S) = c - |L^-1 (x - mu)|^2 / 2
+// with S = L L^T and c = -(D log 2pi) / 2 - sum log L_ii.
+//
+// Text format (classifier.py writes it as model.hmm next to model_params.txt):
+//   gaussian_hmm 1
+//   states K
+//   features D name_1 ... name_D     (registry names, observation order)
+//   startprob  K values
+//   transmat   K*K values, row-major (row = from state)
+//   means      K*D values
+//   covars     K*D*D values
+class GaussianHmm {
+public:
+    // Throws std::invalid_argument on inconsistent sizes, rows that don't sum to
+    // 1, or a covariance that isn't symmetric positive definite
+    GaussianHmm(std::vector<Feature> features, std::vector<double> startprob, std::vector<double> transmat,
+                std::vector<double> means, std::vector<double> covars);
+
+    // Throws std::runtime_error if the file can't be read or parsed
+    static GaussianHmm load(const std::string& filepath);
+    void save(const std::string& filepath) const;
+
+    size_t states() const { return states_; }
+    size_t dimensions() const { return features_.size(); }
+    const std::vector<Feature>& features() const { return features_; }
+
+    std::span<const double> startprob() const { return startprob_; }
+    std::span<const double> transmat() const { return transmat_; }
+    std::span<const double> mean(size_t state) const { return {means_.data() + state * dimensions(), dimensions()}; }
+    std::span<const double> covar(size_t state) const;
+
+    // log N(x; mean(state), covar(state)); x holds dimensions() values
+    double log_density(size_t state, std::span<const double> x) const;
+
+    // log_density for each of the rows of xs (rows x dimensions(), row-major)
+    // into out. Rows are transposed a block at a time so the triangular solve
+    // runs down contiguous columns and vectorizes.
+    void log_densities(size_t state, std::span<const double> xs, std::span<double> out) const;
+
+    // The model's observation from a FeatureSet
+    void observe(const FeatureSet& features, std::span<double> x) const;
+
+private:
+    size_t states_;
+    std::vector<Feature> features_;
+    std::vector<double> startprob_;
+    std::vector<double> transmat_;
+    std::vector<double> means_;
+    std::vector<double> covars_;
+    std::vector<double> cholesky_;  // Lower factors, K*D*D row-major
+    std::vector<double> log_norm_;  // c per state
+};
+
+// Forward filter: P(state_t | x_1..x_t) updated one observation at a time in
+// O(K^2 + K D^2), with per-step rescaling so it runs indefinitely.
+class RegimeFilter {
+public:
+    explicit RegimeFilter(const GaussianHmm& model);
+
+    // Fold in one observation and return the filtered posterior
+    std::span<const double> update(std::span<const double> x);
+
+    // Forget all observations; the next update starts from startprob
+    void reset();
+
+    std::span<const double> posterior() const { return posterior_; }
+    size_t most_likely() const;
+    double log_likelihood() const { return log_likelihood_; }  // log p(x_1..x_t)
+    size_t observations() const { return observations_; }
+
+private:
+    const GaussianHmm& model_;
+    std::vector<double> posterior_;
+    std::vector<double> predicted_;
+    std::vector<double> log_densities_;
+    double log_likelihood_ = 0.0;
+    size_t observations_ = 0;
+};
+
+} // namespace microregime
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "feature_panel.hpp"
+#include "gaussian_hmm.hpp"
+#include "thread_pool.hpp"
+
+namespace microregime {
+
+// Defaults follow classifier.py's GaussianHMM(n_iter=500) and hmmlearn's
+struct HmmTrainerOptions {
+    size_t max_iterations = 500;
+    double tolerance = 1e-2;     // Converged once an iteration gains less log-likelihood
+    double min_covar = 1e-3;     // Added to the initial covariance diagonal, a floor on every later one
+    double covars_prior = 1e-2;  // hmmlearn's covariance prior, added to every M-step scatter entry
+    double covars_weight = 1.0;  // Its weight; the divisor gains max(covars_weight - dimensions, 0)
+    uint64_t seed = 45;          // k-means initialization
+};
+
+struct HmmFit {
+    GaussianHmm model;
+    double log_likelihood;        // log p(panel | model), summed over sequences
+    std::vector<double> history;  // Log-likelihood at each E-step
+    bool converged;
+    size_t rows;
+
+    size_t parameters() const;
+    double aic() const;
+    double bic() const;
+};
+
+// Baum-Welch for full-covariance Gaussian HMMs over a FeaturePanel.
+//
+// Each iteration's E-step runs forward-backward on every sequence as its own
+// pool task: emissions come from GaussianHmm::log_densities, are rescaled
+// per row by their maximum, and the scaled recursions never underflow. The
+// per-sequence sufficient statistics are summed in sequence order, so a fit
+// doesn't depend on the pool size.
+class HmmTrainer {
+public:
+    explicit HmmTrainer(ThreadPool& pool, HmmTrainerOptions options = {});
+
+    // k-means means, the panel covariance for every state, uniform startprob
+    // and transmat (hmmlearn's initialization)
+    GaussianHmm initialize(const FeaturePanel& panel, size_t states) const;
+
+    HmmFit fit(const FeaturePanel& panel, size_t states) const;
+    HmmFit fit(const FeaturePanel& panel, GaussianHmm initial) const;
+
+    // One fit per state count, run concurrently on the same pool
+    std::vector<HmmFit> fit(const FeaturePanel& panel, std::span<const size_t> state_counts) const;
+
+    // log p(panel | model), hmmlearn's score()
+    double score(const GaussianHmm& model, const FeaturePanel& panel) const;
+
+private:
+    struct Statistics;
+
+    ThreadPool& pool_;
+    HmmTrainerOptions options_;
+
+    Statistics expect(const GaussianHmm& model, const FeaturePanel& panel, bool accumulate) const;
+    GaussianHmm maximize(const GaussianHmm& model, const Statistics& statistics) const;
+};
+
+// Append one "regime_count,AIC,BIC,LL" row per fit to a classifier.py
+// _information.csv, writing its header if the file is new. The SIL, DB and
+// CH columns that data_checks.py fills from labelled data are left empty.
+void append_information(const std::string& filepath, std::span<const HmmFit> fits);
+
+} // namespace microregime
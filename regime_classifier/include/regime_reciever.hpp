@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+#include "data_reciever.hpp"
+#include "gaussian_hmm.hpp"
+
+namespace microregime {
+
+// One snapshot's filtered regime probabilities. The spans are valid for the
+// duration of the callback only.
+struct RegimePosterior {
+    const std::string& symbol;
+    uint64_t timestamp_ns;
+    std::span<const double> probabilities;  // One per state
+    size_t regime;                          // Most likely state
+};
+
+// DataReciever running a RegimeFilter over the normalized features of one
+// instrument, so a DualFeaturePipeline labels regimes as it replays.
+// Snapshots with a non-finite model feature are counted and skipped.
+class RegimeReciever : public DataReciever {
+public:
+    using Callback = std::function<void(const RegimePosterior&)>;
+
+    // `model` must outlive the reciever
+    explicit RegimeReciever(const GaussianHmm& model, Callback on_posterior = {});
+
+    void ingest_feature_set(const std::string& symbol, uint64_t timestamp_ns,
+                            const FeatureSet& raw_features, const FeatureSet& normalized) override;
+
+    const RegimeFilter& filter() const { return filter_; }
+    uint64_t skipped() const { return skipped_; }
+
+private:
+    const GaussianHmm& model_;
+    RegimeFilter filter_;
+    Callback on_posterior_;
+    std::vector<double> observation_;
+    uint64_t skipped_ = 0;
+};
+
+} // namespace microregime
@@ -5,6 +5,7 @@ from hmmlearn import vhmm
 from constants import FOLDER_NAME, ASSET, REGIME_COUNT, PCA, PCA_VAR, DROP_COLUMNS, DATES
 import os
 from env import PROJECT_ROOT
+from feature_file import FeatureFile
 
 # ==============================================================
 # ============= Loading Data from Multiple Dates ===============
@@ -13,7 +14,12 @@ from env import PROJECT_ROOT
 dfs = []
 lengths = []
 for date in DATES:
-    df = pd.read_csv("{}\\data\\{}\\{}\\{}_norm.csv".format(PROJECT_ROOT, FOLDER_NAME, date, ASSET))
+    # Prefer the memory-mapped features_to_csv --binary output when it exists
+    binary = "{}\\data\\{}\\{}\\{}.features".format(PROJECT_ROOT, FOLDER_NAME, date, ASSET)
+    if os.path.exists(binary):
+        df = FeatureFile(binary).frame()
+    else:
+        df = pd.read_csv("{}\\data\\{}\\{}\\{}_norm.csv".format(PROJECT_ROOT, FOLDER_NAME, date, ASSET))
     dfs.append(df)
     lengths.append(len(df))
 
@@ -29,7 +35,18 @@ X_array = features.to_numpy()
 # ============= Do PCA if enabled, reducing dimensions =========
 # ==============================================================
 
-if PCA:
+# features_to_csv --pca-basis writes each day already projected onto one
+# streamed basis ({ASSET}_pca.csv, over all 19 features rather than those
+# DROP_COLUMNS keeps), so the panel never goes through sklearn
+pca_files = ["{}\\data\\{}\\{}\\{}_pca.csv".format(PROJECT_ROOT, FOLDER_NAME, date, ASSET) for date in DATES]
+if PCA and all(os.path.exists(path) for path in pca_files):
+    components = [pd.read_csv(path).drop(columns=["timestamp_ns", "instrument"]) for path in pca_files]
+    if [len(c) for c in components] != lengths:
+        raise ValueError("_pca.csv row counts don't match the features; rerun features_to_csv with --pca-basis")
+    X_pca = pd.concat(components).to_numpy()
+    print(f"Using streamed PCA: {X_array.shape[1]} features to {X_pca.shape[1]} components")
+    X_array = X_pca
+elif PCA:
     from sklearn.preprocessing import StandardScaler
     from sklearn.decomposition import PCA
 
@@ -109,4 +126,23 @@ with open(outfile, "w") as f:
     f.write("\ntransmat:\n")
     f.write(str(model.transmat_))
     f.write("\nstartprob:\n")
-    f.write(str(model.startprob_))
\ No newline at end of file
+    f.write(str(model.startprob_))
+
+# output the model for the C++ forward filter (regime_classifier/include/gaussian_hmm.hpp)
+if PCA:
+    print("PCA is on, so no model.hmm: the C++ filter reads feature columns, not components")
+else:
+    def values(array, per_line):
+        flat = np.asarray(array, dtype=float).ravel()
+        return "\n".join(" ".join(repr(float(v)) for v in flat[i:i + per_line])
+                         for i in range(0, len(flat), per_line))
+
+    n_features = len(features.columns)
+    with open(f"{model_dir}\\model.hmm", "w") as f:
+        f.write("gaussian_hmm 1\n")
+        f.write(f"states {REGIME_COUNT}\n")
+        f.write(f"features {n_features} {' '.join(features.columns)}\n")
+        f.write(f"startprob\n{values(model.startprob_, REGIME_COUNT)}\n")
+        f.write(f"transmat\n{values(model.transmat_, REGIME_COUNT)}\n")
+        f.write(f"means\n{values(model.means_, n_features)}\n")
+        f.write(f"covars\n{values(model.covars_, n_features)}\n")
\ No newline at end of file
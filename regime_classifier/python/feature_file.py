@@ -0,0 +1,74 @@
+"""Zero-copy reader for the .features files written by features_to_csv --binary.
+
+The layout is documented in feature_generation/include/feature_file.hpp. The
+whole file is memory-mapped; every array returned here is a view into the
+mapping, so nothing is read from disk until it is touched.
+"""
+import numpy as np
+import pandas as pd
+
+MAGIC = b"MRFEATS1"
+VERSION = 1
+
+HEADER = np.dtype([
+    ("magic", "S8"),
+    ("version", "<u4"),
+    ("column_count", "<u4"),
+    ("row_count", "<u8"),
+    ("metadata_offset", "<u8"),
+    ("metadata_bytes", "<u8"),
+    ("data_offset", "<u8"),
+    ("column_stride", "<u8"),
+])
+
+
+class FeatureFile:
+    def __init__(self, path):
+        self.path = path
+        self._map = np.memmap(path, dtype=np.uint8, mode="r")
+        header = self._map[:HEADER.itemsize].view(HEADER)[0]
+        if header["magic"] != MAGIC:
+            raise ValueError(f"Not a feature file: {path}")
+        if header["version"] != VERSION:
+            raise ValueError(f"Unsupported feature file version {header['version']}: {path}")
+
+        start = int(header["metadata_offset"])
+        text = bytes(self._map[start:start + int(header["metadata_bytes"])]).decode("utf-8")
+        self.metadata = dict(line.split("=", 1) for line in text.splitlines() if "=" in line)
+        self.instrument = self.metadata["instrument"]
+        self.date = self.metadata["date"]
+        self.config = self.metadata["config"]
+        self.groups = self.metadata["groups"].split(",")
+        self.features = self.metadata["features"].split(",")
+
+        self.rows = int(header["row_count"])
+        columns = int(header["column_count"])
+        stride = int(header["column_stride"])
+        data_offset = int(header["data_offset"])
+        if columns != 1 + len(self.groups) * len(self.features) or \
+                data_offset + columns * stride > len(self._map):
+            raise ValueError(f"Corrupt feature file: {path}")
+
+        # One column per row of this array, padded to the stride
+        data = self._map[data_offset:data_offset + columns * stride]
+        self._columns = data.view("<f8").reshape(columns, stride // 8)[:, :self.rows]
+
+    @property
+    def timestamps(self):
+        return self._columns[0].view("<u8")
+
+    def group(self, name=None):
+        """Rows x features view of one group; defaults to the primary normalization."""
+        g = self.groups.index(name) if name is not None else 1
+        first = 1 + g * len(self.features)
+        return self._columns[first:first + len(self.features)].T
+
+    def column(self, feature, group=None):
+        return self.group(group)[:, self.features.index(feature)]
+
+    def frame(self, group=None):
+        """DataFrame shaped like the matching CSV (timestamp_ns, instrument, features)."""
+        df = pd.DataFrame(self.group(group), columns=self.features, copy=False)
+        df.insert(0, "instrument", self.instrument)
+        df.insert(0, "timestamp_ns", self.timestamps)
+        return df
@@ -0,0 +1,252 @@
+#include "gaussian_hmm.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numbers>
+#include <stdexcept>
+#include "text_parser.hpp"
+
+namespace microregime {
+
+GaussianHmm::GaussianHmm(std::vector<Feature> features, std::vector<double> startprob, std::vector<double> transmat,
+                         std::vector<double> means, std::vector<double> covars)
+    : states_{startprob.size()},
+      features_{std::move(features)},
+      startprob_{std::move(startprob)},
+      transmat_{std::move(transmat)},
+      means_{std::move(means)},
+      covars_{std::move(covars)} {
+    const size_t K = states_;
+    const size_t D = features_.size();
+    if (K == 0 || D == 0) {
+        throw std::invalid_argument("GaussianHmm needs at least one state and one feature");
+    }
+    for (size_t i = 0; i < D; ++i) {
+        if (std::find(features_.begin(), features_.begin() + i, features_[i]) != features_.begin() + i) {
+            throw std::invalid_argument("GaussianHmm feature listed twice: " + std::string(kFeatureNames[feature_index(features_[i])]));
+        }
+    }
+    if (transmat_.size() != K * K || means_.size() != K * D || covars_.size() != K * D * D) {
+        throw std::invalid_argument("GaussianHmm parameter sizes don't match " + std::to_string(K) + " states and " +
+                                    std::to_string(D) + " features");
+    }
+    check_distribution(startprob_, "startprob");
+    for (size_t i = 0; i < K; ++i) {
+        check_distribution({transmat_.data() + i * K, K}, "transmat row " + std::to_string(i));
+    }
+
+    // Factor S = L L^T per state; L's diagonal is stored as its reciprocal
+    cholesky_.assign(K * D * D, 0.0);
+    log_norm_.assign(K, 0.0);
+    for (size_t k = 0; k < K; ++k) {
+        const double* S = covars_.data() + k * D * D;
+        double* L = cholesky_.data() + k * D * D;
+        double log_det = 0.0;
+        for (size_t j = 0; j < D; ++j) {
+            for (size_t i = 0; i < j; ++i) {
+                double a = S[i * D + j], b = S[j * D + i];
+                if (std::abs(a - b) > 1e-9 * std::max({1.0, std::abs(a), std::abs(b)})) {
+                    throw std::invalid_argument("Covariance of state " + std::to_string(k) + " isn't symmetric");
+                }
+            }
+            double pivot = S[j * D + j];
+            for (size_t m = 0; m < j; ++m) pivot -= L[j * D + m] * L[j * D + m];
+            if (!(pivot > 0.0)) {
+                throw std::invalid_argument("Covariance of state " + std::to_string(k) + " isn't positive definite");
+            }
+            double diagonal = std::sqrt(pivot);
+            log_det += 2.0 * std::log(diagonal);
+            L[j * D + j] = 1.0 / diagonal;
+            for (size_t i = j + 1; i < D; ++i) {
+                double value = S[i * D + j];
+                for (size_t m = 0; m < j; ++m) value -= L[i * D + m] * L[j * D + m];
+                L[i * D + j] = value / diagonal;
+            }
+        }
+        log_norm_[k] = -0.5 * (static_cast<double>(D) * std::log(2.0 * std::numbers::pi) + log_det);
+    }
+}
+
+std::span<const double> GaussianHmm::covar(size_t state) const {
+    const size_t D = dimensions();
+    return {covars_.data() + state * D * D, D * D};
+}
+
+double GaussianHmm::log_density(size_t state, std::span<const double> x) const {
+    const size_t D = dimensions();
+    const double* mu = means_.data() + state * D;
+    const double* L = cholesky_.data() + state * D * D;
+
+    // Forward substitution for z = L^-1 (x - mu); features are distinct, so D <= kFeatureCount
+    std::array<double, kFeatureCount> z;
+    double squared = 0.0;
+    for (size_t i = 0; i < D; ++i) {
+        double value = x[i] - mu[i];
+        for (size_t m = 0; m < i; ++m) value -= L[i * D + m] * z[m];
+        z[i] = value * L[i * D + i];
+        squared += z[i] * z[i];
+    }
+    return log_norm_[state] - 0.5 * squared;
+}
+
+void GaussianHmm::log_densities(size_t state, std::span<const double> xs, std::span<double> out) const {
+    constexpr size_t kBlock = 256;
+    const size_t D = dimensions();
+    const size_t rows = out.size();
+    if (xs.size() != rows * D) {
+        throw std::invalid_argument("log_densities needs " + std::to_string(D) + " values per row");
+    }
+    const double* mu = means_.data() + state * D;
+    const double* L = cholesky_.data() + state * D * D;
+
+    // z holds the block column-major: z[i * kBlock + r] is dimension i of row r
+    std::array<double, kFeatureCount * kBlock> z;
+    std::array<double, kBlock> squared;
+    for (size_t begin = 0; begin < rows; begin += kBlock) {
+        const size_t n = std::min(kBlock, rows - begin);
+        const double* x = xs.data() + begin * D;
+        for (size_t r = 0; r < n; ++r) {
+            for (size_t i = 0; i < D; ++i) z[i * kBlock + r] = x[r * D + i] - mu[i];
+        }
+        std::fill(squared.begin(), squared.begin() + n, 0.0);
+        for (size_t i = 0; i < D; ++i) {
+            double* zi = z.data() + i * kBlock;
+            for (size_t m = 0; m < i; ++m) {
+                const double l = L[i * D + m];
+                const double* zm = z.data() + m * kBlock;
+                for (size_t r = 0; r < n; ++r) zi[r] -= l * zm[r];
+            }
+            const double scale = L[i * D + i];
+            for (size_t r = 0; r < n; ++r) {
+                zi[r] *= scale;
+                squared[r] += zi[r] * zi[r];
+            }
+        }
+        for (size_t r = 0; r < n; ++r) out[begin + r] = log_norm_[state] - 0.5 * squared[r];
+    }
+}
+
+void GaussianHmm::observe(const FeatureSet& features, std::span<double> x) const {
+    for (size_t i = 0; i < features_.size(); ++i) {
+        x[i] = features.*kFeatureMembers[feature_index(features_[i])];
+    }
+}
+
+GaussianHmm GaussianHmm::load(const std::string& filepath) {
+    TextParser parser(filepath, "HMM model");
+
+    size_t version = 0, K = 0, D = 0;
+    parser.expect("gaussian_hmm");
+    if (!parser.read(version) || version != 1) throw parser.fail("unsupported version");
+    parser.expect("states");
+    if (!parser.read(K) || K == 0) throw parser.fail("bad state count");
+    parser.expect("features");
+    if (!parser.read(D) || D == 0 || D > kFeatureCount) throw parser.fail("bad feature count");
+    std::vector<Feature> features;
+    for (size_t i = 0; i < D; ++i) {
+        std::string name;
+        if (!parser.read(name)) throw parser.fail("too few feature names");
+        auto feature = feature_from_name(name);
+        if (!feature) throw parser.fail("unknown feature '" + name + "'");
+        features.push_back(*feature);
+    }
+    auto startprob = parser.read_values("startprob", K);
+    auto transmat = parser.read_values("transmat", K * K);
+    auto means = parser.read_values("means", K * D);
+    auto covars = parser.read_values("covars", K * D * D);
+    return GaussianHmm(std::move(features), std::move(startprob), std::move(transmat), std::move(means),
+                       std::move(covars));
+}
+
+void GaussianHmm::save(const std::string& filepath) const {
+    std::ofstream out(filepath);
+    if (!out) {
+        throw std::runtime_error("Failed to create HMM model: " + filepath);
+    }
+    out << std::setprecision(17);
+    auto write_values = [&](const char* keyword, std::span<const double> values, size_t per_line) {
+        out << keyword;
+        for (size_t i = 0; i < values.size(); ++i) out << ((i % per_line == 0) ? "\n" : " ") << values[i];
+        out << "\n";
+    };
+    out << "gaussian_hmm 1\nstates " << states_ << "\nfeatures " << dimensions();
+    for (Feature feature : features_) out << " " << kFeatureNames[feature_index(feature)];
+    out << "\n";
+    write_values("startprob", startprob_, states_);
+    write_values("transmat", transmat_, states_);
+    write_values("means", means_, dimensions());
+    write_values("covars", covars_, dimensions());
+    if (!out) {
+        throw std::runtime_error("Failed to write HMM model: " + filepath);
+    }
+}
+
+RegimeFilter::RegimeFilter(const GaussianHmm& model)
+    : model_{model},
+      posterior_(model.states()),
+      predicted_(model.states()),
+      log_densities_(model.states()) {
+    reset();
+}
+
+void RegimeFilter::reset() {
+    std::copy(model_.startprob().begin(), model_.startprob().end(), posterior_.begin());
+    log_likelihood_ = 0.0;
+    observations_ = 0;
+}
+
+std::span<const double> RegimeFilter::update(std::span<const double> x) {
+    const size_t K = model_.states();
+    if (x.size() != model_.dimensions()) {
+        throw std::invalid_argument("Observation has " + std::to_string(x.size()) + " values, model expects " +
+                                    std::to_string(model_.dimensions()));
+    }
+    for (double value : x) {
+        if (!std::isfinite(value)) throw std::invalid_argument("Observation isn't finite");
+    }
+
+    // Predict: the prior is startprob for the first observation, else posterior * transmat
+    if (observations_ == 0) {
+        std::copy(model_.startprob().begin(), model_.startprob().end(), predicted_.begin());
+    } else {
+        auto A = model_.transmat();
+        std::fill(predicted_.begin(), predicted_.end(), 0.0);
+        for (size_t i = 0; i < K; ++i) {
+            for (size_t j = 0; j < K; ++j) predicted_[j] += posterior_[i] * A[i * K + j];
+        }
+    }
+
+    // Correct, in units of the largest density so nothing underflows
+    double max_log = -INFINITY;
+    for (size_t k = 0; k < K; ++k) {
+        log_densities_[k] = model_.log_density(k, x);
+        max_log = std::max(max_log, log_densities_[k]);
+    }
+    if (!std::isfinite(max_log)) {
+        throw std::invalid_argument("Observation is too far from every state");
+    }
+    double total = 0.0;
+    for (size_t k = 0; k < K; ++k) {
+        posterior_[k] = predicted_[k] * std::exp(log_densities_[k] - max_log);
+        total += posterior_[k];
+    }
+    if (!(total > 0.0)) {
+        // Every state that could explain x was ruled out by the transitions: restart from the densities
+        for (size_t k = 0; k < K; ++k) {
+            posterior_[k] = std::exp(log_densities_[k] - max_log) / static_cast<double>(K);
+            total += posterior_[k];
+        }
+    }
+    for (double& p : posterior_) p /= total;
+    log_likelihood_ += max_log + std::log(total);
+    ++observations_;
+    return posterior_;
+}
+
+size_t RegimeFilter::most_likely() const {
+    return static_cast<size_t>(std::max_element(posterior_.begin(), posterior_.end()) - posterior_.begin());
+}
+
+} // namespace microregime
@@ -0,0 +1,386 @@
+#include "hmm_trainer.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <random>
+#include <stdexcept>
+
+namespace microregime {
+
+namespace {
+
+// k-means runs on at most this many rows, evenly strided through the panel
+constexpr size_t kMaxKMeansRows = 65536;
+constexpr size_t kMaxKMeansIterations = 100;
+
+// A state with less posterior mass than this keeps its emission parameters
+constexpr double kMinOccupancy = 1e-10;
+
+double squared_distance(const double* a, const double* b, size_t D) {
+    double sum = 0.0;
+    for (size_t i = 0; i < D; ++i) sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return sum;
+}
+
+std::string shortest(double value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, result.ptr);
+}
+
+} // namespace
+
+// Sufficient statistics of one E-step; outer holds only the lower triangles
+struct HmmTrainer::Statistics {
+    double log_likelihood = 0.0;
+    std::vector<double> start;  // K
+    std::vector<double> trans;  // K*K expected transition counts
+    std::vector<double> post;   // K
+    std::vector<double> obs;    // K*D, sum of gamma * x
+    std::vector<double> outer;  // K*D*D, sum of gamma * x x^T
+
+    Statistics(size_t K, size_t D, bool accumulate)
+        : start(accumulate ? K : 0),
+          trans(accumulate ? K * K : 0),
+          post(accumulate ? K : 0),
+          obs(accumulate ? K * D : 0),
+          outer(accumulate ? K * D * D : 0) {}
+
+    void add(const Statistics& other) {
+        log_likelihood += other.log_likelihood;
+        auto sum = [](std::vector<double>& into, const std::vector<double>& from) {
+            for (size_t i = 0; i < into.size(); ++i) into[i] += from[i];
+        };
+        sum(start, other.start);
+        sum(trans, other.trans);
+        sum(post, other.post);
+        sum(obs, other.obs);
+        sum(outer, other.outer);
+    }
+};
+
+size_t HmmFit::parameters() const {
+    const size_t K = model.states();
+    const size_t D = model.dimensions();
+    return (K - 1) + K * (K - 1) + K * D + K * D * (D + 1) / 2;
+}
+
+double HmmFit::aic() const {
+    return -2.0 * log_likelihood + 2.0 * static_cast<double>(parameters());
+}
+
+double HmmFit::bic() const {
+    return -2.0 * log_likelihood + static_cast<double>(parameters()) * std::log(static_cast<double>(rows));
+}
+
+HmmTrainer::HmmTrainer(ThreadPool& pool, HmmTrainerOptions options) : pool_{pool}, options_{options} {
+    if (options_.max_iterations == 0) {
+        throw std::invalid_argument("HmmTrainer needs at least one iteration");
+    }
+    if (!(options_.min_covar > 0.0)) {
+        throw std::invalid_argument("HmmTrainer min_covar must be positive");
+    }
+    if (!(options_.covars_prior >= 0.0) || !(options_.covars_weight >= 0.0)) {
+        throw std::invalid_argument("HmmTrainer covariance prior and weight can't be negative");
+    }
+}
+
+GaussianHmm HmmTrainer::initialize(const FeaturePanel& panel, size_t states) const {
+    const size_t K = states;
+    const size_t D = panel.dimensions();
+    const size_t N = panel.rows();
+    if (K == 0 || N < std::max<size_t>(K, 2)) {
+        throw std::invalid_argument("Can't fit " + std::to_string(K) + " states to " + std::to_string(N) + " rows");
+    }
+    auto values = panel.values();
+
+    // k-means++ seeding, then Lloyd's iterations, on a strided sample
+    const size_t stride = (N + kMaxKMeansRows - 1) / kMaxKMeansRows;
+    std::vector<const double*> sample;
+    for (size_t r = 0; r < N; r += stride) sample.push_back(values.data() + r * D);
+
+    std::mt19937_64 rng(options_.seed);
+    std::vector<double> means(K * D);
+    std::vector<double> nearest(sample.size(), INFINITY);
+    const double* first = sample[std::uniform_int_distribution<size_t>(0, sample.size() - 1)(rng)];
+    std::copy(first, first + D, means.begin());
+    for (size_t k = 1; k < K; ++k) {
+        double total = 0.0;
+        for (size_t s = 0; s < sample.size(); ++s) {
+            nearest[s] = std::min(nearest[s], squared_distance(sample[s], &means[(k - 1) * D], D));
+            total += nearest[s];
+        }
+        if (!(total > 0.0)) {
+            throw std::invalid_argument("Panel has fewer distinct rows than " + std::to_string(K) + " states");
+        }
+        double target = std::uniform_real_distribution<double>(0.0, total)(rng);
+        size_t chosen = 0;
+        while (chosen + 1 < sample.size() && (target -= nearest[chosen]) > 0.0) ++chosen;
+        while (nearest[chosen] == 0.0) chosen = (chosen + 1) % sample.size();
+        std::copy(sample[chosen], sample[chosen] + D, means.begin() + k * D);
+    }
+
+    std::vector<size_t> cluster(sample.size(), K);
+    std::vector<double> sums(K * D);
+    std::vector<size_t> counts(K);
+    for (size_t iteration = 0; iteration < kMaxKMeansIterations; ++iteration) {
+        bool changed = false;
+        for (size_t s = 0; s < sample.size(); ++s) {
+            size_t best = 0;
+            double best_distance = INFINITY;
+            for (size_t k = 0; k < K; ++k) {
+                double distance = squared_distance(sample[s], &means[k * D], D);
+                if (distance < best_distance) {
+                    best = k;
+                    best_distance = distance;
+                }
+            }
+            changed |= (cluster[s] != best);
+            cluster[s] = best;
+        }
+        if (!changed) break;
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (size_t s = 0; s < sample.size(); ++s) {
+            for (size_t i = 0; i < D; ++i) sums[cluster[s] * D + i] += sample[s][i];
+            ++counts[cluster[s]];
+        }
+        for (size_t k = 0; k < K; ++k) {
+            if (counts[k] == 0) continue;  // An empty cluster keeps its center
+            for (size_t i = 0; i < D; ++i) means[k * D + i] = sums[k * D + i] / static_cast<double>(counts[k]);
+        }
+    }
+
+    // Every state starts from the covariance of the whole panel
+    std::vector<double> mean(D, 0.0), covar(D * D, 0.0);
+    for (size_t r = 0; r < N; ++r) {
+        for (size_t i = 0; i < D; ++i) mean[i] += values[r * D + i];
+    }
+    for (double& m : mean) m /= static_cast<double>(N);
+    for (size_t r = 0; r < N; ++r) {
+        const double* x = values.data() + r * D;
+        for (size_t i = 0; i < D; ++i) {
+            for (size_t j = 0; j <= i; ++j) covar[i * D + j] += (x[i] - mean[i]) * (x[j] - mean[j]);
+        }
+    }
+    for (size_t i = 0; i < D; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            covar[i * D + j] /= static_cast<double>(N - 1);
+            covar[j * D + i] = covar[i * D + j];
+        }
+        covar[i * D + i] += options_.min_covar;
+    }
+    std::vector<double> covars;
+    for (size_t k = 0; k < K; ++k) covars.insert(covars.end(), covar.begin(), covar.end());
+
+    return GaussianHmm(panel.features(), std::vector<double>(K, 1.0 / K), std::vector<double>(K * K, 1.0 / K),
+                       std::move(means), std::move(covars));
+}
+
+HmmFit HmmTrainer::fit(const FeaturePanel& panel, size_t states) const {
+    return fit(panel, initialize(panel, states));
+}
+
+HmmFit HmmTrainer::fit(const FeaturePanel& panel, GaussianHmm initial) const {
+    HmmFit fit{std::move(initial), 0.0, {}, false, panel.rows()};
+    for (size_t iteration = 0; iteration < options_.max_iterations; ++iteration) {
+        Statistics statistics = expect(fit.model, panel, true);
+        fit.history.push_back(statistics.log_likelihood);
+        size_t n = fit.history.size();
+        if (n >= 2 && fit.history[n - 1] - fit.history[n - 2] < options_.tolerance) {
+            fit.converged = true;
+            break;
+        }
+        fit.model = maximize(fit.model, statistics);
+    }
+    fit.log_likelihood = fit.converged ? fit.history.back() : score(fit.model, panel);
+    return fit;
+}
+
+std::vector<HmmFit> HmmTrainer::fit(const FeaturePanel& panel, std::span<const size_t> state_counts) const {
+    // Each fit is driven from its own thread, which only waits on the pool
+    std::vector<std::future<HmmFit>> running;
+    for (size_t states : state_counts) {
+        running.push_back(std::async(std::launch::async, [this, &panel, states] { return fit(panel, states); }));
+    }
+    std::vector<HmmFit> fits;
+    for (auto& future : running) fits.push_back(future.get());
+    return fits;
+}
+
+double HmmTrainer::score(const GaussianHmm& model, const FeaturePanel& panel) const {
+    return expect(model, panel, false).log_likelihood;
+}
+
+HmmTrainer::Statistics HmmTrainer::expect(const GaussianHmm& model, const FeaturePanel& panel,
+                                          bool accumulate) const {
+    const size_t K = model.states();
+    const size_t D = model.dimensions();
+    if (model.features() != panel.features()) {
+        throw std::invalid_argument("Model and panel features differ");
+    }
+
+    auto one_sequence = [&model, K, D, accumulate](std::span<const double> x) {
+        Statistics statistics(K, D, accumulate);
+        const size_t T = x.size() / D;
+        if (T == 0) return statistics;
+        auto pi = model.startprob();
+        auto A = model.transmat();
+
+        // b[t*K + k] = p(x_t | k) / p(x_t | most likely k), with that log scale kept
+        std::vector<double> log_b(K * T), b(T * K), scale(T, -INFINITY);
+        for (size_t k = 0; k < K; ++k) {
+            std::span<double> out(log_b.data() + k * T, T);
+            model.log_densities(k, x, out);
+            for (size_t t = 0; t < T; ++t) scale[t] = std::max(scale[t], out[t]);
+        }
+        for (size_t t = 0; t < T; ++t) {
+            if (!std::isfinite(scale[t])) throw std::runtime_error("Row " + std::to_string(t) + " has no density");
+            for (size_t k = 0; k < K; ++k) b[t * K + k] = std::exp(log_b[k * T + t] - scale[t]);
+        }
+
+        // Forward, normalizing alpha_t to sum to 1 with c_t
+        std::vector<double> alpha(T * K), c(T);
+        for (size_t t = 0; t < T; ++t) {
+            double* a = alpha.data() + t * K;
+            if (t == 0) {
+                for (size_t k = 0; k < K; ++k) a[k] = pi[k];
+            } else {
+                const double* previous = a - K;
+                std::fill(a, a + K, 0.0);
+                for (size_t i = 0; i < K; ++i) {
+                    for (size_t j = 0; j < K; ++j) a[j] += previous[i] * A[i * K + j];
+                }
+            }
+            double total = 0.0;
+            for (size_t k = 0; k < K; ++k) total += (a[k] *= b[t * K + k]);
+            if (!(total > 0.0)) {
+                throw std::runtime_error("Row " + std::to_string(t) + " is impossible under the model");
+            }
+            for (size_t k = 0; k < K; ++k) a[k] /= total;
+            c[t] = total;
+            statistics.log_likelihood += std::log(total) + scale[t];
+        }
+        if (!accumulate) return statistics;
+
+        // Backward with the same scaling, so gamma_t = alpha_t * beta_t directly
+        std::vector<double> beta(T * K, 1.0), weighted(K);
+        for (size_t t = T - 1; t-- > 0;) {
+            const double* next = beta.data() + (t + 1) * K;
+            double* current = beta.data() + t * K;
+            for (size_t j = 0; j < K; ++j) weighted[j] = b[(t + 1) * K + j] * next[j] / c[t + 1];
+            for (size_t i = 0; i < K; ++i) {
+                double sum = 0.0;
+                for (size_t j = 0; j < K; ++j) {
+                    double w = A[i * K + j] * weighted[j];
+                    statistics.trans[i * K + j] += alpha[t * K + i] * w;
+                    sum += w;
+                }
+                current[i] = sum;
+            }
+        }
+
+        for (size_t t = 0; t < T; ++t) {
+            const double* row = x.data() + t * D;
+            for (size_t k = 0; k < K; ++k) {
+                double gamma = alpha[t * K + k] * beta[t * K + k];
+                if (t == 0) statistics.start[k] += gamma;
+                statistics.post[k] += gamma;
+                double* obs = statistics.obs.data() + k * D;
+                double* outer = statistics.outer.data() + k * D * D;
+                for (size_t i = 0; i < D; ++i) {
+                    double weighted_x = gamma * row[i];
+                    obs[i] += weighted_x;
+                    for (size_t j = 0; j <= i; ++j) outer[i * D + j] += weighted_x * row[j];
+                }
+            }
+        }
+        return statistics;
+    };
+
+    std::vector<std::future<Statistics>> running;
+    for (size_t s = 0; s < panel.sequences(); ++s) {
+        running.push_back(pool_.submit([&one_sequence, sequence = panel.sequence(s)] { return one_sequence(sequence); }));
+    }
+    // Wait for every task before rethrowing, since they reference this frame
+    Statistics total(K, D, accumulate);
+    std::exception_ptr error;
+    for (auto& future : running) {
+        try {
+            total.add(future.get());
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+    return total;
+}
+
+GaussianHmm HmmTrainer::maximize(const GaussianHmm& model, const Statistics& statistics) const {
+    const size_t K = model.states();
+    const size_t D = model.dimensions();
+
+    std::vector<double> startprob(statistics.start);
+    double sequences = 0.0;
+    for (double p : startprob) sequences += p;
+    for (double& p : startprob) p /= sequences;
+
+    // A state never left keeps its row, as does one that never occurs
+    std::vector<double> transmat(statistics.trans);
+    for (size_t i = 0; i < K; ++i) {
+        double* row = transmat.data() + i * K;
+        double total = 0.0;
+        for (size_t j = 0; j < K; ++j) total += row[j];
+        for (size_t j = 0; j < K; ++j) row[j] = total > 0.0 ? row[j] / total : model.transmat()[i * K + j];
+    }
+
+    const double prior_weight = std::max(options_.covars_weight - static_cast<double>(D), 0.0);
+    std::vector<double> means(K * D), covars(K * D * D);
+    for (size_t k = 0; k < K; ++k) {
+        double* mu = means.data() + k * D;
+        double* S = covars.data() + k * D * D;
+        double weight = statistics.post[k];
+        if (weight < kMinOccupancy) {
+            std::copy(model.mean(k).begin(), model.mean(k).end(), mu);
+            std::copy(model.covar(k).begin(), model.covar(k).end(), S);
+            continue;
+        }
+        for (size_t i = 0; i < D; ++i) mu[i] = statistics.obs[k * D + i] / weight;
+        // hmmlearn's MAP update: (prior + scatter) / (max(weight_prior - D, 0) + occupancy),
+        // then min_covar as a floor on the variances
+        const double* outer = statistics.outer.data() + k * D * D;
+        const double divisor = prior_weight + weight;
+        for (size_t i = 0; i < D; ++i) {
+            for (size_t j = 0; j <= i; ++j) {
+                double scatter = outer[i * D + j] - weight * mu[i] * mu[j];
+                S[i * D + j] = (options_.covars_prior + scatter) / divisor;
+                S[j * D + i] = S[i * D + j];
+            }
+            S[i * D + i] = std::max(S[i * D + i], options_.min_covar);
+        }
+    }
+    return GaussianHmm(model.features(), std::move(startprob), std::move(transmat), std::move(means),
+                       std::move(covars));
+}
+
+void append_information(const std::string& filepath, std::span<const HmmFit> fits) {
+    std::error_code error;
+    bool fresh = !std::filesystem::exists(filepath) || std::filesystem::file_size(filepath, error) == 0;
+    std::ofstream out(filepath, std::ios::app);
+    if (!out) {
+        throw std::runtime_error("Failed to open " + filepath);
+    }
+    if (fresh) out << "regime_count,AIC,BIC,LL,SIL,DB,CH\n";
+    for (const auto& fit : fits) {
+        out << fit.model.states() << ',' << shortest(fit.aic()) << ',' << shortest(fit.bic()) << ','
+            << shortest(fit.log_likelihood) << ",,,\n";
+    }
+    if (!out) {
+        throw std::runtime_error("Failed to write " + filepath);
+    }
+}
+
+} // namespace microregime
@@ -0,0 +1,23 @@
+#include "regime_reciever.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace microregime {
+
+RegimeReciever::RegimeReciever(const GaussianHmm& model, Callback on_posterior)
+    : model_{model}, filter_{model}, on_posterior_{std::move(on_posterior)}, observation_(model.dimensions()) {}
+
+void RegimeReciever::ingest_feature_set(const std::string& symbol, uint64_t timestamp_ns,
+                                        const FeatureSet&, const FeatureSet& normalized) {
+    model_.observe(normalized, observation_);
+    if (!std::all_of(observation_.begin(), observation_.end(), [](double x) { return std::isfinite(x); })) {
+        ++skipped_;
+        return;
+    }
+    auto posterior = filter_.update(observation_);
+    if (on_posterior_) {
+        on_posterior_(RegimePosterior{symbol, timestamp_ns, posterior, filter_.most_likely()});
+    }
+}
+
+} // namespace microregime
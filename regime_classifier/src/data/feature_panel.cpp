@@ -0,0 +1,119 @@
+#include "feature_panel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "feature_file.hpp"
+
+namespace microregime {
+
+FeaturePanel::FeaturePanel(std::vector<Feature> features) : features_{std::move(features)} {
+    if (features_.empty()) {
+        throw std::invalid_argument("FeaturePanel needs at least one feature");
+    }
+}
+
+std::span<const double> FeaturePanel::sequence(size_t index) const {
+    const size_t D = dimensions();
+    return {values_.data() + offsets_[index] * D, (offsets_[index + 1] - offsets_[index]) * D};
+}
+
+void FeaturePanel::append(std::span<const double> sequence) {
+    if (sequence.size() % dimensions() != 0) {
+        throw std::invalid_argument("FeaturePanel rows need " + std::to_string(dimensions()) + " values each");
+    }
+    values_.insert(values_.end(), sequence.begin(), sequence.end());
+    offsets_.push_back(rows());
+}
+
+void FeaturePanel::load(const std::string& filepath) {
+    const size_t before = values_.size();
+    try {
+        if (std::filesystem::path(filepath).extension() == feature_file::kExtension) {
+            load_feature_file(filepath);
+        } else {
+            load_csv(filepath);
+        }
+    } catch (...) {
+        values_.resize(before);
+        throw;
+    }
+    offsets_.push_back(rows());
+}
+
+void FeaturePanel::load_feature_file(const std::string& filepath) {
+    FeatureFileReader reader(filepath);
+    if (reader.groups().size() < 2) {
+        throw std::runtime_error("Feature file has no normalized features: " + filepath);
+    }
+    const size_t D = dimensions();
+    const size_t first = values_.size();
+    values_.resize(first + reader.row_count() * D);
+    for (size_t i = 0; i < D; ++i) {
+        auto column = reader.column(1, features_[i]);
+        for (size_t r = 0; r < column.size(); ++r) {
+            if (!std::isfinite(column[r])) {
+                throw std::runtime_error("Non-finite " + std::string(kFeatureNames[feature_index(features_[i])]) +
+                                         " in row " + std::to_string(r) + " of " + filepath);
+            }
+            values_[first + r * D + i] = column[r];
+        }
+    }
+}
+
+void FeaturePanel::load_csv(const std::string& filepath) {
+    std::ifstream in(filepath);
+    if (!in) {
+        throw std::runtime_error("Failed to open feature CSV: " + filepath);
+    }
+
+    // Map each header column to the panel dimension it fills, if any
+    std::string line, field;
+    std::getline(in, line);
+    std::vector<size_t> dimension_of;
+    std::vector<bool> found(dimensions(), false);
+    std::istringstream header(line);
+    while (std::getline(header, field, ',')) {
+        if (!field.empty() && field.back() == '\r') field.pop_back();
+        auto feature = feature_from_name(field);
+        auto it = feature ? std::find(features_.begin(), features_.end(), *feature) : features_.end();
+        size_t dimension = static_cast<size_t>(it - features_.begin());
+        dimension_of.push_back(dimension);
+        if (dimension < dimensions()) found[dimension] = true;
+    }
+    for (size_t i = 0; i < dimensions(); ++i) {
+        if (!found[i]) {
+            throw std::runtime_error("Feature CSV has no " + std::string(kFeatureNames[feature_index(features_[i])]) +
+                                     " column: " + filepath);
+        }
+    }
+
+    size_t row = 0;
+    while (std::getline(in, line)) {
+        if (line.empty() || line == "\r") continue;
+        const size_t first = values_.size();
+        values_.resize(first + dimensions());
+        std::istringstream fields(line);
+        size_t column = 0;
+        while (std::getline(fields, field, ',') && column < dimension_of.size()) {
+            size_t dimension = dimension_of[column++];
+            if (dimension >= dimensions()) continue;
+            char* end = nullptr;
+            double value = std::strtod(field.c_str(), &end);
+            if (end == field.c_str() || !std::isfinite(value)) {
+                throw std::runtime_error("Bad " + std::string(kFeatureNames[feature_index(features_[dimension])]) +
+                                         " '" + field + "' in row " + std::to_string(row) + " of " + filepath);
+            }
+            values_[first + dimension] = value;
+        }
+        if (column < dimension_of.size()) {
+            throw std::runtime_error("Row " + std::to_string(row) + " of " + filepath + " is short");
+        }
+        ++row;
+    }
+}
+
+} // namespace microregime
@@ -0,0 +1,53 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "dual_feature_pipeline.hpp"
+#include "gaussian_hmm.hpp"
+#include "pipeline_config.hpp"
+#include "regime_reciever.hpp"
+
+// Replays one day and labels each instrument's regimes as the snapshots are
+// taken, with models exported by classifier.py. Writes CSV to stdout.
+int main(int argc, char** argv) {
+    if (argc < 6) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <date> <base_asset> <future> <base_model.hmm> <future_model.hmm> [snapshot_interval_ns]\n"
+                  << "Example: " << argv[0] << " 20250505 SPY ES base_SPY.hmm future_ES.hmm > regimes.csv\n";
+        return 1;
+    }
+
+    try {
+        using namespace microregime;
+        GaussianHmm base_model = GaussianHmm::load(argv[4]);
+        GaussianHmm future_model = GaussianHmm::load(argv[5]);
+        PipelineConfig config;
+        if (argc > 6) {
+            config.snapshot_interval_ns = std::stoull(argv[6]);
+        }
+
+        std::cout << "instrument,timestamp_ns,regime,probabilities\n" << std::setprecision(6);
+        auto print = [](const RegimePosterior& posterior) {
+            std::cout << posterior.symbol << ',' << posterior.timestamp_ns << ',' << posterior.regime << ',';
+            for (size_t k = 0; k < posterior.probabilities.size(); ++k) {
+                std::cout << (k ? " " : "") << posterior.probabilities[k];
+            }
+            std::cout << '\n';
+        };
+        RegimeReciever base(base_model, print);
+        RegimeReciever future(future_model, print);
+
+        auto start = std::chrono::steady_clock::now();
+        DualFeaturePipeline(argv[1], argv[2], argv[3], {config}).run(base, future);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cerr << "Labelled " << base.filter().observations() << " " << argv[2] << " and "
+                  << future.filter().observations() << " " << argv[3] << " snapshots in " << std::fixed
+                  << std::setprecision(1) << seconds << " s (skipped " << base.skipped() + future.skipped()
+                  << " with non-finite features)\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
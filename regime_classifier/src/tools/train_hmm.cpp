@@ -0,0 +1,88 @@
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "feature_panel.hpp"
+#include "hmm_trainer.hpp"
+#include "thread_pool.hpp"
+
+// Fits full-covariance HMMs for several regime counts at once over a panel of
+// days, in place of sweeping REGIME_COUNT through classifier.py. Writes each
+// model to <output_dir>/<asset>/<K>/model.hmm and appends the AIC/BIC/LL rows
+// to <output_dir>/<asset>_information.csv, classifier.py's layout.
+int main(int argc, char** argv) {
+    if (argc < 6) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <output_dir> <asset> <regime_counts> <features> <day_file>... [--iterations N] [--threads N]\n"
+                  << "Day files are {asset}.features or {asset}_norm.csv, one per date.\n"
+                  << "Example: " << argv[0]
+                  << " run_outputs/output_Snapshot0.50_Window30000_Events1500 base_SPY 2,3,4,5,6"
+                     " ewm_volatility,realized_variance,directional_volatility,tick_direction_entropy,shannon_entropy"
+                     " data/output_Snapshot0.50_Window30000_Events1500/2025*/base_SPY.features\n";
+        return 1;
+    }
+
+    try {
+        using namespace microregime;
+        namespace fs = std::filesystem;
+        const fs::path output_dir = argv[1];
+        const std::string asset = argv[2];
+
+        std::vector<size_t> regime_counts;
+        std::stringstream list(argv[3]);
+        std::string item;
+        while (std::getline(list, item, ',')) regime_counts.push_back(std::stoul(item));
+
+        std::vector<Feature> features;
+        list = std::stringstream(argv[4]);
+        while (std::getline(list, item, ',')) {
+            auto feature = feature_from_name(item);
+            if (!feature) throw std::invalid_argument("Unknown feature '" + item + "'");
+            features.push_back(*feature);
+        }
+
+        HmmTrainerOptions options;
+        size_t threads = std::thread::hardware_concurrency();
+        std::vector<std::string> days;
+        for (int i = 5; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--iterations" && i + 1 < argc) {
+                options.max_iterations = std::stoul(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                threads = std::stoul(argv[++i]);
+            } else {
+                days.push_back(arg);
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        FeaturePanel panel(features);
+        for (const auto& day : days) panel.load(day);
+        std::cerr << "Loaded " << panel.rows() << " rows from " << panel.sequences() << " days\n";
+
+        ThreadPool pool(threads);
+        HmmTrainer trainer(pool, options);
+        std::vector<HmmFit> fits = trainer.fit(panel, regime_counts);
+
+        fs::create_directories(output_dir);
+        for (const auto& fit : fits) {
+            fs::path model_dir = output_dir / asset / std::to_string(fit.model.states());
+            fs::create_directories(model_dir);
+            fit.model.save((model_dir / "model.hmm").string());
+            std::cerr << fit.model.states() << " regimes: LL " << std::fixed << std::setprecision(1)
+                      << fit.log_likelihood << ", BIC " << fit.bic() << " after " << fit.history.size()
+                      << " iterations" << (fit.converged ? "" : " (not converged)") << "\n";
+        }
+        append_information((output_dir / (asset + "_information.csv")).string(), fits);
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Fitted " << fits.size() << " models in " << std::setprecision(1) << seconds << " s\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
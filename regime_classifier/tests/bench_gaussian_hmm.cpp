@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <feature_set.hpp>
+#include <gaussian_hmm.hpp>
+
+using namespace std::chrono;
+using namespace microregime;
+
+// One filter update per snapshot with every feature in the model, the most
+// the live pipeline can ask of it
+TEST(GaussianHmmBenchmark, PerSnapshotUpdateCost) {
+    constexpr size_t K = 4;
+    constexpr size_t D = kFeatureCount;
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    std::vector<Feature> features;
+    for (size_t i = 0; i < D; ++i) features.push_back(static_cast<Feature>(i));
+    std::vector<double> startprob(K, 1.0 / K);
+    std::vector<double> transmat(K * K, 0.02 / (K - 1));
+    for (size_t k = 0; k < K; ++k) transmat[k * K + k] = 0.98;
+    std::vector<double> means(K * D), covars(K * D * D, 0.0);
+    for (auto& mean : means) mean = noise(rng);
+    for (size_t k = 0; k < K; ++k) {
+        // A A^T + I is positive definite
+        std::vector<double> A(D * D);
+        for (auto& a : A) a = 0.3 * noise(rng);
+        for (size_t i = 0; i < D; ++i) {
+            for (size_t j = 0; j < D; ++j) {
+                double sum = (i == j) ? 1.0 : 0.0;
+                for (size_t m = 0; m < D; ++m) sum += A[i * D + m] * A[j * D + m];
+                covars[k * D * D + i * D + j] = sum;
+            }
+        }
+    }
+    GaussianHmm model(features, startprob, transmat, means, covars);
+    RegimeFilter filter(model);
+
+    std::vector<double> observations(100'000 * D);
+    for (auto& x : observations) x = noise(rng);
+
+    auto start = high_resolution_clock::now();
+    for (size_t t = 0; t < observations.size() / D; ++t) {
+        filter.update({observations.data() + t * D, D});
+    }
+    double ns = duration_cast<duration<double, std::nano>>(high_resolution_clock::now() - start).count();
+    EXPECT_TRUE(std::isfinite(filter.log_likelihood()));
+
+    std::cout << "Forward filter, " << K << " states x " << D << " features: "
+              << ns / (observations.size() / D) << " ns/snapshot" << std::endl;
+}
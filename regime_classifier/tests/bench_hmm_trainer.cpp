@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include <feature_panel.hpp>
+#include <hmm_trainer.hpp>
+#include <thread_pool.hpp>
+
+using namespace std::chrono;
+using namespace microregime;
+
+// Baum-Welch iterations over a panel shaped like classifier.py's input: a
+// day per sequence, five features, four regimes. Compares one worker with
+// one per hardware thread.
+TEST(HmmTrainerBenchmark, IterationCostByPoolSize) {
+    constexpr size_t kDays = 37;
+    constexpr size_t kRowsPerDay = 20'000;
+    constexpr size_t D = 5;
+    std::mt19937_64 rng(9);
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    std::vector<Feature> features;
+    for (size_t i = 0; i < D; ++i) features.push_back(static_cast<Feature>(i));
+    FeaturePanel panel(features);
+    for (size_t day = 0; day < kDays; ++day) {
+        std::vector<double> rows(kRowsPerDay * D);
+        double shift = 0.0;
+        for (size_t t = 0; t < kRowsPerDay; ++t) {
+            if (t % 500 == 0) shift = 2.0 * static_cast<double>(rng() % 4);
+            for (size_t i = 0; i < D; ++i) rows[t * D + i] = shift + noise(rng);
+        }
+        panel.append(rows);
+    }
+
+    HmmTrainerOptions options;
+    options.max_iterations = 5;
+    options.tolerance = -INFINITY;  // Always run every iteration
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads : {size_t{1}, hardware}) {
+        ThreadPool pool(threads);
+        HmmTrainer trainer(pool, options);
+        auto start = high_resolution_clock::now();
+        HmmFit fit = trainer.fit(panel, 4);
+        double ms = duration_cast<duration<double, std::milli>>(high_resolution_clock::now() - start).count();
+        EXPECT_TRUE(std::isfinite(fit.log_likelihood));
+
+        std::cout << "Baum-Welch, " << panel.rows() << " rows x " << D << " features, 4 states, " << threads
+                  << " threads: " << ms / options.max_iterations << " ms/iteration" << std::endl;
+    }
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <gaussian_hmm.hpp>
+#include <regime_reciever.hpp>
+
+using namespace microregime;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Three states over two features, with correlated covariances
+GaussianHmm three_state_model() {
+    return GaussianHmm({Feature::ewm_volatility, Feature::shannon_entropy},
+                       {0.5, 0.3, 0.2},
+                       {0.90, 0.07, 0.03,
+                        0.10, 0.85, 0.05,
+                        0.02, 0.18, 0.80},
+                       {0.0, 0.0,
+                        1.5, -0.5,
+                        -1.0, 2.0},
+                       {1.0, 0.3, 0.3, 0.5,
+                        0.4, -0.1, -0.1, 0.8,
+                        2.0, 0.9, 0.9, 1.2});
+}
+
+// Closed-form 2-D normal density, independent of the Cholesky path
+double density_2d(const GaussianHmm& model, size_t k, const double* x) {
+    auto mu = model.mean(k);
+    auto S = model.covar(k);
+    double det = S[0] * S[3] - S[1] * S[2];
+    double dx = x[0] - mu[0], dy = x[1] - mu[1];
+    double q = (S[3] * dx * dx - 2.0 * S[1] * dx * dy + S[0] * dy * dy) / det;
+    return std::exp(-0.5 * q) / (2.0 * std::numbers::pi * std::sqrt(det));
+}
+
+} // namespace
+
+TEST(GaussianHmmTest, LogDensityMatchesClosedForm) {
+    GaussianHmm model = three_state_model();
+    std::mt19937_64 rng(5);
+    std::normal_distribution<double> noise(0.0, 2.0);
+    for (int i = 0; i < 100; ++i) {
+        double x[2] = {noise(rng), noise(rng)};
+        for (size_t k = 0; k < model.states(); ++k) {
+            EXPECT_NEAR(model.log_density(k, x), std::log(density_2d(model, k, x)), 1e-12);
+        }
+    }
+}
+
+TEST(GaussianHmmTest, FilterMatchesEnumeratingEveryPath) {
+    GaussianHmm model = three_state_model();
+    const size_t K = model.states();
+    std::mt19937_64 rng(11);
+    std::normal_distribution<double> noise(0.0, 1.5);
+    std::vector<double> xs;
+    for (int i = 0; i < 12; ++i) xs.push_back(noise(rng));
+
+    RegimeFilter filter(model);
+    for (size_t T = 1; T <= xs.size() / 2; ++T) {
+        auto posterior = filter.update({&xs[2 * (T - 1)], 2});
+
+        // Sum p(x_1..T, s_1..T) over all K^T paths, by final state
+        std::vector<double> joint(K, 0.0);
+        size_t paths = 1;
+        for (size_t t = 0; t < T; ++t) paths *= K;
+        for (size_t path = 0; path < paths; ++path) {
+            size_t code = path, previous = 0;
+            double p = 1.0;
+            for (size_t t = 0; t < T; ++t) {
+                size_t s = code % K;
+                code /= K;
+                p *= (t == 0 ? model.startprob()[s] : model.transmat()[previous * K + s]) *
+                     density_2d(model, s, &xs[2 * t]);
+                previous = s;
+            }
+            joint[previous] += p;
+        }
+        double evidence = joint[0] + joint[1] + joint[2];
+        for (size_t k = 0; k < K; ++k) {
+            EXPECT_NEAR(posterior[k], joint[k] / evidence, 1e-12) << "t=" << T << " state " << k;
+        }
+        EXPECT_NEAR(filter.log_likelihood(), std::log(evidence), 1e-10);
+    }
+
+    filter.reset();
+    EXPECT_EQ(filter.observations(), 0u);
+    EXPECT_EQ(filter.posterior()[0], 0.5);
+}
+
+TEST(GaussianHmmTest, LongRunsStayNormalizedAndRecoverFromImpossibleSwitches) {
+    // State 1 is unreachable from state 0, yet the data jumps to it
+    GaussianHmm model({Feature::ofi}, {1.0, 0.0}, {1.0, 0.0, 0.0, 1.0}, {0.0, 1000.0}, {1.0, 1.0});
+    RegimeFilter filter(model);
+    std::mt19937_64 rng(2);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    for (int t = 0; t < 20'000; ++t) {
+        double x = noise(rng) + (t < 10'000 ? 0.0 : 1000.0);
+        auto posterior = filter.update({&x, 1});
+        ASSERT_NEAR(posterior[0] + posterior[1], 1.0, 1e-12);
+        ASSERT_EQ(filter.most_likely(), t < 10'000 ? 0u : 1u) << t;
+    }
+    EXPECT_TRUE(std::isfinite(filter.log_likelihood()));
+
+    double bad = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_THROW(filter.update({&bad, 1}), std::invalid_argument);
+}
+
+TEST(GaussianHmmTest, SavesAndLoadsExactly) {
+    fs::path path = fs::temp_directory_path() / "gaussian_hmm_test.hmm";
+    GaussianHmm model = three_state_model();
+    model.save(path.string());
+    GaussianHmm loaded = GaussianHmm::load(path.string());
+    EXPECT_EQ(loaded.features(), model.features());
+    for (size_t k = 0; k < model.states(); ++k) {
+        for (size_t i = 0; i < 4; ++i) EXPECT_EQ(loaded.covar(k)[i], model.covar(k)[i]);
+        double x[2] = {0.25, -0.75};
+        EXPECT_EQ(loaded.log_density(k, x), model.log_density(k, x));
+    }
+
+    std::ofstream(path) << "gaussian_hmm 1\nstates 1\nfeatures 1 not_a_feature\nstartprob 1\n";
+    EXPECT_THROW(GaussianHmm::load(path.string()), std::runtime_error);
+    std::ofstream(path) << "gaussian_hmm 1\nstates 1\nfeatures 1 ofi\nstartprob 1\ntransmat 1\nmeans 0\ncovars\n";
+    EXPECT_THROW(GaussianHmm::load(path.string()), std::runtime_error);
+    fs::remove(path);
+}
+
+TEST(GaussianHmmTest, RejectsInvalidParameters) {
+    auto make = [](std::vector<double> startprob, std::vector<double> transmat, std::vector<double> covars) {
+        return GaussianHmm({Feature::ofi, Feature::lob_slope}, startprob, transmat, {0, 0, 0, 0}, covars);
+    };
+    std::vector<double> spd = {1, 0.5, 0.5, 1, 1, 0, 0, 1};
+    EXPECT_NO_THROW(make({0.5, 0.5}, {0.9, 0.1, 0.2, 0.8}, spd));
+    EXPECT_THROW(make({0.5, 0.6}, {0.9, 0.1, 0.2, 0.8}, spd), std::invalid_argument);
+    EXPECT_THROW(make({0.5, 0.5}, {0.9, 0.2, 0.2, 0.8}, spd), std::invalid_argument);
+    EXPECT_THROW(make({0.5, 0.5}, {0.9, 0.1, 0.2, 0.8}, {1, 2, 2, 1, 1, 0, 0, 1}), std::invalid_argument);
+    EXPECT_THROW(make({0.5, 0.5}, {0.9, 0.1, 0.2, 0.8}, {1, 0.5, 0.4, 1, 1, 0, 0, 1}), std::invalid_argument);
+    EXPECT_THROW(make({0.5, 0.5}, {0.9, 0.1, 0.2, 0.8}, {1, 0, 0, 1}), std::invalid_argument);
+    EXPECT_THROW(GaussianHmm({Feature::ofi, Feature::ofi}, {1}, {1}, {0, 0}, {1, 0, 0, 1}), std::invalid_argument);
+}
+
+TEST(RegimeRecieverTest, FiltersTheModelsFeaturesOfEachSnapshot) {
+    GaussianHmm model = three_state_model();
+    std::vector<size_t> regimes;
+    RegimeReciever reciever(model, [&](const RegimePosterior& posterior) {
+        EXPECT_EQ(posterior.symbol, "SPY");
+        EXPECT_EQ(posterior.probabilities.size(), 3u);
+        regimes.push_back(posterior.regime);
+    });
+
+    RegimeFilter expected(model);
+    FeatureSet raw{}, normalized{};
+    for (uint64_t t = 0; t < 50; ++t) {
+        normalized.ewm_volatility = (t < 25) ? 0.0 : 1.5;
+        normalized.shannon_entropy = (t < 25) ? 0.0 : -0.5;
+        normalized.ofi = 1e6;  // Not a model feature
+        reciever.ingest_feature_set("SPY", t, raw, normalized);
+        double x[2] = {normalized.ewm_volatility, normalized.shannon_entropy};
+        expected.update(x);
+        ASSERT_EQ(reciever.filter().posterior()[1], expected.posterior()[1]);
+    }
+    EXPECT_EQ(regimes.front(), 0u);
+    EXPECT_EQ(regimes.back(), 1u);
+
+    normalized.shannon_entropy = std::numeric_limits<double>::infinity();
+    reciever.ingest_feature_set("SPY", 50, raw, normalized);
+    EXPECT_EQ(reciever.skipped(), 1u);
+    EXPECT_EQ(regimes.size(), 50u);
+}
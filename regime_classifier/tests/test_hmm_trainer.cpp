@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <feature_file.hpp>
+#include <feature_panel.hpp>
+#include <gaussian_hmm.hpp>
+#include <hmm_trainer.hpp>
+#include <pipeline_config.hpp>
+#include <thread_pool.hpp>
+
+using namespace microregime;
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::vector<Feature> kFeatures = {Feature::ewm_volatility, Feature::shannon_entropy};
+
+// Two well separated, sticky regimes over two correlated features
+GaussianHmm two_state_truth() {
+    return GaussianHmm(kFeatures, {0.6, 0.4}, {0.95, 0.05, 0.10, 0.90}, {0.0, 0.0, 3.0, -2.0},
+                       {1.0, 0.4, 0.4, 0.5,
+                        0.3, -0.1, -0.1, 0.6});
+}
+
+// Draw sequences from a 2-feature model through each covariance's Cholesky factor
+FeaturePanel simulate(const GaussianHmm& model, size_t sequences, size_t length, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const size_t K = model.states();
+    auto draw = [&](std::span<const double> p) {
+        double u = uniform(rng);
+        for (size_t k = 0; k + 1 < K; ++k) {
+            if ((u -= p[k]) < 0.0) return k;
+        }
+        return K - 1;
+    };
+    FeaturePanel panel(model.features());
+    for (size_t s = 0; s < sequences; ++s) {
+        std::vector<double> rows;
+        size_t state = draw(model.startprob());
+        for (size_t t = 0; t < length; ++t) {
+            if (t > 0) state = draw(model.transmat().subspan(state * K, K));
+            auto mu = model.mean(state);
+            auto S = model.covar(state);
+            double l00 = std::sqrt(S[0]), l10 = S[2] / l00, l11 = std::sqrt(S[3] - l10 * l10);
+            double z0 = noise(rng), z1 = noise(rng);
+            rows.push_back(mu[0] + l00 * z0);
+            rows.push_back(mu[1] + l10 * z0 + l11 * z1);
+        }
+        panel.append(rows);
+    }
+    return panel;
+}
+
+} // namespace
+
+TEST(HmmTrainerTest, BatchedDensitiesMatchOneAtATime) {
+    std::mt19937_64 rng(3);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    const size_t D = 5, rows = 777;  // Not a whole number of blocks
+    std::vector<Feature> features;
+    for (size_t i = 0; i < D; ++i) features.push_back(static_cast<Feature>(i));
+    std::vector<double> means(D), covars(D * D);
+    for (auto& mean : means) mean = noise(rng);
+    for (size_t i = 0; i < D; ++i) {
+        for (size_t j = 0; j < D; ++j) covars[i * D + j] = (i == j) ? 2.0 : 0.3;
+    }
+    GaussianHmm model(features, {1.0}, {1.0}, means, covars);
+
+    std::vector<double> xs(rows * D), out(rows);
+    for (auto& x : xs) x = noise(rng);
+    model.log_densities(0, xs, out);
+    for (size_t r = 0; r < rows; ++r) {
+        EXPECT_NEAR(out[r], model.log_density(0, {xs.data() + r * D, D}), 1e-12) << "row " << r;
+    }
+}
+
+TEST(HmmTrainerTest, ScoreMatchesTheForwardFilterPerSequence) {
+    GaussianHmm model = two_state_truth();
+    FeaturePanel panel = simulate(model, 3, 500, 1);
+    ThreadPool pool(2);
+    HmmTrainer trainer(pool);
+
+    double expected = 0.0;
+    RegimeFilter filter(model);
+    for (size_t s = 0; s < panel.sequences(); ++s) {
+        auto x = panel.sequence(s);
+        filter.reset();
+        for (size_t t = 0; t < x.size() / 2; ++t) filter.update(x.subspan(2 * t, 2));
+        expected += filter.log_likelihood();
+    }
+    EXPECT_NEAR(trainer.score(model, panel), expected, 1e-8 * std::abs(expected));
+}
+
+TEST(HmmTrainerTest, RecoversSimulatedParameters) {
+    GaussianHmm truth = two_state_truth();
+    FeaturePanel panel = simulate(truth, 8, 2'000, 2);
+    ThreadPool pool(4);
+    HmmTrainer trainer(pool);
+    HmmFit fit = trainer.fit(panel, 2);
+
+    EXPECT_TRUE(fit.converged);
+    for (size_t i = 1; i < fit.history.size(); ++i) {
+        EXPECT_GE(fit.history[i], fit.history[i - 1] - 1e-6) << "iteration " << i;
+    }
+    EXPECT_EQ(fit.log_likelihood, fit.history.back());
+
+    // Label switching: match fitted states to true ones by the first mean
+    size_t high = fit.model.mean(0)[0] > fit.model.mean(1)[0] ? 0 : 1;
+    size_t fitted[2] = {1 - high, high};
+    for (size_t k = 0; k < 2; ++k) {
+        for (size_t i = 0; i < 2; ++i) EXPECT_NEAR(fit.model.mean(fitted[k])[i], truth.mean(k)[i], 0.05);
+        for (size_t i = 0; i < 4; ++i) EXPECT_NEAR(fit.model.covar(fitted[k])[i], truth.covar(k)[i], 0.05);
+        for (size_t j = 0; j < 2; ++j) {
+            EXPECT_NEAR(fit.model.transmat()[fitted[k] * 2 + fitted[j]], truth.transmat()[k * 2 + j], 0.02);
+        }
+    }
+    EXPECT_GT(fit.log_likelihood, trainer.score(truth, panel) - 10.0);
+}
+
+// One state sees every row, so a single M-step is hmmlearn's closed form
+TEST(HmmTrainerTest, MStepCovarianceFollowsHmmlearnsPriorAndFloor) {
+    std::vector<double> xs, rows;
+    for (size_t r = 0; r < 16; ++r) xs.push_back(0.25 * static_cast<double>(r * r % 7));
+    for (double x : xs) rows.insert(rows.end(), {x, 5.0});  // Second feature constant
+    FeaturePanel panel(kFeatures);
+    panel.append(rows);
+    HmmTrainerOptions options;
+    options.max_iterations = 1;
+    ThreadPool pool(1);
+    HmmFit fit = HmmTrainer(pool, options).fit(panel, 1);
+
+    const double n = 16.0;
+    double mean = 0.0, scatter = 0.0;
+    for (double x : xs) mean += x / n;
+    for (double x : xs) scatter += (x - mean) * (x - mean);
+    auto S = fit.model.covar(0);
+    EXPECT_NEAR(fit.model.mean(0)[0], mean, 1e-12);
+    EXPECT_NEAR(S[0], (options.covars_prior + scatter) / n, 1e-12);
+    EXPECT_NEAR(S[1], options.covars_prior / n, 1e-12);
+    EXPECT_NEAR(S[2], S[1], 1e-15);
+    EXPECT_EQ(S[3], options.min_covar);  // covars_prior / n falls below the floor
+
+    options.covars_weight = 4.0;  // Adds 4 - D to the divisor
+    HmmFit weighted = HmmTrainer(pool, options).fit(panel, 1);
+    EXPECT_NEAR(weighted.model.covar(0)[0], (options.covars_prior + scatter) / (n + 2.0), 1e-12);
+
+    options.covars_prior = -1.0;
+    EXPECT_THROW(HmmTrainer(pool, options), std::invalid_argument);
+}
+
+TEST(HmmTrainerTest, ConcurrentFitsMatchSerialOnAnyPoolSize) {
+    FeaturePanel panel = simulate(two_state_truth(), 6, 400, 4);
+    HmmTrainerOptions options;
+    options.max_iterations = 30;
+
+    ThreadPool one(1);
+    HmmFit serial = HmmTrainer(one, options).fit(panel, 3);
+
+    ThreadPool four(4);
+    const size_t counts[] = {1, 2, 3};
+    auto fits = HmmTrainer(four, options).fit(panel, counts);
+    ASSERT_EQ(fits.size(), 3u);
+    EXPECT_EQ(fits[2].log_likelihood, serial.log_likelihood);
+    EXPECT_EQ(fits[2].history, serial.history);
+    for (size_t k = 0; k < 3; ++k) EXPECT_EQ(fits[2].model.mean(k)[0], serial.model.mean(k)[0]);
+
+    // hmmlearn's "stmc" count: (K-1) + K(K-1) + KD + KD(D+1)/2
+    EXPECT_EQ(fits[0].parameters(), 5u);
+    EXPECT_EQ(fits[2].parameters(), 2u + 6u + 6u + 9u);
+    EXPECT_DOUBLE_EQ(fits[1].bic(), -2.0 * fits[1].log_likelihood + 13.0 * std::log(2400.0));
+    EXPECT_DOUBLE_EQ(fits[1].aic(), -2.0 * fits[1].log_likelihood + 26.0);
+    EXPECT_LT(fits[1].bic(), fits[0].bic());
+
+    const size_t too_many[] = {2, 3000};
+    EXPECT_THROW(HmmTrainer(four, options).fit(panel, too_many), std::invalid_argument);
+}
+
+TEST(HmmTrainerTest, AppendsClassifierInformationRows) {
+    fs::path path = fs::temp_directory_path() / "hmm_trainer_test_information.csv";
+    fs::remove(path);
+    FeaturePanel panel = simulate(two_state_truth(), 2, 200, 5);
+    ThreadPool pool(2);
+    HmmTrainerOptions options;
+    options.max_iterations = 5;
+    std::vector<HmmFit> fits = {HmmTrainer(pool, options).fit(panel, 2)};
+    append_information(path.string(), fits);
+    append_information(path.string(), fits);
+
+    std::ifstream in(path);
+    std::string header, row, again;
+    std::getline(in, header);
+    std::getline(in, row);
+    std::getline(in, again);
+    EXPECT_EQ(header, "regime_count,AIC,BIC,LL,SIL,DB,CH");
+    EXPECT_EQ(row, again);
+    EXPECT_EQ(row.substr(0, 2), "2,");
+    EXPECT_EQ(row.substr(row.size() - 3), ",,,");
+    std::stringstream fields(row);
+    std::string field;
+    std::getline(fields, field, ',');
+    std::getline(fields, field, ',');
+    EXPECT_EQ(std::stod(field), fits[0].aic());
+    fs::remove(path);
+}
+
+TEST(FeaturePanelTest, LoadsFeatureFilesAndCsvsAlike) {
+    fs::path dir = fs::temp_directory_path() / "feature_panel_test";
+    fs::create_directories(dir);
+    PipelineConfig config;
+    FeatureSet raw{}, normalized{};
+    {
+        std::ofstream csv(dir / "base_SPY_norm.csv");
+        csv << "timestamp_ns,instrument";
+        for (auto name : kFeatureNames) csv << ',' << name;
+        csv << "\r\n" << std::setprecision(17);
+        FeatureFileWriter writer((dir / "base_SPY.features").string(), "SPY", "20250505", config, 4);
+        for (uint64_t t = 0; t < 10; ++t) {
+            for (size_t i = 0; i < kFeatureCount; ++i) normalized.*kFeatureMembers[i] = t * 0.1 + i;
+            writer.ingest_feature_set("SPY", t, raw, normalized);
+            csv << t << ",SPY";
+            for (auto member : kFeatureMembers) csv << ',' << normalized.*member;
+            csv << "\r\n";
+        }
+    }
+
+    FeaturePanel panel(kFeatures);
+    panel.load((dir / "base_SPY.features").string());
+    panel.load((dir / "base_SPY_norm.csv").string());
+    ASSERT_EQ(panel.sequences(), 2u);
+    ASSERT_EQ(panel.rows(), 20u);
+    for (size_t i = 0; i < 20; ++i) {
+        EXPECT_EQ(panel.sequence(0)[i], panel.sequence(1)[i]);
+    }
+    EXPECT_EQ(panel.sequence(1)[2 * 3 + 1], 0.3 + feature_index(Feature::shannon_entropy));
+
+    std::ofstream(dir / "missing.csv") << "timestamp_ns,instrument,ewm_volatility\n1,SPY,0.5\n";
+    EXPECT_THROW(panel.load((dir / "missing.csv").string()), std::runtime_error);
+    std::ofstream(dir / "nan.csv") << "timestamp_ns,ewm_volatility,shannon_entropy\n1,0.5,1\n2,nan,1\n";
+    EXPECT_THROW(panel.load((dir / "nan.csv").string()), std::runtime_error);
+    EXPECT_EQ(panel.rows(), 20u);
+    EXPECT_EQ(panel.sequences(), 2u);
+    fs::remove_all(dir);
+}
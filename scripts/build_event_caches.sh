@@ -0,0 +1,46 @@
+#!/bin/bash
+
+# One-time conversion of each day's DBN files into event caches (data/<asset>/*.mbo.events).
+# features_to_csv picks the caches up automatically, so parameter sweeps skip zstd decoding.
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+CONVERTER=C:/Users/jackd/OneDrive/Documents/MicroRegimeProject/build/data_ingestion/Debug/build_event_cache.exe
+
+# Same dates as multidate_feature_to_csv.sh
+DATES=(
+    "20250430" "20250501" "20250502"
+    "20250505" "20250506" "20250507" "20250508" "20250509"
+    "20250512" "20250513" "20250514" "20250515" "20250516"
+    "20250519" "20250520" "20250521" "20250522" "20250523"
+    "20250527" "20250528" "20250529" "20250530"
+    "20250602" "20250603" "20250604" "20250605" "20250606"
+    "20250609" "20250610" "20250611" "20250612" "20250613"
+    "20250616" "20250617" "20250618" "20250620"
+    "20250623" "20250624" "20250625" "20250626" "20250627"
+    "20250630" "20250701" "20250702" "20250703"
+    "20250707" "20250708" "20250709" "20250710" "20250711"
+    "20250714" "20250715" "20250716" "20250717" "20250718"
+    "20250721" "20250722" "20250723" "20250724" "20250725"
+)
+
+for date in "${DATES[@]}"; do
+    for pair in "SPY:xnas-itch" "ES:glbx-mdp3"; do
+        asset="${pair%%:*}"
+        dataset="${pair#*:}"
+        input="$PROJECT_ROOT/data/$asset/$dataset-$date.mbo.dbn.zst"
+        output="$PROJECT_ROOT/data/$asset/$dataset-$date.mbo.events"
+        if [ ! -f "$input" ]; then
+            echo "Missing $input, skipping"
+            continue
+        fi
+        if [ -f "$output" ] && [ "$output" -nt "$input" ]; then
+            echo "Up to date: $output"
+            continue
+        fi
+        "$CONVERTER" "$input" "$asset" "$output" &
+    done
+    wait
+done
+
+echo "All event caches built!"
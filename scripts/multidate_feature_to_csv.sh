@@ -20,52 +20,11 @@ DATES=(
     "20250721" "20250722" "20250723" "20250724" "20250725"
 )
 
-# Maximum number of parallel processes (adjust based on your CPU cores)
+# Worker threads; features_to_csv defaults to one per core
 MAX_JOBS=8
 
-echo "Starting parallel processing with max $MAX_JOBS concurrent jobs..."
-
-# Array to store process IDs
-declare -a PIDS=()
-
-# Function to check and wait for processes to complete if we've hit the max
-wait_if_busy() {
-    while [ ${#PIDS[@]} -ge $MAX_JOBS ]; do
-        # Check for completed processes
-        for i in "${!PIDS[@]}"; do
-            if ! kill -0 "${PIDS[$i]}" 2>/dev/null; then
-                # Process has completed, remove from array
-                unset "PIDS[$i]"
-            fi
-        done
-        # Rebuild the array to remove empty indices
-        PIDS=("${PIDS[@]}")
-        
-        # If we're still at max, wait a bit before checking again
-        if [ ${#PIDS[@]} -ge $MAX_JOBS ]; then
-            sleep 1
-        fi
-    done
-}
-
-# Process each date
-for date in "${DATES[@]}"; do
-    # Wait if we've hit the maximum number of parallel jobs
-    wait_if_busy
-    
-    # Start the process in the background
-    (
-        echo "Starting processing for $date"
-        C:/Users/jackd/OneDrive/Documents/MicroRegimeProject/build/feature_generation/Debug/features_to_csv.exe "$date" SPY ES
-        echo "Finished processing $date"
-    ) &
-    
-    # Store the process ID
-    PIDS+=($!)
-    echo "Started process for $date (PID: ${PIDS[-1]})"
-done
-
-# Wait for all remaining background processes to complete
-wait
+# One process runs every day on a shared work-stealing pool, largest days first
+DATE_LIST=$(IFS=,; echo "${DATES[*]}")
+C:/Users/jackd/OneDrive/Documents/MicroRegimeProject/build/feature_generation/Debug/features_to_csv.exe "$DATE_LIST" SPY ES --jobs "$MAX_JOBS"
 
 echo "All processing complete!"